@@ -0,0 +1,120 @@
+#ifndef ASTDIFF_H
+#define ASTDIFF_H
+
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <iostream>
+
+/**
+ * 编辑操作的种类
+ */
+enum class ASTEditKind {
+    Update,  // 节点匹配但自身属性（名字、运算符、取值等）改变
+    Move,    // 节点匹配但换了父节点或在兄弟中的次序
+    Insert,  // 新版本中无匹配的子树
+    Delete   // 旧版本中无匹配的子树
+};
+
+/**
+ * 一个编辑操作；oldNode/newNode 为两棵树中的节点序号，不适用时为-1
+ */
+struct ASTEdit {
+    ASTEditKind kind = ASTEditKind::Update;
+    int oldNode = -1;
+    int newNode = -1;
+};
+
+/**
+ * 比较统计
+ */
+struct ASTDiffStats {
+    size_t oldNodes = 0;
+    size_t newNodes = 0;
+    size_t matched = 0;          // 匹配的节点对
+    size_t topLevel = 0;         // 旧版本的顶层声明数
+    size_t unchangedTopLevel = 0;  // 按子树哈希整体匹配、不再细化的顶层声明
+    size_t updates = 0;
+    size_t moves = 0;
+    size_t inserts = 0;
+    size_t deletes = 0;
+};
+
+/**
+ * 语法树级别的差异比较（GumTree风格）
+ * 1. 为每棵子树计算Merkle哈希（种类、自身属性与各子节点位置的哈希），哈希相同的子树结构与内容相同；
+ * 2. 自顶向下：按前序把旧树中未匹配的子树与新树中哈希相同的子树整体配对，
+ *    未改动的函数在这一步整体匹配，之后各步直接跳过；两边不唯一的子树在同名函数配对后，
+ *    只与同一个已匹配祖先之下的相同子树配对；
+ * 3. 自底向上：未匹配的内部节点与其已匹配后代所指向的新节点祖先比较，
+ *    共同后代占比（Dice系数）足够高时配对；
+ * 4. 恢复：已匹配节点的未匹配子节点按种类与属性、再按子节点位置配对；
+ * 最后由匹配关系得到更新、移动（换父节点或不在兄弟次序的最长递增子序列中）、插入与删除。
+ */
+class ASTDiff {
+private:
+    // 扁平化的树节点，按前序编号，子树 i 占据 [i, i + size)
+    struct TreeNode {
+        const ASTNode* ast = nullptr;
+        int parent = -1;
+        int slot = 0;               // 在父节点子节点位置中的序号（含空位置）
+        int top = -1;               // 所属的顶层声明（根节点的子节点）
+        std::vector<int> children;  // 非空子节点
+        uint64_t label = 0;         // 种类与自身属性的哈希
+        uint64_t hash = 0;          // Merkle哈希
+        size_t size = 1;
+        int height = 1;
+        int partner = -1;
+        bool exact = false;         // 作为整棵相同子树的一部分匹配
+    };
+
+    // 一个版本
+    struct Tree {
+        std::string path;
+        bool loaded = false;
+        std::vector<std::string> diagnostics;
+        std::unique_ptr<ProgramNode> program;
+        std::vector<TreeNode> nodes;
+    };
+
+    Tree oldTree;
+    Tree newTree;
+    std::vector<ASTEdit> edits;
+
+    // 私有辅助方法
+    bool loadTree(const std::string& path, Tree& tree) const;
+    static int addNode(Tree& tree, const ASTNode& node, int parent, int slot);
+    static bool eligible(const TreeNode& node);
+    static bool rangeFree(const std::vector<TreeNode>& nodes, int root);
+    static int anchorOf(const std::vector<TreeNode>& nodes, int node);
+    void link(int oldNode, int newNode, bool exact);
+    void linkSubtrees(int oldRoot, int newRoot);
+    std::vector<int> matchIdenticalSubtrees(ASTDiffStats& stats);
+    void matchFunctionsByName();
+    void matchAmbiguousSubtrees(const std::vector<int>& ambiguous);
+    void matchBottomUp();
+    void recoverChildren();
+    void generateEdits(ASTDiffStats& stats);
+    // 编辑所属的顶层声明：旧版本节点序号，仅在新版本中的为旧版本节点数加新版本序号，顶层本身为-1
+    long groupOf(const ASTEdit& edit) const;
+    std::string describe(const Tree& tree, int node) const;
+
+public:
+    /**
+     * 比较两个文件
+     * @return 两个文件都能读取且没有词法或语法错误时返回true
+     */
+    bool compare(const std::string& oldPath, const std::string& newPath, ASTDiffStats& stats);
+
+    // 按所属的顶层声明与位置排列的编辑操作
+    const std::vector<ASTEdit>& getEdits() const;
+
+    // 读取或解析失败的原因
+    std::vector<std::string> getDiagnostics() const;
+
+    void printReport(std::ostream& os, const ASTDiffStats& stats) const;
+};
+
+#endif // ASTDIFF_H
@@ -0,0 +1,41 @@
+#ifndef ASTPRINTER_H
+#define ASTPRINTER_H
+
+#include "Parser.h"
+#include <string>
+#include <iostream>
+#include <cstddef>
+
+/**
+ * 语法树输出格式
+ */
+enum class ASTDumpFormat {
+    Chinese,  // 缩进的中文文本（分析结果中显示的格式）
+    JSON,     // 嵌套对象，子节点带有所在位置的角色，如 "condition"、"body"
+    Dot       // Graphviz 有向图
+};
+
+/**
+ * 语法树打印器
+ * 按节点种类分派的单个访问者，写入固定大小的输出缓冲区，缩进取自预先生成的空格串，
+ * 每行不再单独刷新输出流；大文件的输出只在缓冲区满时写出。
+ */
+class ASTPrinter {
+private:
+    ASTDumpFormat format;
+    size_t bufferSize;
+
+public:
+    explicit ASTPrinter(ASTDumpFormat format, size_t bufferSize = 1 << 16);
+
+    // 由名称（text、json、dot）取得格式，名称无效时返回false
+    static bool parseFormat(const std::string& name, ASTDumpFormat& format);
+
+    /**
+     * 输出整棵语法树
+     * @return 写入的字节数
+     */
+    size_t print(const ProgramNode& program, std::ostream& out) const;
+};
+
+#endif // ASTPRINTER_H
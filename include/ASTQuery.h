@@ -0,0 +1,82 @@
+#ifndef ASTQUERY_H
+#define ASTQUERY_H
+
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <memory>
+
+class ProjectAnalyzer;
+class SymbolIndex;
+struct ParsedUnit;
+
+/**
+ * 一个查询结果
+ */
+struct QueryMatch {
+    std::string file;
+    int line = 0;
+    int column = 0;
+    std::string kind;  // 节点种类（查询语言中的名字）
+    std::string text;  // 所在源码行（被包含文件中的节点为节点描述）
+};
+
+/**
+ * 一次查询的统计
+ */
+struct QueryStats {
+    size_t files = 0;    // 输入文件数
+    size_t skipped = 0;  // 根据符号索引跳过的文件
+    size_t parsed = 0;   // 实际分析的文件
+    size_t matches = 0;
+};
+
+/**
+ * 语法树查询
+ * 查询语言：
+ *   pattern    := '_' | kind [ '(' constraint { ',' constraint } ')' ]
+ *   constraint := field ('=' | '!=') value
+ *   value      := "字符串" | 整数 | pattern | none
+ * 例如 call(name="f", arg0=literal)、for(init=var(type="float"))、if(else=none)。
+ * 编译时检查字段是否适用于节点种类，并把约束排成先比较字符串/整数、后匹配子模式的顺序；
+ * 匹配时按节点种类直接分派，不做字符串查找。
+ */
+class ASTQuery {
+public:
+    struct Pattern;
+
+private:
+    std::unique_ptr<Pattern> root;
+    std::vector<std::string> requiredNames;  // 能匹配的文件中必然出现的函数名（用于索引过滤）
+
+public:
+    ASTQuery();
+    ~ASTQuery();
+
+    /**
+     * 编译查询
+     * @param error 语法错误或字段不适用时的说明
+     */
+    bool compile(const std::string& text, std::string& error);
+
+    // 节点本身是否匹配
+    bool matches(const ASTNode& node) const;
+
+    // 一个翻译单元中所有匹配的节点（前序）
+    std::vector<QueryMatch> find(const ParsedUnit& unit) const;
+
+    /**
+     * 在多个文件中并行查询
+     * @param index 可选的符号索引：索引仍有效且不含必需函数名的文件直接跳过
+     * @return 按文件顺序排列的结果，与线程数无关
+     */
+    std::vector<QueryMatch> run(const std::vector<std::string>& files, const ProjectAnalyzer& frontEnd,
+                                size_t threadCount, const SymbolIndex* index, QueryStats& stats) const;
+
+    const std::vector<std::string>& getRequiredNames() const;
+
+    // 节点种类在查询语言中的名字
+    static const char* kindName(ASTNodeKind kind);
+};
+
+#endif // ASTQUERY_H
@@ -0,0 +1,271 @@
+#ifndef ASTWALKER_H
+#define ASTWALKER_H
+
+#include "Parser.h"
+
+/**
+ * 语法树遍历工具
+ * 按节点种类分派，不使用dynamic_cast；模板形式便于编译器内联回调。
+ */
+
+/**
+ * 依次对节点的每个子节点位置调用 fn(const ASTNode*)，空位置（如没有else分支）传入nullptr
+ * 同种类节点的位置一一对应，可用于比较两棵子树的结构
+ */
+template <typename Fn>
+void forEachChildSlot(const ASTNode& node, Fn&& fn) {
+    auto visit = [&fn](const std::unique_ptr<ASTNode>& child) {
+        fn(child.get());
+    };
+
+    switch (node.getKind()) {
+        case ASTNodeKind::Program:
+            for (const auto& statement : static_cast<const ProgramNode&>(node).statements) {
+                visit(statement);
+            }
+            break;
+        case ASTNodeKind::VarDeclaration:
+            visit(static_cast<const VarDeclarationNode&>(node).initializer);
+            break;
+        case ASTNodeKind::Assignment:
+            visit(static_cast<const AssignmentNode&>(node).expression);
+            break;
+        case ASTNodeKind::BinaryExpression: {
+            const auto& binary = static_cast<const BinaryExpressionNode&>(node);
+            visit(binary.left);
+            visit(binary.right);
+            break;
+        }
+        case ASTNodeKind::UnaryExpression:
+            visit(static_cast<const UnaryExpressionNode&>(node).operand);
+            break;
+        case ASTNodeKind::IfStatement: {
+            const auto& ifStmt = static_cast<const IfStatementNode&>(node);
+            visit(ifStmt.condition);
+            visit(ifStmt.thenStatement);
+            visit(ifStmt.elseStatement);
+            break;
+        }
+        case ASTNodeKind::WhileStatement: {
+            const auto& whileStmt = static_cast<const WhileStatementNode&>(node);
+            visit(whileStmt.condition);
+            visit(whileStmt.body);
+            break;
+        }
+        case ASTNodeKind::CompoundStatement:
+            for (const auto& statement : static_cast<const CompoundStatementNode&>(node).statements) {
+                visit(statement);
+            }
+            break;
+        case ASTNodeKind::ReturnStatement:
+            visit(static_cast<const ReturnStatementNode&>(node).expression);
+            break;
+        case ASTNodeKind::FunctionDeclaration:
+            for (const auto& parameter : static_cast<const FunctionDeclarationNode&>(node).parameters) {
+                visit(parameter);
+            }
+            break;
+        case ASTNodeKind::FunctionDefinition: {
+            const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+            for (const auto& parameter : function.parameters) {
+                visit(parameter);
+            }
+            visit(function.body);
+            break;
+        }
+        case ASTNodeKind::ExpressionStatement:
+            visit(static_cast<const ExpressionStatementNode&>(node).expression);
+            break;
+        case ASTNodeKind::FunctionCall:
+            for (const auto& argument : static_cast<const FunctionCallNode&>(node).arguments) {
+                visit(argument);
+            }
+            break;
+        case ASTNodeKind::ForStatement: {
+            const auto& forStmt = static_cast<const ForStatementNode&>(node);
+            visit(forStmt.initialization);
+            visit(forStmt.condition);
+            visit(forStmt.update);
+            visit(forStmt.body);
+            break;
+        }
+        case ASTNodeKind::IndexExpression: {
+            const auto& index = static_cast<const IndexExpressionNode&>(node);
+            visit(index.array);
+            visit(index.index);
+            break;
+        }
+        case ASTNodeKind::Literal:
+        case ASTNodeKind::Identifier:
+        case ASTNodeKind::PreprocessorDirective:
+        case ASTNodeKind::BreakStatement:
+        case ASTNodeKind::ContinueStatement:
+        case ASTNodeKind::ArrayDeclaration:
+            break;
+    }
+}
+
+/**
+ * 节点自身（不含子节点）的字符串属性，同种类节点按位置一一对应
+ */
+inline std::vector<std::string> nodeFields(const ASTNode& node) {
+    switch (node.getKind()) {
+        case ASTNodeKind::VarDeclaration: {
+            const auto& var = static_cast<const VarDeclarationNode&>(node);
+            return {var.type, var.identifier};
+        }
+        case ASTNodeKind::Assignment:
+            return {static_cast<const AssignmentNode&>(node).identifier};
+        case ASTNodeKind::BinaryExpression:
+            return {static_cast<const BinaryExpressionNode&>(node).operator_};
+        case ASTNodeKind::UnaryExpression:
+            return {static_cast<const UnaryExpressionNode&>(node).operator_};
+        case ASTNodeKind::Literal: {
+            const auto& literal = static_cast<const LiteralNode&>(node);
+            return {literal.value, std::to_string(static_cast<int>(literal.type))};
+        }
+        case ASTNodeKind::Identifier:
+            return {static_cast<const IdentifierNode&>(node).name};
+        case ASTNodeKind::PreprocessorDirective: {
+            const auto& directive = static_cast<const PreprocessorDirectiveNode&>(node);
+            return {directive.directive, directive.content};
+        }
+        case ASTNodeKind::FunctionDeclaration: {
+            const auto& function = static_cast<const FunctionDeclarationNode&>(node);
+            return {function.returnType, function.name};
+        }
+        case ASTNodeKind::FunctionDefinition: {
+            const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+            return {function.returnType, function.name};
+        }
+        case ASTNodeKind::FunctionCall:
+            return {static_cast<const FunctionCallNode&>(node).name};
+        case ASTNodeKind::ArrayDeclaration: {
+            const auto& array = static_cast<const ArrayDeclarationNode&>(node);
+            return {array.type, array.identifier, std::to_string(array.size)};
+        }
+        default:
+            return {};
+    }
+}
+
+/**
+ * 节点覆盖的源码文本：token之间以一个空格分隔（括号内侧与逗号前不加），超过maxLength时截断
+ */
+inline std::string sourceText(const ASTNode& node, const std::vector<Token>& tokens, size_t maxLength = 60) {
+    std::string text;
+    const Token* previous = nullptr;
+    for (size_t i = node.firstToken; i <= node.lastToken && i < tokens.size(); i++) {
+        const Token& token = tokens[i];
+        if (token.type == TokenType::NEWLINE || token.type == TokenType::EOF_TOKEN) {
+            continue;
+        }
+        bool glue = previous && (previous->type == TokenType::LPAREN || token.type == TokenType::RPAREN ||
+                                 previous->type == TokenType::LBRACKET || token.type == TokenType::RBRACKET ||
+                                 token.type == TokenType::COMMA ||
+                                 ((token.type == TokenType::LPAREN || token.type == TokenType::LBRACKET) &&
+                                  previous->type == TokenType::IDENTIFIER));
+        if (previous && !glue) {
+            text += ' ';
+        }
+        text += token.type == TokenType::STRING ? "\"" + token.value + "\"" : token.value;
+        previous = &token;
+    }
+    if (text.size() > maxLength && maxLength > 3) {
+        text = text.substr(0, maxLength - 3) + "...";
+    }
+    return text;
+}
+
+/**
+ * 自增自减写成标识符节点："i++"、"++i"、"i--"、"--i"
+ * 拆出变量名、步长（1或-1）与是否为前缀形式；不是自增自减时返回false
+ */
+inline bool splitIncrement(const std::string& name, std::string& variable, int& delta, bool& prefix) {
+    if (name.size() < 3) {
+        return false;
+    }
+    std::string head = name.substr(0, 2);
+    std::string tail = name.substr(name.size() - 2);
+    if (head == "++" || head == "--") {
+        variable = name.substr(2);
+        delta = head == "++" ? 1 : -1;
+        prefix = true;
+        return true;
+    }
+    if (tail == "++" || tail == "--") {
+        variable = name.substr(0, name.size() - 2);
+        delta = tail == "++" ? 1 : -1;
+        prefix = false;
+        return true;
+    }
+    return false;
+}
+
+inline bool splitIncrement(const std::string& name, std::string& variable) {
+    int delta;
+    bool prefix;
+    return splitIncrement(name, variable, delta, prefix);
+}
+
+// 自增自减修改的变量名，不是自增自减时返回空串
+inline std::string incrementTarget(const std::string& name) {
+    std::string variable;
+    return splitIncrement(name, variable) ? variable : "";
+}
+
+inline bool isComparison(const std::string& op) {
+    return op == "<" || op == "<=" || op == ">" || op == ">=" || op == "==" || op == "!=";
+}
+
+// 赋值运算：语法分析器把赋值建成运算符为 "=" 的二元表达式
+inline bool isAssignmentOperator(const std::string& op) {
+    return op == "=" || op == "+=" || op == "-=" || op == "*=" || op == "/=" || op == "%=";
+}
+
+// 条件不成立时的比较运算
+inline std::string negateComparison(const std::string& op) {
+    if (op == "<") return ">=";
+    if (op == "<=") return ">";
+    if (op == ">") return "<=";
+    if (op == ">=") return "<";
+    if (op == "==") return "!=";
+    return "==";
+}
+
+// 交换两个运算对象后的比较运算
+inline std::string swapComparison(const std::string& op) {
+    if (op == "<") return ">";
+    if (op == "<=") return ">=";
+    if (op == ">") return "<";
+    if (op == ">=") return "<=";
+    return op;
+}
+
+/**
+ * 依次对节点的每个非空子节点调用 fn(const ASTNode&)
+ */
+template <typename Fn>
+void forEachChild(const ASTNode& node, Fn&& fn) {
+    forEachChildSlot(node, [&fn](const ASTNode* child) {
+        if (child) {
+            fn(*child);
+        }
+    });
+}
+
+/**
+ * 前序遍历整棵子树，对每个节点调用 fn(const ASTNode&)
+ * fn 返回false时不再进入该节点的子节点
+ */
+template <typename Fn>
+void walkAST(const ASTNode& node, Fn&& fn) {
+    if (!fn(node)) {
+        return;
+    }
+    forEachChild(node, [&fn](const ASTNode& child) {
+        walkAST(child, fn);
+    });
+}
+
+#endif // ASTWALKER_H
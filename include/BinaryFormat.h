@@ -0,0 +1,106 @@
+#ifndef BINARYFORMAT_H
+#define BINARYFORMAT_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * 磁盘结构中对字符串表的引用
+ */
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+/**
+ * 磁盘结构中的一个数据段（起始偏移与元素个数）
+ */
+struct SectionInfo {
+    uint64_t offset;
+    uint64_t count;
+};
+
+/**
+ * 二进制文件构建器
+ * 按段追加定长记录，字符串统一放入去重后的字符串表。
+ * 生成的文件各段按8字节对齐，可以直接mmap后按结构体读取。
+ */
+class BinaryWriter {
+private:
+    std::string buffer;
+    std::string strings;
+    std::unordered_map<std::string, StringRef> stringIndex;
+
+public:
+    // 在文件开头预留文件头的位置
+    explicit BinaryWriter(size_t headerSize);
+
+    // 加入字符串表，相同内容只存一份
+    StringRef addString(const std::string& str);
+
+    // 追加一个段，返回其位置
+    template <typename Record>
+    SectionInfo addSection(const std::vector<Record>& records) {
+        align();
+        SectionInfo info{buffer.size(), records.size()};
+        if (!records.empty()) {
+            buffer.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+        }
+        return info;
+    }
+
+    // 写入字符串表段（应在所有addString之后调用）
+    SectionInfo addStringTable();
+
+    // 填写文件头
+    void setHeader(const void* header, size_t size);
+
+    // 先写临时文件再改名，读者不会看到写了一半的文件
+    bool writeAtomically(const std::string& path) const;
+
+    // 以同样方式写入任意内容（文本文件的原子替换也用它）
+    // 临时文件在目标目录中由mkstemp创建，落盘后再改名；替换已有文件时保留它的权限位
+    static bool writeFileAtomically(const std::string& path, const char* data, size_t size);
+
+    size_t size() const;
+
+private:
+    void align();
+};
+
+/**
+ * 二进制文件读取器（配合MappedFile使用）
+ */
+class BinaryReader {
+private:
+    const char* data;
+    size_t size;
+    SectionInfo stringTable;
+
+public:
+    BinaryReader(const char* data, size_t size);
+
+    void setStringTable(const SectionInfo& table);
+
+    // 检查段是否完整地位于文件内
+    template <typename Record>
+    bool checkSection(const SectionInfo& section) const {
+        return section.offset % alignof(Record) == 0 &&
+               section.offset <= size &&
+               section.count <= (size - section.offset) / sizeof(Record);
+    }
+
+    template <typename Record>
+    const Record* section(const SectionInfo& info) const {
+        return reinterpret_cast<const Record*>(data + info.offset);
+    }
+
+    bool checkString(const StringRef& ref) const;
+    std::string getString(const StringRef& ref) const;
+    const char* stringData(const StringRef& ref) const;
+};
+
+#endif // BINARYFORMAT_H
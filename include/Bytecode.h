@@ -0,0 +1,198 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+/**
+ * 操作数种类（反汇编与代码变换据此区分寄存器、立即数与跳转目标）
+ */
+enum class OperandKind : uint8_t {
+    None,
+    Register,   // 当前帧中的寄存器
+    Immediate,  // 32位有符号立即数
+    Target,     // 跳转目标（指令下标）
+    Function,   // 函数表下标
+    Global,     // 全局变量槽位
+    Format,     // printf格式串表下标
+    Loop        // 函数的并行循环表下标
+};
+
+/**
+ * 指令表：名称与三个操作数 a、b、c 的种类
+ * - 整数运算按64位补码回绕，DIV/MOD的除数为0时报运行时错误；浮点运算为double，F2I向零取整
+ * - 比较的结果为0或1；条件跳转 Jxx a, b, target 在 R[a] xx R[b] 成立时跳转
+ * - LOADI R[a] = b；ADDK R[a] = R[b] + c
+ * - ARRAY 把帧内偏移b处的c个元素清零并令R[a]指向首元素；CHECKLEN 在数组R[a]的长度不足b时报错
+ * - LOADELEM R[a] = R[b][R[c]]；STOREELEM R[a][R[b]] = R[c]；带 _U 后缀的版本不检查下标
+ * - GARRAY 令R[a]指向全局数组b的首元素
+ * - CALL R[a] = 函数b(R[c], R[c+1], ...)；PRINTF R[a] = 按格式串b输出R[c]起的实参
+ * - PARFOR a, b, target：R[a]为归纳变量的初值，按并行循环表第b项把剩余的迭代分块并行执行，
+ *   完成后跳到target；迭代次数不足阈值或没有工作线程时顺序执行下一条指令（即串行的循环）
+ */
+#define BYTECODE_OPCODES(X)                       \
+    X(NOP,         None,     None,      None)      \
+    X(LOADI,       Register, Immediate, None)      \
+    X(MOVE,        Register, Register,  None)      \
+    X(ADD,         Register, Register,  Register)  \
+    X(SUB,         Register, Register,  Register)  \
+    X(MUL,         Register, Register,  Register)  \
+    X(DIV,         Register, Register,  Register)  \
+    X(MOD,         Register, Register,  Register)  \
+    X(ADDK,        Register, Register,  Immediate) \
+    X(NEG,         Register, Register,  None)      \
+    X(NOT,         Register, Register,  None)      \
+    X(FADD,        Register, Register,  Register)  \
+    X(FSUB,        Register, Register,  Register)  \
+    X(FMUL,        Register, Register,  Register)  \
+    X(FDIV,        Register, Register,  Register)  \
+    X(FNEG,        Register, Register,  None)      \
+    X(I2F,         Register, Register,  None)      \
+    X(F2I,         Register, Register,  None)      \
+    X(LT,          Register, Register,  Register)  \
+    X(LE,          Register, Register,  Register)  \
+    X(EQ,          Register, Register,  Register)  \
+    X(NE,          Register, Register,  Register)  \
+    X(FLT,         Register, Register,  Register)  \
+    X(FLE,         Register, Register,  Register)  \
+    X(FEQ,         Register, Register,  Register)  \
+    X(FNE,         Register, Register,  Register)  \
+    X(JMP,         Target,   None,      None)      \
+    X(JZ,          Register, Target,    None)      \
+    X(JNZ,         Register, Target,    None)      \
+    X(JLT,         Register, Register,  Target)    \
+    X(JLE,         Register, Register,  Target)    \
+    X(JEQ,         Register, Register,  Target)    \
+    X(JNE,         Register, Register,  Target)    \
+    X(ARRAY,       Register, Immediate, Immediate) \
+    X(CHECKLEN,    Register, Immediate, None)      \
+    X(LOADELEM,    Register, Register,  Register)  \
+    X(LOADELEM_U,  Register, Register,  Register)  \
+    X(STOREELEM,   Register, Register,  Register)  \
+    X(STOREELEM_U, Register, Register,  Register)  \
+    X(GLOAD,       Register, Global,    None)      \
+    X(GSTORE,      Global,   Register,  None)      \
+    X(GARRAY,      Register, Global,    None)      \
+    X(CALL,        Register, Function,  Register)  \
+    X(PRINTF,      Register, Format,    Register)  \
+    X(PARFOR,      Register, Loop,      Target)    \
+    X(RET,         Register, None,      None)      \
+    X(RETV,        None,     None,      None)
+
+enum class Opcode : uint8_t {
+#define BYTECODE_OPCODE_ENUM(name, a, b, c) name,
+    BYTECODE_OPCODES(BYTECODE_OPCODE_ENUM)
+#undef BYTECODE_OPCODE_ENUM
+};
+
+#define BYTECODE_OPCODE_COUNT_ONE(name, a, b, c) +1
+constexpr size_t OPCODE_COUNT = 0 BYTECODE_OPCODES(BYTECODE_OPCODE_COUNT_ONE);
+#undef BYTECODE_OPCODE_COUNT_ONE
+
+const char* opcodeName(Opcode op);
+
+// 指令第slot个操作数（0、1、2分别为a、b、c）的种类
+OperandKind operandKind(Opcode op, int slot);
+
+/**
+ * 静态类型；char按int处理
+ */
+enum class ValueType : uint8_t {
+    Void,
+    Int,
+    Float,
+    IntArray,
+    FloatArray
+};
+
+const char* valueTypeName(ValueType type);
+
+/**
+ * 寄存器与数组元素的值，不带类型标记（类型由编译器静态确定）
+ * 数组值是指向首元素的指针，首元素之前的一个槽位保存长度。
+ */
+union Value {
+    int64_t i;
+    double f;
+    Value* array;
+};
+
+static_assert(sizeof(Value) == 8, "Value must fit in one machine word");
+
+struct Instruction {
+    Opcode op = Opcode::NOP;
+    int32_t a = 0;
+    int32_t b = 0;
+    int32_t c = 0;
+};
+
+/**
+ * printf格式串：按转换说明切分，每段为一段原样输出的文本加至多一个转换说明
+ * 转换说明已改写为可直接交给snprintf的形式（整数加上 ll 长度修饰）。
+ */
+struct FormatPiece {
+    std::string text;
+    std::string conversion;  // 为空表示只有文本
+    bool isFloat = false;
+};
+
+struct FormatString {
+    std::string source;
+    std::vector<FormatPiece> pieces;
+    size_t argumentCount = 0;
+};
+
+/**
+ * 可并行的计数循环 for (i = R[a]; i < R[upper]; i++)（inclusive时为 <=）
+ * 循环体编译为单独的函数 void body(int lo, int hi, int partial[], captures...)，
+ * 执行 [lo, hi) 内的迭代并把各归约变量的部分和写入partial；
+ * 各块的部分和按块的顺序加回归约变量，归纳变量置为终值。
+ */
+struct ParallelLoop {
+    int32_t body = -1;
+    int32_t upper = 0;
+    bool inclusive = false;
+    std::vector<int32_t> captures;    // 依次作为实参传给循环体函数的寄存器
+    std::vector<int32_t> reductions;  // 归约变量的寄存器
+};
+
+/**
+ * 一个函数的字节码
+ * 帧布局：[形参][常量寄存器][局部变量与临时值][局部数组（各带一个长度槽位）]
+ * 常量寄存器在调用时由constants整体复制，之后不再写入。
+ */
+struct BytecodeFunction {
+    std::string name;
+    ValueType returnType = ValueType::Int;
+    std::vector<ValueType> parameterTypes;
+    std::vector<Value> constants;
+    std::vector<ValueType> constantTypes;
+    uint32_t registerCount = 0;
+    uint32_t frameSize = 0;
+    std::vector<Instruction> code;
+    std::vector<int> lines;  // 每条指令对应的源码行
+    std::vector<ParallelLoop> parallelLoops;
+
+    uint32_t firstConstant() const {
+        return static_cast<uint32_t>(parameterTypes.size());
+    }
+};
+
+/**
+ * 编译后的整个程序
+ */
+struct BytecodeModule {
+    std::vector<BytecodeFunction> functions;
+    std::vector<FormatString> formats;
+    std::vector<std::pair<uint32_t, int64_t>> globalArrays;  // 长度槽位与长度，元素紧随其后
+    uint32_t globalCount = 0;
+    int mainFunction = -1;
+    int globalInitializer = -1;  // 全局变量的初始化代码，在main之前执行；-1表示没有
+
+    int findFunction(const std::string& name) const;
+    void disassemble(std::ostream& os) const;
+};
+
+#endif // BYTECODE_H
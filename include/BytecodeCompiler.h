@@ -0,0 +1,79 @@
+#ifndef BYTECODECOMPILER_H
+#define BYTECODECOMPILER_H
+
+#include "Bytecode.h"
+#include "Parser.h"
+#include <vector>
+#include <string>
+
+/**
+ * 编译选项
+ */
+struct BytecodeCompileOptions {
+    bool eliminateBoundsChecks = true;  // 按区间分析去掉可证明安全的数组下标检查
+    bool parallelizeLoops = true;       // 为没有跨迭代依赖的计数循环生成并行版本
+    bool optimizeLoops = true;          // 对生成的字节码做循环旋转、强度削减与循环展开
+};
+
+/**
+ * 一个for循环的依赖分析结论
+ */
+struct LoopReport {
+    std::string function;
+    int line = 0;
+    bool parallel = false;
+    std::string detail;  // 可并行时为归约变量列表，否则为原因
+};
+
+/**
+ * 编译统计
+ */
+struct BytecodeCompileStats {
+    size_t functions = 0;
+    size_t instructions = 0;
+    size_t checkedAccesses = 0;  // 保留下标检查的数组访问
+    size_t elidedAccesses = 0;   // 去掉下标检查的数组访问
+    size_t parallelLoops = 0;
+    size_t loopsRotated = 0;
+    size_t multipliesReduced = 0;
+    size_t loopsUnrolled = 0;
+    std::vector<LoopReport> loops;
+};
+
+/**
+ * 语法树到寄存器字节码的编译器
+ * 局部变量各占一个寄存器，字面量放在调用时整体初始化的常量寄存器中，
+ * 整数比较与条件跳转合并为一条指令。定长数组在帧内连续存放，数组形参按引用传递。
+ *
+ * 下标检查消除：对每个函数运行区间分析，取得每个下标表达式在不动点上的下标范围；
+ * 数组长度静态已知（局部或全局数组，或写明长度的形参，入口处检查实参长度一次）
+ * 且下标范围落在 [0, 长度-1] 内的访问改用不检查的指令。
+ * 区间分析按名字跟踪变量，因此下标中出现被内层声明遮蔽过的名字时保留检查。
+ *
+ * 循环并行化：依赖分析证明没有跨迭代依赖的计数循环，循环体另外编译为一个函数，
+ * 循环前插入PARFOR，由虚拟机决定分块并行执行还是落到紧随其后的串行循环。
+ * 两个版本的数组访问对应同一个语法树节点，下标检查的取舍相同。
+ *
+ * 循环优化在全部函数生成之后由LoopOptimizer在字节码上进行，见LoopOptimizer.h。
+ */
+class BytecodeCompiler {
+private:
+    BytecodeCompileOptions options;
+    BytecodeCompileStats stats;
+    std::vector<std::string> errors;
+
+public:
+    explicit BytecodeCompiler(const BytecodeCompileOptions& options = BytecodeCompileOptions());
+
+    /**
+     * 编译整个程序
+     * @param tokens 语法分析所用的token（区间分析生成诊断文本时需要）
+     * @return 没有错误且存在main函数时返回true
+     */
+    bool compile(const ProgramNode& program, const std::vector<Token>& tokens, BytecodeModule& module);
+
+    const std::vector<std::string>& getErrors() const;
+    const BytecodeCompileStats& getStats() const;
+};
+
+#endif // BYTECODECOMPILER_H
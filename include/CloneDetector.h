@@ -0,0 +1,80 @@
+#ifndef CLONEDETECTOR_H
+#define CLONEDETECTOR_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+/**
+ * 一个重复片段
+ */
+struct CloneFragment {
+    size_t file = 0;       // 文件序号
+    size_t start = 0;      // 起始位置（规范化token序列中的下标）
+    int firstLine = 0;     // 覆盖的源码行
+    int lastLine = 0;
+};
+
+/**
+ * 一个克隆类：规范化token序列完全相同的一组片段
+ */
+struct CloneClass {
+    size_t length = 0;  // 片段长度（token数）
+    std::vector<CloneFragment> fragments;
+};
+
+/**
+ * 检测统计
+ */
+struct CloneStats {
+    size_t files = 0;
+    size_t tokens = 0;        // 规范化后的token总数
+    size_t windows = 0;       // 参与哈希的窗口数
+    size_t buckets = 0;       // 出现两次以上的窗口哈希
+    size_t pairs = 0;         // 扩展得到的极大克隆对
+};
+
+/**
+ * 基于token哈希的重复代码检测
+ * 每个文件的token序列规范化为种类序列（所有标识符视为同一种，所有字面量视为同一种），
+ * 用Rabin–Karp滚动哈希计算每个长度为minTokens的窗口，并行地放入分段加锁的哈希表；
+ * 同一桶中的窗口两两比较并向后扩展为极大克隆对（只从前一个token不相同的位置开始，
+ * 每对只报告一次），最后按片段内容把克隆对合并成克隆类。
+ * 整体耗时与token总数近似成正比，不做文件两两比较。
+ */
+class CloneDetector {
+private:
+    // 一个文件的规范化token序列
+    struct FileTokens {
+        std::string path;
+        bool loaded = false;
+        std::vector<uint16_t> kinds;
+        std::vector<int> lines;
+    };
+
+    size_t minTokens;
+    size_t threadCount;
+    std::vector<FileTokens> files;
+    std::vector<CloneClass> classes;
+
+    // 私有辅助方法
+    void loadFile(const std::string& path, FileTokens& file) const;
+
+public:
+    /**
+     * @param minTokens 最短克隆长度（token数）
+     * @param threadCount 并行线程数，0表示使用硬件并发数
+     */
+    CloneDetector(size_t minTokens, size_t threadCount);
+
+    // 检测给定文件中的重复代码
+    void detect(const std::vector<std::string>& paths, CloneStats& stats);
+
+    // 按 长度×片段数 从大到小排列
+    const std::vector<CloneClass>& getClasses() const;
+
+    void printReport(std::ostream& os, const CloneStats& stats) const;
+};
+
+#endif // CLONEDETECTOR_H
@@ -0,0 +1,80 @@
+#ifndef CODEMETRICS_H
+#define CODEMETRICS_H
+
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <iostream>
+
+class ProjectAnalyzer;
+
+/**
+ * 一个函数的度量
+ */
+struct FunctionMetrics {
+    std::string file;
+    std::string name;
+    int line = 0;
+    size_t parameters = 0;
+    size_t statements = 0;
+    size_t complexity = 1;     // 圈复杂度：1 + if/while/for + && / ||
+    size_t nesting = 0;        // if/while/for 的最大嵌套深度
+    size_t fanIn = 0;          // 调用它的不同函数数（所有输入文件中按函数名统计）
+    size_t fanOut = 0;         // 它调用的不同函数数
+    std::vector<std::string> callees;  // 排序去重后的被调用函数
+
+    // Halstead计数：运算符为关键字、运算符与分隔符，运算对象为标识符与字面量
+    size_t operators = 0;
+    size_t operands = 0;
+    size_t distinctOperators = 0;
+    size_t distinctOperands = 0;
+
+    double volume() const;
+    double difficulty() const;
+    double effort() const;
+};
+
+/**
+ * 度量统计
+ */
+struct MetricsStats {
+    size_t files = 0;
+    size_t failed = 0;     // 无法读取或有语法错误的文件
+    size_t functions = 0;
+};
+
+/**
+ * 函数级代码度量
+ * 各文件并行地做词法与语法分析；每个函数定义只遍历一次语法树，同时得到语句数、圈复杂度、
+ * 嵌套深度与调用关系，再扫描一次它覆盖的token得到Halstead计数。
+ * 扇入在所有文件处理完之后由各函数的调用集合汇总得到。
+ */
+class CodeMetrics {
+private:
+    size_t threadCount;
+    std::vector<FunctionMetrics> functions;
+    std::vector<std::string> diagnostics;
+
+    // 私有辅助方法
+    static void measure(const FunctionDefinitionNode& function, const std::vector<Token>& tokens,
+                        FunctionMetrics& metrics);
+
+public:
+    /**
+     * @param threadCount 并行线程数，0表示使用硬件并发数
+     */
+    explicit CodeMetrics(size_t threadCount);
+
+    // 度量给定文件中的所有函数定义；由frontEnd展开 #include 与宏后解析，包含进来的定义不计
+    void analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, MetricsStats& stats);
+
+    // 按文件与行号排列
+    const std::vector<FunctionMetrics>& getFunctions() const;
+    const std::vector<std::string>& getDiagnostics() const;
+
+    void printReport(std::ostream& os, const MetricsStats& stats) const;
+    void writeCSV(std::ostream& os) const;
+    void writeJSON(std::ostream& os) const;
+};
+
+#endif // CODEMETRICS_H
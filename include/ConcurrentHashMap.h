@@ -0,0 +1,97 @@
+#ifndef CONCURRENTHASHMAP_H
+#define CONCURRENTHASHMAP_H
+
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <cstddef>
+
+/**
+ * 分段加锁的并发哈希表
+ * 键按哈希值分到固定数量的分段，每段一把锁；不同分段上的操作互不阻塞。
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ConcurrentHashMap {
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, Value, Hash> map;
+    };
+
+    std::vector<Shard> shards;
+    Hash hasher;
+
+    Shard& shardFor(const Key& key) {
+        return shards[hasher(key) % shards.size()];
+    }
+
+public:
+    explicit ConcurrentHashMap(size_t shardCount = 64) : shards(shardCount == 0 ? 1 : shardCount) {}
+
+    /**
+     * 在持有分段锁的情况下修改键对应的值（不存在时先默认构造）
+     */
+    template <typename Fn>
+    void update(const Key& key, Fn&& fn) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        fn(shard.map[key]);
+    }
+
+    // 键不存在时插入，返回是否插入
+    bool insert(const Key& key, const Value& value) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.map.emplace(key, value).second;
+    }
+
+    // 取出值的副本
+    bool find(const Key& key, Value& value) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+
+    bool erase(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.map.erase(key) > 0;
+    }
+
+    /**
+     * 逐段遍历所有键值对（遍历期间各段依次加锁）
+     */
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto& entry : shard.map) {
+                fn(entry.first, entry.second);
+            }
+        }
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.map.size();
+        }
+        return total;
+    }
+
+    void clear() {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.map.clear();
+        }
+    }
+};
+
+#endif // CONCURRENTHASHMAP_H
@@ -0,0 +1,72 @@
+#ifndef CONTROLFLOWGRAPH_H
+#define CONTROLFLOWGRAPH_H
+
+#include "Parser.h"
+#include <vector>
+#include <unordered_map>
+
+/**
+ * 函数的控制流图
+ * 基本块内按执行顺序保存语句（以及for的初始化与更新表达式），以条件结束的块有两个后继：
+ * successors[0] 为条件成立的分支，successors[1] 为不成立的分支。
+ * return/break/continue 之后的语句放入没有前驱的新块，因此不可达的代码就是不在弱拓扑序中的块。
+ */
+class ControlFlowGraph {
+public:
+    static const int ENTRY = 0;
+    static const int EXIT = 1;
+
+    /**
+     * 基本块
+     */
+    struct Block {
+        std::vector<const ASTNode*> statements;
+        const ASTNode* condition = nullptr;  // 非空时块以条件分支结束
+        const ASTNode* loop = nullptr;       // 该块是这个for/while循环的条件判断块（循环头）
+        std::vector<int> successors;
+        std::vector<int> predecessors;
+    };
+
+private:
+    // break与continue的目标块
+    struct LoopTargets {
+        int breakTarget;
+        int continueTarget;
+    };
+
+    std::vector<Block> blocks;
+    std::vector<LoopTargets> loops;
+    int current = ENTRY;
+
+    // 弱拓扑序：order[i] 为块号；componentEnd[i] >= 0 时 order[i] 是一个强连通分量的头，
+    // 分量（含嵌套分量）占据 [i, componentEnd[i])
+    std::vector<int> order;
+    std::vector<int> componentEnd;
+    std::vector<bool> reachable;
+
+    // 每条语句（含复合语句与循环）开始执行时所在的块
+    std::unordered_map<const ASTNode*, int> statementBlocks;
+
+    // 私有辅助方法
+    int newBlock();
+    void addEdge(int from, int to);
+    void buildStatement(const ASTNode* node);
+    void computeWeakTopologicalOrder();
+
+public:
+    explicit ControlFlowGraph(const FunctionDefinitionNode& function);
+
+    const std::vector<Block>& getBlocks() const;
+
+    // 从入口可达的块按Bourdoncle弱拓扑序排列；内层循环作为嵌套分量，分量头即循环头
+    const std::vector<int>& getOrder() const;
+    const std::vector<int>& getComponentEnd() const;
+
+    // 块是否从入口可达
+    bool isReachable(int block) const;
+
+    // 语句开始执行时所在的块，不是函数体中的语句时返回-1
+    int blockOf(const ASTNode* statement) const;
+};
+
+#endif // CONTROLFLOWGRAPH_H
@@ -0,0 +1,74 @@
+#ifndef CORPUSSTATS_H
+#define CORPUSSTATS_H
+
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <array>
+#include <map>
+#include <iostream>
+
+class ProjectAnalyzer;
+struct ParsedUnit;
+
+/**
+ * 一组语料计数器；批量模式下每个工作线程一份，互不加锁，最后合并
+ */
+struct CorpusCounters {
+    static constexpr size_t TOKEN_KINDS = static_cast<size_t>(TokenType::ERROR) + 1;
+    static constexpr size_t NODE_KINDS = AST_NODE_KIND_COUNT;
+    static constexpr size_t MAX_LENGTH = 32;  // 长度直方图的最后一格收纳更长的
+    static constexpr size_t MAX_DEPTH = 16;
+    static constexpr size_t SIZE_BUCKETS = 12; // 每函数语句数按2的幂分桶：0, 1, 2-3, 4-7, ...
+
+    size_t files = 0;
+    size_t failed = 0;      // 无法读取或有语法错误的文件（其token仍计入）
+    size_t bytes = 0;
+    size_t lines = 0;
+    size_t functions = 0;
+    size_t statements = 0;
+
+    // 源码字节按类别计数：字母与下划线、数字、空格与制表符、换行、标点运算符、其他
+    std::array<size_t, 6> byteClasses{};
+    std::array<size_t, TOKEN_KINDS> tokenKinds{};
+    std::array<size_t, MAX_LENGTH + 1> identifierLengths{};
+    std::array<size_t, MAX_LENGTH + 1> literalLengths{};
+    std::array<size_t, NODE_KINDS> nodeKinds{};
+    std::array<size_t, MAX_DEPTH + 1> statementDepths{};   // 语句所在的控制语句嵌套深度
+    std::array<size_t, SIZE_BUCKETS> functionSizes{};      // 每函数的语句数
+    std::map<std::string, size_t> operators;               // 表达式中的运算符
+    std::map<std::string, size_t> operatorPairs;           // 运算符与其直接操作数的运算符，如 "+ (*)"
+
+    void merge(const CorpusCounters& other);
+};
+
+/**
+ * 语料统计
+ * 统计token种类、标识符与字面量长度、语法树节点种类、语句嵌套深度与每函数语句数的分布，
+ * 以及运算符和相邻运算符对的频率，用于决定哪些词法分析路径与运算符组合值得专门优化。
+ */
+class CorpusStats {
+private:
+    size_t threadCount;
+    CorpusCounters totals;
+    std::vector<std::string> diagnostics;
+
+public:
+    /**
+     * @param threadCount 并行线程数，0表示使用硬件并发数
+     */
+    explicit CorpusStats(size_t threadCount);
+
+    // 统计一个解析过的翻译单元（只计主文件中的token与节点），累加到counters
+    static void countUnit(const ParsedUnit& unit, CorpusCounters& counters);
+
+    // 统计给定文件（经frontEnd预处理后解析）；每个线程使用自己的计数器，结果与线程数无关
+    void analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd);
+
+    const CorpusCounters& getTotals() const;
+    const std::vector<std::string>& getDiagnostics() const;
+
+    void printReport(std::ostream& os) const;
+};
+
+#endif // CORPUSSTATS_H
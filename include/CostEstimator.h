@@ -0,0 +1,152 @@
+#ifndef COSTESTIMATOR_H
+#define COSTESTIMATOR_H
+
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <iostream>
+
+class ProjectAnalyzer;
+
+/**
+ * 符号多项式：每一项为若干符号之积（可重复，表示乘方）乘以系数
+ * 符号为变量名；"name(实参)" 表示未能展开的调用的代价，"loop@N" 表示第N行无法确定的循环次数，
+ * "sum#N" 表示等调用展开后才能求和的第N个循环
+ */
+class CostExpression {
+private:
+    std::map<std::vector<std::string>, double> terms;
+
+public:
+    static CostExpression constant(double value);
+    static CostExpression symbol(const std::string& name);
+
+    CostExpression operator+(const CostExpression& other) const;
+    CostExpression operator-(const CostExpression& other) const;
+    CostExpression operator*(const CostExpression& other) const;
+    CostExpression scaled(double factor) const;
+
+    bool isConstant() const;
+    double constantTerm() const;
+    std::vector<std::string> symbols() const;
+
+    // 把values中的符号换成给定的多项式（同时代入），其余符号保留
+    CostExpression substitute(const std::unordered_map<std::string, CostExpression>& values) const;
+    // variable依次取 first, first+step, ... 共count个值时各项之和（按幂和公式展开）
+    CostExpression summed(const std::string& variable, const CostExpression& first, double step,
+                          const CostExpression& count) const;
+    // 求值：values中没有的符号取assumed
+    double evaluate(const std::unordered_map<std::string, double>& values, double assumed) const;
+
+    std::string toString() const;
+};
+
+/**
+ * 一个循环的次数估计
+ */
+struct LoopEstimate {
+    int line = 0;
+    std::string kind;        // for / while
+    std::string variable;    // 计数变量，非计数循环为空
+    bool counted = false;    // 是否识别为计数循环
+    CostExpression trips;
+};
+
+/**
+ * 迭代代价含未展开调用的计数循环：调用展开后才能对计数变量求和，在此之前以符号代替
+ */
+struct LoopSum {
+    std::string symbol;          // "sum#N"
+    std::string variable;        // 计数变量
+    CostExpression first;        // 计数变量的初值
+    double step = 0.0;           // 每次迭代计数变量的变化
+    CostExpression trips;
+    CostExpression iteration;    // 每次迭代的代价，可含计数变量
+};
+
+/**
+ * 一处调用：实参按调用者中的符号表示
+ */
+struct CallSite {
+    std::string callee;
+    std::string symbol;                     // 调用者cost中代表这次调用的符号
+    std::vector<CostExpression> arguments;
+};
+
+/**
+ * 一个函数的代价估计
+ */
+struct FunctionCost {
+    std::string file;
+    std::string name;
+    int line = 0;
+    std::vector<std::string> parameters;
+    CostExpression cost;              // 被调用函数的多项式已代入实参后展开；调用环与实参个数不符的调用保留为符号
+    std::vector<CallSite> calls;
+    std::vector<LoopSum> sums;        // 内层在前
+    std::vector<LoopEstimate> loops;
+    bool recursive = false;           // 位于调用环上
+    bool unbounded = false;           // 含递归或未展开的调用、无法确定的循环次数
+    double estimate = 0.0;            // 未知符号取假定值后的代价；unbounded且未给出假定值时为无穷大
+    bool overLimit = false;
+};
+
+/**
+ * 估计统计
+ */
+struct CostStats {
+    size_t files = 0;
+    size_t failed = 0;      // 无法读取或有语法错误的文件
+    size_t functions = 0;
+    size_t loops = 0;
+    size_t countedLoops = 0;
+    size_t overLimit = 0;
+};
+
+/**
+ * 静态的循环次数与代价估计
+ * 识别计数循环：for (int i = a; i < b; i++) 及 <=、>、>=、!= 与递减的形式，
+ * 以及循环体顶层只有一条 i++ / i = i + c 之类步进语句的while循环，循环体内不得再修改计数变量。
+ * 起点与终点先用区间分析在循环头处的不动点代入常量，否则保留为符号，得到常量或符号的循环次数。
+ * 每条简单语句、条件与循环的每次判断计1，循环的代价为每次迭代的代价在计数变量取值范围上的和
+ * （内层次数依赖外层计数变量时得到 n^2 等高次项），if取两个分支中较大者，按嵌套组合成每个函数的多项式；
+ * 调用处把实参代入被调用函数的多项式后计入。规模符号取假定值后超过上限的函数被标记；
+ * 递归、未展开的调用与无法确定的循环次数视为无界，除非明确给出假定值。
+ */
+class CostEstimator {
+private:
+    size_t threadCount;
+    double limit;
+    double assumed;
+    bool assumeUnbounded;
+    std::vector<FunctionCost> functions;
+    std::vector<std::string> diagnostics;
+
+    // 私有辅助方法
+    void resolveCalls();
+
+public:
+    /**
+     * @param threadCount 并行线程数，0表示使用硬件并发数
+     * @param limit 代价上限
+     * @param assumed 未知规模符号的假定值
+     * @param assumeUnbounded 为true时递归、未展开的调用与无法确定的循环次数也取assumed，否则视为无界
+     */
+    CostEstimator(size_t threadCount, double limit, double assumed, bool assumeUnbounded);
+
+    // 估计单个函数；调用以 "name(实参)" 符号保留在cost中，记录在calls里，含调用的计数循环记录在sums里
+    static FunctionCost estimateFunction(const FunctionDefinitionNode& function, const std::vector<Token>& tokens);
+
+    // 估计给定文件中的所有函数定义（经frontEnd预处理后解析）
+    void analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, CostStats& stats);
+
+    // 按文件与行号排列
+    const std::vector<FunctionCost>& getFunctions() const;
+    const std::vector<std::string>& getDiagnostics() const;
+
+    void printReport(std::ostream& os, const CostStats& stats) const;
+};
+
+#endif // COSTESTIMATOR_H
@@ -0,0 +1,83 @@
+#ifndef DEADCODEDETECTOR_H
+#define DEADCODEDETECTOR_H
+
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <iostream>
+
+class ProjectAnalyzer;
+
+/**
+ * 死代码的种类
+ */
+enum class DeadCodeKind {
+    Unreachable,  // 从函数入口不可达的语句
+    DeadStore     // 写入的值在之后任何路径上都不会被读取
+};
+
+/**
+ * 一条检测结果；不可达代码按复合语句中连续的一段报告，endLine为该段最后一行
+ */
+struct DeadCodeFinding {
+    std::string file;
+    std::string function;
+    int line = 0;
+    int column = 0;
+    int endLine = 0;
+    DeadCodeKind kind = DeadCodeKind::DeadStore;
+    std::string message;
+};
+
+/**
+ * 检测统计
+ */
+struct DeadCodeStats {
+    size_t files = 0;
+    size_t failed = 0;       // 无法读取或有语法错误的文件
+    size_t functions = 0;
+    size_t unreachable = 0;  // 不可达的语句段数
+    size_t deadStores = 0;
+};
+
+/**
+ * 不可达代码与无用写入检测
+ * 可达性取自控制流图：return/break/continue之后、以及所有分支都已返回之后的语句所在的块没有前驱。
+ * 无用写入由基本块上的逆向活跃变量分析得到（按函数内变量编号的位集），
+ * 只跟踪在函数中恰好声明一次的形参与局部变量，全局变量与重名变量的写入一律视为有用。
+ * 没有副作用的无用写入不使其右边的变量活跃，因此 "x++; x = x * 2;" 这样只为自己服务的写入链会一并报告。
+ */
+class DeadCodeDetector {
+private:
+    size_t threadCount;
+    std::vector<DeadCodeFinding> findings;
+    std::vector<std::string> diagnostics;
+
+public:
+    /**
+     * @param threadCount 并行线程数，0表示使用硬件并发数
+     */
+    explicit DeadCodeDetector(size_t threadCount);
+
+    // 检测单个函数，结果按位置追加到out
+    static void detectFunction(const FunctionDefinitionNode& function, const std::vector<Token>& tokens,
+                               std::vector<DeadCodeFinding>& out);
+
+    /**
+     * 从语法树与token流中删除死代码，直到不再有可删除的语句，返回删除的语句与初始化表达式个数
+     * 只删除复合语句中直接出现的语句：不可达的整段语句，以及右边没有函数调用与自增自减的无用写入；
+     * 变量在别处仍被引用时只删去声明的初始化部分。删除后节点的token下标指向新的token流。
+     */
+    static size_t strip(ProgramNode& program, std::vector<Token>& tokens);
+
+    // 检测给定文件中的所有函数定义（经frontEnd预处理后解析）
+    void analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, DeadCodeStats& stats);
+
+    // 按文件与位置排列
+    const std::vector<DeadCodeFinding>& getFindings() const;
+    const std::vector<std::string>& getDiagnostics() const;
+
+    void printReport(std::ostream& os, const DeadCodeStats& stats) const;
+};
+
+#endif // DEADCODEDETECTOR_H
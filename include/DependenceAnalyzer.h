@@ -0,0 +1,57 @@
+#ifndef DEPENDENCEANALYZER_H
+#define DEPENDENCEANALYZER_H
+
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <functional>
+
+/**
+ * 循环外可见的名字的存储位置（由调用者按作用域解析）
+ */
+enum class LoopStorage {
+    Unknown,    // 循环外不可见
+    Local,
+    Parameter,  // 数组形参按引用传递，可能与其他数组形参或全局数组是同一个数组
+    Global
+};
+
+struct LoopVariableInfo {
+    LoopStorage storage = LoopStorage::Unknown;
+    bool isArray = false;
+    bool isInteger = false;  // 整数标量
+};
+
+/**
+ * 一个for循环的依赖分析结果
+ */
+struct LoopDependence {
+    bool parallel = false;
+    std::string reason;                   // 不能并行时的原因
+    std::string induction;                // 归纳变量
+    const ASTNode* upper = nullptr;       // 循环不变的上界
+    bool inclusive = false;               // 条件为 <=（否则为 <）
+    std::vector<std::string> reductions;  // 求和归约变量，按首次出现的顺序
+};
+
+/**
+ * 计数循环的依赖分析
+ * 只接受规范形式 for (i = a; i < b; i++)（也可为 <=、++i、i = i + 1），且b在循环中不变。
+ * 循环体不得含函数调用、return与跳出本循环的break；没有跨迭代的依赖当且仅当：
+ * - 循环外的标量只读，或者是只以 s = s + e、s = s - e、s++ 形式出现的整数归约变量；
+ * - 循环外的数组凡是被写入，对它的所有访问下标都是 i + c（c为同一个常量），
+ *   且不会通过数组形参与循环中出现的其他数组指向同一块存储；
+ * - 循环体内声明的变量不与循环外的名字重名（按名字跟踪，重名时无法区分）。
+ * 浮点归约改变求和顺序会改变舍入结果，因此不接受。
+ */
+class DependenceAnalyzer {
+public:
+    using Lookup = std::function<LoopVariableInfo(const std::string&)>;
+
+    /**
+     * @param lookup 在循环初始化语句之后的作用域中解析名字
+     */
+    static LoopDependence analyzeLoop(const ForStatementNode& loop, const Lookup& lookup);
+};
+
+#endif // DEPENDENCEANALYZER_H
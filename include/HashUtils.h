@@ -0,0 +1,32 @@
+#ifndef HASHUTILS_H
+#define HASHUTILS_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * 工具类，提供内容哈希相关的辅助函数（64位FNV-1a）
+ */
+class HashUtils {
+public:
+    static constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    // 对一段内存计算哈希，可在上一次结果的基础上继续
+    static uint64_t hashBytes(const void* data, size_t size, uint64_t seed = FNV_OFFSET);
+
+    // 对字符串计算哈希
+    static uint64_t hashString(const std::string& str, uint64_t seed = FNV_OFFSET);
+
+    // 把一个整数混入哈希
+    static uint64_t combine(uint64_t seed, uint64_t value);
+
+    // 计算文件内容的哈希，文件无法读取时返回false
+    static bool hashFile(const std::string& path, uint64_t& hash);
+
+    // 转为16位十六进制字符串（用于文件名）
+    static std::string toHex(uint64_t hash);
+};
+
+#endif // HASHUTILS_H
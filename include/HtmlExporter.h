@@ -0,0 +1,48 @@
+#ifndef HTMLEXPORTER_H
+#define HTMLEXPORTER_H
+
+#include <string>
+#include <iostream>
+#include <cstddef>
+
+/**
+ * HTML导出选项
+ */
+struct HtmlExportOptions {
+    bool lineAnchors = false;        // 每行前加可链接的行号 <a id="L12">
+    size_t bufferSize = 1 << 16;     // 输出缓冲区大小（字节）
+};
+
+/**
+ * 导出统计
+ */
+struct HtmlExportStats {
+    size_t inputBytes = 0;
+    size_t tokens = 0;
+    size_t lines = 0;
+    size_t outputBytes = 0;
+};
+
+/**
+ * 流式的语法高亮HTML导出
+ * 逐个向词法分析器取token，不建立token数组、语法树或DOM；token之间的空白与注释按源码原样输出，
+ * 源码中的每个字节恰好输出一次（转义后）。相同类别的相邻片段合并为一个 <span>，
+ * 输出先写入固定大小的缓冲区，满了再整块写出，内存占用与文件大小无关。
+ */
+class HtmlExporter {
+private:
+    HtmlExportOptions options;
+
+public:
+    explicit HtmlExporter(const HtmlExportOptions& options);
+
+    /**
+     * 把source导出为完整的HTML文档
+     * @param title 页面标题（通常为文件名）
+     * @return 输出流在写完后是否仍然正常
+     */
+    bool exportSource(const std::string& source, const std::string& title, std::ostream& out,
+                      HtmlExportStats& stats) const;
+};
+
+#endif // HTMLEXPORTER_H
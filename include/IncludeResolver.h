@@ -0,0 +1,135 @@
+#ifndef INCLUDERESOLVER_H
+#define INCLUDERESOLVER_H
+
+#include "TokenTypes.h"
+#include "Lexer.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <iostream>
+
+/**
+ * 已加载的被包含文件
+ * 每个文件在一次运行中只词法分析一次，其token流在所有包含它的文件之间共享
+ */
+struct IncludedFile {
+    std::string path;                              // 规范化后的文件路径
+    int fileId = 0;                                // 文件编号（写入每个token的fileId）
+    bool found = false;                            // 文件是否成功读取
+    bool includeOnce = false;                      // 是否带有 #pragma once 或头文件保护宏
+    std::string guardMacro;                        // 头文件保护宏名（如有）
+    std::shared_ptr<const std::vector<Token>> tokens;  // 去掉保护指令后的token流（不含EOF）
+    std::vector<LexicalError> errors;              // 词法错误
+};
+
+/**
+ * 包含关系图中的一条边
+ */
+struct IncludeEdge {
+    std::string spelled;   // 源码中书写的名字（含 <> 或 ""）
+    std::string resolved;  // 解析后的路径，未找到时为空
+    int line;              // #include 所在行
+};
+
+/**
+ * 一个翻译单元的包含状态
+ * 分段展开（如预编译头前缀与其余部分）时在各段之间传递
+ */
+struct IncludeState {
+    std::unordered_set<std::string> onceIncluded;  // 已展开过的带保护文件
+    std::vector<std::string> includedFiles;        // 展开过的文件（按首次出现顺序）
+    std::vector<std::pair<std::string, IncludeEdge>> edges;  // 本单元遇到的包含关系
+};
+
+/**
+ * #include 解析器
+ * 按搜索路径查找被包含文件，缓存其token流，并在翻译单元内展开 #include 指令。
+ * 缓存与包含关系图可被多个线程同时使用。
+ */
+class IncludeResolver {
+private:
+    // 缓存项：call_once 保证同一文件即使被并发请求也只词法分析一次
+    struct CacheEntry {
+        std::once_flag loaded;
+        int fileId = 0;
+        std::shared_ptr<const IncludedFile> file;
+    };
+
+    std::vector<std::string> searchPaths;
+
+    mutable std::mutex cacheMutex;
+    std::unordered_map<std::string, std::shared_ptr<CacheEntry>> cache;
+    std::vector<std::string> fileNames;  // fileId -> 路径，下标0为主文件占位
+    std::atomic<size_t> lexCount;        // 实际进行词法分析的次数
+    std::atomic<size_t> cacheHits;       // 命中缓存的次数
+
+    mutable std::mutex graphMutex;
+    std::vector<std::string> graphOrder;  // 按首次出现顺序记录的包含者
+    std::unordered_map<std::string, std::vector<IncludeEdge>> graph;
+
+    // 私有辅助方法
+    std::shared_ptr<CacheEntry> findOrCreateEntry(const std::string& path, bool& created);
+    std::shared_ptr<const IncludedFile> lexFile(const std::string& path, int fileId) const;
+    void expandInto(const std::vector<Token>& input, const std::string& filename,
+                    std::vector<Token>& output, IncludeState& state,
+                    std::vector<std::string>& includeStack, std::vector<LexicalError>& errors);
+
+public:
+    IncludeResolver();
+
+    // 搜索路径（用于 <...> 形式以及当前目录找不到的 "..." 形式）
+    void addSearchPath(const std::string& path);
+    const std::vector<std::string>& getSearchPaths() const;
+
+    /**
+     * 查找被包含文件
+     * @param name 不含引号/尖括号的文件名
+     * @param angled 是否为 <...> 形式
+     * @param includingFile 发出 #include 的文件，用于查找相对路径
+     * @return 规范化后的路径，找不到时返回空字符串
+     */
+    std::string resolvePath(const std::string& name, bool angled, const std::string& includingFile) const;
+
+    /**
+     * 加载（或从缓存取得）文件的token流
+     */
+    std::shared_ptr<const IncludedFile> load(const std::string& path);
+
+    /**
+     * 展开token流中的 #include 指令
+     * 指令本身保留，被包含文件的token紧随其后插入；带保护的文件在同一翻译单元中只展开一次
+     * @param tokens 主文件的token流
+     * @param filename 主文件路径
+     * @param errors 收集找不到文件、循环包含等错误
+     * @param state 可选的包含状态，传入时在其基础上继续展开并更新
+     * @return 展开后的token流
+     */
+    std::vector<Token> expand(const std::vector<Token>& tokens, const std::string& filename,
+                              std::vector<LexicalError>& errors, IncludeState* state = nullptr);
+
+    // 根据fileId取得文件名（0返回空字符串）
+    std::string getFileName(int fileId) const;
+
+    // 取得文件编号，文件尚未出现过时只登记名字而不读取
+    int getFileId(const std::string& path);
+
+    // 记录包含关系（展开时自动调用，从预编译头恢复时也会用到）
+    void addEdge(const std::string& from, const IncludeEdge& edge);
+
+    // 统计信息
+    size_t getLexCount() const;
+    size_t getCacheHits() const;
+
+    // 包含关系图输出
+    void printIncludeGraph(std::ostream& os) const;
+    void printIncludeGraphDot(std::ostream& os) const;
+
+    // 从 #include 指令之后的token中取出目标名，返回值为书写形式（含 <> 或 ""）
+    static std::string readIncludeTarget(const std::vector<Token>& tokens, size_t& index);
+};
+
+#endif // INCLUDERESOLVER_H
@@ -0,0 +1,132 @@
+#ifndef INTERVALANALYZER_H
+#define INTERVALANALYZER_H
+
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+class ProjectAnalyzer;
+
+/**
+ * 整数区间 [lo, hi]；INT64_MIN/INT64_MAX 分别表示负无穷与正无穷，lo > hi 表示空区间（不可达）
+ */
+struct Interval {
+    static constexpr int64_t NEG_INF = INT64_MIN;
+    static constexpr int64_t POS_INF = INT64_MAX;
+
+    int64_t lo = NEG_INF;
+    int64_t hi = POS_INF;
+
+    static Interval top();
+    static Interval bottom();
+    static Interval constant(int64_t value);
+    static Interval range(int64_t lo, int64_t hi);
+
+    bool isTop() const;
+    bool isBottom() const;
+    bool isConstant() const;
+    bool isFinite() const;
+    bool contains(int64_t value) const;
+
+    Interval join(const Interval& other) const;
+    Interval meet(const Interval& other) const;
+    // 加宽：变大的一端直接推到无穷，保证循环头的迭代有限步内收敛
+    Interval widen(const Interval& next) const;
+    // 收窄：只把无穷端换成新的界，用于加宽之后找回循环条件给出的上下界
+    Interval narrow(const Interval& next) const;
+
+    bool operator==(const Interval& other) const;
+    bool operator!=(const Interval& other) const;
+    std::string toString() const;
+};
+
+/**
+ * 区间分析发现的问题种类
+ */
+enum class IntervalFindingKind {
+    DivisionByZero,          // 除数恒为0
+    PossibleDivisionByZero,  // 除数的区间有界且包含0
+    AlwaysTrue,              // 条件恒成立
+    AlwaysFalse,             // 条件恒不成立
+    LoopBound                // 循环条件与常量比较，循环头处变量的区间有界
+};
+
+/**
+ * 一条分析结果
+ */
+struct IntervalFinding {
+    std::string file;
+    std::string function;
+    int line = 0;
+    int column = 0;
+    IntervalFindingKind kind = IntervalFindingKind::PossibleDivisionByZero;
+    std::string message;
+};
+
+/**
+ * 不动点上某个循环头处有界的变量（按名字），未列出的变量取值未知
+ */
+struct LoopHeadState {
+    const ASTNode* loop = nullptr;
+    std::vector<std::pair<std::string, Interval>> bounds;
+};
+
+/**
+ * 不动点上某个下标表达式的下标取值范围；同一节点可能出现多次，应取并
+ */
+struct IndexRange {
+    const ASTNode* access = nullptr;  // IndexExpressionNode
+    Interval index;
+};
+
+/**
+ * 分析统计
+ */
+struct IntervalStats {
+    size_t files = 0;
+    size_t failed = 0;     // 无法读取或有语法错误的文件
+    size_t functions = 0;
+    size_t blocks = 0;     // 控制流图基本块总数
+    size_t iterations = 0; // 基本块转移函数的执行次数
+};
+
+/**
+ * 基于抽象解释的区间分析
+ * 为每个函数建立控制流图，在区间抽象域上按弱拓扑序迭代求不动点：
+ * 分量头（即for/while的条件判断块）处加宽保证收敛，随后按同样顺序做两遍收窄；
+ * 条件分支按比较运算细化两个后继的区间。抽象状态只在基本块入口保存，
+ * 且只记录不是⊤的int/char变量（按变量编号排序的稀疏数组），未知变量不占空间。
+ * 函数调用不改变局部变量，全局变量与浮点变量一律视为⊤。
+ */
+class IntervalAnalyzer {
+private:
+    size_t threadCount;
+    std::vector<IntervalFinding> findings;
+    std::vector<std::string> diagnostics;
+
+public:
+    /**
+     * @param threadCount 并行线程数，0表示使用硬件并发数
+     */
+    explicit IntervalAnalyzer(size_t threadCount);
+
+    // 分析单个函数：结果追加到out，基本块数与转移次数累加到stats；loopHeads非空时追加各可达循环头的状态，
+    // indexRanges非空时追加可达的下标表达式的下标范围（未列出的下标表达式不可达）
+    static void analyzeFunction(const FunctionDefinitionNode& function, const std::vector<Token>& tokens,
+                                std::vector<IntervalFinding>& out, IntervalStats& stats,
+                                std::vector<LoopHeadState>* loopHeads = nullptr,
+                                std::vector<IndexRange>* indexRanges = nullptr);
+
+    // 分析给定文件中的所有函数定义（经frontEnd预处理后解析）
+    void analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, IntervalStats& stats);
+
+    // 按文件与位置排列
+    const std::vector<IntervalFinding>& getFindings() const;
+    const std::vector<std::string>& getDiagnostics() const;
+
+    void printReport(std::ostream& os, const IntervalStats& stats) const;
+};
+
+#endif // INTERVALANALYZER_H
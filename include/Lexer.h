@@ -14,8 +14,9 @@ public:
     std::string message;
     int line;
     int column;
+    int fileId;  // 出错token所属文件编号（0表示主文件）
     
-    LexicalError(const std::string& msg, int line, int column);
+    LexicalError(const std::string& msg, int line, int column, int fileId = 0);
     const char* what() const noexcept override;
     std::string getFullMessage() const;
 };
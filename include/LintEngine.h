@@ -0,0 +1,126 @@
+#ifndef LINTENGINE_H
+#define LINTENGINE_H
+
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <array>
+#include <cstdint>
+#include <iostream>
+
+class ProjectAnalyzer;
+
+/**
+ * 一条检查结果
+ */
+struct LintFinding {
+    std::string file;
+    std::string rule;
+    int line = 0;
+    int column = 0;
+    std::string message;
+};
+
+/**
+ * 检查过程中规则可见的上下文：当前文件、所在函数与从根到父节点的祖先链
+ */
+class LintContext {
+private:
+    std::vector<LintFinding>& out;
+    const std::string* rule = nullptr;
+
+    friend class LintEngine;
+
+public:
+    const std::vector<Token>& tokens;
+    const FunctionDefinitionNode* function = nullptr;  // 当前所在函数，全局作用域为空
+    std::vector<const ASTNode*> ancestors;             // 不含当前节点
+
+    LintContext(const std::vector<Token>& tokens, std::vector<LintFinding>& out);
+
+    const ASTNode* parent() const;
+    void report(const ASTNode& node, const std::string& message);
+};
+
+/**
+ * 检查规则：声明关心的节点种类，引擎只在这些种类的节点上调用check
+ * 规则对象在各线程之间共享，check不得修改规则自身的状态
+ */
+class LintRule {
+public:
+    virtual ~LintRule() = default;
+    virtual std::string name() const = 0;
+    virtual std::string description() const = 0;
+    virtual std::vector<ASTNodeKind> kinds() const = 0;
+    virtual void check(const ASTNode& node, LintContext& context) const = 0;
+};
+
+/**
+ * 每条规则的耗时统计
+ */
+struct LintRuleTiming {
+    std::string rule;
+    size_t calls = 0;
+    uint64_t nanoseconds = 0;
+    size_t findings = 0;
+};
+
+/**
+ * 检查统计
+ */
+struct LintStats {
+    size_t files = 0;
+    size_t failed = 0;     // 无法读取或有语法错误的文件
+    size_t nodes = 0;      // 访问的节点总数
+    size_t calls = 0;      // 规则调用总数
+};
+
+/**
+ * 多路复用的检查引擎
+ * 添加规则时按节点种类建立分派表，每个文件只遍历一次语法树，每个节点只调用关心其种类的规则，
+ * 因此遍历代价与规则数无关，总代价只随实际被调用的规则增长。每次调用计时，按规则汇总。
+ */
+class LintEngine {
+private:
+    static constexpr size_t KIND_COUNT = AST_NODE_KIND_COUNT;
+
+    size_t threadCount;
+    std::vector<std::unique_ptr<LintRule>> rules;
+    std::vector<std::string> ruleNames;
+    std::array<std::vector<size_t>, KIND_COUNT> dispatch;  // 节点种类 -> 关心该种类的规则下标
+    std::vector<LintFinding> findings;
+    std::vector<LintRuleTiming> timings;
+    std::vector<std::string> diagnostics;
+
+    void visit(const ASTNode& node, LintContext& context, std::vector<LintRuleTiming>& timing,
+               LintStats& stats) const;
+
+public:
+    /**
+     * @param threadCount 并行线程数，0表示使用硬件并发数
+     */
+    explicit LintEngine(size_t threadCount);
+
+    // 内置规则
+    static std::vector<std::unique_ptr<LintRule>> builtinRules();
+
+    void addRule(std::unique_ptr<LintRule> rule);
+    const std::vector<std::unique_ptr<LintRule>>& getRules() const;
+
+    // 检查一棵语法树，结果追加到out，耗时累加到timing（与规则一一对应）
+    void run(const ProgramNode& program, const std::vector<Token>& tokens, std::vector<LintFinding>& out,
+             std::vector<LintRuleTiming>& timing, LintStats& stats) const;
+
+    // 检查给定文件（经frontEnd预处理后解析）；包含进来的文件中的代码不检查
+    void analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, LintStats& stats);
+
+    // 按文件与位置排列
+    const std::vector<LintFinding>& getFindings() const;
+    const std::vector<LintRuleTiming>& getTimings() const;
+    const std::vector<std::string>& getDiagnostics() const;
+
+    void printReport(std::ostream& os, const LintStats& stats) const;
+};
+
+#endif // LINTENGINE_H
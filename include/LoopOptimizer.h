@@ -0,0 +1,46 @@
+#ifndef LOOPOPTIMIZER_H
+#define LOOPOPTIMIZER_H
+
+#include "Bytecode.h"
+#include <vector>
+#include <cstdint>
+
+/**
+ * 循环变换统计
+ */
+struct LoopOptimizerStats {
+    size_t rotated = 0;   // 条件测试移到循环底部的循环
+    size_t reduced = 0;   // 改为加法的归纳变量乘法
+    size_t unrolled = 0;  // 展开的循环
+};
+
+/**
+ * 字节码上的循环变换
+ * 循环由向回的跳转识别，不依赖语法树，对编译器生成的所有函数（包括并行循环的循环体函数）适用。
+ *
+ * - 循环旋转：`head: 条件 → exit; 循环体; JMP head` 改为在底部重复一份取反的条件，
+ *   直接跳回循环体开头，每次迭代少执行一条无条件跳转；原来的条件留作进入循环前的检查
+ * - 强度削减：计数循环（底部为 i += 1 与 i < n 的比较）中的 t = i * c（c在循环中不变），
+ *   改为进入循环前计算一次，之后随 i 的每次加一执行 t += c
+ * - 循环展开：只含直线代码与前向分支的最内层计数循环，按代价模型选取展开倍数k，
+ *   展开后的循环在 i + k - 1 仍满足条件时每次执行k个迭代，剩下的迭代由原来的循环执行
+ */
+class LoopOptimizer {
+private:
+    const BytecodeModule& module;  // 确定调用与printf读取的寄存器
+    LoopOptimizerStats stats;
+
+    bool rotateOne(BytecodeFunction& function, std::vector<uint8_t>& marks);
+    bool reduceOne(BytecodeFunction& function, std::vector<uint8_t>& marks);
+    bool unrollOne(BytecodeFunction& function, std::vector<uint8_t>& marks);
+
+public:
+    explicit LoopOptimizer(const BytecodeModule& module);
+
+    // 对一个函数依次做循环旋转、强度削减与循环展开；函数可以是模块中函数的副本
+    void optimize(BytecodeFunction& function);
+
+    const LoopOptimizerStats& getStats() const;
+};
+
+#endif // LOOPOPTIMIZER_H
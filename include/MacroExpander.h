@@ -0,0 +1,97 @@
+#ifndef MACROEXPANDER_H
+#define MACROEXPANDER_H
+
+#include "TokenTypes.h"
+#include "Lexer.h"
+#include "StringInterner.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <iostream>
+
+/**
+ * 宏定义
+ */
+struct MacroDefinition {
+    uint32_t name = 0;                 // 宏名（驻留编号）
+    bool functionLike = false;         // 是否为带参数的宏
+    std::vector<uint32_t> parameters;  // 形参名（驻留编号）
+    std::vector<Token> body;           // 替换列表
+    int line = 0;                      // 定义所在位置
+    int column = 0;
+    int fileId = 0;
+};
+
+/**
+ * 宏展开器
+ * 处理 #define / #undef，并展开对象宏与函数宏的使用。
+ * 宏表以驻留后的标识符编号为键；不带参数的宏展开结果按宏缓存为token序列，
+ * 嵌套很深的宏只展开一次，之后每次使用只需复制，展开耗时与输出规模成正比。
+ */
+class MacroExpander {
+private:
+    // 缓存的对象宏展开结果（任何 #define / #undef 都会清空缓存）
+    struct CachedExpansion {
+        std::vector<Token> tokens;
+        std::vector<uint32_t> dependencies;  // 展开过程中遇到的宏名
+        bool deferred = false;               // 结果以等待实参的函数宏名结尾
+    };
+
+    StringInterner& interner;
+    std::unordered_map<uint32_t, MacroDefinition> macros;
+    std::unordered_map<uint32_t, CachedExpansion> expansionCache;
+    std::vector<LexicalError> errors;
+
+    // 统计
+    size_t expansionCount;
+    size_t cacheHitCount;
+
+    // 私有辅助方法
+    const MacroDefinition* findMacro(const Token& token) const;
+    void defineFromTokens(const std::vector<Token>& tokens, size_t begin, size_t end);
+    // 返回true表示输出以函数宏名结尾且input中已没有它的 ( ，实参要从外层随后的token中取
+    bool expandRange(const std::vector<Token>& input, std::vector<Token>& output,
+                     std::vector<uint32_t>& active, std::vector<uint32_t>& dependencies);
+    bool expandMacro(const MacroDefinition& macro, const std::vector<Token>& input, size_t& index,
+                     std::vector<Token>& output, std::vector<uint32_t>& active,
+                     std::vector<uint32_t>& dependencies, bool& deferred);
+    bool expandCall(const MacroDefinition& macro, const Token& site, const std::vector<Token>& input,
+                    size_t& cursor, std::vector<Token>& output, std::vector<uint32_t>& active,
+                    std::vector<uint32_t>& dependencies, bool& deferred);
+    bool collectArguments(const MacroDefinition& macro, const std::vector<Token>& input, size_t& index,
+                          std::vector<std::vector<Token>>& arguments);
+    void substitute(const MacroDefinition& macro, const std::vector<std::vector<Token>>& arguments,
+                    std::vector<Token>& result, std::vector<uint32_t>& active,
+                    std::vector<uint32_t>& dependencies);
+    Token pasteTokens(const Token& left, const Token& right);
+    static void markOrigin(std::vector<Token>& tokens);
+    static void placeAt(std::vector<Token>& tokens, size_t from, const Token& site);
+
+public:
+    explicit MacroExpander(StringInterner& interner);
+
+    /**
+     * 展开token流中的宏
+     * #define / #undef 指令行原样保留（供语法分析生成预处理指令节点），其后的宏使用被替换。
+     * 展开得到的token位置指向宏的使用处，originLine/originColumn记录其在宏定义中的位置。
+     */
+    std::vector<Token> expand(const std::vector<Token>& tokens);
+
+    // 直接定义/取消宏（供命令行或预编译头使用）
+    void define(const MacroDefinition& macro);
+    void undefine(const std::string& name);
+    bool isDefined(const std::string& name) const;
+    const std::unordered_map<uint32_t, MacroDefinition>& getMacros() const;
+
+    // 错误信息
+    const std::vector<LexicalError>& getErrors() const;
+    bool hasErrors() const;
+
+    // 统计信息
+    size_t getExpansionCount() const;
+    size_t getCacheHitCount() const;
+    void printMacroTable(std::ostream& os) const;
+};
+
+#endif // MACROEXPANDER_H
@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * 只读内存映射文件
+ * 用于直接读取预编译头、符号索引等磁盘结构，无需先把整个文件读入内存
+ */
+class MappedFile {
+private:
+    void* data;
+    size_t size;
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * 映射文件，失败（文件不存在或为空）时返回false
+     */
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const;
+    const char* getData() const;
+    size_t getSize() const;
+};
+
+#endif // MAPPEDFILE_H
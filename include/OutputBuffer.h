@@ -0,0 +1,83 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+
+/**
+ * 固定大小的输出缓冲区
+ * 逐段追加，写满后整块写入输出流；大量短小的写入只在缓冲区满时产生一次流操作。
+ * 析构时写出剩余内容。
+ */
+class OutputBuffer {
+private:
+    std::ostream& out;
+    std::vector<char> buffer;
+    size_t used = 0;
+    size_t total = 0;
+
+public:
+    OutputBuffer(std::ostream& out, size_t capacity)
+        : out(out), buffer(std::max<size_t>(capacity, 256)) {}
+
+    ~OutputBuffer() {
+        flush();
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void write(const char* data, size_t size) {
+        total += size;
+        if (used + size > buffer.size()) {
+            flush();
+            if (size > buffer.size()) {
+                out.write(data, static_cast<std::streamsize>(size));
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, data, size);
+        used += size;
+    }
+
+    void write(const char* text) {
+        write(text, std::strlen(text));
+    }
+
+    void write(const std::string& text) {
+        write(text.data(), text.size());
+    }
+
+    void put(char c) {
+        if (used == buffer.size()) {
+            flush();
+        }
+        buffer[used++] = c;
+        total++;
+    }
+
+    template <typename Integer>
+    void writeNumber(Integer value) {
+        char text[24];
+        auto result = std::to_chars(text, text + sizeof(text), value);
+        write(text, static_cast<size_t>(result.ptr - text));
+    }
+
+    void flush() {
+        if (used > 0) {
+            out.write(buffer.data(), static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+
+    // 累计写入的字节数（含尚在缓冲区中的）
+    size_t written() const {
+        return total;
+    }
+};
+
+#endif // OUTPUTBUFFER_H
@@ -18,21 +18,59 @@ public:
     std::string message;
     int line;
     int column;
+    int fileId;  // 出错token所属文件编号（0表示主文件）
     
-    SyntaxError(const std::string& msg, int line, int column);
+    SyntaxError(const std::string& msg, int line, int column, int fileId = 0);
     const char* what() const noexcept override;
     std::string getFullMessage() const;
 };
 
+/**
+ * 语法树节点种类（用于快速分派，避免逐个dynamic_cast）
+ */
+enum class ASTNodeKind {
+    Program,
+    VarDeclaration,
+    Assignment,
+    BinaryExpression,
+    UnaryExpression,
+    Literal,
+    Identifier,
+    IfStatement,
+    WhileStatement,
+    CompoundStatement,
+    ReturnStatement,
+    PreprocessorDirective,
+    FunctionDeclaration,
+    FunctionDefinition,
+    ExpressionStatement,
+    FunctionCall,
+    ForStatement,
+    BreakStatement,
+    ContinueStatement,
+    ArrayDeclaration,
+    IndexExpression
+};
+
+// 节点种类数，用于按种类建表
+constexpr size_t AST_NODE_KIND_COUNT = static_cast<size_t>(ASTNodeKind::IndexExpression) + 1;
+
 /**
  * 抽象语法树节点基类
  */
 class ASTNode {
 public:
+    // 源码位置（节点第一个token）及其在语法分析token流中覆盖的下标范围（闭区间）
+    int line = 0;
+    int column = 0;
+    int fileId = 0;
+    size_t firstToken = 0;
+    size_t lastToken = 0;
+    
     virtual ~ASTNode() = default;
+    virtual ASTNodeKind getKind() const = 0;
     virtual std::string toString() const = 0;
     virtual void print(int indent = 0) const;
-    virtual void printChinese(int indent = 0) const;
 };
 
 /**
@@ -42,8 +80,8 @@ class ProgramNode : public ASTNode {
 public:
     std::vector<std::unique_ptr<ASTNode>> statements;
     
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
     void addStatement(std::unique_ptr<ASTNode> stmt);
 };
 
@@ -57,8 +95,8 @@ public:
     std::unique_ptr<ASTNode> initializer;  // 初始化表达式
     
     VarDeclarationNode(const std::string& type, const std::string& id);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -70,8 +108,8 @@ public:
     std::unique_ptr<ASTNode> expression;
     
     AssignmentNode(const std::string& id);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -84,8 +122,8 @@ public:
     std::unique_ptr<ASTNode> right;
     
     BinaryExpressionNode(const std::string& op);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -97,8 +135,8 @@ public:
     std::unique_ptr<ASTNode> operand;
     
     UnaryExpressionNode(const std::string& op);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -110,8 +148,8 @@ public:
     TokenType type;
     
     LiteralNode(const std::string& val, TokenType t);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -122,8 +160,8 @@ public:
     std::string name;
     
     IdentifierNode(const std::string& n);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -135,8 +173,8 @@ public:
     std::unique_ptr<ASTNode> thenStatement;
     std::unique_ptr<ASTNode> elseStatement;
     
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -147,8 +185,8 @@ public:
     std::unique_ptr<ASTNode> condition;
     std::unique_ptr<ASTNode> body;
     
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -158,8 +196,8 @@ class CompoundStatementNode : public ASTNode {
 public:
     std::vector<std::unique_ptr<ASTNode>> statements;
     
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
     void addStatement(std::unique_ptr<ASTNode> stmt);
 };
 
@@ -170,8 +208,8 @@ class ReturnStatementNode : public ASTNode {
 public:
     std::unique_ptr<ASTNode> expression;
     
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -183,8 +221,8 @@ public:
     std::string content;   // 指令内容
     
     PreprocessorDirectiveNode(const std::string& dir, const std::string& cont);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -197,8 +235,8 @@ public:
     std::vector<std::unique_ptr<ASTNode>> parameters;
     
     FunctionDeclarationNode(const std::string& retType, const std::string& funcName);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -212,8 +250,8 @@ public:
     std::unique_ptr<ASTNode> body;
     
     FunctionDefinitionNode(const std::string& retType, const std::string& funcName);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -224,8 +262,8 @@ public:
     std::unique_ptr<ASTNode> expression;
     
     ExpressionStatementNode(std::unique_ptr<ASTNode> expr);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -237,8 +275,8 @@ public:
     std::vector<std::unique_ptr<ASTNode>> arguments;
     
     FunctionCallNode(const std::string& funcName);
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -251,8 +289,8 @@ public:
     std::unique_ptr<ASTNode> update;
     std::unique_ptr<ASTNode> body;
     
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -260,8 +298,8 @@ public:
  */
 class BreakStatementNode : public ASTNode {
 public:
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -269,8 +307,35 @@ public:
  */
 class ContinueStatementNode : public ASTNode {
 public:
+    ASTNodeKind getKind() const override;
+    std::string toString() const override;
+};
+
+/**
+ * 定长数组声明节点，如 int a[100]; 元素连续存放并初始化为0
+ * 作为函数形参时写作 int a[] 或 int a[N]，size为0表示长度由实参决定
+ */
+class ArrayDeclarationNode : public ASTNode {
+public:
+    std::string type;        // 元素类型
+    std::string identifier;  // 数组名
+    size_t size;             // 元素个数
+
+    ArrayDeclarationNode(const std::string& type, const std::string& id, size_t size);
+    ASTNodeKind getKind() const override;
+    std::string toString() const override;
+};
+
+/**
+ * 下标表达式节点，如 a[i]；作为赋值左边时写作 BinaryExpression("=", IndexExpression, 值)
+ */
+class IndexExpressionNode : public ASTNode {
+public:
+    std::unique_ptr<ASTNode> array;  // 数组名（IdentifierNode）
+    std::unique_ptr<ASTNode> index;
+
+    ASTNodeKind getKind() const override;
     std::string toString() const override;
-    void printChinese(int indent = 0) const override;
 };
 
 /**
@@ -296,10 +361,14 @@ private:
     void recordError(const std::string& message);
     void synchronize();
     
+    // 记录节点位置：从first到最后一个已消费的token
+    void markRange(ASTNode* node, size_t first) const;
+    
     // 语法分析方法（递归下降）
     std::unique_ptr<ProgramNode> parseProgram();
     std::unique_ptr<ASTNode> parseStatement();
     std::unique_ptr<ASTNode> parseVarDeclaration();
+    size_t parseArraySize();
     std::unique_ptr<ASTNode> parseAssignment();
     std::unique_ptr<ASTNode> parseIfStatement();
     std::unique_ptr<ASTNode> parseWhileStatement();
@@ -309,6 +378,7 @@ private:
     std::unique_ptr<ASTNode> parseExpressionStatement();
     
     // 表达式分析
+    std::unique_ptr<ASTNode> parseAssignmentOrExpression();  // 表达式语句与for子句中允许赋值
     std::unique_ptr<ASTNode> parseExpression();
     std::unique_ptr<ASTNode> parseLogicalOr();
     std::unique_ptr<ASTNode> parseLogicalAnd();
@@ -0,0 +1,102 @@
+#ifndef PRECOMPILEDHEADER_H
+#define PRECOMPILEDHEADER_H
+
+#include "TokenTypes.h"
+#include "IncludeResolver.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * 预编译头中记录的宏（宏名用字符串保存，加载时重新驻留）
+ */
+struct PchMacro {
+    std::string name;
+    bool functionLike = false;
+    std::vector<std::string> parameters;
+    std::vector<Token> body;
+    int line = 0;
+    int column = 0;
+    int fileId = 0;
+};
+
+/**
+ * 头文件前缀处理完成后的状态快照
+ * 前缀指源文件开头连续的预处理指令行（至少含一条 #include）。
+ * 快照中token与宏的fileId均为本次运行中的编号；写盘时换成路径，读回时重新编号。
+ * 包含关系边的包含者为空字符串时表示主文件。
+ * 快照只保存预处理的结果，语法分析仍在前缀token流与主文件其余部分拼接后的完整token流上进行。
+ */
+struct PchSnapshot {
+    uint64_t key = 0;
+    std::vector<std::pair<std::string, uint64_t>> dependencies;  // 依赖文件及其内容哈希
+    std::vector<Token> tokens;                                   // 预处理后的前缀token流（不含EOF）
+    std::vector<PchMacro> macros;                                // 前缀结束时的宏表
+    std::vector<std::string> onceIncluded;                       // 已展开过的带保护文件
+    std::vector<std::pair<std::string, IncludeEdge>> edges;      // 前缀中的包含关系
+};
+
+/**
+ * 预编译头缓存
+ * 快照以二进制格式保存在指定目录中，按前缀内容、搜索路径与主文件目录计算的键命名。
+ * 读取时直接mmap文件，校验各段边界与依赖文件哈希后再构造快照；
+ * 已加载的快照在内存中缓存，多个翻译单元（或线程）可以共享同一份。
+ */
+class PrecompiledHeaderCache {
+private:
+    std::string directory;
+    IncludeResolver* includeResolver;
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<const PchSnapshot>> loaded;
+
+    // 统计
+    std::atomic<size_t> hitCount;
+    std::atomic<size_t> missCount;
+    std::atomic<size_t> writeCount;
+
+    // 私有辅助方法
+    std::string snapshotPath(uint64_t key) const;
+    std::shared_ptr<PchSnapshot> readSnapshot(const std::string& path, uint64_t key);
+    bool writeSnapshot(const std::string& path, const PchSnapshot& snapshot) const;
+    bool dependenciesUnchanged(const PchSnapshot& snapshot) const;
+    std::string fileName(int fileId) const;
+    int fileId(const std::string& path) const;
+
+public:
+    /**
+     * @param directory 快照目录（不存在时自动创建）
+     * @param resolver 用于fileId与路径互相转换，可以为空
+     */
+    PrecompiledHeaderCache(const std::string& directory, IncludeResolver* resolver);
+
+    /**
+     * 取得源文件开头可以预编译的前缀长度（token个数）
+     * 前缀由连续的预处理指令行与空行组成，且至少含一条 #include，否则返回0
+     */
+    static size_t findPrefixEnd(const std::vector<Token>& tokens);
+
+    /**
+     * 计算前缀的键
+     * @param options 其他影响预处理结果的选项（如是否展开宏）
+     */
+    uint64_t computeKey(const std::vector<Token>& tokens, size_t prefixEnd,
+                        const std::string& filename, uint64_t options) const;
+
+    // 查找快照，不存在或已失效时返回空
+    std::shared_ptr<const PchSnapshot> load(uint64_t key);
+
+    // 保存快照
+    bool store(const PchSnapshot& snapshot);
+
+    const std::string& getDirectory() const;
+    size_t getHitCount() const;
+    size_t getMissCount() const;
+    size_t getWriteCount() const;
+};
+
+#endif // PRECOMPILEDHEADER_H
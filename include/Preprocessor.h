@@ -0,0 +1,82 @@
+#ifndef PREPROCESSOR_H
+#define PREPROCESSOR_H
+
+#include "TokenTypes.h"
+#include "Lexer.h"
+#include "IncludeResolver.h"
+#include "MacroExpander.h"
+#include "PrecompiledHeader.h"
+#include "StringInterner.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <iostream>
+
+/**
+ * 预处理器
+ * 依次展开 #include 与宏。设置了预编译头缓存时，源文件开头的指令前缀
+ * 直接从快照恢复token流、宏表与包含状态，只处理其余部分。
+ */
+class Preprocessor {
+private:
+    StringInterner& interner;
+    IncludeResolver* includeResolver = nullptr;
+    PrecompiledHeaderCache* pchCache = nullptr;
+    bool expandMacros = true;
+    MacroExpander macroExpander;
+    std::vector<LexicalError> errors;
+    bool includeFailed = false;  // 错误是否出现在 #include 展开阶段
+    IncludeState includeState;   // 本翻译单元的包含状态
+
+    // 本次预编译头的使用情况
+    std::shared_ptr<const PchSnapshot> precompiledHeader;
+    bool precompiledHeaderLoaded = false;
+
+    // 私有辅助方法
+    bool runWithPrecompiledHeader(const std::vector<Token>& tokens, size_t prefixEnd,
+                                  const std::string& filename, std::vector<Token>& output);
+    std::vector<Token> processRange(const std::vector<Token>& tokens, const std::string& filename,
+                                    IncludeState* state);
+    std::shared_ptr<PchSnapshot> createSnapshot(uint64_t key, const std::vector<Token>& prefix,
+                                                const std::string& filename, const IncludeState& state) const;
+    void restoreSnapshot(const PchSnapshot& snapshot, const std::string& filename, IncludeState& state);
+
+public:
+    explicit Preprocessor(StringInterner& interner);
+
+    void setIncludeResolver(IncludeResolver* resolver);
+    void setPrecompiledHeaderCache(PrecompiledHeaderCache* cache);
+    void setExpandMacros(bool enabled);
+
+    /**
+     * 预处理一个翻译单元
+     * @param tokens 词法分析得到的token流（以EOF结尾）
+     * @param filename 源文件路径
+     * @param output 预处理后的token流
+     * @return 是否生成了新的token流；返回false时应直接使用原token流
+     */
+    bool run(const std::vector<Token>& tokens, const std::string& filename, std::vector<Token>& output);
+
+    const MacroExpander& getMacroExpander() const;
+    
+    // 本翻译单元（直接或间接）包含的文件
+    const std::vector<std::string>& getIncludedFiles() const;
+
+    // 错误信息（包含解析错误与宏展开错误）
+    const std::vector<LexicalError>& getErrors() const;
+    bool hasErrors() const;
+    bool hasIncludeErrors() const;
+
+    // 预编译头：本次使用或生成的快照，未使用时为空
+    std::shared_ptr<const PchSnapshot> getPrecompiledHeader() const;
+    bool loadedPrecompiledHeader() const;
+
+    /**
+     * 输出预处理后的token流（-E），结果可以重新词法分析与语法分析
+     * 按NEWLINE换行；同一源码行上相邻的源码token保留原来的间距（#define F(x) 中宏名与 ( 不分开），
+     * 宏展开得到的token之间用一个空格分隔；字符串重新加上引号与转义。
+     */
+    static void print(const std::vector<Token>& tokens, std::ostream& os);
+};
+
+#endif // PREPROCESSOR_H
@@ -0,0 +1,145 @@
+#ifndef PROJECTANALYZER_H
+#define PROJECTANALYZER_H
+
+#include "SymbolCollector.h"
+#include "IncludeResolver.h"
+#include "PrecompiledHeader.h"
+#include "ConcurrentHashMap.h"
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <iostream>
+
+class ProjectCache;
+
+/**
+ * 一个翻译单元的分析结果
+ */
+struct TranslationUnitResult {
+    std::string path;
+    bool loaded = false;                    // 文件是否成功读取
+    std::vector<std::string> diagnostics;   // 词法/语法错误（已带文件名与位置）
+    std::vector<SymbolOccurrence> symbols;  // 顶层符号、函数调用与全局变量引用
+    std::vector<std::string> includedFiles; // 直接或间接包含的文件
+    bool includesResolved = true;           // 所有 #include 都找到了文件（否则不写入增量缓存）
+    size_t tokenCount = 0;
+};
+
+/**
+ * 一个翻译单元的前端产物（源码、预处理后的token流与语法树）
+ * 供查询、重写等需要语法树的工具使用
+ */
+struct ParsedUnit {
+    std::string path;
+    bool loaded = false;
+    std::string source;                     // 主文件原文（token的offset指向这里，fileId为0时）
+    std::vector<std::string> diagnostics;
+    std::vector<Token> tokens;              // 语法分析使用的token流
+    std::unique_ptr<ProgramNode> program;
+    std::vector<std::string> includedFiles;
+    bool includesResolved = true;
+
+    // 根据fileId取得文件名（0为主文件）
+    std::function<std::string(int)> fileName;
+
+    // 主文件中的顶层函数定义，不含包含进来的文件中的定义
+    std::vector<const FunctionDefinitionNode*> definedFunctions() const;
+};
+
+/**
+ * 合并后符号表中的一项
+ */
+struct ProjectSymbol {
+    std::vector<SymbolOccurrence> declarations;
+    std::vector<SymbolOccurrence> definitions;  // 函数定义
+    std::vector<SymbolOccurrence> variables;    // 全局变量定义
+    std::vector<SymbolOccurrence> calls;
+};
+
+/**
+ * 链接级问题
+ */
+struct LinkDiagnostic {
+    std::string name;
+    std::string message;
+    std::vector<SymbolOccurrence> sites;  // 相关位置
+};
+
+/**
+ * 工程分析器
+ * 并行分析多个翻译单元，把各自的顶层符号合并到并发哈希表中，
+ * 再检查跨文件的问题：未定义的函数、重复定义、声明与定义签名不一致。
+ */
+class ProjectAnalyzer {
+private:
+    size_t threadCount;
+    IncludeResolver* includeResolver = nullptr;
+    PrecompiledHeaderCache* pchCache = nullptr;
+    bool expandMacros = true;
+    ProjectCache* cache = nullptr;
+
+    std::vector<TranslationUnitResult> units;
+    size_t reusedCount = 0;    // 本次直接使用缓存结果的单元数
+    ConcurrentHashMap<std::string, ProjectSymbol> symbolTable;
+    std::vector<LinkDiagnostic> linkDiagnostics;
+
+    // 私有辅助方法
+    void mergeSymbols(const TranslationUnitResult& unit);
+    void checkLinkage();
+    static std::string location(const SymbolOccurrence& symbol);
+
+public:
+    /**
+     * @param threadCount 并行线程数，0表示使用硬件并发数
+     */
+    explicit ProjectAnalyzer(size_t threadCount = 0);
+
+    void setIncludeResolver(IncludeResolver* resolver);
+    void setPrecompiledHeaderCache(PrecompiledHeaderCache* cache);
+    void setExpandMacros(bool enabled);
+
+    /**
+     * 设置增量缓存：未变化的单元直接取缓存结果，分析完成后由调用者保存缓存
+     */
+    void setCache(ProjectCache* projectCache);
+
+    /**
+     * 展开输入列表：目录递归查找 .txt/.c/.cc/.cpp 文件，结果按路径排序并去重
+     */
+    static std::vector<std::string> collectSourceFiles(const std::vector<std::string>& inputs);
+
+    // 分析所有翻译单元并做链接检查
+    void analyze(const std::vector<std::string>& files);
+    
+    /**
+     * 对单个翻译单元做词法分析、预处理与语法分析，可被多个线程同时调用
+     * @return 文件能否读取
+     */
+    bool parseUnit(const std::string& path, ParsedUnit& unit) const;
+
+    /**
+     * 用threads个线程并行解析多个翻译单元，供度量、区间分析、代价估计等只需要语法树的工具共用
+     * 各单元的诊断信息按输入顺序追加到diagnostics；只对能读取且没有错误的单元调用 fn(index, unit)，
+     * fn可能在多个线程上同时执行
+     * @return 无法读取或有错误的单元数
+     */
+    size_t parseUnits(const std::vector<std::string>& files, size_t threads,
+                      const std::function<void(size_t, const ParsedUnit&)>& fn,
+                      std::vector<std::string>& diagnostics) const;
+
+    /**
+     * 分析单个翻译单元（parseUnit 之后收集符号），可被多个线程同时调用
+     */
+    TranslationUnitResult analyzeUnit(const std::string& path, size_t unitIndex) const;
+
+    const std::vector<TranslationUnitResult>& getUnits() const;
+    const std::vector<LinkDiagnostic>& getLinkDiagnostics() const;
+    bool hasErrors() const;
+    size_t getReusedCount() const;
+
+    void printReport(std::ostream& os) const;
+};
+
+#endif // PROJECTANALYZER_H
@@ -0,0 +1,61 @@
+#ifndef PROJECTCACHE_H
+#define PROJECTCACHE_H
+
+#include "ProjectAnalyzer.h"
+#include "ConcurrentHashMap.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * 工程模式的增量缓存
+ * 保存每个翻译单元的分析结果、它（直接或间接）包含的文件，以及所有相关文件的
+ * 大小、修改时间和内容哈希。再次运行时，只有自身或任一被包含文件发生变化的单元
+ * 需要重新分析，其余单元直接使用缓存结果。
+ * 大小与修改时间都没变的文件不再计算哈希，因此热运行的开销与改动规模成正比。
+ */
+class ProjectCache {
+public:
+    // 文件状态
+    struct FileState {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+    };
+
+private:
+    std::string path;
+    uint64_t options;  // 影响分析结果的选项（搜索路径、宏展开、工作目录）
+
+    std::unordered_map<std::string, FileState> previousFiles;
+    std::unordered_map<std::string, TranslationUnitResult> previousUnits;
+
+    // 本次运行中确认过的文件状态（多个单元包含同一头文件时只检查一次）
+    ConcurrentHashMap<std::string, FileState> currentFiles;
+    ConcurrentHashMap<std::string, bool> changedFiles;
+
+    // 私有辅助方法
+    bool currentState(const std::string& file, FileState& state);
+    bool fileChanged(const std::string& file);
+
+public:
+    ProjectCache(const std::string& path, uint64_t options);
+
+    // 读取缓存文件，不存在或无效时返回false（视为空缓存）
+    bool load();
+
+    /**
+     * 单元及其所有依赖都未变化时取出缓存结果
+     * @param unitIndex 结果中各符号的单元序号会改为本次的序号
+     */
+    bool lookup(const std::string& unitPath, size_t unitIndex, TranslationUnitResult& result);
+
+    // 写入本次所有单元的结果
+    bool save(const std::vector<TranslationUnitResult>& units);
+
+    // 根据命令行选项计算options
+    static uint64_t computeOptions(const std::vector<std::string>& includePaths, bool expandMacros);
+};
+
+#endif // PROJECTCACHE_H
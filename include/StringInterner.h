@@ -0,0 +1,42 @@
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+
+/**
+ * 字符串驻留表
+ * 把相同内容的字符串映射为同一个整数编号，之后的比较与哈希只需处理整数。
+ * 查找可并发进行，插入时加写锁。
+ */
+class StringInterner {
+private:
+    std::deque<std::string> strings;  // deque保证已插入字符串的地址稳定
+    std::unordered_map<std::string, uint32_t> ids;
+    mutable std::shared_mutex mutex;
+
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    /**
+     * 取得字符串的编号，不存在时新建
+     */
+    uint32_t intern(const std::string& str);
+
+    /**
+     * 只查找不插入，不存在时返回npos
+     */
+    uint32_t lookup(const std::string& str) const;
+
+    /**
+     * 根据编号取回字符串
+     */
+    const std::string& str(uint32_t id) const;
+
+    size_t size() const;
+};
+
+#endif // STRINGINTERNER_H
@@ -0,0 +1,97 @@
+#ifndef STRUCTURALREWRITER_H
+#define STRUCTURALREWRITER_H
+
+#include "TokenTypes.h"
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <bitset>
+#include <unordered_map>
+
+/**
+ * 一个文件的重写结果
+ */
+struct RewriteResult {
+    std::string path;
+    bool loaded = false;                   // 文件能否读取
+    bool skipped = false;                  // 被token种类预筛选跳过（未做语法分析）
+    size_t edits = 0;                      // 被替换的子树个数
+    std::string output;                    // 改写后的新代码（有替换时）：原文只替换匹配的部分
+    std::vector<std::string> diagnostics;  // 语法错误等（有错误的文件或改写后无法解析的文件不重写）
+};
+
+/**
+ * 结构化查找替换
+ * 模式与替换都是代码片段，`$name` 为占位符。模式用现有Parser解析成语法树，
+ * 在目标文件的语法树中逐个子树比较结构；匹配的子树所占的字节范围替换为代入占位符后的
+ * 替换文本（占位符代入目标文件中的原文），其余代码、注释与预处理指令原样保留。
+ * 代入的表达式与替换结果按运算优先级与所在位置（替换文本中、原语法树中的父节点）比较，必要时加括号。
+ * 改写结果重新解析，出现错误时不输出也不写回。
+ * 同一占位符在模式中出现多次时，各处匹配到的代码必须相同。
+ * 分析前先比较token种类的哈希签名：文件缺少模式中的某种token时直接跳过。
+ */
+class StructuralRewriter {
+public:
+    using Signature = std::bitset<256>;
+
+private:
+    std::vector<Token> patternTokens;      // 模式的token流（占位符已改写为内部标识符）
+    std::unique_ptr<ProgramNode> patternProgram;
+    const ASTNode* pattern = nullptr;      // 参与匹配的模式根节点
+    std::vector<Token> replacement;        // 替换的token序列（不含EOF）
+    std::string replacementSource;         // 替换的文本（占位符已改写），replacement的偏移指向它
+    Signature patternSignature;
+    // 替换文本能单独解析时按它的语法树决定占位符处是否加括号，否则看占位符两侧的token
+    bool replacementParsed = false;
+    std::unordered_map<size_t, int> requiredAt;  // 占位符token的偏移 -> 代入的表达式不加括号所需的最低优先级
+    int replacementPrecedence = 0;               // 替换文本整体的优先级
+    std::string replacementRoot;                 // 替换文本只是一个占位符时的占位符名，整体优先级取绑定的代码
+
+    // 占位符绑定：占位符名 -> 匹配到的token序列
+    struct Binding {
+        std::vector<Token> tokens;
+        int precedence = 0;     // 绑定子树的运算优先级，低于代入位置的要求时加括号
+        size_t first = 0;       // 绑定子树在目标token流中的首尾token（ranged为false时只有名字）
+        size_t last = 0;
+        bool ranged = false;
+    };
+    using Bindings = std::unordered_map<std::string, Binding>;
+
+    // 私有辅助方法
+    bool matchNode(const ASTNode& pattern, const ASTNode& target, const std::vector<Token>& tokens,
+                   Bindings& bindings) const;
+    bool bind(const std::string& name, Binding value, Bindings& bindings) const;
+    // precedence返回替换结果整体的运算优先级
+    std::string substitute(const Bindings& bindings, const std::vector<Token>& tokens, const std::string& source,
+                           int& precedence) const;
+
+public:
+    StructuralRewriter();
+    ~StructuralRewriter();
+
+    /**
+     * 编译模式与替换
+     * @param error 解析失败或替换中出现未定义占位符时的说明
+     */
+    bool compile(const std::string& patternText, const std::string& replacementText, std::string& error);
+
+    // 重写一段源码
+    RewriteResult rewriteSource(const std::string& path, const std::string& source) const;
+
+    // 读取并重写一个文件
+    RewriteResult rewriteFile(const std::string& path) const;
+
+    /**
+     * 并行重写多个文件，结果与输入顺序一致
+     */
+    std::vector<RewriteResult> run(const std::vector<std::string>& files, size_t threadCount) const;
+
+    // token流的种类签名（标识符与字面量按取值区分）
+    static Signature signature(const std::vector<Token>& tokens);
+
+    // 把 `$name` 改写为内部标识符
+    static std::string expandPlaceholders(const std::string& text);
+};
+
+#endif // STRUCTURALREWRITER_H
@@ -0,0 +1,61 @@
+#ifndef SYMBOLCOLLECTOR_H
+#define SYMBOLCOLLECTOR_H
+
+#include "TokenTypes.h"
+#include "Parser.h"
+#include <vector>
+#include <string>
+#include <functional>
+
+/**
+ * 符号出现的种类
+ */
+enum class SymbolKind {
+    FunctionDeclaration,  // 函数声明（原型）
+    FunctionDefinition,   // 函数定义
+    Variable,             // 全局变量定义
+    FunctionCall,         // 函数调用
+    VariableReference     // 对全局变量的引用（未被局部变量遮蔽）
+};
+
+/**
+ * 一个翻译单元中符号的一次出现
+ */
+struct SymbolOccurrence {
+    std::string name;
+    SymbolKind kind = SymbolKind::FunctionCall;
+    std::string type;                         // 返回类型或变量类型（调用为空）
+    std::vector<std::string> parameterTypes;  // 函数的形参类型
+    size_t argumentCount = 0;                 // 调用的实参个数
+    std::string file;                         // 所在文件（被包含文件为其路径）
+    int line = 0;                             // 名字所在的位置
+    int column = 0;
+    size_t offset = 0;                        // 名字在所在文件中的字节偏移
+    size_t unit = 0;                          // 所属翻译单元序号
+};
+
+/**
+ * 符号收集器
+ * 从一个翻译单元的语法树中取出顶层函数/全局变量、所有函数调用，
+ * 以及按作用域解析后指向全局的标识符引用。
+ */
+class SymbolCollector {
+public:
+    /**
+     * @param program 语法树
+     * @param tokens 生成该语法树的token流（用于读取未命名形参的类型）
+     * @param fileName 根据fileId取得文件名
+     */
+    static std::vector<SymbolOccurrence> collect(const ProgramNode& program, const std::vector<Token>& tokens,
+                                                 const std::function<std::string(int)>& fileName);
+
+    // 从函数节点的token范围中取出形参类型（"void" 或空参数表返回空）
+    static std::vector<std::string> parameterTypes(const ASTNode& function, const std::vector<Token>& tokens);
+
+    // 形如 "int(int, float)" 的签名
+    static std::string signature(const SymbolOccurrence& symbol);
+
+    static const char* kindName(SymbolKind kind);
+};
+
+#endif // SYMBOLCOLLECTOR_H
@@ -0,0 +1,104 @@
+#ifndef SYMBOLINDEX_H
+#define SYMBOLINDEX_H
+
+#include "SymbolCollector.h"
+#include "MappedFile.h"
+#include "BinaryFormat.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class ProjectAnalyzer;
+
+/**
+ * 索引中的一条记录（查询结果）
+ */
+struct IndexEntry {
+    std::string name;
+    SymbolKind kind = SymbolKind::FunctionCall;
+    std::string file;
+    int line = 0;
+    int column = 0;
+    size_t offset = 0;
+};
+
+/**
+ * 增量更新的统计
+ */
+struct IndexBuildStats {
+    size_t units = 0;     // 翻译单元总数
+    size_t reparsed = 0;  // 重新分析的单元
+    size_t reused = 0;    // 直接沿用旧索引的单元
+    size_t records = 0;   // 写入的记录数
+};
+
+/**
+ * 跨文件符号索引
+ * 记录工程中每个函数/全局变量的定义、声明与引用（文件、行列与字节偏移）。
+ * 磁盘格式为按 (名字, 种类, 文件, 偏移) 排序的记录下标表加字符串表，可直接mmap后二分查找，
+ * 查询时不需要重新分析任何文件。记录按翻译单元分组保存，更新时只重新分析
+ * 自身或所包含文件内容有变化的单元。
+ */
+class SymbolIndex {
+private:
+    MappedFile file;
+    const char* data = nullptr;
+    size_t size = 0;
+    BinaryReader reader;
+    const void* units = nullptr;
+    const void* dependencies = nullptr;
+    const void* records = nullptr;
+    const uint32_t* sorted = nullptr;
+    uint64_t unitCount = 0;
+    uint64_t dependencyCount = 0;
+    uint64_t recordCount = 0;
+
+    // 私有辅助方法
+    bool validRecord(uint32_t record) const;
+    bool validUnit(uint64_t unit) const;
+    IndexEntry entryAt(uint32_t record) const;
+    std::pair<size_t, size_t> findRange(const std::string& name) const;
+
+public:
+    SymbolIndex();
+
+    /**
+     * 映射并校验索引文件
+     */
+    bool open(const std::string& path);
+    bool isOpen() const;
+
+    /**
+     * 查找名字的所有记录，按种类、文件、偏移排序（同一头文件被多个单元包含时只出现一次）
+     */
+    std::vector<IndexEntry> lookup(const std::string& name) const;
+
+    // 名字是否出现在索引中
+    bool contains(const std::string& name) const;
+
+    /**
+     * 记录中出现过该名字的翻译单元
+     */
+    std::vector<std::string> unitsReferencing(const std::string& name) const;
+
+    /**
+     * 索引仍然有效的翻译单元：自身与所有被包含文件的内容都与建立索引时相同
+     * 只有这些单元可以根据索引判断"不含某个名字"而跳过
+     */
+    std::vector<std::string> currentUnits() const;
+
+    size_t getUnitCount() const;
+    size_t getRecordCount() const;
+
+    /**
+     * 建立或增量更新索引
+     * @param indexPath 索引文件路径（已存在时在其基础上更新）
+     * @param files 工程中的翻译单元
+     * @param frontEnd 用于分析发生变化的单元
+     * @param threadCount 并行线程数
+     */
+    static bool update(const std::string& indexPath, const std::vector<std::string>& files,
+                       const ProjectAnalyzer& frontEnd, size_t threadCount, IndexBuildStats& stats);
+};
+
+#endif // SYMBOLINDEX_H
@@ -0,0 +1,79 @@
+#ifndef SYMBOLRENAMER_H
+#define SYMBOLRENAMER_H
+
+#include <vector>
+#include <string>
+#include <map>
+
+class ProjectAnalyzer;
+class SymbolIndex;
+
+/**
+ * 一处需要改名的位置
+ */
+struct RenameLocation {
+    int line = 0;
+    int column = 0;
+    size_t offset = 0;  // 名字在文件中的字节偏移
+};
+
+/**
+ * 改名计划的统计
+ */
+struct RenameStats {
+    size_t files = 0;     // 输入文件数
+    size_t analysed = 0;  // 实际分析的文件
+    size_t skipped = 0;   // 根据符号索引跳过的文件
+};
+
+/**
+ * 按作用域解析的批量改名
+ * 用工程前端分析每个翻译单元，只收集解析到全局函数/变量的名字（定义、声明、调用与引用），
+ * 被局部变量或形参遮蔽的同名标识符以及注释、字符串都不会被改动。
+ * 改动以字节偏移记录，每个文件只替换这些位置上的名字，并行地先写临时文件再改名。
+ */
+class SymbolRenamer {
+private:
+    const ProjectAnalyzer& frontEnd;
+    size_t threadCount;
+
+    std::string oldName;
+    std::string newName;
+    std::map<std::string, std::vector<RenameLocation>> edits;  // 文件 -> 按偏移排序的位置
+    std::vector<std::string> conflicts;
+    std::vector<std::string> warnings;
+
+public:
+    SymbolRenamer(const ProjectAnalyzer& frontEnd, size_t threadCount);
+
+    /**
+     * 找出所有需要改名的位置并检查冲突
+     * @param index 可选的符号索引：索引仍有效且不含该名字的文件不再分析
+     * @return 找到了全局符号且没有冲突
+     */
+    bool plan(const std::string& from, const std::string& to, const std::vector<std::string>& files,
+              const SymbolIndex* index, RenameStats& stats);
+
+    /**
+     * 并行地把改动写入各文件
+     * @param failures 写入失败或内容已变化的文件
+     */
+    bool apply(std::vector<std::string>& failures) const;
+
+    const std::map<std::string, std::vector<RenameLocation>>& getEdits() const;
+    const std::vector<std::string>& getConflicts() const;
+    const std::vector<std::string>& getWarnings() const;
+    size_t getEditCount() const;
+
+    /**
+     * 在内容的给定偏移处把 from 替换为 to
+     * @return 每个偏移处确实是完整的 from 时返回true
+     */
+    static bool applyEdits(std::string& content, const std::vector<RenameLocation>& locations,
+                           const std::string& from, const std::string& to);
+
+    // 是否为合法且不是关键字的标识符
+    static bool isIdentifier(const std::string& name);
+};
+
+#endif // SYMBOLRENAMER_H
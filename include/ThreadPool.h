@@ -0,0 +1,59 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * 固定大小的线程池
+ * 工程模式下各翻译单元的分析、各类批量处理都通过它并行执行。
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    size_t pending;  // 已提交但未完成的任务数
+    bool stopping;
+
+    void workerLoop();
+
+public:
+    /**
+     * @param threadCount 线程数，0表示使用硬件并发数
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 提交任务
+    void submit(std::function<void()> task);
+
+    // 等待所有已提交的任务完成
+    void wait();
+
+    /**
+     * 并行执行 fn(0) ... fn(count-1)，返回时全部完成
+     * 下标按块动态分配给各线程（包括调用线程），各次调用之间没有顺序保证
+     * 只等待本次调用的下标，不等待线程池中的其他任务，可在任务中嵌套调用
+     * fn抛出异常时其余下标不再执行，全部结束后在调用线程重新抛出第一个异常
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    size_t size() const;
+
+    // 默认线程数（硬件并发数，至少为1）
+    static size_t defaultThreadCount();
+};
+
+#endif // THREADPOOL_H
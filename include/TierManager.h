@@ -0,0 +1,102 @@
+#ifndef TIERMANAGER_H
+#define TIERMANAGER_H
+
+#include "Bytecode.h"
+#include "LoopOptimizer.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 一次升级：函数的调用次数或向回跳转次数达到阈值后编译的优化版本
+ */
+struct TierUp {
+    int function = -1;
+    bool byCalls = false;         // true为调用计数触发，false为向回跳转计数触发
+    uint64_t calls = 0;           // 触发时的调用次数
+    uint64_t backEdges = 0;       // 触发时的向回跳转次数（含轨迹中的迭代）
+    LoopOptimizerStats loops;     // 优化版本中的循环变换
+    bool changed = false;         // 循环变换改变了代码；没有改变时不发布优化版本
+    double compileMs = 0;
+    uint64_t switchedAtCall = 0;  // 从第几次调用开始执行优化版本，0表示没有切换
+    uint64_t optimizedCalls = 0;  // 执行优化版本的调用次数
+};
+
+/**
+ * 分层执行统计
+ */
+struct TierStats {
+    uint64_t tierUps = 0;
+    uint64_t byCalls = 0;
+    uint64_t byBackEdges = 0;
+    uint64_t optimized = 0;       // 发布了优化版本的函数
+    uint64_t unchanged = 0;       // 循环变换没有改变代码的函数
+    uint64_t switched = 0;        // 已在入口处切换到优化版本的函数
+    uint64_t optimizedCalls = 0;
+    double compileMs = 0;
+    LoopOptimizerStats loops;
+};
+
+/**
+ * 分层执行：函数先在解释器中执行基线字节码（不做循环变换），由计数器决定何时升级
+ * 每个函数记录调用次数与向回跳转次数（含轨迹JIT在机器码中完成的迭代），任一计数达到阈值时请求编译优化版本：
+ * 复制基线字节码并做循环旋转、强度削减与循环展开。编译在后台线程中进行，不阻塞解释器；
+ * 完成后原子地发布，之后对这个函数的调用在入口处切换到优化版本，已在执行的调用继续执行基线代码。
+ * 没有栈上替换（OSR）：只调用一次的函数（如热循环都在其中的main）升级后也不会执行优化版本。
+ *
+ * 计数与切换只在执行main的线程上进行；后台线程只读取模块并写入自己的函数版本，
+ * 发布用release/acquire保证解释器看到完整的代码。
+ */
+class TierManager {
+private:
+    struct FunctionTier {
+        uint64_t calls = 0;
+        uint64_t backEdges = 0;
+        bool requested = false;
+        TierUp event;                                            // 优化结果由编译线程填写
+        std::unique_ptr<BytecodeFunction> version;               // 编译线程写入后不再改变
+        std::atomic<const BytecodeFunction*> optimized{nullptr}; // 发布后的优化版本
+    };
+
+    const BytecodeModule& module;
+    uint32_t callThreshold;
+    uint32_t backEdgeThreshold;
+    bool background;
+    std::vector<FunctionTier> functions;
+    std::vector<int> requests;             // 按请求顺序的函数下标
+    std::unique_ptr<ThreadPool> compiler;  // 第一次请求时创建；最后声明，析构时先等待编译任务结束
+
+    void request(int index, bool byCalls);
+    void compile(int index);
+
+public:
+    /**
+     * @param callThreshold 调用多少次后升级
+     * @param backEdgeThreshold 向回跳转多少次后升级
+     * @param background 为false时在请求处同步编译（结果与执行时序无关，便于比较）
+     */
+    TierManager(const BytecodeModule& module, uint32_t callThreshold, uint32_t backEdgeThreshold, bool background);
+
+    TierManager(const TierManager&) = delete;
+    TierManager& operator=(const TierManager&) = delete;
+
+    /**
+     * 进入函数index时调用：计数，必要时请求升级
+     * @return 这次调用执行的代码，优化版本已发布时为优化版本，否则为基线代码
+     */
+    const BytecodeFunction* enter(int index);
+
+    // 函数index中执行了count次向回的跳转（解释执行或在轨迹JIT的机器码中）
+    void backEdge(int index, uint64_t count);
+
+    // 等待已请求的编译全部完成
+    void wait();
+
+    // 以下两个函数须在wait之后调用
+    TierStats getStats() const;
+    std::vector<TierUp> getTierUps() const;
+};
+
+#endif // TIERMANAGER_H
@@ -0,0 +1,94 @@
+#ifndef TOKENDIFF_H
+#define TOKENDIFF_H
+
+#include "TokenTypes.h"
+#include "StringInterner.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+
+/**
+ * 一处连续的改动：旧版本中被删除的token区间与新版本中插入的token区间
+ * 两个区间之一可以为空
+ */
+struct TokenChange {
+    size_t oldBegin = 0;
+    size_t oldEnd = 0;
+    size_t newBegin = 0;
+    size_t newEnd = 0;
+};
+
+/**
+ * 比较统计
+ */
+struct TokenDiffStats {
+    size_t oldTokens = 0;
+    size_t newTokens = 0;
+    size_t deleted = 0;
+    size_t inserted = 0;
+};
+
+/**
+ * token级别的差异比较
+ * 两个文件分别做词法分析（忽略空白、换行与注释），每个token按 种类+取值 驻留为一个整数，
+ * 在整数序列上运行Myers线性空间算法（双向搜索中间蛇形，分治递归），先去掉公共前后缀。
+ * 编辑距离过大时按GNU diff的做法取搜索最远处作为分割点，得到不一定最短但正确的结果。
+ * 改动以token为粒度，输出时映射回两个版本的行号，并用原始拼写显示。
+ */
+class TokenDiff {
+private:
+    // 一个版本的token序列
+    struct Version {
+        std::string path;
+        bool loaded = false;
+        std::string source;
+        std::vector<Token> tokens;
+        std::vector<uint64_t> ids;  // 种类与驻留后的取值拼成的编号
+    };
+
+    // 分割点
+    struct Partition {
+        ptrdiff_t x = 0;
+        ptrdiff_t y = 0;
+    };
+
+    Version oldVersion;
+    Version newVersion;
+    StringInterner interner;
+    std::vector<char> deleted;   // 旧版本中被删除的token
+    std::vector<char> inserted;  // 新版本中插入的token
+    std::vector<TokenChange> changes;
+
+    // 中间蛇形搜索用的对角线数组
+    std::vector<ptrdiff_t> forward;
+    std::vector<ptrdiff_t> backward;
+    ptrdiff_t diagonalOffset = 0;
+
+    // 私有辅助方法
+    bool loadVersion(const std::string& path, Version& version);
+    void compareRange(ptrdiff_t xoff, ptrdiff_t xlim, ptrdiff_t yoff, ptrdiff_t ylim);
+    Partition findMiddle(ptrdiff_t xoff, ptrdiff_t xlim, ptrdiff_t yoff, ptrdiff_t ylim);
+    void collectChanges();
+    std::string tokenText(const Version& version, size_t index) const;
+    std::string rangeText(const Version& version, size_t begin, size_t end) const;
+
+public:
+    /**
+     * 比较两个文件
+     * @return 两个文件都能读取时返回true
+     */
+    bool compare(const std::string& oldPath, const std::string& newPath, TokenDiffStats& stats);
+
+    // 按位置排列的改动
+    const std::vector<TokenChange>& getChanges() const;
+
+    /**
+     * 输出改动：相距不超过 context 个token的改动合并为一段，
+     * 每段给出新旧行号范围，删除的token显示为 [-...-]，插入的显示为 {+...+}
+     */
+    void printReport(std::ostream& os, const TokenDiffStats& stats, size_t context = 3) const;
+};
+
+#endif // TOKENDIFF_H
@@ -61,6 +61,8 @@ enum class TokenType {
     RBRACE,         // }
     LANGLE,         // <
     RANGLE,         // >
+    LBRACKET,       // [
+    RBRACKET,       // ]
     
     // 预处理
     HASH,           // #
@@ -85,6 +87,10 @@ public:
     std::string value;      // Token值
     int line;              // 行号
     int column;            // 列号
+    int fileId;            // 所属文件编号（0表示主文件，其余由IncludeResolver分配）
+    int originLine;        // 宏展开得到的token在宏定义中的行号（普通token为0）
+    int originColumn;      // 宏展开得到的token在宏定义中的列号
+    size_t offset;         // 在所属文件中的字节偏移
     
     // 构造函数
     Token();
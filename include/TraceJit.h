@@ -0,0 +1,136 @@
+#ifndef TRACEJIT_H
+#define TRACEJIT_H
+
+#include "Bytecode.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+/**
+ * 轨迹的出口：守卫失败时回到解释器继续执行的位置
+ * 出口之前本轮迭代已执行的字节码指令与下标检查次数用于保持执行统计与解释执行一致。
+ */
+struct TraceExit {
+    int32_t pc = 0;
+    uint32_t instructions = 0;
+    uint32_t boundsChecks = 0;
+    uint64_t taken = 0;  // 执行时经这个出口离开的次数
+};
+
+/**
+ * 轨迹上的一条操作：录制时执行过的字节码指令
+ * 条件跳转变为守卫，要求条件与录制时的方向相同；可能出错的指令（带检查的数组访问、
+ * 除法、F2I的越界）带一个守卫，失败时回到这条指令由解释器重新执行并报错。
+ * 常量传播得到的操作数记在known/value中；LOADI的value[1]为64位常量，GARRAY的value[2]为数组长度。
+ */
+struct TraceOp {
+    Opcode op = Opcode::NOP;
+    int32_t a = 0;
+    int32_t b = 0;
+    int32_t c = 0;
+    int32_t pc = 0;
+    bool taken = false;     // 条件跳转在录制时是否跳转
+    int32_t exit = -1;      // 守卫的出口下标，-1表示没有守卫
+    bool known[3] = {false, false, false};
+    Value value[3] = {};
+};
+
+/**
+ * 一个循环的轨迹：从循环头开始的一轮迭代，末尾回到循环头
+ */
+struct Trace {
+    const BytecodeFunction* function = nullptr;
+    int32_t head = 0;
+    int line = 0;
+    std::vector<TraceOp> ops;
+    std::vector<TraceExit> exits;
+    uint32_t instructions = 0;  // 每轮迭代的字节码指令条数
+    uint32_t boundsChecks = 0;
+    size_t recorded = 0;        // 优化前的操作数
+    size_t folded = 0;          // 常量传播折叠的操作
+    size_t guardsRemoved = 0;   // 常量或重复而去掉的守卫
+    size_t codeSize = 0;        // 机器码字节数
+    uint64_t entries = 0;
+    uint64_t iterations = 0;
+};
+
+/**
+ * 轨迹JIT统计
+ */
+struct TraceJitStats {
+    uint64_t compiled = 0;
+    uint64_t aborted = 0;      // 放弃的录制（遇到调用、内层循环、不支持的指令等）
+    uint64_t entries = 0;
+    uint64_t iterations = 0;
+    uint64_t instructions = 0; // 在机器码中执行的字节码指令条数
+};
+
+class ExecutableCode;
+
+/**
+ * 热循环的轨迹JIT（x86-64）
+ * 解释器在每条向回的跳转处调用enterLoop。循环头的计数器达到阈值后，由录制器执行一轮迭代
+ * 并记下实际经过的路径；回到循环头时轨迹闭合，经常量传播与冗余守卫消除后编译为机器码。
+ * 录制中遇到调用、printf、并行循环、返回、内层循环或超长路径时放弃，几次放弃后不再尝试。
+ *
+ * 机器码直接读写帧中的寄存器（帧基址在rbx，全局变量在r13），每条操作的结果立即写回，
+ * 因此出口不需要重建解释器状态：返回出口下标与完成的迭代次数，解释器从出口处继续。
+ * 录制器执行的语义与解释器相同，可能出错的指令在出错前放弃录制，由解释器报告错误。
+ * 非x86-64或没有mmap的平台上只解释执行。
+ */
+class TraceJit {
+private:
+    struct LoopSlot {
+        uint32_t counter = 0;
+        uint32_t attempts = 0;  // 放弃录制的次数
+        int32_t trace = -1;     // traces的下标
+    };
+
+    uint32_t threshold;
+    std::vector<std::vector<LoopSlot>> slots;  // [代码版本][循环头]，首次到达时分配
+    std::vector<std::unique_ptr<Trace>> traces;
+    std::vector<std::unique_ptr<ExecutableCode>> code;  // 与traces一一对应
+    TraceJitStats stats;
+
+    /**
+     * 从循环头录制一轮迭代（同时真正执行它）
+     * @param pc 输入为循环头，输出为解释器继续执行的位置
+     * @return 轨迹闭合时返回true
+     */
+    bool record(const BytecodeFunction& function, Value* registers, Value* globals, int32_t& pc, Trace& trace,
+                uint64_t& instructions, uint64_t& boundsChecks) const;
+
+    void optimize(Trace& trace) const;
+
+public:
+    /**
+     * @param threshold 循环头到达多少次后开始录制
+     */
+    TraceJit(const BytecodeModule& module, uint32_t threshold);
+    ~TraceJit();
+
+    TraceJit(const TraceJit&) = delete;
+    TraceJit& operator=(const TraceJit&) = delete;
+
+    // 当前平台能否生成机器码
+    static bool supported();
+
+    /**
+     * 解释器经向回的跳转到达循环头head时调用
+     * 有轨迹时执行轨迹，计数达到阈值时录制；执行过的指令计入instructions与boundsChecks
+     * @param version 代码版本：基线代码为函数下标，分层执行优化后的代码为函数下标加函数个数
+     * @param backEdges 加上轨迹与录制中执行的回到循环头的跳转次数（即完成的迭代数）
+     * @return 解释器继续执行的指令下标
+     */
+    int32_t enterLoop(const BytecodeFunction& function, int version, int32_t head, Value* registers, Value* globals, uint64_t& instructions,
+                      uint64_t& boundsChecks, uint64_t& backEdges);
+
+    const TraceJitStats& getStats() const;
+
+    // 输出各条轨迹的统计与优化后的操作
+    void dump(std::ostream& os) const;
+};
+
+#endif // TRACEJIT_H
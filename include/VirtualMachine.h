@@ -0,0 +1,119 @@
+#ifndef VIRTUALMACHINE_H
+#define VIRTUALMACHINE_H
+
+#include "Bytecode.h"
+#include "ThreadPool.h"
+#include "TraceJit.h"
+#include "TierManager.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+class OutputBuffer;
+
+/**
+ * 运行时错误（除数为0、下标越界、栈溢出等），带出错指令的源码行
+ */
+class RuntimeError : public std::exception {
+public:
+    std::string message;
+    int line;
+    std::string function;
+
+    RuntimeError(const std::string& message, int line, const std::string& function);
+    const char* what() const noexcept override;
+    std::string getFullMessage() const;
+};
+
+/**
+ * 虚拟机选项
+ */
+struct VMOptions {
+    size_t stackSize = 1 << 20;        // 值栈的槽位数（寄存器与局部数组都在栈上）
+    size_t maxCallDepth = 100000;
+    size_t outputBufferSize = 1 << 16; // 程序输出的缓冲区大小（字节）
+    size_t threads = 0;                // 并行循环的工作线程数，0表示硬件并发数，1表示不并行
+    int64_t minParallelTrips = 10000;  // 迭代次数达到此值的可并行循环才分块并行执行
+    bool jit = true;                   // 热循环编译为机器码（平台支持时）
+    uint32_t jitThreshold = 100;       // 循环头到达多少次后录制轨迹
+    bool tiering = false;              // 函数先执行基线字节码，由计数器触发循环变换后的优化版本
+    uint32_t tierCallThreshold = 50;   // 调用多少次后升级
+    uint32_t tierBackEdgeThreshold = 5000;  // 解释执行多少次向回跳转后升级
+    bool tierInBackground = true;      // 在后台线程中编译优化版本
+};
+
+/**
+ * 执行统计
+ */
+struct VMStats {
+    uint64_t instructions = 0;  // 执行的指令条数
+    uint64_t boundsChecks = 0;  // 执行的数组下标检查次数
+    uint64_t calls = 0;
+    size_t maxCallDepth = 0;
+    uint64_t parallelLoops = 0;   // 分块并行执行的循环次数
+    uint64_t parallelChunks = 0;
+};
+
+/**
+ * 字节码虚拟机
+ * 寄存器式解释器：GCC/Clang下用计算跳转（每条指令末尾直接跳到下一条指令的处理代码），
+ * 其他编译器退回switch。所有帧在一块固定大小的值栈上连续分配，调用不使用本机递归，
+ * 栈不会重新分配，因此数组指针在整个执行期间有效。
+ *
+ * PARFOR把迭代按迭代次数均分为至多64块（块的划分与线程数无关），每块在线程池中
+ * 用自己的帧执行循环体函数；部分和按块的顺序相加，出错时报告下标最小的块中的错误，
+ * 即串行执行时最先遇到的错误，因此结果与线程数和调度顺序无关。
+ *
+ * 主线程上的向回跳转交给TraceJit计数并执行热循环的轨迹；并行循环的各块只解释执行。
+ * 轨迹按完成的迭代与出口补记执行统计，指令条数与纯解释执行相同。
+ *
+ * 分层执行时主线程上的每次调用经TierManager计数并选择代码版本（基线或优化版本），
+ * 调用帧记下所执行的版本，返回后继续执行同一版本；并行循环的各块执行循环体函数的基线代码。
+ */
+class VirtualMachine {
+private:
+    const BytecodeModule& module;
+    VMOptions options;
+    VMStats stats;
+    std::vector<Value> globals;
+    std::vector<Value> stack;
+    std::unique_ptr<ThreadPool> pool;  // 第一次并行执行循环时创建
+    std::unique_ptr<TierManager> tiers;  // 每次run重新创建；先于jit声明，轨迹引用其中的函数版本
+    std::unique_ptr<TraceJit> jit;     // 每次run重新创建
+    std::ostream* programOutput = nullptr;
+
+    /**
+     * 从function的入口开始执行，直到它返回
+     * @param frame 入口函数的帧，形参已经写入；帧与被调用者的帧都不超过frameEnd
+     * @param traces 为空时不使用轨迹JIT
+     * @param tierManager 为空时只执行基线代码
+     */
+    int64_t execute(int function, Value* frame, Value* frameEnd, OutputBuffer& output, VMStats& counters,
+                    TraceJit* traces, TierManager* tierManager);
+
+    void runParallelLoop(const ParallelLoop& loop, Value* registers, int64_t lower, int64_t upper,
+                         VMStats& counters);
+
+public:
+    explicit VirtualMachine(const BytecodeModule& module, const VMOptions& options = VMOptions());
+
+    /**
+     * 执行全局变量的初始化与main
+     * @param out 程序的printf输出
+     * @return main的返回值；出错时抛出RuntimeError
+     */
+    int64_t run(std::ostream& out);
+
+    const VMStats& getStats() const;
+
+    // 最近一次run的轨迹JIT，未启用时为空
+    const TraceJit* getTraceJit() const;
+
+    // 最近一次run的分层执行，未启用时为空；run返回或抛出异常前已等待编译完成
+    const TierManager* getTierManager() const;
+};
+
+#endif // VIRTUALMACHINE_H
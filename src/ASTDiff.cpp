@@ -0,0 +1,659 @@
+#include "../include/ASTDiff.h"
+#include "../include/ASTWalker.h"
+#include "../include/ASTQuery.h"
+#include "../include/Lexer.h"
+#include "../include/HashUtils.h"
+#include "../include/ThreadPool.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+// 参与自顶向下整体匹配的最小子树高度：单个标识符、字面量等叶子太常见，留给后面的步骤按上下文配对
+const int MIN_HEIGHT = 2;
+
+// 自底向上配对所需的最小Dice系数
+const double MIN_DICE = 0.5;
+
+// 哈希相同的一组新子树，first 之前的都已匹配
+struct CandidateList {
+    std::vector<int> nodes;
+    size_t first = 0;
+};
+
+// 字符串字面量的取值已处理转义，显示时还原
+std::string quote(const std::string& value) {
+    std::string text = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '\n': text += "\\n"; break;
+            case '\t': text += "\\t"; break;
+            case '\r': text += "\\r"; break;
+            case '"': text += "\\\""; break;
+            case '\\': text += "\\\\"; break;
+            default: text += c; break;
+        }
+    }
+    return text + "\"";
+}
+
+std::string position(const ASTNode* node) {
+    return std::to_string(node->line) + ":" + std::to_string(node->column);
+}
+
+/**
+ * 权重最大的递增子序列（树状数组维护前缀最大值），返回不在其中的元素下标
+ * 用于从兄弟次序中找出移动的节点：保留的子树越大越好，只把小的子树报告为移动
+ */
+std::vector<size_t> outsideHeaviestIncreasing(const std::vector<int>& values, const std::vector<size_t>& weights) {
+    std::vector<int> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::pair<size_t, long>> tree(values.size() + 1, {0, -1});  // (权重和, 末尾元素下标)
+    std::vector<size_t> best(values.size(), 0);
+    std::vector<long> previous(values.size(), -1);
+    for (size_t i = 0; i < values.size(); i++) {
+        size_t rank = static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), values[i]) - sorted.begin()) + 1;
+        std::pair<size_t, long> prefix(0, -1);
+        for (size_t r = rank - 1; r > 0; r -= r & (~r + 1)) {
+            prefix = std::max(prefix, tree[r]);
+        }
+        best[i] = prefix.first + weights[i];
+        previous[i] = prefix.second;
+        for (size_t r = rank; r < tree.size(); r += r & (~r + 1)) {
+            tree[r] = std::max(tree[r], std::make_pair(best[i], static_cast<long>(i)));
+        }
+    }
+    std::vector<char> kept(values.size(), 0);
+    long last = values.empty() ? -1 : static_cast<long>(std::max_element(best.begin(), best.end()) - best.begin());
+    for (long i = last; i >= 0; i = previous[i]) {
+        kept[i] = 1;
+    }
+    std::vector<size_t> outside;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (!kept[i]) {
+            outside.push_back(i);
+        }
+    }
+    return outside;
+}
+
+} // namespace
+
+// ASTDiff类实现
+bool ASTDiff::loadTree(const std::string& path, Tree& tree) const {
+    tree.path = path;
+    std::ifstream input(path);
+    if (!input.is_open()) {
+        tree.diagnostics.push_back("Cannot open file '" + path + "'");
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << input.rdbuf();
+    tree.loaded = true;
+
+    Lexer lexer(buffer.str());
+    std::vector<Token> tokens = lexer.tokenize();
+    for (const auto& error : lexer.getErrors()) {
+        tree.diagnostics.push_back(path + ": " + error.getFullMessage());
+    }
+    Parser parser(tokens);
+    tree.program = parser.parse();
+    for (const auto& error : parser.getErrors()) {
+        tree.diagnostics.push_back(path + ": " + error.getFullMessage());
+    }
+    if (!tree.program || !tree.diagnostics.empty()) {
+        return false;  // 语法树不完整时比较结果没有意义
+    }
+    addNode(tree, *tree.program, -1, 0);
+    return true;
+}
+
+int ASTDiff::addNode(Tree& tree, const ASTNode& node, int parent, int slot) {
+    int index = static_cast<int>(tree.nodes.size());
+    tree.nodes.emplace_back();
+    tree.nodes[index].ast = &node;
+    tree.nodes[index].parent = parent;
+    tree.nodes[index].slot = slot;
+    tree.nodes[index].top = parent < 0 ? -1 : (parent == 0 ? index : tree.nodes[parent].top);
+
+    uint64_t label = HashUtils::combine(HashUtils::FNV_OFFSET, static_cast<uint64_t>(node.getKind()));
+    for (const auto& field : nodeFields(node)) {
+        label = HashUtils::hashString(field, HashUtils::combine(label, field.size()));
+    }
+    uint64_t hash = label;
+    size_t size = 1;
+    int height = 0;
+    int childSlot = 0;
+    forEachChildSlot(node, [&](const ASTNode* child) {
+        if (child) {
+            int childIndex = addNode(tree, *child, index, childSlot);
+            const TreeNode& added = tree.nodes[childIndex];
+            tree.nodes[index].children.push_back(childIndex);
+            hash = HashUtils::combine(hash, added.hash);
+            size += added.size;
+            height = std::max(height, added.height);
+        } else {
+            hash = HashUtils::combine(hash, 0);
+        }
+        childSlot++;
+    });
+
+    TreeNode& current = tree.nodes[index];
+    current.label = label;
+    current.hash = HashUtils::combine(hash, static_cast<uint64_t>(childSlot));
+    current.size = size;
+    current.height = height + 1;
+    return index;
+}
+
+void ASTDiff::link(int oldNode, int newNode, bool exact) {
+    oldTree.nodes[oldNode].partner = newNode;
+    oldTree.nodes[oldNode].exact = exact;
+    newTree.nodes[newNode].partner = oldNode;
+    newTree.nodes[newNode].exact = exact;
+}
+
+bool ASTDiff::eligible(const TreeNode& node) {
+    return node.height >= MIN_HEIGHT || node.parent == 0;
+}
+
+bool ASTDiff::rangeFree(const std::vector<TreeNode>& nodes, int root) {
+    for (size_t k = 0; k < nodes[root].size; k++) {
+        if (nodes[root + k].partner >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int ASTDiff::anchorOf(const std::vector<TreeNode>& nodes, int node) {
+    int ancestor = nodes[node].parent;
+    while (ancestor > 0 && nodes[ancestor].partner < 0) {
+        ancestor = nodes[ancestor].parent;
+    }
+    return ancestor;
+}
+
+void ASTDiff::linkSubtrees(int oldRoot, int newRoot) {
+    // 两棵相同子树的前序编号一一对应
+    for (size_t k = 0; k < oldTree.nodes[oldRoot].size; k++) {
+        link(oldRoot + static_cast<int>(k), newRoot + static_cast<int>(k), true);
+    }
+}
+
+std::vector<int> ASTDiff::matchIdenticalSubtrees(ASTDiffStats& stats) {
+    std::vector<TreeNode>& oldNodes = oldTree.nodes;
+    std::vector<TreeNode>& newNodes = newTree.nodes;
+    std::unordered_map<uint64_t, CandidateList> candidates;
+    for (size_t j = 1; j < newNodes.size(); j++) {
+        if (eligible(newNodes[j])) {
+            candidates[newNodes[j].hash].nodes.push_back(static_cast<int>(j));
+        }
+    }
+    std::unordered_map<uint64_t, size_t> oldCounts;
+    for (size_t i = 1; i < oldNodes.size(); i++) {
+        if (eligible(oldNodes[i])) {
+            oldCounts[oldNodes[i].hash]++;
+        }
+    }
+
+    // 前序：先尝试大的子树，匹配成功后跳过其内部。
+    // 顶层声明按出现次序配对；其余子树只在两边都唯一时配对，不唯一的留待确定所属函数后再配对
+    std::vector<int> ambiguous;
+    size_t i = 1;
+    while (i < oldNodes.size()) {
+        const TreeNode& node = oldNodes[i];
+        if (node.partner >= 0) {
+            i += node.size;
+            continue;
+        }
+        int chosen = -1;
+        auto it = eligible(node) ? candidates.find(node.hash) : candidates.end();
+        if (it != candidates.end()) {
+            CandidateList& list = it->second;
+            while (list.first < list.nodes.size() && newNodes[list.nodes[list.first]].partner >= 0) {
+                list.first++;
+            }
+            if (node.parent == 0) {
+                for (size_t k = list.first; k < list.nodes.size(); k++) {
+                    int candidate = list.nodes[k];
+                    if (newNodes[candidate].parent == 0 && newNodes[candidate].partner < 0 &&
+                        newNodes[candidate].size == node.size) {
+                        chosen = candidate;
+                        break;
+                    }
+                }
+            } else if (list.nodes.size() - list.first == 1 && oldCounts[node.hash] == 1) {
+                int candidate = list.nodes[list.first];
+                if (newNodes[candidate].size == node.size && rangeFree(newNodes, candidate)) {
+                    chosen = candidate;
+                }
+            } else if (list.first < list.nodes.size()) {
+                ambiguous.push_back(static_cast<int>(i));
+            }
+        }
+        if (chosen < 0) {
+            i++;
+            continue;
+        }
+        linkSubtrees(static_cast<int>(i), chosen);
+        if (node.parent == 0) {
+            stats.unchangedTopLevel++;
+        }
+        i += node.size;
+    }
+    return ambiguous;
+}
+
+void ASTDiff::matchAmbiguousSubtrees(const std::vector<int>& ambiguous) {
+    std::vector<TreeNode>& oldNodes = oldTree.nodes;
+    std::vector<TreeNode>& newNodes = newTree.nodes;
+    if (ambiguous.empty()) {
+        return;
+    }
+    std::unordered_set<uint64_t> hashes;
+    for (int node : ambiguous) {
+        hashes.insert(oldNodes[node].hash);
+    }
+    // 按 子树哈希+最近的已匹配祖先 建立候选表：只在对应的函数（或语句块）内部配对
+    std::unordered_map<uint64_t, std::vector<int>> candidates;
+    for (size_t j = 1; j < newNodes.size(); j++) {
+        const TreeNode& node = newNodes[j];
+        if (node.exact) {
+            j += node.size - 1;
+            continue;
+        }
+        if (node.partner < 0 && eligible(node) && hashes.count(node.hash)) {
+            uint64_t key = HashUtils::combine(node.hash, static_cast<uint64_t>(anchorOf(newNodes, static_cast<int>(j))));
+            candidates[key].push_back(static_cast<int>(j));
+        }
+    }
+    for (int node : ambiguous) {
+        if (oldNodes[node].partner >= 0 || !rangeFree(oldNodes, node)) {
+            continue;
+        }
+        int anchor = oldNodes[anchorOf(oldNodes, node)].partner;
+        auto it = candidates.find(HashUtils::combine(oldNodes[node].hash, static_cast<uint64_t>(anchor)));
+        if (it == candidates.end()) {
+            continue;
+        }
+        for (int candidate : it->second) {
+            if (newNodes[candidate].partner < 0 && newNodes[candidate].size == oldNodes[node].size &&
+                rangeFree(newNodes, candidate)) {
+                linkSubtrees(node, candidate);
+                break;
+            }
+        }
+    }
+}
+
+void ASTDiff::matchFunctionsByName() {
+    std::unordered_map<std::string, std::vector<int>> functions;
+    for (int child : newTree.nodes[0].children) {
+        const TreeNode& node = newTree.nodes[child];
+        ASTNodeKind kind = node.ast->getKind();
+        if (node.partner < 0 && (kind == ASTNodeKind::FunctionDefinition || kind == ASTNodeKind::FunctionDeclaration)) {
+            std::vector<std::string> fields = nodeFields(*node.ast);
+            functions[std::to_string(static_cast<int>(kind)) + ":" + fields[1]].push_back(child);
+        }
+    }
+    for (int child : oldTree.nodes[0].children) {
+        const TreeNode& node = oldTree.nodes[child];
+        ASTNodeKind kind = node.ast->getKind();
+        if (node.partner >= 0 || (kind != ASTNodeKind::FunctionDefinition && kind != ASTNodeKind::FunctionDeclaration)) {
+            continue;
+        }
+        auto it = functions.find(std::to_string(static_cast<int>(kind)) + ":" + nodeFields(*node.ast)[1]);
+        if (it == functions.end()) {
+            continue;
+        }
+        for (int candidate : it->second) {
+            if (newTree.nodes[candidate].partner < 0) {
+                link(child, candidate, false);
+                break;
+            }
+        }
+    }
+}
+
+void ASTDiff::matchBottomUp() {
+    std::vector<TreeNode>& oldNodes = oldTree.nodes;
+    std::vector<TreeNode>& newNodes = newTree.nodes;
+    // 前序编号倒序遍历时子节点先于父节点
+    for (size_t i = oldNodes.size(); i-- > 1;) {
+        const TreeNode& node = oldNodes[i];
+        if (node.partner >= 0 || node.children.empty()) {
+            continue;
+        }
+        // 候选：已匹配子节点的对应节点向上直到已匹配祖先为止的同种类未匹配节点
+        std::vector<int> candidates;
+        for (int child : node.children) {
+            int partner = oldNodes[child].partner;
+            if (partner < 0) {
+                continue;
+            }
+            for (int ancestor = newNodes[partner].parent; ancestor > 0 && newNodes[ancestor].partner < 0;
+                 ancestor = newNodes[ancestor].parent) {
+                if (newNodes[ancestor].ast->getKind() == node.ast->getKind() &&
+                    std::find(candidates.begin(), candidates.end(), ancestor) == candidates.end()) {
+                    candidates.push_back(ancestor);
+                }
+            }
+        }
+
+        int best = -1;
+        double bestDice = 0;
+        for (int candidate : candidates) {
+            size_t begin = static_cast<size_t>(candidate);
+            size_t end = begin + newNodes[candidate].size;
+            size_t common = 0;
+            for (size_t k = i + 1; k < i + node.size; k++) {
+                int partner = oldNodes[k].partner;
+                if (partner >= 0 && static_cast<size_t>(partner) > begin && static_cast<size_t>(partner) < end) {
+                    common++;
+                }
+            }
+            double dice = 2.0 * static_cast<double>(common) /
+                          static_cast<double>(node.size - 1 + newNodes[candidate].size - 1);
+            if (dice > bestDice) {
+                bestDice = dice;
+                best = candidate;
+            }
+        }
+        if (best >= 0 && bestDice >= MIN_DICE) {
+            link(static_cast<int>(i), best, false);
+        }
+    }
+}
+
+void ASTDiff::recoverChildren() {
+    std::vector<TreeNode>& oldNodes = oldTree.nodes;
+    std::vector<TreeNode>& newNodes = newTree.nodes;
+    // 仍未匹配的子节点：到对方未匹配的兄弟子树内部找相同的子树（如被包进新表达式的操作数）
+    auto matchNested = [&](const std::vector<TreeNode>& from, const std::vector<int>& fromChildren,
+                           const std::vector<TreeNode>& into, const std::vector<int>& intoChildren, bool fromOld) {
+        std::unordered_map<uint64_t, int> inside;
+        for (int root : intoChildren) {
+            if (into[root].partner >= 0) {
+                continue;
+            }
+            for (size_t k = 1; k < into[root].size; k++) {
+                if (into[root + k].partner < 0) {
+                    inside.emplace(into[root + k].hash, root + static_cast<int>(k));
+                }
+            }
+        }
+        for (int child : fromChildren) {
+            auto it = inside.find(from[child].hash);
+            if (from[child].partner >= 0 || it == inside.end() || into[it->second].size != from[child].size ||
+                !rangeFree(from, child) || !rangeFree(into, it->second)) {
+                continue;
+            }
+            for (size_t k = 0; k < from[child].size; k++) {
+                int a = child + static_cast<int>(k);
+                int b = it->second + static_cast<int>(k);
+                link(fromOld ? a : b, fromOld ? b : a, true);
+            }
+        }
+    };
+
+    size_t i = 0;
+    while (i < oldNodes.size()) {
+        const TreeNode& node = oldNodes[i];
+        if (node.exact) {
+            i += node.size;
+            continue;
+        }
+        if (node.partner >= 0) {
+            const TreeNode& partner = newNodes[node.partner];
+            // 先按种类与自身属性在兄弟中依次配对，再按相同的子节点位置配对（即属性被修改的节点）
+            std::unordered_map<uint64_t, std::vector<int>> byLabel;
+            std::unordered_map<int, int> bySlot;
+            for (auto it = partner.children.rbegin(); it != partner.children.rend(); ++it) {
+                if (newNodes[*it].partner < 0) {
+                    byLabel[newNodes[*it].label].push_back(*it);
+                    bySlot[newNodes[*it].slot] = *it;
+                }
+            }
+            for (int child : node.children) {
+                if (oldNodes[child].partner >= 0) {
+                    continue;
+                }
+                auto it = byLabel.find(oldNodes[child].label);
+                while (it != byLabel.end() && !it->second.empty()) {
+                    int candidate = it->second.back();
+                    it->second.pop_back();
+                    if (newNodes[candidate].partner < 0) {
+                        link(child, candidate, false);
+                        break;
+                    }
+                }
+            }
+            for (int child : node.children) {
+                if (oldNodes[child].partner >= 0) {
+                    continue;
+                }
+                auto it = bySlot.find(oldNodes[child].slot);
+                if (it != bySlot.end() && newNodes[it->second].partner < 0 &&
+                    newNodes[it->second].ast->getKind() == oldNodes[child].ast->getKind()) {
+                    link(child, it->second, false);
+                }
+            }
+            matchNested(oldNodes, node.children, newNodes, partner.children, true);
+            matchNested(newNodes, partner.children, oldNodes, node.children, false);
+        }
+        i++;
+    }
+}
+
+void ASTDiff::generateEdits(ASTDiffStats& stats) {
+    const std::vector<TreeNode>& oldNodes = oldTree.nodes;
+    const std::vector<TreeNode>& newNodes = newTree.nodes;
+    auto addEdit = [this](ASTEditKind kind, int oldNode, int newNode) {
+        ASTEdit edit;
+        edit.kind = kind;
+        edit.oldNode = oldNode;
+        edit.newNode = newNode;
+        edits.push_back(edit);
+    };
+
+    size_t i = 0;
+    while (i < oldNodes.size()) {
+        const TreeNode& node = oldNodes[i];
+        int index = static_cast<int>(i);
+        if (node.partner >= 0) {
+            stats.matched += node.exact ? node.size : 1;
+        }
+        if (i > 0) {
+            if (node.partner < 0) {
+                if (oldNodes[node.parent].partner >= 0) {
+                    addEdit(ASTEditKind::Delete, index, -1);
+                }
+            } else {
+                const TreeNode& partner = newNodes[node.partner];
+                if (partner.label != node.label) {
+                    addEdit(ASTEditKind::Update, index, node.partner);
+                }
+                if (oldNodes[node.parent].partner != partner.parent) {
+                    addEdit(ASTEditKind::Move, index, node.partner);
+                }
+            }
+        }
+        // 父节点互相匹配的子节点：不在新位置递增子序列中的视为移动
+        if (node.partner >= 0 && !node.exact && node.children.size() > 1) {
+            std::vector<int> children;
+            std::vector<int> positions;
+            std::vector<size_t> weights;
+            for (int child : node.children) {
+                int partner = oldNodes[child].partner;
+                if (partner >= 0 && newNodes[partner].parent == node.partner) {
+                    children.push_back(child);
+                    positions.push_back(partner);
+                    weights.push_back(oldNodes[child].size);
+                }
+            }
+            for (size_t k : outsideHeaviestIncreasing(positions, weights)) {
+                addEdit(ASTEditKind::Move, children[k], positions[k]);
+            }
+        }
+        i += node.exact ? node.size : 1;
+    }
+
+    size_t j = 1;
+    while (j < newNodes.size()) {
+        const TreeNode& node = newNodes[j];
+        if (node.exact) {
+            j += node.size;
+            continue;
+        }
+        if (node.partner < 0 && newNodes[node.parent].partner >= 0) {
+            addEdit(ASTEditKind::Insert, -1, static_cast<int>(j));
+        }
+        j++;
+    }
+
+    // 按所属的顶层声明和行号排列
+    auto lineOf = [&](const ASTEdit& edit) {
+        return edit.newNode >= 0 ? newNodes[edit.newNode].ast->line : oldNodes[edit.oldNode].ast->line;
+    };
+    std::stable_sort(edits.begin(), edits.end(), [&](const ASTEdit& a, const ASTEdit& b) {
+        long groupA = groupOf(a);
+        long groupB = groupOf(b);
+        return groupA != groupB ? groupA < groupB : lineOf(a) < lineOf(b);
+    });
+
+    for (const auto& edit : edits) {
+        switch (edit.kind) {
+            case ASTEditKind::Update: stats.updates++; break;
+            case ASTEditKind::Move: stats.moves++; break;
+            case ASTEditKind::Insert: stats.inserts++; break;
+            case ASTEditKind::Delete: stats.deletes++; break;
+        }
+    }
+}
+
+bool ASTDiff::compare(const std::string& oldPath, const std::string& newPath, ASTDiffStats& stats) {
+    stats = ASTDiffStats();
+    edits.clear();
+    oldTree = Tree();
+    newTree = Tree();
+
+    // 两个版本并行地做词法与语法分析
+    std::vector<char> ok(2, 0);
+    ThreadPool pool(2);
+    pool.parallelFor(2, [&](size_t i) {
+        ok[i] = loadTree(i == 0 ? oldPath : newPath, i == 0 ? oldTree : newTree);
+    });
+    if (!ok[0] || !ok[1]) {
+        return false;
+    }
+    stats.oldNodes = oldTree.nodes.size();
+    stats.newNodes = newTree.nodes.size();
+    stats.topLevel = oldTree.nodes[0].children.size();
+
+    link(0, 0, false);
+    std::vector<int> ambiguous = matchIdenticalSubtrees(stats);
+    matchFunctionsByName();
+    matchAmbiguousSubtrees(ambiguous);
+    matchBottomUp();
+    recoverChildren();
+    generateEdits(stats);
+    return true;
+}
+
+const std::vector<ASTEdit>& ASTDiff::getEdits() const {
+    return edits;
+}
+
+std::vector<std::string> ASTDiff::getDiagnostics() const {
+    std::vector<std::string> diagnostics = oldTree.diagnostics;
+    diagnostics.insert(diagnostics.end(), newTree.diagnostics.begin(), newTree.diagnostics.end());
+    return diagnostics;
+}
+
+long ASTDiff::groupOf(const ASTEdit& edit) const {
+    if (edit.oldNode >= 0) {
+        int top = oldTree.nodes[edit.oldNode].top;
+        return top == edit.oldNode ? -1 : top;
+    }
+    int top = newTree.nodes[edit.newNode].top;
+    if (top == edit.newNode) {
+        return -1;
+    }
+    int oldTop = newTree.nodes[top].partner;
+    return oldTop >= 0 ? oldTop : static_cast<long>(oldTree.nodes.size()) + top;
+}
+
+std::string ASTDiff::describe(const Tree& tree, int node) const {
+    const ASTNode& ast = *tree.nodes[node].ast;
+    std::string text = ASTQuery::kindName(ast.getKind());
+    if (ast.getKind() == ASTNodeKind::Literal) {
+        const auto& literal = static_cast<const LiteralNode&>(ast);
+        return text + " " + (literal.type == TokenType::STRING ? quote(literal.value) : literal.value);
+    }
+    for (const auto& field : nodeFields(ast)) {
+        if (!field.empty()) {
+            text += " " + field;
+        }
+    }
+    return text;
+}
+
+void ASTDiff::printReport(std::ostream& os, const ASTDiffStats& stats) const {
+    os << "\n=== AST Diff ===" << std::endl;
+    os << "--- " << oldTree.path << " (" << stats.oldNodes << " nodes)" << std::endl;
+    os << "+++ " << newTree.path << " (" << stats.newNodes << " nodes)" << std::endl;
+    os << "Top level: " << stats.unchangedTopLevel << " of " << stats.topLevel
+       << " declaration(s) unchanged (matched by subtree hash)" << std::endl;
+    if (edits.empty()) {
+        os << "✓ Syntax trees are identical." << std::endl;
+        return;
+    }
+
+    long currentGroup = -2;
+    for (const auto& edit : edits) {
+        // 分组标题：编辑所属的顶层声明
+        long group = groupOf(edit);
+        if (group != currentGroup) {
+            currentGroup = group;
+            long oldCount = static_cast<long>(oldTree.nodes.size());
+            if (group == -1) {
+                os << "top level:" << std::endl;
+            } else if (group < oldCount) {
+                os << describe(oldTree, static_cast<int>(group)) << " (old "
+                   << position(oldTree.nodes[group].ast) << "):" << std::endl;
+            } else {
+                int top = static_cast<int>(group - oldCount);
+                os << describe(newTree, top) << " (new " << position(newTree.nodes[top].ast) << "):" << std::endl;
+            }
+        }
+
+        switch (edit.kind) {
+            case ASTEditKind::Update:
+                os << "  ~ update " << describe(oldTree, edit.oldNode) << " -> " << describe(newTree, edit.newNode)
+                   << " (old " << position(oldTree.nodes[edit.oldNode].ast) << ", new "
+                   << position(newTree.nodes[edit.newNode].ast) << ")" << std::endl;
+                break;
+            case ASTEditKind::Move:
+                os << "  > move " << describe(oldTree, edit.oldNode) << " (old "
+                   << position(oldTree.nodes[edit.oldNode].ast) << " -> new "
+                   << position(newTree.nodes[edit.newNode].ast) << ")" << std::endl;
+                break;
+            case ASTEditKind::Insert:
+                os << "  + insert " << describe(newTree, edit.newNode) << " (new "
+                   << position(newTree.nodes[edit.newNode].ast) << ", " << newTree.nodes[edit.newNode].size
+                   << " node(s))" << std::endl;
+                break;
+            case ASTEditKind::Delete:
+                os << "  - delete " << describe(oldTree, edit.oldNode) << " (old "
+                   << position(oldTree.nodes[edit.oldNode].ast) << ", " << oldTree.nodes[edit.oldNode].size
+                   << " node(s))" << std::endl;
+                break;
+        }
+    }
+    os << stats.updates << " update(s), " << stats.moves << " move(s), " << stats.inserts << " insert(s), "
+       << stats.deletes << " delete(s); " << stats.matched << " of " << stats.oldNodes << " node(s) matched." << std::endl;
+}
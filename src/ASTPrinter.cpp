@@ -0,0 +1,523 @@
+#include "../include/ASTPrinter.h"
+#include "../include/ASTQuery.h"
+#include "../include/OutputBuffer.h"
+#include <array>
+#include <cstring>
+
+namespace {
+
+/**
+ * 依次对节点的每个非空子节点调用 fn(role, child)，role 为子节点在父节点中的角色
+ */
+template <typename Fn>
+void forEachRole(const ASTNode& node, Fn&& fn) {
+    auto visit = [&fn](const char* role, const std::unique_ptr<ASTNode>& child) {
+        if (child) {
+            fn(role, *child);
+        }
+    };
+
+    switch (node.getKind()) {
+        case ASTNodeKind::Program:
+            for (const auto& statement : static_cast<const ProgramNode&>(node).statements) {
+                visit("statement", statement);
+            }
+            break;
+        case ASTNodeKind::VarDeclaration:
+            visit("initializer", static_cast<const VarDeclarationNode&>(node).initializer);
+            break;
+        case ASTNodeKind::Assignment:
+            visit("expression", static_cast<const AssignmentNode&>(node).expression);
+            break;
+        case ASTNodeKind::BinaryExpression: {
+            const auto& binary = static_cast<const BinaryExpressionNode&>(node);
+            visit("left", binary.left);
+            visit("right", binary.right);
+            break;
+        }
+        case ASTNodeKind::UnaryExpression:
+            visit("operand", static_cast<const UnaryExpressionNode&>(node).operand);
+            break;
+        case ASTNodeKind::IfStatement: {
+            const auto& ifStmt = static_cast<const IfStatementNode&>(node);
+            visit("condition", ifStmt.condition);
+            visit("then", ifStmt.thenStatement);
+            visit("else", ifStmt.elseStatement);
+            break;
+        }
+        case ASTNodeKind::WhileStatement: {
+            const auto& whileStmt = static_cast<const WhileStatementNode&>(node);
+            visit("condition", whileStmt.condition);
+            visit("body", whileStmt.body);
+            break;
+        }
+        case ASTNodeKind::CompoundStatement:
+            for (const auto& statement : static_cast<const CompoundStatementNode&>(node).statements) {
+                visit("statement", statement);
+            }
+            break;
+        case ASTNodeKind::ReturnStatement:
+            visit("expression", static_cast<const ReturnStatementNode&>(node).expression);
+            break;
+        case ASTNodeKind::FunctionDeclaration:
+            for (const auto& parameter : static_cast<const FunctionDeclarationNode&>(node).parameters) {
+                visit("parameter", parameter);
+            }
+            break;
+        case ASTNodeKind::FunctionDefinition: {
+            const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+            for (const auto& parameter : function.parameters) {
+                visit("parameter", parameter);
+            }
+            visit("body", function.body);
+            break;
+        }
+        case ASTNodeKind::ExpressionStatement:
+            visit("expression", static_cast<const ExpressionStatementNode&>(node).expression);
+            break;
+        case ASTNodeKind::FunctionCall:
+            for (const auto& argument : static_cast<const FunctionCallNode&>(node).arguments) {
+                visit("argument", argument);
+            }
+            break;
+        case ASTNodeKind::ForStatement: {
+            const auto& forStmt = static_cast<const ForStatementNode&>(node);
+            visit("init", forStmt.initialization);
+            visit("condition", forStmt.condition);
+            visit("update", forStmt.update);
+            visit("body", forStmt.body);
+            break;
+        }
+        case ASTNodeKind::IndexExpression: {
+            const auto& index = static_cast<const IndexExpressionNode&>(node);
+            visit("array", index.array);
+            visit("index", index.index);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+ * 依次对节点的每个文本属性调用 fn(key, value)
+ */
+template <typename Fn>
+void forEachAttribute(const ASTNode& node, Fn&& fn) {
+    switch (node.getKind()) {
+        case ASTNodeKind::VarDeclaration: {
+            const auto& var = static_cast<const VarDeclarationNode&>(node);
+            fn("type", var.type);
+            fn("name", var.identifier);
+            break;
+        }
+        case ASTNodeKind::Assignment:
+            fn("name", static_cast<const AssignmentNode&>(node).identifier);
+            break;
+        case ASTNodeKind::BinaryExpression:
+            fn("operator", static_cast<const BinaryExpressionNode&>(node).operator_);
+            break;
+        case ASTNodeKind::UnaryExpression:
+            fn("operator", static_cast<const UnaryExpressionNode&>(node).operator_);
+            break;
+        case ASTNodeKind::Literal: {
+            const auto& literal = static_cast<const LiteralNode&>(node);
+            fn("value", literal.value);
+            fn("literal", TokenTypeUtils::tokenTypeToString(literal.type));
+            break;
+        }
+        case ASTNodeKind::Identifier:
+            fn("name", static_cast<const IdentifierNode&>(node).name);
+            break;
+        case ASTNodeKind::PreprocessorDirective: {
+            const auto& directive = static_cast<const PreprocessorDirectiveNode&>(node);
+            fn("directive", directive.directive);
+            fn("content", directive.content);
+            break;
+        }
+        case ASTNodeKind::FunctionDeclaration: {
+            const auto& function = static_cast<const FunctionDeclarationNode&>(node);
+            fn("returnType", function.returnType);
+            fn("name", function.name);
+            break;
+        }
+        case ASTNodeKind::FunctionDefinition: {
+            const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+            fn("returnType", function.returnType);
+            fn("name", function.name);
+            break;
+        }
+        case ASTNodeKind::FunctionCall:
+            fn("name", static_cast<const FunctionCallNode&>(node).name);
+            break;
+        case ASTNodeKind::ArrayDeclaration: {
+            const auto& array = static_cast<const ArrayDeclarationNode&>(node);
+            fn("type", array.type);
+            fn("name", array.identifier);
+            fn("size", std::to_string(array.size));
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+class Printer {
+private:
+    OutputBuffer& out;
+    std::string spaces;  // 缩进取其前缀，按需加长
+    std::array<const char*, AST_NODE_KIND_COUNT> kindNames;
+    size_t nextId = 0;   // DOT 节点编号
+
+    void indent(size_t width) {
+        if (width > spaces.size()) {
+            spaces.assign(std::max(width, spaces.size() * 2), ' ');
+        }
+        out.write(spaces.data(), width);
+    }
+
+    // 一行中文文本：缩进两格一级
+    void line(int level, const char* label, const std::string& text = std::string()) {
+        indent(static_cast<size_t>(level) * 2);
+        out.write(label);
+        out.write(text);
+        out.put('\n');
+    }
+
+    void jsonString(const std::string& text) {
+        out.put('"');
+        const char* run = text.data();
+        const char* end = run + text.size();
+        for (const char* p = run; p < end; ++p) {
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            out.write(run, static_cast<size_t>(p - run));
+            run = p + 1;
+            switch (c) {
+                case '"': out.write("\\\"", 2); break;
+                case '\\': out.write("\\\\", 2); break;
+                case '\n': out.write("\\n", 2); break;
+                case '\t': out.write("\\t", 2); break;
+                default: {
+                    static const char HEX[] = "0123456789abcdef";
+                    char escaped[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 15]};
+                    out.write(escaped, sizeof(escaped));
+                    break;
+                }
+            }
+        }
+        out.write(run, static_cast<size_t>(end - run));
+        out.put('"');
+    }
+
+    void dotString(const std::string& text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out.put('\\');
+                out.put(c);
+            } else if (c == '\n') {
+                out.write("\\n", 2);
+            } else {
+                out.put(c);
+            }
+        }
+    }
+
+public:
+    explicit Printer(OutputBuffer& out) : out(out), spaces(64, ' ') {
+        for (size_t kind = 0; kind < AST_NODE_KIND_COUNT; ++kind) {
+            kindNames[kind] = ASTQuery::kindName(static_cast<ASTNodeKind>(kind));
+        }
+    }
+
+    /**
+     * 中文文本格式，与原先各节点的 printChinese 逐字节相同
+     */
+    void chinese(const ASTNode& node, int level) {
+        auto child = [this](const std::unique_ptr<ASTNode>& node, int level) {
+            if (node) {
+                chinese(*node, level);
+            }
+        };
+
+        switch (node.getKind()) {
+            case ASTNodeKind::Program:
+                // 直接打印所有语句，不需要额外的"Program"标识
+                for (const auto& statement : static_cast<const ProgramNode&>(node).statements) {
+                    child(statement, level);
+                }
+                break;
+            case ASTNodeKind::VarDeclaration: {
+                const auto& var = static_cast<const VarDeclarationNode&>(node);
+                line(level, "变量声明: ", var.type);
+                line(level + 1, "标识符: ", var.identifier);
+                if (var.initializer) {
+                    line(level + 2, "运算符: =");
+                    chinese(*var.initializer, level + 3);
+                }
+                break;
+            }
+            case ASTNodeKind::Assignment: {
+                const auto& assignment = static_cast<const AssignmentNode&>(node);
+                line(level, "标识符: ", assignment.identifier);
+                child(assignment.expression, level);
+                break;
+            }
+            case ASTNodeKind::BinaryExpression: {
+                const auto& binary = static_cast<const BinaryExpressionNode&>(node);
+                child(binary.left, level);
+                line(level, "运算符: ", binary.operator_);
+                child(binary.right, level + 1);
+                break;
+            }
+            case ASTNodeKind::UnaryExpression: {
+                const auto& unary = static_cast<const UnaryExpressionNode&>(node);
+                line(level, "运算符: ", unary.operator_);
+                child(unary.operand, level);
+                break;
+            }
+            case ASTNodeKind::Literal: {
+                const auto& literal = static_cast<const LiteralNode&>(node);
+                if (literal.type == TokenType::INTEGER || literal.type == TokenType::FLOAT) {
+                    line(level, "数字: ", literal.value);
+                } else if (literal.type == TokenType::STRING) {
+                    line(level, "字符串: ", literal.value);
+                } else if (literal.type == TokenType::BREAK) {
+                    line(level, "break语句: break");
+                } else if (literal.type == TokenType::CONTINUE) {
+                    line(level, "continue语句: continue");
+                } else {
+                    line(level, "", literal.value);
+                }
+                break;
+            }
+            case ASTNodeKind::Identifier:
+                line(level, "标识符: ", static_cast<const IdentifierNode&>(node).name);
+                break;
+            case ASTNodeKind::IfStatement: {
+                const auto& ifStmt = static_cast<const IfStatementNode&>(node);
+                line(level, "if语句: if");
+                line(level + 1, "表达式:");
+                child(ifStmt.condition, level + 2);
+                child(ifStmt.thenStatement, level + 1);
+                if (ifStmt.elseStatement) {
+                    line(level + 1, "关键字: else");
+                    chinese(*ifStmt.elseStatement, level + 2);
+                }
+                break;
+            }
+            case ASTNodeKind::WhileStatement: {
+                const auto& whileStmt = static_cast<const WhileStatementNode&>(node);
+                line(level, "while语句: while");
+                line(level + 1, "表达式:");
+                child(whileStmt.condition, level + 2);
+                child(whileStmt.body, level + 1);
+                break;
+            }
+            case ASTNodeKind::CompoundStatement:
+                line(level, "复合语句:");
+                for (const auto& statement : static_cast<const CompoundStatementNode&>(node).statements) {
+                    child(statement, level + 1);
+                }
+                break;
+            case ASTNodeKind::ReturnStatement:
+                line(level, "return语句: return");
+                child(static_cast<const ReturnStatementNode&>(node).expression, level + 1);
+                break;
+            case ASTNodeKind::PreprocessorDirective: {
+                const auto& directive = static_cast<const PreprocessorDirectiveNode&>(node);
+                indent(static_cast<size_t>(level) * 2);
+                out.write("预处理指令: # ");
+                out.write(directive.directive);
+                out.put(' ');
+                out.write(directive.content);
+                out.put('\n');
+                break;
+            }
+            case ASTNodeKind::FunctionDeclaration: {
+                const auto& function = static_cast<const FunctionDeclarationNode&>(node);
+                line(level, "函数声明: ", function.returnType);
+                line(level + 1, "标识符: ", function.name);
+                for (const auto& parameter : function.parameters) {
+                    child(parameter, level + 1);
+                }
+                break;
+            }
+            case ASTNodeKind::FunctionDefinition: {
+                const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+                line(level, "函数定义: ", function.returnType);
+                line(level + 1, "标识符: ", function.name);
+                for (const auto& parameter : function.parameters) {
+                    child(parameter, level + 1);
+                }
+                child(function.body, level + 1);
+                break;
+            }
+            case ASTNodeKind::ExpressionStatement: {
+                const auto& statement = static_cast<const ExpressionStatementNode&>(node);
+                line(level, "表达式语句:");
+                if (statement.expression) {
+                    line(level + 1, "表达式:");
+                    chinese(*statement.expression, level + 2);
+                }
+                break;
+            }
+            case ASTNodeKind::FunctionCall: {
+                const auto& call = static_cast<const FunctionCallNode&>(node);
+                line(level, "函数调用: ", call.name);
+                for (const auto& argument : call.arguments) {
+                    child(argument, level + 1);
+                }
+                break;
+            }
+            case ASTNodeKind::ForStatement: {
+                const auto& forStmt = static_cast<const ForStatementNode&>(node);
+                line(level, "for语句: for");
+                child(forStmt.initialization, level + 1);
+                if (forStmt.condition) {
+                    line(level + 1, "表达式:");
+                    chinese(*forStmt.condition, level + 2);
+                }
+                if (forStmt.update) {
+                    line(level + 1, "表达式:");
+                    chinese(*forStmt.update, level + 2);
+                }
+                child(forStmt.body, level + 1);
+                break;
+            }
+            case ASTNodeKind::BreakStatement:
+                line(level, "break语句: break");
+                break;
+            case ASTNodeKind::ContinueStatement:
+                line(level, "continue语句: continue");
+                break;
+            case ASTNodeKind::ArrayDeclaration: {
+                const auto& array = static_cast<const ArrayDeclarationNode&>(node);
+                line(level, "数组声明: ", array.type);
+                line(level + 1, "标识符: ", array.identifier);
+                line(level + 1, "长度: ", array.size > 0 ? std::to_string(array.size) : "由实参决定");
+                break;
+            }
+            case ASTNodeKind::IndexExpression: {
+                const auto& index = static_cast<const IndexExpressionNode&>(node);
+                line(level, "下标:");
+                child(index.array, level + 1);
+                child(index.index, level + 1);
+                break;
+            }
+            default:
+                line(level, "", node.toString());
+                break;
+        }
+    }
+
+    /**
+     * JSON：每个节点一行开头，子节点放在 "children" 数组中并缩进一级
+     */
+    void json(const ASTNode& node, const char* role, size_t depth) {
+        indent(depth * 2);
+        out.put('{');
+        if (role) {
+            out.write("\"role\": \"");
+            out.write(role);
+            out.write("\", ");
+        }
+        out.write("\"kind\": \"");
+        out.write(kindNames[static_cast<size_t>(node.getKind())]);
+        out.write("\", \"line\": ");
+        out.writeNumber(node.line);
+        out.write(", \"column\": ");
+        out.writeNumber(node.column);
+        forEachAttribute(node, [this](const char* key, const std::string& value) {
+            out.write(", \"");
+            out.write(key);
+            out.write("\": ");
+            jsonString(value);
+        });
+
+        bool first = true;
+        forEachRole(node, [&](const char* childRole, const ASTNode& child) {
+            out.write(first ? ", \"children\": [\n" : ",\n");
+            first = false;
+            json(child, childRole, depth + 1);
+        });
+        if (!first) {
+            out.put('\n');
+            indent(depth * 2);
+            out.put(']');
+        }
+        out.put('}');
+    }
+
+    /**
+     * DOT：先声明节点再连边，边上标注子节点的角色
+     * @return 节点编号
+     */
+    size_t dot(const ASTNode& node) {
+        size_t id = nextId++;
+        out.write("    n");
+        out.writeNumber(id);
+        out.write(" [label=\"");
+        out.write(kindNames[static_cast<size_t>(node.getKind())]);
+        forEachAttribute(node, [this](const char* key, const std::string& value) {
+            if (std::strcmp(key, "literal") != 0) {  // 字面量的token种类不显示
+                out.write("\\n");
+                dotString(value);
+            }
+        });
+        out.write("\"];\n");
+
+        forEachRole(node, [&](const char* role, const ASTNode& child) {
+            size_t childId = dot(child);
+            out.write("    n");
+            out.writeNumber(id);
+            out.write(" -> n");
+            out.writeNumber(childId);
+            out.write(" [label=\"");
+            out.write(role);
+            out.write("\"];\n");
+        });
+        return id;
+    }
+};
+
+} // namespace
+
+// ASTPrinter类实现
+ASTPrinter::ASTPrinter(ASTDumpFormat format, size_t bufferSize) : format(format), bufferSize(bufferSize) {}
+
+bool ASTPrinter::parseFormat(const std::string& name, ASTDumpFormat& format) {
+    if (name == "text") {
+        format = ASTDumpFormat::Chinese;
+    } else if (name == "json") {
+        format = ASTDumpFormat::JSON;
+    } else if (name == "dot") {
+        format = ASTDumpFormat::Dot;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+size_t ASTPrinter::print(const ProgramNode& program, std::ostream& out) const {
+    OutputBuffer buffer(out, bufferSize);
+    Printer printer(buffer);
+    switch (format) {
+        case ASTDumpFormat::Chinese:
+            printer.chinese(program, 0);
+            break;
+        case ASTDumpFormat::JSON:
+            printer.json(program, nullptr, 0);
+            buffer.put('\n');
+            break;
+        case ASTDumpFormat::Dot:
+            buffer.write("digraph ast {\n    node [shape=box, fontname=\"monospace\"];\n");
+            printer.dot(program);
+            buffer.write("}\n");
+            break;
+    }
+    buffer.flush();
+    return buffer.written();
+}
@@ -0,0 +1,672 @@
+#include "../include/ASTQuery.h"
+#include "../include/ASTWalker.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/SymbolIndex.h"
+#include "../include/ThreadPool.h"
+#include <filesystem>
+#include <algorithm>
+#include <unordered_set>
+#include <cctype>
+
+namespace {
+
+/**
+ * 查询语言中的字段
+ */
+enum class QueryField {
+    Name, Type, Op, Value, Args,
+    Arg, Param,
+    Init, Expr, Left, Right, Operand, Cond, Then, Else, Body, Update,
+    Has
+};
+
+struct FieldInfo {
+    const char* name;
+    QueryField field;
+};
+
+const FieldInfo FIELDS[] = {
+    {"name", QueryField::Name}, {"type", QueryField::Type}, {"op", QueryField::Op},
+    {"value", QueryField::Value}, {"args", QueryField::Args}, {"init", QueryField::Init},
+    {"expr", QueryField::Expr}, {"left", QueryField::Left}, {"right", QueryField::Right},
+    {"operand", QueryField::Operand}, {"cond", QueryField::Cond}, {"then", QueryField::Then},
+    {"else", QueryField::Else}, {"body", QueryField::Body}, {"update", QueryField::Update},
+    {"has", QueryField::Has},
+};
+
+struct KindInfo {
+    const char* name;
+    ASTNodeKind kind;
+    bool assignment = false;  // 只匹配赋值运算的二元表达式
+};
+
+const KindInfo KINDS[] = {
+    {"call", ASTNodeKind::FunctionCall}, {"var", ASTNodeKind::VarDeclaration},
+    {"binary", ASTNodeKind::BinaryExpression}, {"assign", ASTNodeKind::BinaryExpression, true},
+    {"unary", ASTNodeKind::UnaryExpression}, {"literal", ASTNodeKind::Literal},
+    {"ident", ASTNodeKind::Identifier}, {"if", ASTNodeKind::IfStatement},
+    {"while", ASTNodeKind::WhileStatement}, {"for", ASTNodeKind::ForStatement},
+    {"block", ASTNodeKind::CompoundStatement}, {"return", ASTNodeKind::ReturnStatement},
+    {"func", ASTNodeKind::FunctionDefinition}, {"decl", ASTNodeKind::FunctionDeclaration},
+    {"expr", ASTNodeKind::ExpressionStatement}, {"break", ASTNodeKind::BreakStatement},
+    {"continue", ASTNodeKind::ContinueStatement}, {"directive", ASTNodeKind::PreprocessorDirective},
+    {"program", ASTNodeKind::Program}, {"array", ASTNodeKind::ArrayDeclaration},
+    {"index", ASTNodeKind::IndexExpression},
+};
+
+// 字段是否适用于节点种类（has 适用于所有种类）
+bool fieldApplies(QueryField field, ASTNodeKind kind) {
+    switch (field) {
+        case QueryField::Has:
+            return true;
+        case QueryField::Name:
+            return kind == ASTNodeKind::FunctionCall || kind == ASTNodeKind::VarDeclaration ||
+                   kind == ASTNodeKind::Assignment || kind == ASTNodeKind::Identifier ||
+                   kind == ASTNodeKind::FunctionDefinition || kind == ASTNodeKind::FunctionDeclaration ||
+                   kind == ASTNodeKind::PreprocessorDirective || kind == ASTNodeKind::ArrayDeclaration;
+        case QueryField::Type:
+            return kind == ASTNodeKind::VarDeclaration || kind == ASTNodeKind::ArrayDeclaration ||
+                   kind == ASTNodeKind::Literal ||
+                   kind == ASTNodeKind::FunctionDefinition || kind == ASTNodeKind::FunctionDeclaration;
+        case QueryField::Op:
+            return kind == ASTNodeKind::BinaryExpression || kind == ASTNodeKind::UnaryExpression;
+        case QueryField::Value:
+            return kind == ASTNodeKind::Literal || kind == ASTNodeKind::PreprocessorDirective;
+        case QueryField::Args:
+            return kind == ASTNodeKind::FunctionCall || kind == ASTNodeKind::FunctionDefinition ||
+                   kind == ASTNodeKind::FunctionDeclaration;
+        case QueryField::Arg:
+            return kind == ASTNodeKind::FunctionCall;
+        case QueryField::Param:
+            return kind == ASTNodeKind::FunctionDefinition || kind == ASTNodeKind::FunctionDeclaration;
+        case QueryField::Init:
+            return kind == ASTNodeKind::VarDeclaration || kind == ASTNodeKind::ForStatement;
+        case QueryField::Expr:
+            return kind == ASTNodeKind::Assignment || kind == ASTNodeKind::ReturnStatement ||
+                   kind == ASTNodeKind::ExpressionStatement;
+        case QueryField::Left:
+        case QueryField::Right:
+            return kind == ASTNodeKind::BinaryExpression;
+        case QueryField::Operand:
+            return kind == ASTNodeKind::UnaryExpression;
+        case QueryField::Cond:
+            return kind == ASTNodeKind::IfStatement || kind == ASTNodeKind::WhileStatement ||
+                   kind == ASTNodeKind::ForStatement;
+        case QueryField::Then:
+        case QueryField::Else:
+            return kind == ASTNodeKind::IfStatement;
+        case QueryField::Body:
+            return kind == ASTNodeKind::WhileStatement || kind == ASTNodeKind::ForStatement ||
+                   kind == ASTNodeKind::FunctionDefinition;
+        case QueryField::Update:
+            return kind == ASTNodeKind::ForStatement;
+    }
+    return false;
+}
+
+bool isStringField(QueryField field) {
+    return field == QueryField::Name || field == QueryField::Type || field == QueryField::Op ||
+           field == QueryField::Value;
+}
+
+const char* literalTypeName(TokenType type) {
+    switch (type) {
+        case TokenType::INTEGER: return "int";
+        case TokenType::FLOAT: return "float";
+        case TokenType::STRING: return "string";
+        default: return "";
+    }
+}
+
+/**
+ * 查询文本的词法单元
+ */
+struct QueryToken {
+    enum Kind { Identifier, String, Number, Punct, End } kind;
+    std::string text;
+    size_t position;
+};
+
+bool tokenizeQuery(const std::string& text, std::vector<QueryToken>& tokens, std::string& error) {
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            i++;
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = i;
+            while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) {
+                i++;
+            }
+            tokens.push_back({QueryToken::Identifier, text.substr(start, i - start), start});
+        } else if (std::isdigit(static_cast<unsigned char>(c))) {
+            size_t start = i;
+            while (i < text.size() && std::isdigit(static_cast<unsigned char>(text[i]))) {
+                i++;
+            }
+            tokens.push_back({QueryToken::Number, text.substr(start, i - start), start});
+        } else if (c == '"') {
+            size_t start = i++;
+            std::string value;
+            while (i < text.size() && text[i] != '"') {
+                if (text[i] == '\\' && i + 1 < text.size()) {
+                    i++;
+                }
+                value += text[i++];
+            }
+            if (i >= text.size()) {
+                error = "unterminated string at position " + std::to_string(start);
+                return false;
+            }
+            i++;
+            tokens.push_back({QueryToken::String, value, start});
+        } else if (c == '!' && i + 1 < text.size() && text[i + 1] == '=') {
+            tokens.push_back({QueryToken::Punct, "!=", i});
+            i += 2;
+        } else if (c == '(' || c == ')' || c == ',' || c == '=') {
+            tokens.push_back({QueryToken::Punct, std::string(1, c), i});
+            i++;
+        } else {
+            error = std::string("unexpected character '") + c + "' at position " + std::to_string(i);
+            return false;
+        }
+    }
+    tokens.push_back({QueryToken::End, "", text.size()});
+    return true;
+}
+
+} // namespace
+
+/**
+ * 编译后的模式
+ */
+struct ASTQuery::Pattern {
+    struct Constraint {
+        QueryField field = QueryField::Name;
+        size_t index = 0;                  // argN / paramN 的下标
+        bool negate = false;
+        bool none = false;                 // 值为 none：子节点不存在
+        std::string text;                  // 字符串值
+        size_t number = 0;                 // 整数值（args）
+        std::unique_ptr<Pattern> pattern;  // 子模式
+    };
+
+    bool any = true;  // '_'：任意种类
+    ASTNodeKind kind = ASTNodeKind::Program;
+    bool assignment = false;  // assign：运算符为 = 或复合赋值的二元表达式
+    std::vector<Constraint> constraints;
+};
+
+namespace {
+
+/**
+ * 递归下降解析查询文本
+ */
+class QueryParser {
+private:
+    const std::vector<QueryToken>& tokens;
+    size_t current = 0;
+    std::string& error;
+
+    const QueryToken& peek() const { return tokens[current]; }
+
+    bool fail(const std::string& message) {
+        if (error.empty()) {
+            error = message + " at position " + std::to_string(peek().position);
+        }
+        return false;
+    }
+
+    bool expect(const char* punct) {
+        if (peek().kind != QueryToken::Punct || peek().text != punct) {
+            return fail(std::string("expected '") + punct + "'");
+        }
+        current++;
+        return true;
+    }
+
+    bool parseConstraint(ASTQuery::Pattern& pattern) {
+        using Constraint = ASTQuery::Pattern::Constraint;
+        if (peek().kind != QueryToken::Identifier) {
+            return fail("expected field name");
+        }
+        Constraint constraint;
+        std::string name = peek().text;
+        bool known = false;
+        for (const auto& info : FIELDS) {
+            if (name == info.name) {
+                constraint.field = info.field;
+                known = true;
+            }
+        }
+        for (const char* prefix : {"arg", "param"}) {
+            size_t length = std::char_traits<char>::length(prefix);
+            if (!known && name.size() > length && name.compare(0, length, prefix) == 0 &&
+                std::all_of(name.begin() + length, name.end(), ::isdigit)) {
+                constraint.field = length == 3 ? QueryField::Arg : QueryField::Param;
+                constraint.index = std::stoul(name.substr(length));
+                known = true;
+            }
+        }
+        if (!known) {
+            return fail("unknown field '" + name + "'");
+        }
+        if (!pattern.any && !fieldApplies(constraint.field, pattern.kind)) {
+            return fail("field '" + name + "' does not apply to " +
+                        (pattern.assignment ? "assign" : ASTQuery::kindName(pattern.kind)));
+        }
+        if (pattern.any && constraint.field != QueryField::Has) {
+            return fail("'_' only supports the 'has' field");
+        }
+        current++;
+
+        if (peek().kind != QueryToken::Punct || (peek().text != "=" && peek().text != "!=")) {
+            return fail("expected '=' or '!='");
+        }
+        constraint.negate = peek().text == "!=";
+        current++;
+
+        const QueryToken& value = peek();
+        if (isStringField(constraint.field)) {
+            if (value.kind != QueryToken::String && value.kind != QueryToken::Number) {
+                return fail("field '" + name + "' expects a string");
+            }
+            constraint.text = value.text;
+            current++;
+        } else if (constraint.field == QueryField::Args) {
+            if (value.kind != QueryToken::Number) {
+                return fail("field 'args' expects a number");
+            }
+            constraint.number = std::stoul(value.text);
+            current++;
+        } else if (value.kind == QueryToken::Identifier && value.text == "none") {
+            if (constraint.field == QueryField::Has) {
+                return fail("field 'has' expects a pattern");
+            }
+            constraint.none = true;
+            current++;
+        } else {
+            constraint.pattern = std::make_unique<ASTQuery::Pattern>();
+            if (!parsePattern(*constraint.pattern)) {
+                return false;
+            }
+        }
+        pattern.constraints.push_back(std::move(constraint));
+        return true;
+    }
+
+public:
+    QueryParser(const std::vector<QueryToken>& tokens, std::string& error) : tokens(tokens), error(error) {}
+
+    bool parsePattern(ASTQuery::Pattern& pattern) {
+        if (peek().kind != QueryToken::Identifier) {
+            return fail("expected node kind");
+        }
+        const std::string& name = peek().text;
+        if (name == "_") {
+            pattern.any = true;
+        } else {
+            pattern.any = false;
+            bool known = false;
+            for (const auto& info : KINDS) {
+                if (name == info.name) {
+                    pattern.kind = info.kind;
+                    pattern.assignment = info.assignment;
+                    known = true;
+                }
+            }
+            if (!known) {
+                return fail("unknown node kind '" + name + "'");
+            }
+        }
+        current++;
+
+        if (peek().kind == QueryToken::Punct && peek().text == "(") {
+            current++;
+            if (peek().kind == QueryToken::Punct && peek().text == ")") {
+                current++;
+                return true;
+            }
+            while (true) {
+                if (!parseConstraint(pattern)) {
+                    return false;
+                }
+                if (peek().kind != QueryToken::Punct || peek().text != ",") {
+                    break;
+                }
+                current++;
+            }
+            if (!expect(")")) {
+                return false;
+            }
+        }
+
+        // 先做字符串/整数比较，再匹配子模式，最后做需要遍历子树的 has
+        std::stable_sort(pattern.constraints.begin(), pattern.constraints.end(),
+                         [](const ASTQuery::Pattern::Constraint& a, const ASTQuery::Pattern::Constraint& b) {
+                             auto rank = [](const ASTQuery::Pattern::Constraint& c) {
+                                 return c.field == QueryField::Has ? 2 : (c.pattern ? 1 : 0);
+                             };
+                             return rank(a) < rank(b);
+                         });
+        return true;
+    }
+
+    bool atEnd() const { return peek().kind == QueryToken::End; }
+};
+
+// 取得节点的字符串字段
+std::string stringField(const ASTNode& node, QueryField field) {
+    switch (node.getKind()) {
+        case ASTNodeKind::FunctionCall:
+            return static_cast<const FunctionCallNode&>(node).name;
+        case ASTNodeKind::VarDeclaration: {
+            const auto& var = static_cast<const VarDeclarationNode&>(node);
+            return field == QueryField::Type ? var.type : var.identifier;
+        }
+        case ASTNodeKind::ArrayDeclaration: {
+            const auto& array = static_cast<const ArrayDeclarationNode&>(node);
+            return field == QueryField::Type ? array.type : array.identifier;
+        }
+        case ASTNodeKind::Assignment:
+            return static_cast<const AssignmentNode&>(node).identifier;
+        case ASTNodeKind::Identifier:
+            return static_cast<const IdentifierNode&>(node).name;
+        case ASTNodeKind::BinaryExpression:
+            return static_cast<const BinaryExpressionNode&>(node).operator_;
+        case ASTNodeKind::UnaryExpression:
+            return static_cast<const UnaryExpressionNode&>(node).operator_;
+        case ASTNodeKind::Literal: {
+            const auto& literal = static_cast<const LiteralNode&>(node);
+            return field == QueryField::Type ? literalTypeName(literal.type) : literal.value;
+        }
+        case ASTNodeKind::FunctionDefinition: {
+            const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+            return field == QueryField::Type ? function.returnType : function.name;
+        }
+        case ASTNodeKind::FunctionDeclaration: {
+            const auto& function = static_cast<const FunctionDeclarationNode&>(node);
+            return field == QueryField::Type ? function.returnType : function.name;
+        }
+        case ASTNodeKind::PreprocessorDirective: {
+            const auto& directive = static_cast<const PreprocessorDirectiveNode&>(node);
+            return field == QueryField::Value ? directive.content : directive.directive;
+        }
+        default:
+            return "";
+    }
+}
+
+// 取得节点的列表字段（实参或形参）
+const std::vector<std::unique_ptr<ASTNode>>* listField(const ASTNode& node) {
+    switch (node.getKind()) {
+        case ASTNodeKind::FunctionCall:
+            return &static_cast<const FunctionCallNode&>(node).arguments;
+        case ASTNodeKind::FunctionDefinition:
+            return &static_cast<const FunctionDefinitionNode&>(node).parameters;
+        case ASTNodeKind::FunctionDeclaration:
+            return &static_cast<const FunctionDeclarationNode&>(node).parameters;
+        default:
+            return nullptr;
+    }
+}
+
+// 取得节点的子节点字段，不存在时返回nullptr
+const ASTNode* childField(const ASTNode& node, QueryField field, size_t index) {
+    if (field == QueryField::Arg || field == QueryField::Param) {
+        const auto* list = listField(node);
+        return list && index < list->size() ? (*list)[index].get() : nullptr;
+    }
+    switch (node.getKind()) {
+        case ASTNodeKind::VarDeclaration:
+            return static_cast<const VarDeclarationNode&>(node).initializer.get();
+        case ASTNodeKind::Assignment:
+            return static_cast<const AssignmentNode&>(node).expression.get();
+        case ASTNodeKind::ReturnStatement:
+            return static_cast<const ReturnStatementNode&>(node).expression.get();
+        case ASTNodeKind::ExpressionStatement:
+            return static_cast<const ExpressionStatementNode&>(node).expression.get();
+        case ASTNodeKind::BinaryExpression: {
+            const auto& binary = static_cast<const BinaryExpressionNode&>(node);
+            return field == QueryField::Left ? binary.left.get() : binary.right.get();
+        }
+        case ASTNodeKind::UnaryExpression:
+            return static_cast<const UnaryExpressionNode&>(node).operand.get();
+        case ASTNodeKind::IfStatement: {
+            const auto& ifStmt = static_cast<const IfStatementNode&>(node);
+            if (field == QueryField::Cond) return ifStmt.condition.get();
+            return field == QueryField::Then ? ifStmt.thenStatement.get() : ifStmt.elseStatement.get();
+        }
+        case ASTNodeKind::WhileStatement: {
+            const auto& whileStmt = static_cast<const WhileStatementNode&>(node);
+            return field == QueryField::Cond ? whileStmt.condition.get() : whileStmt.body.get();
+        }
+        case ASTNodeKind::ForStatement: {
+            const auto& forStmt = static_cast<const ForStatementNode&>(node);
+            switch (field) {
+                case QueryField::Init: return forStmt.initialization.get();
+                case QueryField::Cond: return forStmt.condition.get();
+                case QueryField::Update: return forStmt.update.get();
+                default: return forStmt.body.get();
+            }
+        }
+        case ASTNodeKind::FunctionDefinition:
+            return static_cast<const FunctionDefinitionNode&>(node).body.get();
+        default:
+            return nullptr;
+    }
+}
+
+bool matchPattern(const ASTQuery::Pattern& pattern, const ASTNode& node);
+
+bool matchConstraint(const ASTQuery::Pattern::Constraint& constraint, const ASTNode& node) {
+    switch (constraint.field) {
+        case QueryField::Name:
+        case QueryField::Type:
+        case QueryField::Op:
+        case QueryField::Value:
+            return stringField(node, constraint.field) == constraint.text;
+        case QueryField::Args: {
+            const auto* list = listField(node);
+            return list && list->size() == constraint.number;
+        }
+        case QueryField::Has: {
+            bool found = false;
+            forEachChild(node, [&](const ASTNode& child) {
+                walkAST(child, [&](const ASTNode& descendant) {
+                    if (!found && matchPattern(*constraint.pattern, descendant)) {
+                        found = true;
+                    }
+                    return !found;
+                });
+            });
+            return found;
+        }
+        default: {
+            const ASTNode* child = childField(node, constraint.field, constraint.index);
+            if (constraint.none) {
+                return child == nullptr;
+            }
+            return child && matchPattern(*constraint.pattern, *child);
+        }
+    }
+}
+
+bool matchPattern(const ASTQuery::Pattern& pattern, const ASTNode& node) {
+    if (!pattern.any && node.getKind() != pattern.kind) {
+        return false;
+    }
+    if (pattern.assignment &&
+        !isAssignmentOperator(static_cast<const BinaryExpressionNode&>(node).operator_)) {
+        return false;
+    }
+    for (const auto& constraint : pattern.constraints) {
+        if (matchConstraint(constraint, node) == constraint.negate) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 取出匹配时必然出现的函数名：未被否定的 call/func/decl 的 name 约束
+void collectRequiredNames(const ASTQuery::Pattern& pattern, std::vector<std::string>& names) {
+    for (const auto& constraint : pattern.constraints) {
+        if (constraint.negate) {
+            continue;
+        }
+        if (constraint.field == QueryField::Name && !pattern.any &&
+            (pattern.kind == ASTNodeKind::FunctionCall || pattern.kind == ASTNodeKind::FunctionDefinition ||
+             pattern.kind == ASTNodeKind::FunctionDeclaration)) {
+            names.push_back(constraint.text);
+        }
+        if (constraint.pattern) {
+            collectRequiredNames(*constraint.pattern, names);
+        }
+    }
+}
+
+} // namespace
+
+// ASTQuery类实现
+ASTQuery::ASTQuery() = default;
+
+ASTQuery::~ASTQuery() = default;
+
+bool ASTQuery::compile(const std::string& text, std::string& error) {
+    root.reset();
+    requiredNames.clear();
+    error.clear();
+
+    std::vector<QueryToken> tokens;
+    if (!tokenizeQuery(text, tokens, error)) {
+        return false;
+    }
+    auto pattern = std::make_unique<Pattern>();
+    QueryParser parser(tokens, error);
+    if (!parser.parsePattern(*pattern)) {
+        return false;
+    }
+    if (!parser.atEnd()) {
+        error = "unexpected input after the pattern";
+        return false;
+    }
+
+    root = std::move(pattern);
+    collectRequiredNames(*root, requiredNames);
+    std::sort(requiredNames.begin(), requiredNames.end());
+    requiredNames.erase(std::unique(requiredNames.begin(), requiredNames.end()), requiredNames.end());
+    return true;
+}
+
+bool ASTQuery::matches(const ASTNode& node) const {
+    return root && matchPattern(*root, node);
+}
+
+std::vector<QueryMatch> ASTQuery::find(const ParsedUnit& unit) const {
+    std::vector<QueryMatch> matches;
+    if (!root || !unit.program) {
+        return matches;
+    }
+
+    // 主文件中的结果附上所在源码行，被包含文件中的结果附上节点描述
+    std::vector<size_t> lineStarts = {0};
+    for (size_t i = 0; i < unit.source.size(); i++) {
+        if (unit.source[i] == '\n') {
+            lineStarts.push_back(i + 1);
+        }
+    }
+    walkAST(*unit.program, [&](const ASTNode& current) {
+        if (!matchPattern(*root, current)) {
+            return true;
+        }
+        QueryMatch match;
+        match.file = unit.fileName(current.fileId);
+        match.line = current.line;
+        match.column = current.column;
+        bool assignment = current.getKind() == ASTNodeKind::BinaryExpression &&
+                          isAssignmentOperator(static_cast<const BinaryExpressionNode&>(current).operator_);
+        match.kind = assignment ? "assign" : kindName(current.getKind());
+        if (current.fileId == 0 && current.line >= 1 && static_cast<size_t>(current.line) <= lineStarts.size()) {
+            size_t begin = lineStarts[current.line - 1];
+            size_t end = unit.source.find('\n', begin);
+            std::string line = unit.source.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+            size_t first = line.find_first_not_of(" \t\r");
+            size_t last = line.find_last_not_of(" \t\r");
+            match.text = first == std::string::npos ? "" : line.substr(first, last - first + 1);
+        } else {
+            match.text = current.toString();
+        }
+        matches.push_back(std::move(match));
+        return true;
+    });
+    return matches;
+}
+
+std::vector<QueryMatch> ASTQuery::run(const std::vector<std::string>& files, const ProjectAnalyzer& frontEnd,
+                                      size_t threadCount, const SymbolIndex* index, QueryStats& stats) const {
+    stats = QueryStats();
+    stats.files = files.size();
+
+    // 索引仍然有效、但不含任一必需函数名的文件不可能匹配
+    std::vector<char> candidate(files.size(), 1);
+    if (index && index->isOpen() && !requiredNames.empty()) {
+        std::vector<std::string> current = index->currentUnits();
+        std::unordered_set<std::string> upToDate(current.begin(), current.end());
+        std::vector<std::unordered_set<std::string>> referencing;
+        for (const auto& name : requiredNames) {
+            std::vector<std::string> units = index->unitsReferencing(name);
+            referencing.emplace_back(units.begin(), units.end());
+        }
+        for (size_t i = 0; i < files.size(); i++) {
+            std::string path = std::filesystem::absolute(files[i]).lexically_normal().string();
+            if (!upToDate.count(path)) {
+                continue;
+            }
+            for (const auto& units : referencing) {
+                if (!units.count(path)) {
+                    candidate[i] = 0;
+                    stats.skipped++;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<QueryMatch>> perFile(files.size());
+    ThreadPool pool(std::min(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount,
+                             std::max<size_t>(1, files.size())));
+    pool.parallelFor(files.size(), [&](size_t i) {
+        if (!candidate[i]) {
+            return;
+        }
+        ParsedUnit unit;
+        if (frontEnd.parseUnit(files[i], unit)) {
+            perFile[i] = find(unit);
+        }
+    });
+
+    std::vector<QueryMatch> matches;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (candidate[i]) {
+            stats.parsed++;
+        }
+        for (auto& match : perFile[i]) {
+            matches.push_back(std::move(match));
+        }
+    }
+    stats.matches = matches.size();
+    return matches;
+}
+
+const std::vector<std::string>& ASTQuery::getRequiredNames() const {
+    return requiredNames;
+}
+
+const char* ASTQuery::kindName(ASTNodeKind kind) {
+    for (const auto& info : KINDS) {
+        if (info.kind == kind && !info.assignment) {
+            return info.name;
+        }
+    }
+    return "node";
+}
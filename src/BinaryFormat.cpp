@@ -0,0 +1,131 @@
+#include "../include/BinaryFormat.h"
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <vector>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// BinaryWriter类实现
+BinaryWriter::BinaryWriter(size_t headerSize) : buffer(headerSize, '\0') {}
+
+StringRef BinaryWriter::addString(const std::string& str) {
+    auto it = stringIndex.find(str);
+    if (it != stringIndex.end()) {
+        return it->second;
+    }
+    StringRef ref{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(str.size())};
+    strings += str;
+    stringIndex.emplace(str, ref);
+    return ref;
+}
+
+SectionInfo BinaryWriter::addStringTable() {
+    align();
+    SectionInfo info{buffer.size(), strings.size()};
+    buffer += strings;
+    return info;
+}
+
+void BinaryWriter::setHeader(const void* header, size_t size) {
+    std::memcpy(&buffer[0], header, size);
+}
+
+bool BinaryWriter::writeAtomically(const std::string& path) const {
+    return writeFileAtomically(path, buffer.data(), buffer.size());
+}
+
+bool BinaryWriter::writeFileAtomically(const std::string& path, const char* data, size_t size) {
+    // 新文件的权限：与直接创建文件相同，0666去掉umask（umask只能读一次并恢复，在第一次调用时读取）
+    static const mode_t newFileMode = [] {
+        mode_t mask = ::umask(0);
+        ::umask(mask);
+        return static_cast<mode_t>(0666 & ~mask);
+    }();
+
+    // 临时文件由mkstemp在目标目录中创建，名字唯一（跨进程也不冲突），改名不跨文件系统
+    std::vector<char> temp(path.begin(), path.end());
+    const char suffix[] = ".tmpXXXXXX";
+    temp.insert(temp.end(), suffix, suffix + sizeof(suffix));
+    int fd = ::mkstemp(temp.data());
+    if (fd < 0) {
+        return false;
+    }
+    auto fail = [&]() {
+        ::close(fd);
+        ::unlink(temp.data());
+        return false;
+    };
+
+    // 保留原文件的权限位，原文件不存在时按新建文件处理
+    struct stat original;
+    mode_t mode = ::stat(path.c_str(), &original) == 0 ? (original.st_mode & 07777) : newFileMode;
+    if (::fchmod(fd, mode) != 0) {
+        return fail();
+    }
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return fail();
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    // 改名前把内容落盘，断电后不会留下空的或写了一半的目标文件
+    if (::fsync(fd) != 0) {
+        return fail();
+    }
+    if (::close(fd) != 0) {
+        ::unlink(temp.data());
+        return false;
+    }
+    if (std::rename(temp.data(), path.c_str()) != 0) {
+        ::unlink(temp.data());
+        return false;
+    }
+
+    // 目录项也落盘，改名本身才持久；失败不影响已完成的替换
+    std::string::size_type slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int dirFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+
+size_t BinaryWriter::size() const {
+    return buffer.size();
+}
+
+void BinaryWriter::align() {
+    while (buffer.size() % 8 != 0) {
+        buffer += '\0';
+    }
+}
+
+// BinaryReader类实现
+BinaryReader::BinaryReader(const char* data, size_t size)
+    : data(data), size(size), stringTable{0, 0} {}
+
+void BinaryReader::setStringTable(const SectionInfo& table) {
+    stringTable = table;
+}
+
+bool BinaryReader::checkString(const StringRef& ref) const {
+    return stringTable.offset <= size && stringTable.count <= size - stringTable.offset &&
+           static_cast<uint64_t>(ref.offset) + ref.length <= stringTable.count;
+}
+
+std::string BinaryReader::getString(const StringRef& ref) const {
+    return std::string(stringData(ref), ref.length);
+}
+
+const char* BinaryReader::stringData(const StringRef& ref) const {
+    return data + stringTable.offset + ref.offset;
+}
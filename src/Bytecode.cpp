@@ -0,0 +1,146 @@
+#include "../include/Bytecode.h"
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+struct OpcodeInfo {
+    const char* name;
+    OperandKind operands[3];
+};
+
+const OpcodeInfo OPCODE_INFO[] = {
+#define BYTECODE_OPCODE_INFO(name, a, b, c) {#name, {OperandKind::a, OperandKind::b, OperandKind::c}},
+    BYTECODE_OPCODES(BYTECODE_OPCODE_INFO)
+#undef BYTECODE_OPCODE_INFO
+};
+
+static_assert(sizeof(OPCODE_INFO) / sizeof(OPCODE_INFO[0]) == OPCODE_COUNT, "opcode table out of sync");
+
+void printOperand(std::ostream& os, OperandKind kind, int32_t value, const BytecodeModule& module) {
+    switch (kind) {
+        case OperandKind::Register:
+            os << "r" << value;
+            break;
+        case OperandKind::Immediate:
+            os << value;
+            break;
+        case OperandKind::Target:
+            os << "@" << value;
+            break;
+        case OperandKind::Function:
+            os << (value >= 0 && static_cast<size_t>(value) < module.functions.size()
+                       ? module.functions[value].name : "?");
+            break;
+        case OperandKind::Global:
+            os << "g" << value;
+            break;
+        case OperandKind::Format:
+            os << "fmt" << value;
+            break;
+        case OperandKind::Loop:
+            os << "loop" << value;
+            break;
+        case OperandKind::None:
+            break;
+    }
+}
+
+std::string escape(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        switch (c) {
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            default: result += c; break;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+const char* opcodeName(Opcode op) {
+    return OPCODE_INFO[static_cast<size_t>(op)].name;
+}
+
+OperandKind operandKind(Opcode op, int slot) {
+    return OPCODE_INFO[static_cast<size_t>(op)].operands[slot];
+}
+
+const char* valueTypeName(ValueType type) {
+    switch (type) {
+        case ValueType::Void: return "void";
+        case ValueType::Int: return "int";
+        case ValueType::Float: return "float";
+        case ValueType::IntArray: return "int[]";
+        case ValueType::FloatArray: return "float[]";
+    }
+    return "?";
+}
+
+// BytecodeModule实现
+int BytecodeModule::findFunction(const std::string& name) const {
+    for (size_t i = 0; i < functions.size(); i++) {
+        if (functions[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void BytecodeModule::disassemble(std::ostream& os) const {
+    for (size_t i = 0; i < formats.size(); i++) {
+        os << "fmt" << i << ": \"" << escape(formats[i].source) << "\"\n";
+    }
+    for (const auto& array : globalArrays) {
+        os << "g" << array.first << ": array[" << array.second << "]\n";
+    }
+    for (const auto& function : functions) {
+        os << "\n" << valueTypeName(function.returnType) << " " << function.name << "(";
+        for (size_t i = 0; i < function.parameterTypes.size(); i++) {
+            os << (i > 0 ? ", " : "") << valueTypeName(function.parameterTypes[i]) << " r" << i;
+        }
+        os << ")  registers=" << function.registerCount << " frame=" << function.frameSize << "\n";
+        for (size_t i = 0; i < function.constants.size(); i++) {
+            os << "    r" << function.firstConstant() + i << " = ";
+            if (function.constantTypes[i] == ValueType::Float) {
+                os << function.constants[i].f;
+            } else {
+                os << function.constants[i].i;
+            }
+            os << "\n";
+        }
+        for (size_t i = 0; i < function.parallelLoops.size(); i++) {
+            const ParallelLoop& loop = function.parallelLoops[i];
+            os << "    loop" << i << ": body=" << functions[loop.body].name << " upper=r" << loop.upper
+               << (loop.inclusive ? " inclusive" : "");
+            for (size_t j = 0; j < loop.captures.size(); j++) {
+                os << (j == 0 ? " captures=" : ",") << "r" << loop.captures[j];
+            }
+            for (size_t j = 0; j < loop.reductions.size(); j++) {
+                os << (j == 0 ? " reductions=" : ",") << "r" << loop.reductions[j];
+            }
+            os << "\n";
+        }
+        for (size_t pc = 0; pc < function.code.size(); pc++) {
+            const Instruction& instruction = function.code[pc];
+            std::ostringstream operandText;
+            const int32_t operands[3] = {instruction.a, instruction.b, instruction.c};
+            bool first = true;
+            for (int slot = 0; slot < 3; slot++) {
+                OperandKind kind = operandKind(instruction.op, slot);
+                if (kind == OperandKind::None) {
+                    continue;
+                }
+                operandText << (first ? "" : ", ");
+                printOperand(operandText, kind, operands[slot], *this);
+                first = false;
+            }
+            os << std::setw(6) << pc << "  " << std::left << std::setw(12) << opcodeName(instruction.op) << " "
+               << std::setw(20) << operandText.str() << std::right << " ; line " << function.lines[pc] << "\n";
+        }
+    }
+}
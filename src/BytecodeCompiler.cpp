@@ -0,0 +1,1372 @@
+#include "../include/BytecodeCompiler.h"
+#include "../include/IntervalAnalyzer.h"
+#include "../include/DependenceAnalyzer.h"
+#include "../include/LoopOptimizer.h"
+#include "../include/ASTWalker.h"
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <sstream>
+#include <cerrno>
+#include <cstdlib>
+#include <climits>
+
+namespace {
+
+/**
+ * 编译错误：在当前函数内抛出，由模块编译器记录后继续编译下一个函数
+ */
+struct CompileError {
+    std::string message;
+    int line;
+    int column;
+};
+
+[[noreturn]] void fail(const ASTNode& node, const std::string& message) {
+    throw CompileError{message, node.line, node.column};
+}
+
+bool isArray(ValueType type) {
+    return type == ValueType::IntArray || type == ValueType::FloatArray;
+}
+
+ValueType scalarType(const std::string& type) {
+    return type == "float" ? ValueType::Float : type == "void" ? ValueType::Void : ValueType::Int;
+}
+
+ValueType arrayType(const std::string& type) {
+    return type == "float" ? ValueType::FloatArray : ValueType::IntArray;
+}
+
+ValueType elementType(ValueType array) {
+    return array == ValueType::FloatArray ? ValueType::Float : ValueType::Int;
+}
+
+bool parseInteger(const std::string& text, int64_t& value) {
+    errno = 0;
+    char* end = nullptr;
+    long long parsed = std::strtoll(text.c_str(), &end, 10);
+    value = parsed;
+    return errno == 0 && end && *end == '\0';
+}
+
+// 把printf格式串切分为文本与转换说明；不支持的转换说明返回false
+bool parseFormat(const std::string& text, FormatString& format, std::string& problem) {
+    format.source = text;
+    FormatPiece piece;
+    size_t i = 0;
+    while (i < text.size()) {
+        if (text[i] != '%') {
+            piece.text += text[i++];
+            continue;
+        }
+        if (i + 1 < text.size() && text[i + 1] == '%') {
+            piece.text += '%';
+            i += 2;
+            continue;
+        }
+        std::string spec = "%";
+        i++;
+        while (i < text.size() && std::string("-+ #0").find(text[i]) != std::string::npos) {
+            spec += text[i++];
+        }
+        while (i < text.size() && (std::isdigit(static_cast<unsigned char>(text[i])) || text[i] == '.')) {
+            spec += text[i++];
+        }
+        while (i < text.size() && std::string("hlLqjzt").find(text[i]) != std::string::npos) {
+            i++;  // 长度修饰按实参的静态类型重新给出
+        }
+        if (i == text.size()) {
+            problem = "incomplete conversion at the end of the printf format";
+            return false;
+        }
+        char conversion = text[i++];
+        if (std::string("diuxXo").find(conversion) != std::string::npos) {
+            piece.conversion = spec + "ll" + conversion;
+        } else if (conversion == 'c') {
+            piece.conversion = spec + conversion;
+        } else if (std::string("fFeEgGaA").find(conversion) != std::string::npos) {
+            piece.conversion = spec + conversion;
+            piece.isFloat = true;
+        } else {
+            problem = std::string("unsupported printf conversion '%") + conversion + "'";
+            return false;
+        }
+        format.pieces.push_back(std::move(piece));
+        format.argumentCount++;
+        piece = FormatPiece();
+    }
+    if (!piece.text.empty()) {
+        format.pieces.push_back(std::move(piece));
+    }
+    return true;
+}
+
+/**
+ * 名字解析的结果
+ */
+struct Variable {
+    ValueType type = ValueType::Int;
+    int32_t reg = -1;      // 局部变量或形参的寄存器；全局变量为-1
+    int32_t global = -1;   // 全局变量的槽位（数组为长度槽位）
+    int64_t length = 0;    // 数组长度，0表示编译时未知
+};
+
+struct FunctionSignature {
+    int index = -1;
+    ValueType returnType = ValueType::Int;
+    std::vector<ValueType> parameters;
+    std::vector<int64_t> lengths;  // 数组形参写明的长度
+    const FunctionDefinitionNode* definition = nullptr;
+    const ASTNode* firstCall = nullptr;
+};
+
+struct Operand {
+    int32_t reg;
+    ValueType type;
+};
+
+/**
+ * 跳转标签：绑定之前的引用先记下，绑定时回填
+ */
+struct Label {
+    int32_t position = -1;
+    std::vector<std::pair<size_t, int>> pending;  // 指令下标与操作数位置
+};
+
+/**
+ * 整个程序共享的编译状态
+ */
+struct ModuleState {
+    BytecodeModule& module;
+    const std::vector<Token>& tokens;
+    const BytecodeCompileOptions& options;
+    BytecodeCompileStats& stats;
+    std::unordered_map<std::string, Variable> globals;
+    std::unordered_map<std::string, FunctionSignature> functions;
+    std::deque<BytecodeFunction> outlined;  // 并行循环的循环体函数，编译结束后追加到函数表
+};
+
+/**
+ * 单个函数的编译
+ */
+class FunctionCompiler {
+private:
+    ModuleState& state;
+    BytecodeFunction& function;
+    std::vector<std::unordered_map<std::string, Variable>> scopes;
+    std::unordered_map<std::string, int32_t> constantRegisters;  // 类型前缀加字面量文本
+    int32_t nextRegister = 0;
+    int32_t localTop = 0;       // 存活的局部变量之上的第一个寄存器
+    int32_t maxRegister = 0;
+    int32_t arrayOffset = 0;    // 数组区内的下一个偏移
+    std::vector<size_t> arrayInstructions;
+    std::unordered_set<std::string> shadowed;  // 声明时遮蔽了外层同名变量的名字
+    int line = 0;
+    bool outlining = false;  // 正在编译并行循环的循环体函数
+
+    /**
+     * 一次数组访问，函数编译完后决定是否去掉下标检查
+     */
+    struct Access {
+        BytecodeFunction* function;  // 所在的函数（本函数或其并行循环的循环体函数）
+        size_t instruction;
+        const IndexExpressionNode* node;
+        int64_t length;
+    };
+    std::vector<Access> accesses;
+
+    struct Loop {
+        Label* breakLabel;
+        Label* continueLabel;
+    };
+    std::vector<Loop> loops;
+
+    size_t emit(Opcode op, int32_t a = 0, int32_t b = 0, int32_t c = 0) {
+        Instruction instruction;
+        instruction.op = op;
+        instruction.a = a;
+        instruction.b = b;
+        instruction.c = c;
+        function.code.push_back(instruction);
+        function.lines.push_back(line);
+        return function.code.size() - 1;
+    }
+
+    static void setOperand(Instruction& instruction, int slot, int32_t value) {
+        (slot == 0 ? instruction.a : slot == 1 ? instruction.b : instruction.c) = value;
+    }
+
+    void jumpTo(Label& label, size_t instruction, int slot) {
+        if (label.position >= 0) {
+            setOperand(function.code[instruction], slot, label.position);
+        } else {
+            label.pending.emplace_back(instruction, slot);
+        }
+    }
+
+    void bind(Label& label) {
+        label.position = static_cast<int32_t>(function.code.size());
+        for (const auto& use : label.pending) {
+            setOperand(function.code[use.first], use.second, label.position);
+        }
+        label.pending.clear();
+    }
+
+    int32_t temp() {
+        int32_t reg = nextRegister++;
+        maxRegister = std::max(maxRegister, nextRegister);
+        return reg;
+    }
+
+    int32_t destination(int32_t target) {
+        return target >= 0 ? target : temp();
+    }
+
+    // 字面量所在的常量寄存器；在编译函数体之前由collectConstants分配
+    int32_t constantRegister(const LiteralNode& literal) {
+        std::string key = (literal.type == TokenType::FLOAT ? "f" : "i") + literal.value;
+        auto it = constantRegisters.find(key);
+        if (it != constantRegisters.end()) {
+            return it->second;
+        }
+        Value value;
+        if (literal.type == TokenType::FLOAT) {
+            value.f = std::strtod(literal.value.c_str(), nullptr);
+        } else if (!parseInteger(literal.value, value.i)) {
+            fail(literal, "integer literal '" + literal.value + "' is out of range");
+        }
+        int32_t reg = static_cast<int32_t>(function.firstConstant() + function.constants.size());
+        function.constants.push_back(value);
+        function.constantTypes.push_back(literal.type == TokenType::FLOAT ? ValueType::Float : ValueType::Int);
+        constantRegisters.emplace(key, reg);
+        return reg;
+    }
+
+    void collectConstants(const ASTNode& node) {
+        walkAST(node, [this](const ASTNode& current) {
+            if (current.getKind() == ASTNodeKind::Literal) {
+                const auto& literal = static_cast<const LiteralNode&>(current);
+                if (literal.type == TokenType::INTEGER || literal.type == TokenType::FLOAT) {
+                    constantRegister(literal);
+                }
+            }
+            return true;
+        });
+    }
+
+    const Variable* lookup(const std::string& name) const {
+        for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+            auto found = it->find(name);
+            if (found != it->end()) {
+                return &found->second;
+            }
+        }
+        auto global = state.globals.find(name);
+        return global != state.globals.end() ? &global->second : nullptr;
+    }
+
+    const Variable& resolve(const ASTNode& node, const std::string& name) {
+        const Variable* variable = lookup(name);
+        if (!variable) {
+            fail(node, "use of undeclared identifier '" + name + "'");
+        }
+        return *variable;
+    }
+
+    int32_t declare(const ASTNode& node, const std::string& name, ValueType type, int64_t length) {
+        if (scopes.back().count(name)) {
+            fail(node, "redeclaration of '" + name + "'");
+        }
+        if (lookup(name)) {
+            shadowed.insert(name);
+        }
+        Variable variable;
+        variable.type = type;
+        variable.reg = temp();
+        variable.length = length;
+        localTop = nextRegister;
+        scopes.back().emplace(name, variable);
+        return variable.reg;
+    }
+
+    void pushScope() {
+        scopes.emplace_back();
+    }
+
+    void popScope(int32_t savedTop) {
+        scopes.pop_back();
+        localTop = savedTop;
+        nextRegister = savedTop;
+    }
+
+    // 静态类型；不生成代码
+    ValueType typeOf(const ASTNode* node) {
+        if (!node) {
+            return ValueType::Void;
+        }
+        switch (node->getKind()) {
+            case ASTNodeKind::Literal:
+                return static_cast<const LiteralNode*>(node)->type == TokenType::FLOAT ? ValueType::Float
+                                                                                      : ValueType::Int;
+            case ASTNodeKind::Identifier: {
+                std::string name = static_cast<const IdentifierNode*>(node)->name;
+                std::string variable;
+                int delta;
+                bool prefix;
+                if (splitIncrement(name, variable, delta, prefix)) {
+                    name = variable;
+                }
+                return resolve(*node, name).type;
+            }
+            case ASTNodeKind::UnaryExpression: {
+                const auto* unary = static_cast<const UnaryExpressionNode*>(node);
+                return unary->operator_ == "!" ? ValueType::Int : typeOf(unary->operand.get());
+            }
+            case ASTNodeKind::BinaryExpression: {
+                const auto* binary = static_cast<const BinaryExpressionNode*>(node);
+                const std::string& op = binary->operator_;
+                if (op == "=") {
+                    return typeOf(binary->left.get());
+                }
+                if (op == "&&" || op == "||" || isComparison(op)) {
+                    return ValueType::Int;
+                }
+                ValueType left = typeOf(binary->left.get());
+                ValueType right = typeOf(binary->right.get());
+                return left == ValueType::Float || right == ValueType::Float ? ValueType::Float : ValueType::Int;
+            }
+            case ASTNodeKind::Assignment:
+                return resolve(*node, static_cast<const AssignmentNode*>(node)->identifier).type;
+            case ASTNodeKind::FunctionCall: {
+                const std::string& name = static_cast<const FunctionCallNode*>(node)->name;
+                auto it = state.functions.find(name);
+                return name == "printf" || it == state.functions.end() ? ValueType::Int : it->second.returnType;
+            }
+            case ASTNodeKind::IndexExpression: {
+                const auto* index = static_cast<const IndexExpressionNode*>(node);
+                return elementType(typeOf(index->array.get()));
+            }
+            default:
+                return ValueType::Int;
+        }
+    }
+
+    Operand requireScalar(const ASTNode& node, Operand operand) {
+        if (operand.type == ValueType::Void) {
+            fail(node, "void value used in an expression");
+        }
+        if (isArray(operand.type)) {
+            fail(node, "array used where a number is expected");
+        }
+        return operand;
+    }
+
+    // 把标量转换为type；类型相同且不要求目标寄存器时不生成代码
+    Operand convert(const ASTNode& node, Operand operand, ValueType type, int32_t target = -1) {
+        requireScalar(node, operand);
+        if (operand.type == type) {
+            if (target >= 0 && target != operand.reg) {
+                emit(Opcode::MOVE, target, operand.reg);
+                return {target, type};
+            }
+            return operand;
+        }
+        int32_t dst = destination(target);
+        emit(type == ValueType::Float ? Opcode::I2F : Opcode::F2I, dst, operand.reg);
+        return {dst, type};
+    }
+
+    // 求值并把结果以type类型放入target（target为-1时任选寄存器）
+    Operand expressionAs(const ASTNode* node, ValueType type, int32_t target = -1) {
+        if (isArray(type)) {
+            Operand operand = expression(node, target);
+            if (operand.type != type) {
+                fail(*node, std::string("expected an array of type ") + valueTypeName(type));
+            }
+            return operand;
+        }
+        if (typeOf(node) == type) {
+            return requireScalar(*node, expression(node, target));
+        }
+        return convert(*node, expression(node), type, target);
+    }
+
+    Operand expression(const ASTNode* node, int32_t target = -1) {
+        if (!node) {
+            throw CompileError{"missing expression", line, 0};
+        }
+        switch (node->getKind()) {
+            case ASTNodeKind::Literal: {
+                const auto* literal = static_cast<const LiteralNode*>(node);
+                if (literal->type == TokenType::STRING) {
+                    fail(*node, "string literals are only supported as the printf format");
+                }
+                if (literal->type != TokenType::INTEGER && literal->type != TokenType::FLOAT) {
+                    fail(*node, "invalid expression");
+                }
+                Operand constant{constantRegister(*literal), typeOf(node)};
+                if (target >= 0) {
+                    emit(Opcode::MOVE, target, constant.reg);
+                    return {target, constant.type};
+                }
+                return constant;
+            }
+            case ASTNodeKind::Identifier:
+                return identifier(static_cast<const IdentifierNode&>(*node), target, true);
+            case ASTNodeKind::UnaryExpression:
+                return unary(static_cast<const UnaryExpressionNode&>(*node), target);
+            case ASTNodeKind::BinaryExpression:
+                return binary(static_cast<const BinaryExpressionNode&>(*node), target);
+            case ASTNodeKind::Assignment: {
+                const auto& assignment = static_cast<const AssignmentNode&>(*node);
+                return assign(*node, assignment.identifier, assignment.expression.get(), target);
+            }
+            case ASTNodeKind::FunctionCall:
+                return call(static_cast<const FunctionCallNode&>(*node), target);
+            case ASTNodeKind::IndexExpression:
+                return loadElement(static_cast<const IndexExpressionNode&>(*node), target);
+            default:
+                fail(*node, "statement used as an expression");
+        }
+    }
+
+    Operand identifier(const IdentifierNode& node, int32_t target, bool needValue) {
+        std::string name;
+        int delta;
+        bool prefix;
+        if (splitIncrement(node.name, name, delta, prefix)) {
+            return increment(node, name, delta, prefix, target, needValue);
+        }
+        const Variable& variable = resolve(node, node.name);
+        if (variable.reg >= 0) {
+            if (target >= 0 && target != variable.reg) {
+                emit(Opcode::MOVE, target, variable.reg);
+                return {target, variable.type};
+            }
+            return {variable.reg, variable.type};
+        }
+        int32_t dst = destination(target);
+        emit(isArray(variable.type) ? Opcode::GARRAY : Opcode::GLOAD, dst, variable.global);
+        return {dst, variable.type};
+    }
+
+    Operand increment(const ASTNode& node, const std::string& name, int delta, bool prefix, int32_t target,
+                      bool needValue) {
+        const Variable& variable = resolve(node, name);
+        if (isArray(variable.type)) {
+            fail(node, "cannot increment array '" + name + "'");
+        }
+        int32_t reg = variable.reg;
+        if (reg < 0) {
+            reg = temp();
+            emit(Opcode::GLOAD, reg, variable.global);
+        }
+        Operand old{reg, variable.type};
+        if (needValue && !prefix) {
+            old = {destination(target), variable.type};
+            emit(Opcode::MOVE, old.reg, reg);
+        }
+        if (variable.type == ValueType::Float) {
+            int32_t one = temp();
+            emit(Opcode::LOADI, one, delta);
+            emit(Opcode::I2F, one, one);
+            emit(Opcode::FADD, reg, reg, one);
+        } else {
+            emit(Opcode::ADDK, reg, reg, delta);
+        }
+        if (variable.reg < 0) {
+            emit(Opcode::GSTORE, variable.global, reg);
+        }
+        if (!needValue || !prefix) {
+            return old;
+        }
+        if (target >= 0 && target != reg) {
+            emit(Opcode::MOVE, target, reg);
+            return {target, variable.type};
+        }
+        return {reg, variable.type};
+    }
+
+    Operand unary(const UnaryExpressionNode& node, int32_t target) {
+        Operand operand = requireScalar(node, expression(node.operand.get()));
+        int32_t dst = destination(target);
+        if (node.operator_ == "-") {
+            emit(operand.type == ValueType::Float ? Opcode::FNEG : Opcode::NEG, dst, operand.reg);
+            return {dst, operand.type};
+        }
+        if (operand.type == ValueType::Float) {
+            int32_t zero = temp();
+            emit(Opcode::LOADI, zero, 0);
+            emit(Opcode::FEQ, dst, operand.reg, zero);  // 0.0 与整数0的位模式相同
+        } else {
+            emit(Opcode::NOT, dst, operand.reg);
+        }
+        return {dst, ValueType::Int};
+    }
+
+    Operand binary(const BinaryExpressionNode& node, int32_t target) {
+        const std::string& op = node.operator_;
+        if (op == "=") {
+            if (node.left && node.left->getKind() == ASTNodeKind::IndexExpression) {
+                return storeElement(static_cast<const IndexExpressionNode&>(*node.left), node.right.get(), target);
+            }
+            if (!node.left || node.left->getKind() != ASTNodeKind::Identifier) {
+                fail(node, "left side of '=' is not assignable");
+            }
+            return assign(*node.left, static_cast<const IdentifierNode&>(*node.left).name, node.right.get(), target);
+        }
+        if (op == "&&" || op == "||" || isComparison(op)) {
+            if (isComparison(op) && typeOf(node.left.get()) != ValueType::Float &&
+                typeOf(node.right.get()) != ValueType::Float) {
+                Operand left = requireScalar(*node.left, expression(node.left.get()));
+                Operand right = requireScalar(*node.right, expression(node.right.get()));
+                int32_t dst = destination(target);
+                bool swap = op == ">" || op == ">=";
+                Opcode code = op == "<" || op == ">" ? Opcode::LT : op == "<=" || op == ">=" ? Opcode::LE
+                              : op == "==" ? Opcode::EQ : Opcode::NE;
+                emit(code, dst, swap ? right.reg : left.reg, swap ? left.reg : right.reg);
+                return {dst, ValueType::Int};
+            }
+            // 逻辑运算与浮点比较：按条件跳转求值，目标寄存器只在条件求值完后写入
+            Label isFalse;
+            Label done;
+            branch(&node, false, isFalse);
+            int32_t dst = destination(target);
+            emit(Opcode::LOADI, dst, 1);
+            jumpTo(done, emit(Opcode::JMP), 0);
+            bind(isFalse);
+            emit(Opcode::LOADI, dst, 0);
+            bind(done);
+            return {dst, ValueType::Int};
+        }
+
+        ValueType type = typeOf(&node);
+        if (op == "%" && type == ValueType::Float) {
+            fail(node, "operands of '%' must be integers");
+        }
+        Operand left = expressionAs(node.left.get(), type);
+        Operand right = expressionAs(node.right.get(), type);
+        int32_t dst = destination(target);
+        bool isFloat = type == ValueType::Float;
+        Opcode code;
+        if (op == "+") {
+            code = isFloat ? Opcode::FADD : Opcode::ADD;
+        } else if (op == "-") {
+            code = isFloat ? Opcode::FSUB : Opcode::SUB;
+        } else if (op == "*") {
+            code = isFloat ? Opcode::FMUL : Opcode::MUL;
+        } else if (op == "/") {
+            code = isFloat ? Opcode::FDIV : Opcode::DIV;
+        } else if (op == "%") {
+            code = Opcode::MOD;
+        } else {
+            fail(node, "unsupported operator '" + op + "'");
+        }
+        emit(code, dst, left.reg, right.reg);
+        return {dst, type};
+    }
+
+    Operand assign(const ASTNode& node, const std::string& name, const ASTNode* value, int32_t target) {
+        std::string variableName;
+        int delta;
+        bool prefix;
+        if (splitIncrement(name, variableName, delta, prefix)) {
+            fail(node, "left side of '=' is not assignable");
+        }
+        const Variable& variable = resolve(node, name);
+        if (isArray(variable.type)) {
+            fail(node, "cannot assign to array '" + name + "'");
+        }
+        if (variable.reg >= 0) {
+            Operand result = expressionAs(value, variable.type, variable.reg);
+            if (target >= 0 && target != result.reg) {
+                emit(Opcode::MOVE, target, result.reg);
+                return {target, variable.type};
+            }
+            return result;
+        }
+        Operand result = expressionAs(value, variable.type, target);
+        emit(Opcode::GSTORE, variable.global, result.reg);
+        return result;
+    }
+
+    // 数组与下标；数组的长度编译时未知时length为0
+    Operand arrayOperand(const IndexExpressionNode& node, int64_t& length) {
+        if (!node.array || node.array->getKind() != ASTNodeKind::Identifier) {
+            fail(node, "subscripted value is not an array");
+        }
+        const auto& name = static_cast<const IdentifierNode&>(*node.array);
+        const Variable& variable = resolve(name, name.name);
+        if (!isArray(variable.type)) {
+            fail(node, "subscripted value '" + name.name + "' is not an array");
+        }
+        length = variable.length;
+        return identifier(name, -1, true);
+    }
+
+    Operand indexOperand(const IndexExpressionNode& node) {
+        Operand index = requireScalar(*node.index, expression(node.index.get()));
+        if (index.type != ValueType::Int) {
+            fail(*node.index, "array index must be an integer");
+        }
+        return index;
+    }
+
+    Operand loadElement(const IndexExpressionNode& node, int32_t target) {
+        int64_t length;
+        Operand array = arrayOperand(node, length);
+        Operand index = indexOperand(node);
+        int32_t dst = destination(target);
+        accesses.push_back({&function, emit(Opcode::LOADELEM, dst, array.reg, index.reg), &node, length});
+        return {dst, elementType(array.type)};
+    }
+
+    Operand storeElement(const IndexExpressionNode& node, const ASTNode* value, int32_t target) {
+        int64_t length;
+        Operand array = arrayOperand(node, length);
+        Operand index = indexOperand(node);
+        Operand result = expressionAs(value, elementType(array.type), target);
+        accesses.push_back({&function, emit(Opcode::STOREELEM, array.reg, index.reg, result.reg), &node, length});
+        return result;
+    }
+
+    Operand call(const FunctionCallNode& node, int32_t target) {
+        if (node.name == "printf") {
+            return callPrintf(node, target);
+        }
+        auto it = state.functions.find(node.name);
+        if (it == state.functions.end()) {
+            fail(node, "call to undeclared function '" + node.name + "'");
+        }
+        FunctionSignature& signature = it->second;
+        if (node.arguments.size() != signature.parameters.size()) {
+            fail(node, "function '" + node.name + "' expects " + std::to_string(signature.parameters.size()) +
+                           " argument(s), got " + std::to_string(node.arguments.size()));
+        }
+        if (!signature.firstCall) {
+            signature.firstCall = &node;
+        }
+        int32_t base = nextRegister;
+        for (size_t i = 0; i < node.arguments.size(); i++) {
+            temp();
+        }
+        for (size_t i = 0; i < node.arguments.size(); i++) {
+            expressionAs(node.arguments[i].get(), signature.parameters[i], base + static_cast<int32_t>(i));
+        }
+        int32_t dst = destination(target);
+        emit(Opcode::CALL, dst, signature.index, base);
+        return {dst, signature.returnType};
+    }
+
+    Operand callPrintf(const FunctionCallNode& node, int32_t target) {
+        if (node.arguments.empty() || node.arguments[0]->getKind() != ASTNodeKind::Literal ||
+            static_cast<const LiteralNode&>(*node.arguments[0]).type != TokenType::STRING) {
+            fail(node, "the first argument of printf must be a string literal");
+        }
+        FormatString format;
+        std::string problem;
+        if (!parseFormat(static_cast<const LiteralNode&>(*node.arguments[0]).value, format, problem)) {
+            fail(*node.arguments[0], problem);
+        }
+        if (format.argumentCount != node.arguments.size() - 1) {
+            fail(node, "printf format expects " + std::to_string(format.argumentCount) + " argument(s), got " +
+                           std::to_string(node.arguments.size() - 1));
+        }
+        int32_t base = nextRegister;
+        for (size_t i = 0; i < format.argumentCount; i++) {
+            temp();
+        }
+        size_t argument = 0;
+        for (const auto& piece : format.pieces) {
+            if (!piece.conversion.empty()) {
+                expressionAs(node.arguments[argument + 1].get(), piece.isFloat ? ValueType::Float : ValueType::Int,
+                             base + static_cast<int32_t>(argument));
+                argument++;
+            }
+        }
+        int32_t index = static_cast<int32_t>(state.module.formats.size());
+        state.module.formats.push_back(std::move(format));
+        int32_t dst = destination(target);
+        emit(Opcode::PRINTF, dst, index, base);
+        return {dst, ValueType::Int};
+    }
+
+    // 条件为when时跳到label，否则顺序执行
+    void branch(const ASTNode* condition, bool when, Label& label) {
+        if (!condition) {
+            if (when) {
+                jumpTo(label, emit(Opcode::JMP), 0);
+            }
+            return;
+        }
+        if (condition->getKind() == ASTNodeKind::UnaryExpression &&
+            static_cast<const UnaryExpressionNode*>(condition)->operator_ == "!") {
+            branch(static_cast<const UnaryExpressionNode*>(condition)->operand.get(), !when, label);
+            return;
+        }
+        if (condition->getKind() == ASTNodeKind::Literal &&
+            static_cast<const LiteralNode*>(condition)->type == TokenType::INTEGER) {
+            int64_t value = 0;
+            parseInteger(static_cast<const LiteralNode*>(condition)->value, value);
+            if ((value != 0) == when) {
+                jumpTo(label, emit(Opcode::JMP), 0);
+            }
+            return;
+        }
+        if (condition->getKind() == ASTNodeKind::BinaryExpression) {
+            const auto& binary = static_cast<const BinaryExpressionNode&>(*condition);
+            const std::string& op = binary.operator_;
+            if (op == "&&" || op == "||") {
+                if ((op == "&&") != when) {
+                    // a && b 不成立或 a || b 成立：任一边即可决定
+                    branch(binary.left.get(), when, label);
+                    branch(binary.right.get(), when, label);
+                } else {
+                    Label skip;
+                    branch(binary.left.get(), !when, skip);
+                    branch(binary.right.get(), when, label);
+                    bind(skip);
+                }
+                return;
+            }
+            if (isComparison(op) && typeOf(binary.left.get()) != ValueType::Float &&
+                typeOf(binary.right.get()) != ValueType::Float) {
+                Operand left = requireScalar(*binary.left, expression(binary.left.get()));
+                Operand right = requireScalar(*binary.right, expression(binary.right.get()));
+                std::string holds = when ? op : negateComparison(op);
+                bool swap = holds == ">" || holds == ">=";
+                Opcode code = holds == "<" || holds == ">" ? Opcode::JLT : holds == "<=" || holds == ">=" ? Opcode::JLE
+                              : holds == "==" ? Opcode::JEQ : Opcode::JNE;
+                jumpTo(label, emit(code, swap ? right.reg : left.reg, swap ? left.reg : right.reg), 2);
+                return;
+            }
+            if (isComparison(op)) {
+                Operand left = expressionAs(binary.left.get(), ValueType::Float);
+                Operand right = expressionAs(binary.right.get(), ValueType::Float);
+                bool swap = op == ">" || op == ">=";
+                Opcode code = op == "<" || op == ">" ? Opcode::FLT : op == "<=" || op == ">=" ? Opcode::FLE
+                              : op == "==" ? Opcode::FEQ : Opcode::FNE;
+                int32_t result = temp();
+                emit(code, result, swap ? right.reg : left.reg, swap ? left.reg : right.reg);
+                jumpTo(label, emit(when ? Opcode::JNZ : Opcode::JZ, result), 1);
+                return;
+            }
+        }
+        Operand value = requireScalar(*condition, expression(condition));
+        if (value.type == ValueType::Float) {
+            int32_t zero = temp();
+            emit(Opcode::LOADI, zero, 0);
+            int32_t result = temp();
+            emit(Opcode::FNE, result, value.reg, zero);
+            value = {result, ValueType::Int};
+        }
+        jumpTo(label, emit(when ? Opcode::JNZ : Opcode::JZ, value.reg), 1);
+    }
+
+    // 作为语句求值，不需要结果
+    void effect(const ASTNode* node) {
+        if (node && node->getKind() == ASTNodeKind::Identifier) {
+            identifier(static_cast<const IdentifierNode&>(*node), -1, false);
+        } else if (node) {
+            expression(node);
+        }
+    }
+
+    void statement(const ASTNode* node) {
+        if (!node) {
+            return;
+        }
+        int savedLine = line;
+        line = node->line;
+        switch (node->getKind()) {
+            case ASTNodeKind::VarDeclaration: {
+                const auto& var = static_cast<const VarDeclarationNode&>(*node);
+                ValueType type = scalarType(var.type);
+                if (type == ValueType::Void) {
+                    fail(*node, "variable '" + var.identifier + "' declared void");
+                }
+                int32_t reg = declare(*node, var.identifier, type, 0);
+                if (var.initializer) {
+                    expressionAs(var.initializer.get(), type, reg);
+                } else {
+                    emit(Opcode::LOADI, reg, 0);  // 未初始化的局部变量为0
+                }
+                break;
+            }
+            case ASTNodeKind::ArrayDeclaration: {
+                const auto& array = static_cast<const ArrayDeclarationNode&>(*node);
+                if (array.size == 0 || array.size > static_cast<size_t>(INT32_MAX - arrayOffset - 1)) {
+                    fail(*node, "invalid size for array '" + array.identifier + "'");
+                }
+                int32_t reg = declare(*node, array.identifier, arrayType(array.type),
+                                      static_cast<int64_t>(array.size));
+                arrayInstructions.push_back(emit(Opcode::ARRAY, reg, arrayOffset, static_cast<int32_t>(array.size)));
+                arrayOffset += static_cast<int32_t>(array.size) + 1;
+                break;
+            }
+            case ASTNodeKind::ExpressionStatement:
+                effect(static_cast<const ExpressionStatementNode&>(*node).expression.get());
+                break;
+            case ASTNodeKind::Identifier:
+            case ASTNodeKind::Assignment:
+            case ASTNodeKind::FunctionCall:
+            case ASTNodeKind::BinaryExpression:
+            case ASTNodeKind::UnaryExpression:
+            case ASTNodeKind::Literal:
+            case ASTNodeKind::IndexExpression:
+                effect(node);
+                break;
+            case ASTNodeKind::IfStatement: {
+                const auto& ifStmt = static_cast<const IfStatementNode&>(*node);
+                Label otherwise;
+                Label done;
+                branch(ifStmt.condition.get(), false, otherwise);
+                nextRegister = localTop;
+                statement(ifStmt.thenStatement.get());
+                if (ifStmt.elseStatement) {
+                    jumpTo(done, emit(Opcode::JMP), 0);
+                }
+                bind(otherwise);
+                statement(ifStmt.elseStatement.get());
+                bind(done);
+                break;
+            }
+            case ASTNodeKind::WhileStatement: {
+                const auto& whileStmt = static_cast<const WhileStatementNode&>(*node);
+                Label head;
+                Label exit;
+                bind(head);
+                branch(whileStmt.condition.get(), false, exit);
+                nextRegister = localTop;
+                loops.push_back({&exit, &head});
+                statement(whileStmt.body.get());
+                loops.pop_back();
+                jumpTo(head, emit(Opcode::JMP), 0);
+                bind(exit);
+                break;
+            }
+            case ASTNodeKind::ForStatement: {
+                const auto& forStmt = static_cast<const ForStatementNode&>(*node);
+                int32_t savedTop = localTop;
+                pushScope();
+                statement(forStmt.initialization.get());
+                Label head;
+                Label next;
+                Label exit;
+                if (state.options.parallelizeLoops && !outlining) {
+                    parallelVersion(forStmt, exit);
+                }
+                bind(head);
+                branch(forStmt.condition.get(), false, exit);
+                nextRegister = localTop;
+                loops.push_back({&exit, &next});
+                statement(forStmt.body.get());
+                loops.pop_back();
+                bind(next);
+                line = node->line;
+                effect(forStmt.update.get());
+                jumpTo(head, emit(Opcode::JMP), 0);
+                bind(exit);
+                popScope(savedTop);
+                break;
+            }
+            case ASTNodeKind::CompoundStatement: {
+                int32_t savedTop = localTop;
+                pushScope();
+                for (const auto& child : static_cast<const CompoundStatementNode&>(*node).statements) {
+                    statement(child.get());
+                }
+                popScope(savedTop);
+                break;
+            }
+            case ASTNodeKind::ReturnStatement: {
+                const ASTNode* value = static_cast<const ReturnStatementNode&>(*node).expression.get();
+                if (function.returnType == ValueType::Void) {
+                    if (value) {
+                        fail(*node, "void function '" + function.name + "' should not return a value");
+                    }
+                    emit(Opcode::RETV);
+                } else if (value) {
+                    emit(Opcode::RET, expressionAs(value, function.returnType).reg);
+                } else {
+                    int32_t zero = temp();
+                    emit(Opcode::LOADI, zero, 0);
+                    emit(Opcode::RET, zero);
+                }
+                break;
+            }
+            case ASTNodeKind::BreakStatement:
+            case ASTNodeKind::ContinueStatement: {
+                bool isBreak = node->getKind() == ASTNodeKind::BreakStatement;
+                if (loops.empty()) {
+                    fail(*node, std::string(isBreak ? "'break'" : "'continue'") + " outside of a loop");
+                }
+                jumpTo(isBreak ? *loops.back().breakLabel : *loops.back().continueLabel, emit(Opcode::JMP), 0);
+                break;
+            }
+            case ASTNodeKind::PreprocessorDirective:
+                break;
+            default:
+                fail(*node, "unsupported statement");
+        }
+        nextRegister = localTop;
+        line = savedLine;
+    }
+
+    LoopVariableInfo variableInfo(const std::string& name) const {
+        LoopVariableInfo info;
+        const Variable* variable = lookup(name);
+        if (!variable) {
+            return info;
+        }
+        info.storage = variable->reg < 0 ? LoopStorage::Global
+                       : variable->reg < static_cast<int32_t>(function.firstConstant()) ? LoopStorage::Parameter
+                                                                                        : LoopStorage::Local;
+        info.isArray = isArray(variable->type);
+        info.isInteger = variable->type == ValueType::Int;
+        return info;
+    }
+
+    // 依赖分析通过时生成循环体函数与PARFOR；串行的循环照常紧随其后
+    void parallelVersion(const ForStatementNode& forStmt, Label& exit) {
+        LoopDependence dependence = DependenceAnalyzer::analyzeLoop(forStmt, [this](const std::string& name) {
+            return variableInfo(name);
+        });
+        LoopReport report;
+        report.function = function.name;
+        report.line = forStmt.line;
+        report.parallel = dependence.parallel;
+        report.detail = dependence.reason;
+        if (dependence.parallel) {
+            report.detail = dependence.reductions.empty() ? "no reduction" : "reduction";
+            for (size_t i = 0; i < dependence.reductions.size(); i++) {
+                report.detail += (i == 0 ? " " : ", ") + dependence.reductions[i];
+            }
+            state.stats.parallelLoops++;
+        }
+        state.stats.loops.push_back(report);
+        if (!dependence.parallel) {
+            return;
+        }
+
+        ParallelLoop loop;
+        loop.upper = expressionAs(dependence.upper, ValueType::Int).reg;  // 上界在循环前求值一次
+        loop.inclusive = dependence.inclusive;
+        std::unordered_set<std::string> seen{dependence.induction};
+        for (const auto& name : dependence.reductions) {
+            loop.reductions.push_back(resolve(forStmt, name).reg);
+            seen.insert(name);
+        }
+        // 循环体读到的局部变量与形参按值传入；全局变量由循环体函数直接访问
+        std::vector<std::pair<std::string, Variable>> captured;
+        if (forStmt.body) {
+            walkAST(*forStmt.body, [&](const ASTNode& node) {
+                if (node.getKind() == ASTNodeKind::Identifier) {
+                    std::string name = static_cast<const IdentifierNode&>(node).name;
+                    std::string variable;
+                    int delta;
+                    bool prefix;
+                    if (splitIncrement(name, variable, delta, prefix)) {
+                        name = variable;
+                    }
+                    const Variable* found = seen.insert(name).second ? lookup(name) : nullptr;
+                    if (found && found->reg >= 0) {
+                        captured.emplace_back(name, *found);
+                        loop.captures.push_back(found->reg);
+                    }
+                }
+                return true;
+            });
+        }
+
+        BytecodeFunction& body = state.outlined.emplace_back();
+        body.name = function.name + "$loop" + std::to_string(function.parallelLoops.size());
+        body.returnType = ValueType::Void;
+        body.parameterTypes = {ValueType::Int, ValueType::Int, ValueType::IntArray};
+        for (const auto& capture : captured) {
+            body.parameterTypes.push_back(capture.second.type);
+        }
+        FunctionCompiler compiler(state, body);
+        compiler.compileLoopBody(forStmt, dependence, captured);
+        accesses.insert(accesses.end(), compiler.accesses.begin(), compiler.accesses.end());
+
+        loop.body = static_cast<int32_t>(state.outlined.size() - 1);  // 编译结束后改为函数表下标
+        int32_t index = static_cast<int32_t>(function.parallelLoops.size());
+        function.parallelLoops.push_back(std::move(loop));
+        const Variable& induction = resolve(forStmt, dependence.induction);
+        jumpTo(exit, emit(Opcode::PARFOR, induction.reg, index), 2);
+    }
+
+    // 区间分析证明下标在范围内的访问改用不检查的指令
+    void eliminateBoundsChecks(const FunctionDefinitionNode& definition) {
+        std::unordered_map<const ASTNode*, Interval> ranges;
+        if (state.options.eliminateBoundsChecks && !accesses.empty()) {
+            std::vector<IntervalFinding> findings;
+            std::vector<IndexRange> indexRanges;
+            IntervalStats intervalStats;
+            IntervalAnalyzer::analyzeFunction(definition, state.tokens, findings, intervalStats, nullptr,
+                                              &indexRanges);
+            for (const auto& range : indexRanges) {
+                auto inserted = ranges.emplace(range.access, range.index);
+                if (!inserted.second) {
+                    inserted.first->second = inserted.first->second.join(range.index);
+                }
+            }
+        }
+        for (const Access& access : accesses) {
+            auto it = ranges.find(access.node);
+            bool safe = access.length > 0 && it != ranges.end() && it->second.lo >= 0 &&
+                        it->second.hi <= access.length - 1 && !mentionsShadowed(*access.node->index);
+            Instruction& instruction = access.function->code[access.instruction];
+            if (safe) {
+                instruction.op = instruction.op == Opcode::LOADELEM ? Opcode::LOADELEM_U : Opcode::STOREELEM_U;
+            }
+            if (access.function == &function) {
+                (safe ? state.stats.elidedAccesses : state.stats.checkedAccesses)++;
+            }
+        }
+    }
+
+    bool mentionsShadowed(const ASTNode& node) const {
+        bool found = false;
+        walkAST(node, [this, &found](const ASTNode& current) {
+            if (current.getKind() == ASTNodeKind::Identifier) {
+                std::string name = static_cast<const IdentifierNode&>(current).name;
+                std::string variable;
+                int delta;
+                bool prefix;
+                if (splitIncrement(name, variable, delta, prefix)) {
+                    name = variable;
+                }
+                found = found || shadowed.count(name) > 0;
+            }
+            return !found;
+        });
+        return found;
+    }
+
+    void finish() {
+        line = function.lines.empty() ? line : function.lines.back();
+        if (function.returnType == ValueType::Void) {
+            emit(Opcode::RETV);
+        } else {
+            int32_t zero = temp();
+            emit(Opcode::LOADI, zero, 0);
+            emit(Opcode::RET, zero);
+        }
+        function.registerCount = static_cast<uint32_t>(maxRegister);
+        for (size_t index : arrayInstructions) {
+            function.code[index].b += maxRegister;
+        }
+        function.frameSize = function.registerCount + static_cast<uint32_t>(arrayOffset);
+    }
+
+public:
+    FunctionCompiler(ModuleState& state, BytecodeFunction& function) : state(state), function(function) {}
+
+    void compileDefinition(const FunctionDefinitionNode& definition, const FunctionSignature& signature) {
+        line = definition.line;
+        pushScope();
+        // 形参占最前面的寄存器，常量寄存器紧随其后
+        nextRegister = static_cast<int32_t>(definition.parameters.size());
+        maxRegister = nextRegister;
+        if (definition.body) {
+            collectConstants(*definition.body);
+        }
+        nextRegister += static_cast<int32_t>(function.constants.size());
+        maxRegister = nextRegister;
+        localTop = nextRegister;
+        for (size_t i = 0; i < definition.parameters.size(); i++) {
+            const ASTNode& parameter = *definition.parameters[i];
+            std::string name = parameter.getKind() == ASTNodeKind::ArrayDeclaration
+                                   ? static_cast<const ArrayDeclarationNode&>(parameter).identifier
+                                   : static_cast<const VarDeclarationNode&>(parameter).identifier;
+            if (scopes.back().count(name)) {
+                fail(parameter, "duplicate parameter '" + name + "'");
+            }
+            if (state.globals.count(name)) {
+                shadowed.insert(name);
+            }
+            Variable variable;
+            variable.type = signature.parameters[i];
+            variable.reg = static_cast<int32_t>(i);
+            variable.length = signature.lengths[i];
+            scopes.back().emplace(name, variable);
+            if (variable.length > 0) {
+                // 写明长度的数组形参：入口处检查一次，函数体内按该长度消除下标检查
+                emit(Opcode::CHECKLEN, variable.reg, static_cast<int32_t>(variable.length));
+            }
+        }
+        statement(definition.body.get());
+        finish();
+        eliminateBoundsChecks(definition);
+    }
+
+    /**
+     * 并行循环的循环体函数：void body(int lo, int hi, int partial[], captures...)
+     * 执行 [lo, hi) 内的迭代，归约变量从0开始累加，结束时写入partial
+     */
+    void compileLoopBody(const ForStatementNode& forStmt, const LoopDependence& dependence,
+                         const std::vector<std::pair<std::string, Variable>>& captured) {
+        outlining = true;
+        line = forStmt.line;
+        pushScope();
+        nextRegister = static_cast<int32_t>(function.parameterTypes.size());
+        maxRegister = nextRegister;
+        if (forStmt.body) {
+            collectConstants(*forStmt.body);
+        }
+        nextRegister += static_cast<int32_t>(function.constants.size());
+        maxRegister = nextRegister;
+        localTop = nextRegister;
+        for (size_t i = 0; i < captured.size(); i++) {
+            Variable variable = captured[i].second;
+            variable.reg = static_cast<int32_t>(3 + i);
+            scopes.back().emplace(captured[i].first, variable);
+        }
+        int32_t induction = declare(forStmt, dependence.induction, ValueType::Int, 0);
+        emit(Opcode::MOVE, induction, 0);
+        std::vector<int32_t> sums;
+        for (const auto& name : dependence.reductions) {
+            sums.push_back(declare(forStmt, name, ValueType::Int, 0));
+            emit(Opcode::LOADI, sums.back(), 0);
+        }
+        Label head;
+        Label next;
+        Label exit;
+        bind(head);
+        jumpTo(exit, emit(Opcode::JLE, 1, induction), 2);
+        loops.push_back({&exit, &next});
+        statement(forStmt.body.get());
+        loops.pop_back();
+        bind(next);
+        line = forStmt.line;
+        emit(Opcode::ADDK, induction, induction, 1);
+        jumpTo(head, emit(Opcode::JMP), 0);
+        bind(exit);
+        for (size_t i = 0; i < sums.size(); i++) {
+            int32_t slot = temp();
+            emit(Opcode::LOADI, slot, static_cast<int32_t>(i));
+            emit(Opcode::STOREELEM_U, 2, slot, sums[i]);
+        }
+        finish();
+    }
+
+    // 全局变量的初始化表达式，按声明顺序求值
+    void compileGlobals(const std::vector<const VarDeclarationNode*>& declarations) {
+        for (const auto* declaration : declarations) {
+            collectConstants(*declaration->initializer);
+        }
+        nextRegister = static_cast<int32_t>(function.constants.size());
+        maxRegister = nextRegister;
+        localTop = nextRegister;
+        for (const auto* declaration : declarations) {
+            line = declaration->line;
+            const Variable& variable = state.globals.at(declaration->identifier);
+            Operand value = expressionAs(declaration->initializer.get(), variable.type);
+            emit(Opcode::GSTORE, variable.global, value.reg);
+            nextRegister = localTop;
+        }
+        finish();
+    }
+};
+
+} // namespace
+
+// BytecodeCompiler类实现
+BytecodeCompiler::BytecodeCompiler(const BytecodeCompileOptions& options) : options(options) {}
+
+bool BytecodeCompiler::compile(const ProgramNode& program, const std::vector<Token>& tokens, BytecodeModule& module) {
+    module = BytecodeModule();
+    stats = BytecodeCompileStats();
+    errors.clear();
+    ModuleState state{module, tokens, options, stats, {}, {}, {}};
+    auto report = [this](const CompileError& error) {
+        std::ostringstream oss;
+        oss << "Compile error at " << error.line << ":" << error.column << ": " << error.message;
+        errors.push_back(oss.str());
+    };
+
+    // 第一遍：登记全局变量与所有函数的签名，函数可以先调用后定义
+    std::vector<const VarDeclarationNode*> initializers;
+    std::vector<std::string> functionOrder;
+    for (const auto& statement : program.statements) {
+        if (!statement) {
+            continue;
+        }
+        try {
+            switch (statement->getKind()) {
+                case ASTNodeKind::VarDeclaration:
+                case ASTNodeKind::ArrayDeclaration: {
+                    bool array = statement->getKind() == ASTNodeKind::ArrayDeclaration;
+                    const std::string& name = array ? static_cast<const ArrayDeclarationNode&>(*statement).identifier
+                                                    : static_cast<const VarDeclarationNode&>(*statement).identifier;
+                    if (state.globals.count(name) || state.functions.count(name)) {
+                        fail(*statement, "redefinition of '" + name + "'");
+                    }
+                    Variable variable;
+                    variable.global = static_cast<int32_t>(module.globalCount);
+                    if (array) {
+                        const auto& declaration = static_cast<const ArrayDeclarationNode&>(*statement);
+                        if (declaration.size == 0) {
+                            fail(*statement, "invalid size for array '" + name + "'");
+                        }
+                        variable.type = arrayType(declaration.type);
+                        variable.length = static_cast<int64_t>(declaration.size);
+                        module.globalArrays.emplace_back(module.globalCount, variable.length);
+                        module.globalCount += static_cast<uint32_t>(declaration.size) + 1;
+                    } else {
+                        const auto& declaration = static_cast<const VarDeclarationNode&>(*statement);
+                        variable.type = scalarType(declaration.type);
+                        if (variable.type == ValueType::Void) {
+                            fail(*statement, "variable '" + name + "' declared void");
+                        }
+                        module.globalCount++;
+                        if (declaration.initializer) {
+                            initializers.push_back(&declaration);
+                        }
+                    }
+                    state.globals.emplace(name, variable);
+                    break;
+                }
+                case ASTNodeKind::FunctionDeclaration:
+                case ASTNodeKind::FunctionDefinition: {
+                    bool isDefinition = statement->getKind() == ASTNodeKind::FunctionDefinition;
+                    const auto* definition =
+                        isDefinition ? static_cast<const FunctionDefinitionNode*>(statement.get()) : nullptr;
+                    const auto* declaration =
+                        isDefinition ? nullptr : static_cast<const FunctionDeclarationNode*>(statement.get());
+                    const std::string& name = isDefinition ? definition->name : declaration->name;
+                    if (name == "printf") {
+                        break;  // 内建函数
+                    }
+                    FunctionSignature signature;
+                    signature.returnType = scalarType(isDefinition ? definition->returnType : declaration->returnType);
+                    const auto& parameters = isDefinition ? definition->parameters : declaration->parameters;
+                    for (const auto& parameter : parameters) {
+                        if (parameter->getKind() == ASTNodeKind::ArrayDeclaration) {
+                            const auto& array = static_cast<const ArrayDeclarationNode&>(*parameter);
+                            signature.parameters.push_back(arrayType(array.type));
+                            signature.lengths.push_back(static_cast<int64_t>(array.size));
+                        } else {
+                            ValueType type = scalarType(static_cast<const VarDeclarationNode&>(*parameter).type);
+                            if (type == ValueType::Void) {
+                                fail(*parameter, "parameter declared void");
+                            }
+                            signature.parameters.push_back(type);
+                            signature.lengths.push_back(0);
+                        }
+                    }
+                    if (state.globals.count(name)) {
+                        fail(*statement, "redefinition of '" + name + "'");
+                    }
+                    auto it = state.functions.find(name);
+                    if (it == state.functions.end()) {
+                        signature.index = static_cast<int>(module.functions.size());
+                        BytecodeFunction function;
+                        function.name = name;
+                        function.returnType = signature.returnType;
+                        function.parameterTypes = signature.parameters;
+                        module.functions.push_back(std::move(function));
+                        it = state.functions.emplace(name, signature).first;
+                        functionOrder.push_back(name);
+                    } else if (it->second.returnType != signature.returnType ||
+                               it->second.parameters != signature.parameters) {
+                        fail(*statement, "conflicting declaration of function '" + name + "'");
+                    }
+                    if (isDefinition) {
+                        if (it->second.definition) {
+                            fail(*statement, "redefinition of function '" + name + "'");
+                        }
+                        it->second.definition = definition;
+                        it->second.lengths = signature.lengths;
+                    }
+                    break;
+                }
+                case ASTNodeKind::PreprocessorDirective:
+                    break;
+                default:
+                    fail(*statement, "statement outside of a function");
+            }
+        } catch (const CompileError& error) {
+            report(error);
+        }
+    }
+
+    // 第二遍：编译函数体
+    for (const auto& name : functionOrder) {
+        FunctionSignature& signature = state.functions.at(name);
+        if (!signature.definition) {
+            continue;
+        }
+        try {
+            FunctionCompiler compiler(state, module.functions[signature.index]);
+            compiler.compileDefinition(*signature.definition, signature);
+        } catch (const CompileError& error) {
+            report(error);
+        }
+    }
+    if (!initializers.empty()) {
+        module.globalInitializer = static_cast<int>(module.functions.size());
+        module.functions.emplace_back();
+        module.functions.back().name = "<globals>";
+        module.functions.back().returnType = ValueType::Void;
+        try {
+            FunctionCompiler compiler(state, module.functions.back());
+            compiler.compileGlobals(initializers);
+        } catch (const CompileError& error) {
+            report(error);
+        }
+    }
+
+    for (const auto& name : functionOrder) {
+        const FunctionSignature& signature = state.functions.at(name);
+        if (!signature.definition && signature.firstCall) {
+            report({"function '" + name + "' is called but never defined", signature.firstCall->line,
+                    signature.firstCall->column});
+        }
+    }
+    auto main = state.functions.find("main");
+    if (main == state.functions.end() || !main->second.definition) {
+        errors.push_back("Compile error: no definition of 'main'");
+    } else if (!main->second.parameters.empty()) {
+        report({"'main' must not take parameters", main->second.definition->line, main->second.definition->column});
+    } else {
+        module.mainFunction = main->second.index;
+    }
+
+    int base = static_cast<int>(module.functions.size());
+    for (auto& function : module.functions) {
+        for (auto& loop : function.parallelLoops) {
+            loop.body += base;
+        }
+    }
+    for (auto& body : state.outlined) {
+        module.functions.push_back(std::move(body));
+    }
+
+    if (options.optimizeLoops && errors.empty()) {
+        LoopOptimizer optimizer(module);
+        for (auto& function : module.functions) {
+            optimizer.optimize(function);
+        }
+        stats.loopsRotated = optimizer.getStats().rotated;
+        stats.multipliesReduced = optimizer.getStats().reduced;
+        stats.loopsUnrolled = optimizer.getStats().unrolled;
+    }
+
+    stats.functions = module.functions.size();
+    for (const auto& function : module.functions) {
+        stats.instructions += function.code.size();
+    }
+    return errors.empty();
+}
+
+const std::vector<std::string>& BytecodeCompiler::getErrors() const {
+    return errors;
+}
+
+const BytecodeCompileStats& BytecodeCompiler::getStats() const {
+    return stats;
+}
@@ -0,0 +1,282 @@
+#include "../include/CloneDetector.h"
+#include "../include/Lexer.h"
+#include "../include/HashUtils.h"
+#include "../include/ThreadPool.h"
+#include "../include/ConcurrentHashMap.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <set>
+
+namespace {
+
+// 规范化后的种类：所有标识符、所有字面量各自视为同一种
+const uint16_t IDENTIFIER_KIND = 1000;
+const uint16_t LITERAL_KIND = 1001;
+
+// 滚动哈希的基数（按2^64取模）
+const uint64_t ROLLING_BASE = 1000003ULL;
+
+// 桶中位置多于此数时不再两两比较，只比较相邻位置
+const size_t MAX_PAIRWISE_BUCKET = 16;
+
+// 位置编码：高32位为文件序号，低32位为token下标
+uint64_t encode(size_t file, size_t position) {
+    return (static_cast<uint64_t>(file) << 32) | static_cast<uint64_t>(position);
+}
+
+size_t fileOf(uint64_t location) {
+    return static_cast<size_t>(location >> 32);
+}
+
+size_t positionOf(uint64_t location) {
+    return static_cast<size_t>(location & 0xFFFFFFFFULL);
+}
+
+struct ClonePair {
+    uint64_t first;
+    uint64_t second;
+    size_t length;
+};
+
+} // namespace
+
+// CloneDetector类实现
+CloneDetector::CloneDetector(size_t minTokens, size_t threadCount)
+    : minTokens(std::max<size_t>(1, minTokens)),
+      threadCount(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount) {}
+
+void CloneDetector::loadFile(const std::string& path, FileTokens& file) const {
+    file.path = path;
+    std::ifstream input(path);
+    if (!input.is_open()) {
+        return;
+    }
+    std::ostringstream buffer;
+    buffer << input.rdbuf();
+    file.loaded = true;
+
+    Lexer lexer(buffer.str());
+    for (const auto& token : lexer.tokenize()) {
+        switch (token.type) {
+            case TokenType::NEWLINE:
+            case TokenType::WHITESPACE:
+            case TokenType::EOF_TOKEN:
+                continue;
+            case TokenType::IDENTIFIER:
+                file.kinds.push_back(IDENTIFIER_KIND);
+                break;
+            case TokenType::INTEGER:
+            case TokenType::FLOAT:
+            case TokenType::STRING:
+                file.kinds.push_back(LITERAL_KIND);
+                break;
+            default:
+                file.kinds.push_back(static_cast<uint16_t>(token.type));
+                break;
+        }
+        file.lines.push_back(token.line);
+    }
+}
+
+void CloneDetector::detect(const std::vector<std::string>& paths, CloneStats& stats) {
+    stats = CloneStats();
+    stats.files = paths.size();
+    files.clear();
+    files.resize(paths.size());
+    classes.clear();
+    ThreadPool pool(std::min(threadCount, std::max<size_t>(1, paths.size())));
+
+    // 1. 并行词法分析并规范化
+    pool.parallelFor(paths.size(), [&](size_t i) {
+        loadFile(paths[i], files[i]);
+    });
+
+    // 2. 滚动哈希每个窗口，放入分段加锁的哈希表
+    uint64_t highPower = 1;
+    for (size_t i = 1; i < minTokens; i++) {
+        highPower *= ROLLING_BASE;
+    }
+    ConcurrentHashMap<uint64_t, std::vector<uint64_t>> table(256);
+    std::vector<size_t> windowCounts(files.size(), 0);
+    pool.parallelFor(files.size(), [&](size_t f) {
+        const std::vector<uint16_t>& kinds = files[f].kinds;
+        if (kinds.size() < minTokens) {
+            return;
+        }
+        uint64_t hash = 0;
+        for (size_t i = 0; i < minTokens; i++) {
+            hash = hash * ROLLING_BASE + kinds[i];
+        }
+        for (size_t start = 0;; start++) {
+            table.update(hash, [&](std::vector<uint64_t>& bucket) {
+                bucket.push_back(encode(f, start));
+            });
+            if (start + minTokens >= kinds.size()) {
+                break;
+            }
+            hash = (hash - kinds[start] * highPower) * ROLLING_BASE + kinds[start + minTokens];
+        }
+        windowCounts[f] = kinds.size() - minTokens + 1;
+    });
+    for (size_t f = 0; f < files.size(); f++) {
+        stats.tokens += files[f].kinds.size();
+        stats.windows += windowCounts[f];
+    }
+
+    // 3. 只保留出现两次以上的窗口；排序保证结果与线程调度无关
+    std::vector<std::vector<uint64_t>> buckets;
+    table.forEach([&buckets](const uint64_t&, std::vector<uint64_t>& bucket) {
+        if (bucket.size() >= 2) {
+            std::sort(bucket.begin(), bucket.end());
+            buckets.push_back(std::move(bucket));
+        }
+    });
+    table.clear();
+    std::sort(buckets.begin(), buckets.end());
+    stats.buckets = buckets.size();
+
+    // 4. 并行地把候选位置对扩展为极大克隆对
+    std::vector<std::vector<ClonePair>> bucketPairs(buckets.size());
+    pool.parallelFor(buckets.size(), [&](size_t b) {
+        const std::vector<uint64_t>& bucket = buckets[b];
+        auto extend = [&](uint64_t first, uint64_t second, bool chained) {
+            const FileTokens& a = files[fileOf(first)];
+            const FileTokens& c = files[fileOf(second)];
+            size_t pa = positionOf(first);
+            size_t pc = positionOf(second);
+            bool sameFile = fileOf(first) == fileOf(second);
+            // 前一个token也相同时，这一对会从更早的位置开始报告
+            bool leftExtends = pa > 0 && pc > 0 && a.kinds[pa - 1] == c.kinds[pc - 1];
+            if (leftExtends && !(chained && sameFile)) {
+                return;
+            }
+            size_t limit = std::min(a.kinds.size() - pa, c.kinds.size() - pc);
+            if (sameFile) {
+                limit = std::min(limit, pc - pa);  // 同一文件内的两段不重叠
+            }
+            size_t length = 0;
+            while (length < limit && a.kinds[pa + length] == c.kinds[pc + length]) {
+                length++;
+            }
+            // 相邻位置配对时，同一文件内左侧的一对同样受间距限制：只有它没有被截断时才覆盖这一对。
+            // 连续重复的代码（间距等于重复周期）中每一对都被截断；其中只报告起点按间距对齐的一对
+            // 和重复区域末尾的一对，各个错开的位置得到相同的覆盖，不必逐一报告
+            if (leftExtends) {
+                size_t gap = pc - pa;
+                bool runEnds = pc + length >= c.kinds.size() || a.kinds[pa + length] != c.kinds[pc + length];
+                if (length < gap || (pa % gap != 0 && !runEnds)) {
+                    return;
+                }
+            }
+            if (length >= minTokens) {  // 哈希冲突时长度不足
+                bucketPairs[b].push_back({first, second, length});
+            }
+        };
+        if (bucket.size() <= MAX_PAIRWISE_BUCKET) {
+            for (size_t i = 0; i < bucket.size(); i++) {
+                for (size_t j = i + 1; j < bucket.size(); j++) {
+                    extend(bucket[i], bucket[j], false);
+                }
+            }
+        } else {
+            // 每个位置只与它之前最近的、不与它重叠的位置比较：同一文件内的扩展长度受间距限制，
+            // 高度重复的代码不会因每个位置都与首个位置比较而退化为平方复杂度
+            size_t partner = 0;
+            for (size_t j = 1; j < bucket.size(); j++) {
+                while (partner + 1 < j && fileOf(bucket[partner + 1]) == fileOf(bucket[j]) &&
+                       positionOf(bucket[partner + 1]) + minTokens <= positionOf(bucket[j])) {
+                    partner++;
+                }
+                if (fileOf(bucket[j - 1]) != fileOf(bucket[j])) {
+                    partner = j - 1;
+                }
+                extend(bucket[partner], bucket[j], true);
+            }
+        }
+    });
+
+    // 5. 内容相同的片段归入同一克隆类
+    std::unordered_map<uint64_t, size_t> classIndex;
+    std::vector<std::set<uint64_t>> members;
+    for (const auto& pairs : bucketPairs) {
+        for (const auto& pair : pairs) {
+            stats.pairs++;
+            const FileTokens& file = files[fileOf(pair.first)];
+            uint64_t key = HashUtils::hashBytes(file.kinds.data() + positionOf(pair.first),
+                                                pair.length * sizeof(uint16_t));
+            key = HashUtils::combine(key, pair.length);
+            auto it = classIndex.find(key);
+            if (it == classIndex.end()) {
+                it = classIndex.emplace(key, classes.size()).first;
+                classes.emplace_back();
+                classes.back().length = pair.length;
+                members.emplace_back();
+            }
+            members[it->second].insert(pair.first);
+            members[it->second].insert(pair.second);
+        }
+    }
+    for (size_t c = 0; c < classes.size(); c++) {
+        for (uint64_t location : members[c]) {
+            const FileTokens& file = files[fileOf(location)];
+            CloneFragment fragment;
+            fragment.file = fileOf(location);
+            fragment.start = positionOf(location);
+            fragment.firstLine = file.lines[fragment.start];
+            fragment.lastLine = file.lines[fragment.start + classes[c].length - 1];
+            classes[c].fragments.push_back(fragment);
+        }
+    }
+    std::sort(classes.begin(), classes.end(), [](const CloneClass& a, const CloneClass& b) {
+        size_t weightA = a.length * a.fragments.size();
+        size_t weightB = b.length * b.fragments.size();
+        if (weightA != weightB) return weightA > weightB;
+        const CloneFragment& fa = a.fragments.front();
+        const CloneFragment& fb = b.fragments.front();
+        return fa.file != fb.file ? fa.file < fb.file : fa.start < fb.start;
+    });
+}
+
+const std::vector<CloneClass>& CloneDetector::getClasses() const {
+    return classes;
+}
+
+void CloneDetector::printReport(std::ostream& os, const CloneStats& stats) const {
+    os << "\n=== Clone Detection ===" << std::endl;
+    os << "Files: " << stats.files << ", tokens: " << stats.tokens << ", windows: " << stats.windows
+       << " (minimum clone length: " << minTokens << " tokens, threads: " << threadCount << ")" << std::endl;
+    for (const auto& file : files) {
+        if (!file.loaded) {
+            os << "  [error] " << file.path << ": Cannot open file" << std::endl;
+        }
+    }
+
+    // 被任一片段覆盖的token数（嵌套的克隆类只计一次）
+    std::vector<std::vector<bool>> covered(files.size());
+    for (size_t f = 0; f < files.size(); f++) {
+        covered[f].assign(files[f].kinds.size(), false);
+    }
+    for (size_t c = 0; c < classes.size(); c++) {
+        const CloneClass& cloneClass = classes[c];
+        os << "Clone class " << c + 1 << ": " << cloneClass.length << " tokens x "
+           << cloneClass.fragments.size() << " fragments" << std::endl;
+        for (const auto& fragment : cloneClass.fragments) {
+            os << "  " << files[fragment.file].path << ":" << fragment.firstLine << "-" << fragment.lastLine << std::endl;
+        }
+        for (const auto& fragment : cloneClass.fragments) {
+            std::fill_n(covered[fragment.file].begin() + fragment.start, cloneClass.length, true);
+        }
+    }
+    if (classes.empty()) {
+        os << "✓ No duplicated code found." << std::endl;
+        return;
+    }
+    size_t duplicated = 0;
+    for (const auto& flags : covered) {
+        duplicated += static_cast<size_t>(std::count(flags.begin(), flags.end(), true));
+    }
+    os << classes.size() << " clone class(es) from " << stats.pairs << " clone pair(s); "
+       << duplicated << " of " << stats.tokens << " token(s) are in clones." << std::endl;
+}
@@ -0,0 +1,285 @@
+#include "../include/CodeMetrics.h"
+#include "../include/ASTWalker.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+
+namespace {
+
+/**
+ * 一次遍历函数体，同时累计语句数、圈复杂度、嵌套深度与被调用函数
+ */
+struct FunctionVisitor {
+    FunctionMetrics& metrics;
+    std::set<std::string> callees;
+
+    explicit FunctionVisitor(FunctionMetrics& metrics) : metrics(metrics) {}
+
+    void visit(const ASTNode& node, size_t depth) {
+        size_t childDepth = depth;
+        switch (node.getKind()) {
+            case ASTNodeKind::IfStatement:
+            case ASTNodeKind::WhileStatement:
+            case ASTNodeKind::ForStatement:
+                metrics.statements++;
+                metrics.complexity++;
+                childDepth = depth + 1;
+                metrics.nesting = std::max(metrics.nesting, childDepth);
+                break;
+            case ASTNodeKind::VarDeclaration:
+            case ASTNodeKind::ArrayDeclaration:
+            case ASTNodeKind::ExpressionStatement:
+            case ASTNodeKind::ReturnStatement:
+            case ASTNodeKind::BreakStatement:
+            case ASTNodeKind::ContinueStatement:
+                metrics.statements++;
+                break;
+            case ASTNodeKind::BinaryExpression: {
+                const std::string& op = static_cast<const BinaryExpressionNode&>(node).operator_;
+                if (op == "&&" || op == "||") {
+                    metrics.complexity++;
+                }
+                break;
+            }
+            case ASTNodeKind::FunctionCall:
+                callees.insert(static_cast<const FunctionCallNode&>(node).name);
+                break;
+            default:
+                break;
+        }
+        forEachChild(node, [this, childDepth](const ASTNode& child) {
+            visit(child, childDepth);
+        });
+    }
+};
+
+bool isOperand(TokenType type) {
+    return type == TokenType::IDENTIFIER || type == TokenType::INTEGER || type == TokenType::FLOAT ||
+           type == TokenType::STRING;
+}
+
+std::string csvField(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) {
+        return text;
+    }
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        switch (c) {
+            case '"': quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\t': quoted += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    quoted += escaped;
+                } else {
+                    quoted += c;
+                }
+                break;
+        }
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+// FunctionMetrics实现
+double FunctionMetrics::volume() const {
+    size_t vocabulary = distinctOperators + distinctOperands;
+    return vocabulary == 0 ? 0.0 : static_cast<double>(operators + operands) * std::log2(static_cast<double>(vocabulary));
+}
+
+double FunctionMetrics::difficulty() const {
+    return distinctOperands == 0 ? 0.0
+                                 : static_cast<double>(distinctOperators) / 2.0 * static_cast<double>(operands) /
+                                       static_cast<double>(distinctOperands);
+}
+
+double FunctionMetrics::effort() const {
+    return difficulty() * volume();
+}
+
+// CodeMetrics类实现
+CodeMetrics::CodeMetrics(size_t threadCount)
+    : threadCount(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount) {}
+
+void CodeMetrics::measure(const FunctionDefinitionNode& function, const std::vector<Token>& tokens,
+                          FunctionMetrics& metrics) {
+    metrics.name = function.name;
+    metrics.line = function.line;
+    metrics.parameters = function.parameters.size();
+
+    FunctionVisitor visitor(metrics);
+    if (function.body) {
+        visitor.visit(*function.body, 0);
+    }
+    metrics.callees.assign(visitor.callees.begin(), visitor.callees.end());
+    metrics.fanOut = metrics.callees.size();
+
+    // Halstead：函数覆盖的token，运算符按种类、运算对象按种类与取值区分
+    std::unordered_set<int> operatorKinds;
+    std::unordered_set<std::string> operandValues;
+    size_t last = std::min(function.lastToken, tokens.empty() ? 0 : tokens.size() - 1);
+    for (size_t i = function.firstToken; i <= last && i < tokens.size(); i++) {
+        const Token& token = tokens[i];
+        if (token.type == TokenType::NEWLINE || token.type == TokenType::WHITESPACE ||
+            token.type == TokenType::EOF_TOKEN) {
+            continue;
+        }
+        if (isOperand(token.type)) {
+            metrics.operands++;
+            operandValues.insert(std::to_string(static_cast<int>(token.type)) + ":" + token.value);
+        } else {
+            metrics.operators++;
+            operatorKinds.insert(static_cast<int>(token.type));
+        }
+    }
+    metrics.distinctOperators = operatorKinds.size();
+    metrics.distinctOperands = operandValues.size();
+}
+
+void CodeMetrics::analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, MetricsStats& stats) {
+    stats = MetricsStats();
+    stats.files = paths.size();
+    functions.clear();
+    diagnostics.clear();
+
+    std::vector<std::vector<FunctionMetrics>> perFile(paths.size());
+    stats.failed = frontEnd.parseUnits(paths, threadCount, [&](size_t i, const ParsedUnit& unit) {
+        const std::vector<Token>& tokens = unit.tokens;
+        for (const FunctionDefinitionNode* function : unit.definedFunctions()) {
+            FunctionMetrics metrics;
+            metrics.file = paths[i];
+            measure(*function, tokens, metrics);
+            perFile[i].push_back(std::move(metrics));
+        }
+    }, diagnostics);
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        for (auto& metrics : perFile[i]) {
+            functions.push_back(std::move(metrics));
+        }
+    }
+
+    // 扇入：按函数名汇总调用者
+    std::unordered_map<std::string, std::unordered_set<std::string>> callers;
+    for (const auto& metrics : functions) {
+        for (const auto& callee : metrics.callees) {
+            callers[callee].insert(metrics.name);
+        }
+    }
+    for (auto& metrics : functions) {
+        auto it = callers.find(metrics.name);
+        metrics.fanIn = it == callers.end() ? 0 : it->second.size();
+    }
+    stats.functions = functions.size();
+}
+
+const std::vector<FunctionMetrics>& CodeMetrics::getFunctions() const {
+    return functions;
+}
+
+const std::vector<std::string>& CodeMetrics::getDiagnostics() const {
+    return diagnostics;
+}
+
+void CodeMetrics::printReport(std::ostream& os, const MetricsStats& stats) const {
+    os << "\n=== Code Metrics ===" << std::endl;
+    os << "Files: " << stats.files << ", functions: " << stats.functions << " (threads: " << threadCount << ")"
+       << std::endl;
+    for (const auto& diagnostic : diagnostics) {
+        os << "  [error] " << diagnostic << std::endl;
+    }
+    if (functions.empty()) {
+        os << "No function definitions found." << std::endl;
+        return;
+    }
+
+    std::vector<std::string> locations;
+    size_t width = 8;
+    for (const auto& metrics : functions) {
+        locations.push_back(metrics.name + " (" + metrics.file + ":" + std::to_string(metrics.line) + ")");
+        width = std::max(width, locations.back().size() + 1);
+    }
+    std::ios_base::fmtflags flags = os.flags();
+    os << std::left << std::setw(static_cast<int>(width)) << "Function" << std::right << std::setw(7) << "Params" << std::setw(7)
+       << "Stmts" << std::setw(5) << "CC" << std::setw(6) << "Nest" << std::setw(7) << "FanIn" << std::setw(8)
+       << "FanOut" << std::setw(10) << "Volume" << std::endl;
+    const FunctionMetrics* mostComplex = &functions.front();
+    size_t totalComplexity = 0;
+    for (size_t i = 0; i < functions.size(); i++) {
+        const FunctionMetrics& metrics = functions[i];
+        os << std::left << std::setw(static_cast<int>(width)) << locations[i] << std::right << std::setw(7) << metrics.parameters
+           << std::setw(7) << metrics.statements << std::setw(5) << metrics.complexity << std::setw(6)
+           << metrics.nesting << std::setw(7) << metrics.fanIn << std::setw(8) << metrics.fanOut << std::setw(10)
+           << std::fixed << std::setprecision(1) << metrics.volume() << std::endl;
+        totalComplexity += metrics.complexity;
+        if (metrics.complexity > mostComplex->complexity) {
+            mostComplex = &metrics;
+        }
+    }
+    os << "Average cyclomatic complexity: " << std::fixed << std::setprecision(2)
+       << static_cast<double>(totalComplexity) / static_cast<double>(functions.size()) << "; most complex: "
+       << mostComplex->name << " (" << mostComplex->file << ":" << mostComplex->line << ", "
+       << mostComplex->complexity << ")" << std::endl;
+    os.flags(flags);
+}
+
+void CodeMetrics::writeCSV(std::ostream& os) const {
+    os << "file,function,line,parameters,statements,complexity,nesting,fan_in,fan_out,"
+          "operators,operands,distinct_operators,distinct_operands,volume,difficulty,effort\n";
+    os << std::fixed << std::setprecision(2);
+    for (const auto& metrics : functions) {
+        os << csvField(metrics.file) << ',' << csvField(metrics.name) << ',' << metrics.line << ','
+           << metrics.parameters << ',' << metrics.statements << ',' << metrics.complexity << ','
+           << metrics.nesting << ',' << metrics.fanIn << ',' << metrics.fanOut << ',' << metrics.operators << ','
+           << metrics.operands << ',' << metrics.distinctOperators << ',' << metrics.distinctOperands << ','
+           << metrics.volume() << ',' << metrics.difficulty() << ',' << metrics.effort() << '\n';
+    }
+}
+
+void CodeMetrics::writeJSON(std::ostream& os) const {
+    os << std::fixed << std::setprecision(2);
+    os << "{\n  \"functions\": [";
+    for (size_t i = 0; i < functions.size(); i++) {
+        const FunctionMetrics& metrics = functions[i];
+        os << (i == 0 ? "\n" : ",\n");
+        os << "    {\"file\": " << jsonString(metrics.file) << ", \"function\": " << jsonString(metrics.name)
+           << ", \"line\": " << metrics.line << ", \"parameters\": " << metrics.parameters
+           << ", \"statements\": " << metrics.statements << ", \"complexity\": " << metrics.complexity
+           << ", \"nesting\": " << metrics.nesting << ", \"fan_in\": " << metrics.fanIn
+           << ", \"fan_out\": " << metrics.fanOut << ", \"calls\": [";
+        for (size_t c = 0; c < metrics.callees.size(); c++) {
+            os << (c == 0 ? "" : ", ") << jsonString(metrics.callees[c]);
+        }
+        os << "], \"halstead\": {\"operators\": " << metrics.operators << ", \"operands\": " << metrics.operands
+           << ", \"distinct_operators\": " << metrics.distinctOperators
+           << ", \"distinct_operands\": " << metrics.distinctOperands << ", \"volume\": " << metrics.volume()
+           << ", \"difficulty\": " << metrics.difficulty() << ", \"effort\": " << metrics.effort() << "}}";
+    }
+    os << (functions.empty() ? "],\n" : "\n  ],\n");
+    os << "  \"errors\": [";
+    for (size_t i = 0; i < diagnostics.size(); i++) {
+        os << (i == 0 ? "" : ", ") << jsonString(diagnostics[i]);
+    }
+    os << "]\n}\n";
+}
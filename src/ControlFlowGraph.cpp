@@ -0,0 +1,246 @@
+#include "../include/ControlFlowGraph.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+// 弱拓扑序中的元素：单个块，或以某个块为头的分量
+struct WTOElement {
+    int block;
+    bool component;
+    std::vector<WTOElement> children;
+};
+
+/**
+ * Bourdoncle算法：深度优先遍历，回边指向的块成为分量头，分量内部递归地再做一次
+ */
+class WTOBuilder {
+private:
+    const std::vector<ControlFlowGraph::Block>& blocks;
+    std::vector<int> dfn;
+    std::vector<int> stack;
+    int counter = 0;
+
+    WTOElement component(int head) {
+        std::vector<WTOElement> partition;
+        for (int successor : blocks[head].successors) {
+            if (dfn[successor] == 0) {
+                visit(successor, partition);
+            }
+        }
+        std::reverse(partition.begin(), partition.end());
+        return WTOElement{head, true, std::move(partition)};
+    }
+
+public:
+    explicit WTOBuilder(const std::vector<ControlFlowGraph::Block>& blocks)
+        : blocks(blocks), dfn(blocks.size(), 0) {}
+
+    // 元素按完成的逆序追加到partition，调用者最后反转
+    int visit(int vertex, std::vector<WTOElement>& partition) {
+        stack.push_back(vertex);
+        dfn[vertex] = ++counter;
+        int head = dfn[vertex];
+        bool loop = false;
+        for (int successor : blocks[vertex].successors) {
+            int low = dfn[successor] == 0 ? visit(successor, partition) : dfn[successor];
+            if (low <= head) {
+                head = low;
+                loop = true;
+            }
+        }
+        if (head == dfn[vertex]) {
+            dfn[vertex] = INT_MAX;
+            int element = stack.back();
+            stack.pop_back();
+            if (loop) {
+                while (element != vertex) {
+                    dfn[element] = 0;
+                    element = stack.back();
+                    stack.pop_back();
+                }
+                partition.push_back(component(vertex));
+            } else {
+                partition.push_back(WTOElement{vertex, false, {}});
+            }
+        }
+        return head;
+    }
+};
+
+void flatten(const WTOElement& element, std::vector<int>& order, std::vector<int>& componentEnd) {
+    size_t position = order.size();
+    order.push_back(element.block);
+    componentEnd.push_back(-1);
+    if (!element.component) {
+        return;
+    }
+    for (const auto& child : element.children) {
+        flatten(child, order, componentEnd);
+    }
+    componentEnd[position] = static_cast<int>(order.size());
+}
+
+} // namespace
+
+// ControlFlowGraph类实现
+ControlFlowGraph::ControlFlowGraph(const FunctionDefinitionNode& function) {
+    newBlock();  // ENTRY
+    newBlock();  // EXIT
+    current = ENTRY;
+    buildStatement(function.body.get());
+    addEdge(current, EXIT);
+    computeWeakTopologicalOrder();
+}
+
+int ControlFlowGraph::newBlock() {
+    blocks.emplace_back();
+    return static_cast<int>(blocks.size()) - 1;
+}
+
+void ControlFlowGraph::addEdge(int from, int to) {
+    blocks[from].successors.push_back(to);
+    blocks[to].predecessors.push_back(from);
+}
+
+void ControlFlowGraph::buildStatement(const ASTNode* node) {
+    if (!node) {
+        return;
+    }
+    statementBlocks[node] = current;
+    switch (node->getKind()) {
+        case ASTNodeKind::CompoundStatement:
+            for (const auto& statement : static_cast<const CompoundStatementNode*>(node)->statements) {
+                buildStatement(statement.get());
+            }
+            break;
+        case ASTNodeKind::IfStatement: {
+            const auto* ifStmt = static_cast<const IfStatementNode*>(node);
+            int thenBlock = newBlock();
+            int elseBlock = ifStmt->elseStatement ? newBlock() : -1;
+            int joinBlock = newBlock();
+            blocks[current].condition = ifStmt->condition.get();
+            addEdge(current, thenBlock);
+            addEdge(current, elseBlock >= 0 ? elseBlock : joinBlock);
+            current = thenBlock;
+            buildStatement(ifStmt->thenStatement.get());
+            addEdge(current, joinBlock);
+            if (elseBlock >= 0) {
+                current = elseBlock;
+                buildStatement(ifStmt->elseStatement.get());
+                addEdge(current, joinBlock);
+            }
+            current = joinBlock;
+            break;
+        }
+        case ASTNodeKind::WhileStatement: {
+            const auto* whileStmt = static_cast<const WhileStatementNode*>(node);
+            int head = newBlock();
+            int body = newBlock();
+            int exit = newBlock();
+            addEdge(current, head);
+            blocks[head].loop = node;
+            blocks[head].condition = whileStmt->condition.get();
+            addEdge(head, body);
+            if (whileStmt->condition) {
+                addEdge(head, exit);
+            }
+            loops.push_back(LoopTargets{exit, head});
+            current = body;
+            buildStatement(whileStmt->body.get());
+            addEdge(current, head);
+            loops.pop_back();
+            current = exit;
+            break;
+        }
+        case ASTNodeKind::ForStatement: {
+            const auto* forStmt = static_cast<const ForStatementNode*>(node);
+            if (forStmt->initialization) {
+                blocks[current].statements.push_back(forStmt->initialization.get());
+            }
+            int head = newBlock();
+            int body = newBlock();
+            int update = newBlock();
+            int exit = newBlock();
+            addEdge(current, head);
+            blocks[head].loop = node;
+            blocks[head].condition = forStmt->condition.get();
+            addEdge(head, body);
+            if (forStmt->condition) {
+                addEdge(head, exit);
+            }
+            loops.push_back(LoopTargets{exit, update});
+            current = body;
+            buildStatement(forStmt->body.get());
+            addEdge(current, update);
+            loops.pop_back();
+            if (forStmt->update) {
+                blocks[update].statements.push_back(forStmt->update.get());
+            }
+            addEdge(update, head);
+            current = exit;
+            break;
+        }
+        case ASTNodeKind::ReturnStatement:
+            blocks[current].statements.push_back(node);
+            addEdge(current, EXIT);
+            current = newBlock();
+            break;
+        case ASTNodeKind::BreakStatement:
+        case ASTNodeKind::ContinueStatement:
+            // 循环外的break/continue没有目标，按空语句处理
+            if (!loops.empty()) {
+                const LoopTargets& targets = loops.back();
+                addEdge(current, node->getKind() == ASTNodeKind::BreakStatement ? targets.breakTarget
+                                                                                 : targets.continueTarget);
+                current = newBlock();
+            }
+            break;
+        case ASTNodeKind::PreprocessorDirective:
+        case ASTNodeKind::FunctionDeclaration:
+        case ASTNodeKind::FunctionDefinition:
+        case ASTNodeKind::Program:
+            break;
+        default:
+            // 变量声明、表达式语句、自增自减语句等顺序执行的语句
+            blocks[current].statements.push_back(node);
+            break;
+    }
+}
+
+void ControlFlowGraph::computeWeakTopologicalOrder() {
+    WTOBuilder builder(blocks);
+    std::vector<WTOElement> partition;
+    builder.visit(ENTRY, partition);
+    std::reverse(partition.begin(), partition.end());
+    order.clear();
+    componentEnd.clear();
+    for (const auto& element : partition) {
+        flatten(element, order, componentEnd);
+    }
+    reachable.assign(blocks.size(), false);
+    for (int block : order) {
+        reachable[block] = true;
+    }
+}
+
+const std::vector<ControlFlowGraph::Block>& ControlFlowGraph::getBlocks() const {
+    return blocks;
+}
+
+const std::vector<int>& ControlFlowGraph::getOrder() const {
+    return order;
+}
+
+const std::vector<int>& ControlFlowGraph::getComponentEnd() const {
+    return componentEnd;
+}
+
+bool ControlFlowGraph::isReachable(int block) const {
+    return block >= 0 && block < static_cast<int>(reachable.size()) && reachable[block];
+}
+
+int ControlFlowGraph::blockOf(const ASTNode* statement) const {
+    auto it = statementBlocks.find(statement);
+    return it == statementBlocks.end() ? -1 : it->second;
+}
@@ -0,0 +1,369 @@
+#include "../include/CorpusStats.h"
+#include "../include/ASTWalker.h"
+#include "../include/ASTQuery.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <cctype>
+
+namespace {
+
+const char* const BYTE_CLASS_NAMES[] = {"letter/_", "digit", "space/tab", "newline", "punctuation", "other"};
+
+int byteClass(unsigned char ch) {
+    if (std::isalpha(ch) || ch == '_') {
+        return 0;
+    }
+    if (std::isdigit(ch)) {
+        return 1;
+    }
+    if (ch == ' ' || ch == '\t' || ch == '\r') {
+        return 2;
+    }
+    if (ch == '\n') {
+        return 3;
+    }
+    if (std::ispunct(ch)) {
+        return 4;
+    }
+    return 5;
+}
+
+// 每函数语句数的桶：0, 1, 2-3, 4-7, ...
+size_t sizeBucket(size_t count) {
+    size_t bucket = 0;
+    while (count > 0 && bucket + 1 < CorpusCounters::SIZE_BUCKETS) {
+        count >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+std::string sizeBucketLabel(size_t bucket) {
+    if (bucket == 0) {
+        return "0";
+    }
+    size_t low = size_t(1) << (bucket - 1);
+    if (bucket + 1 == CorpusCounters::SIZE_BUCKETS) {
+        return std::to_string(low) + "+";
+    }
+    size_t high = (size_t(1) << bucket) - 1;
+    return low == high ? std::to_string(low) : std::to_string(low) + "-" + std::to_string(high);
+}
+
+// 表达式节点的运算符，不是运算时返回空串
+std::string operatorOf(const ASTNode& node) {
+    switch (node.getKind()) {
+        case ASTNodeKind::BinaryExpression:
+            return static_cast<const BinaryExpressionNode&>(node).operator_;
+        case ASTNodeKind::UnaryExpression:
+            return "unary " + static_cast<const UnaryExpressionNode&>(node).operator_;
+        case ASTNodeKind::Identifier: {
+            std::string variable;
+            int delta;
+            bool prefix;
+            if (!splitIncrement(static_cast<const IdentifierNode&>(node).name, variable, delta, prefix)) {
+                return "";
+            }
+            return std::string(prefix ? "prefix " : "postfix ") + (delta > 0 ? "++" : "--");
+        }
+        case ASTNodeKind::FunctionCall:
+            return "call";
+        case ASTNodeKind::IndexExpression:
+            return "[]";
+        default:
+            return "";
+    }
+}
+
+// 统计函数体中的语句：复合语句本身不计，控制语句的分支与循环体深度加1，else if 链保持同一深度
+void countStatements(const ASTNode* node, size_t depth, size_t& count, CorpusCounters& counters) {
+    if (!node) {
+        return;
+    }
+    if (node->getKind() == ASTNodeKind::CompoundStatement) {
+        for (const auto& statement : static_cast<const CompoundStatementNode*>(node)->statements) {
+            countStatements(statement.get(), depth, count, counters);
+        }
+        return;
+    }
+    count++;
+    counters.statementDepths[std::min(depth, CorpusCounters::MAX_DEPTH)]++;
+    switch (node->getKind()) {
+        case ASTNodeKind::IfStatement: {
+            // else if 链上的if与最外层的if算作同一条语句
+            const auto* ifStmt = static_cast<const IfStatementNode*>(node);
+            while (true) {
+                countStatements(ifStmt->thenStatement.get(), depth + 1, count, counters);
+                const ASTNode* elseStatement = ifStmt->elseStatement.get();
+                if (!elseStatement || elseStatement->getKind() != ASTNodeKind::IfStatement) {
+                    countStatements(elseStatement, depth + 1, count, counters);
+                    break;
+                }
+                ifStmt = static_cast<const IfStatementNode*>(elseStatement);
+            }
+            break;
+        }
+        case ASTNodeKind::WhileStatement:
+            countStatements(static_cast<const WhileStatementNode*>(node)->body.get(), depth + 1, count, counters);
+            break;
+        case ASTNodeKind::ForStatement:
+            countStatements(static_cast<const ForStatementNode*>(node)->body.get(), depth + 1, count, counters);
+            break;
+        default:
+            break;
+    }
+}
+
+// 直方图的一行：标签、计数、占比与按最大值缩放的条形
+void printRow(std::ostream& os, const std::string& label, size_t count, size_t total, size_t maximum) {
+    constexpr size_t BAR_WIDTH = 30;
+    size_t bar = maximum == 0 ? 0 : (count * BAR_WIDTH + maximum - 1) / maximum;
+    double percent = total == 0 ? 0.0 : 100.0 * count / total;
+    os << "  " << std::left << std::setw(18) << label << std::right << std::setw(10) << count << std::setw(7)
+       << std::fixed << std::setprecision(1) << percent << "%  " << std::string(bar, '#') << std::endl;
+}
+
+void printRanked(std::ostream& os, const std::string& title, std::vector<std::pair<std::string, size_t>> rows,
+                 size_t limit) {
+    std::stable_sort(rows.begin(), rows.end(), [](const std::pair<std::string, size_t>& a,
+                                                  const std::pair<std::string, size_t>& b) {
+        return a.second > b.second;
+    });
+    size_t total = 0;
+    for (const auto& row : rows) {
+        total += row.second;
+    }
+    os << "\n" << title << " (" << total << "):" << std::endl;
+    size_t maximum = rows.empty() ? 0 : rows.front().second;
+    for (size_t i = 0; i < rows.size() && i < limit; i++) {
+        if (rows[i].second > 0) {
+            printRow(os, rows[i].first, rows[i].second, total, maximum);
+        }
+    }
+}
+
+// 长度直方图，附带均值与分位数
+template <size_t N>
+void printLengths(std::ostream& os, const std::string& title, const std::array<size_t, N>& histogram) {
+    size_t total = 0;
+    size_t sum = 0;
+    size_t maximum = 0;
+    for (size_t length = 0; length < N; length++) {
+        total += histogram[length];
+        sum += histogram[length] * length;
+        maximum = std::max(maximum, histogram[length]);
+    }
+    auto percentile = [&](double fraction) {
+        size_t seen = 0;
+        for (size_t length = 0; length < N; length++) {
+            seen += histogram[length];
+            if (seen >= fraction * total) {
+                return length;
+            }
+        }
+        return N - 1;
+    };
+    os << "\n" << title << " (" << total << ")";
+    if (total > 0) {
+        os << ": mean " << std::fixed << std::setprecision(1) << static_cast<double>(sum) / total << ", median "
+           << percentile(0.5) << ", p90 " << percentile(0.9) << ", p99 " << percentile(0.99);
+    }
+    os << std::endl;
+    for (size_t length = 0; length < N; length++) {
+        if (histogram[length] > 0) {
+            std::string label = std::to_string(length) + (length + 1 == N ? "+" : "");
+            printRow(os, label, histogram[length], total, maximum);
+        }
+    }
+}
+
+} // namespace
+
+// CorpusCounters实现
+void CorpusCounters::merge(const CorpusCounters& other) {
+    files += other.files;
+    failed += other.failed;
+    bytes += other.bytes;
+    lines += other.lines;
+    functions += other.functions;
+    statements += other.statements;
+    auto add = [](auto& into, const auto& from) {
+        for (size_t i = 0; i < into.size(); i++) {
+            into[i] += from[i];
+        }
+    };
+    add(byteClasses, other.byteClasses);
+    add(tokenKinds, other.tokenKinds);
+    add(identifierLengths, other.identifierLengths);
+    add(literalLengths, other.literalLengths);
+    add(nodeKinds, other.nodeKinds);
+    add(statementDepths, other.statementDepths);
+    add(functionSizes, other.functionSizes);
+    for (const auto& entry : other.operators) {
+        operators[entry.first] += entry.second;
+    }
+    for (const auto& entry : other.operatorPairs) {
+        operatorPairs[entry.first] += entry.second;
+    }
+}
+
+// CorpusStats类实现
+CorpusStats::CorpusStats(size_t threadCount)
+    : threadCount(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount) {}
+
+void CorpusStats::countUnit(const ParsedUnit& unit, CorpusCounters& counters) {
+    const std::string& source = unit.source;
+    counters.files++;
+    counters.bytes += source.size();
+    for (unsigned char ch : source) {
+        counters.byteClasses[byteClass(ch)]++;
+    }
+    counters.lines += std::count(source.begin(), source.end(), '\n') +
+                      (!source.empty() && source.back() != '\n' ? 1 : 0);
+
+    for (const auto& token : unit.tokens) {
+        if (token.fileId != 0) {
+            continue;  // 包含进来的文件由以它为输入的统计计入
+        }
+        counters.tokenKinds[static_cast<size_t>(token.type)]++;
+        size_t length = std::min(token.value.size(), CorpusCounters::MAX_LENGTH);
+        if (token.type == TokenType::IDENTIFIER) {
+            counters.identifierLengths[length]++;
+        } else if (token.type == TokenType::INTEGER || token.type == TokenType::FLOAT ||
+                   token.type == TokenType::STRING) {
+            counters.literalLengths[length]++;
+        }
+    }
+    if (!unit.program || !unit.diagnostics.empty()) {
+        counters.failed++;
+        return;  // 语法树不完整，只计入token
+    }
+
+    walkAST(*unit.program, [&counters](const ASTNode& node) {
+        if (node.fileId != 0) {
+            return false;
+        }
+        counters.nodeKinds[static_cast<size_t>(node.getKind())]++;
+        std::string op = operatorOf(node);
+        if (op.empty()) {
+            return true;
+        }
+        counters.operators[op]++;
+        if (node.getKind() == ASTNodeKind::BinaryExpression || node.getKind() == ASTNodeKind::UnaryExpression) {
+            forEachChild(node, [&counters, &op](const ASTNode& child) {
+                std::string inner = operatorOf(child);
+                if (!inner.empty()) {
+                    counters.operatorPairs[op + " (" + inner + ")"]++;
+                }
+            });
+        }
+        return true;
+    });
+    for (const FunctionDefinitionNode* function : unit.definedFunctions()) {
+        size_t count = 0;
+        countStatements(function->body.get(), 0, count, counters);
+        counters.functions++;
+        counters.statements += count;
+        counters.functionSizes[sizeBucket(count)]++;
+    }
+}
+
+void CorpusStats::analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd) {
+    totals = CorpusCounters();
+    diagnostics.clear();
+
+    // 工作线程按原子下标领取文件，各自累加到自己的计数器
+    size_t workers = std::min(threadCount, std::max<size_t>(1, paths.size()));
+    std::vector<CorpusCounters> perThread(workers);
+    std::vector<std::vector<std::string>> perFileDiagnostics(paths.size());
+    std::atomic<size_t> next{0};
+    ThreadPool pool(workers);
+    pool.parallelFor(workers, [&](size_t worker) {
+        CorpusCounters& counters = perThread[worker];
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            ParsedUnit unit;
+            if (frontEnd.parseUnit(paths[i], unit)) {
+                countUnit(unit, counters);
+            } else {
+                counters.files++;
+                counters.failed++;
+            }
+            perFileDiagnostics[i] = std::move(unit.diagnostics);
+        }
+    });
+
+    for (const auto& counters : perThread) {
+        totals.merge(counters);
+    }
+    for (const auto& fileDiagnostics : perFileDiagnostics) {
+        diagnostics.insert(diagnostics.end(), fileDiagnostics.begin(), fileDiagnostics.end());
+    }
+}
+
+const CorpusCounters& CorpusStats::getTotals() const {
+    return totals;
+}
+
+const std::vector<std::string>& CorpusStats::getDiagnostics() const {
+    return diagnostics;
+}
+
+void CorpusStats::printReport(std::ostream& os) const {
+    const CorpusCounters& c = totals;
+    size_t tokenTotal = 0;
+    for (size_t count : c.tokenKinds) {
+        tokenTotal += count;
+    }
+    os << "\n=== Corpus Statistics ===" << std::endl;
+    os << "Files: " << c.files << " (" << c.failed << " with errors), bytes: " << c.bytes << ", lines: " << c.lines
+       << ", tokens: " << tokenTotal << ", functions: " << c.functions << ", statements: " << c.statements
+       << " (threads: " << threadCount << ")" << std::endl;
+    for (const auto& diagnostic : diagnostics) {
+        os << "  [error] " << diagnostic << std::endl;
+    }
+
+    std::vector<std::pair<std::string, size_t>> rows;
+    for (size_t i = 0; i < c.byteClasses.size(); i++) {
+        rows.emplace_back(BYTE_CLASS_NAMES[i], c.byteClasses[i]);
+    }
+    printRanked(os, "Source bytes by class", rows, rows.size());
+
+    rows.clear();
+    for (size_t i = 0; i < CorpusCounters::TOKEN_KINDS; i++) {
+        rows.emplace_back(TokenTypeUtils::tokenTypeToString(static_cast<TokenType>(i)), c.tokenKinds[i]);
+    }
+    printRanked(os, "Token kinds", rows, rows.size());
+
+    printLengths(os, "Identifier lengths", c.identifierLengths);
+    printLengths(os, "Literal lengths", c.literalLengths);
+
+    rows.clear();
+    for (size_t i = 0; i < CorpusCounters::NODE_KINDS; i++) {
+        rows.emplace_back(ASTQuery::kindName(static_cast<ASTNodeKind>(i)), c.nodeKinds[i]);
+    }
+    printRanked(os, "AST node kinds", rows, rows.size());
+
+    printRanked(os, "Operators", {c.operators.begin(), c.operators.end()}, 20);
+    printRanked(os, "Operator pairs (outer (operand))", {c.operatorPairs.begin(), c.operatorPairs.end()}, 15);
+
+    size_t maximum = *std::max_element(c.statementDepths.begin(), c.statementDepths.end());
+    os << "\nStatement nesting depth (" << c.statements << "):" << std::endl;
+    for (size_t depth = 0; depth <= CorpusCounters::MAX_DEPTH; depth++) {
+        if (c.statementDepths[depth] > 0) {
+            std::string label = std::to_string(depth) + (depth == CorpusCounters::MAX_DEPTH ? "+" : "");
+            printRow(os, label, c.statementDepths[depth], c.statements, maximum);
+        }
+    }
+
+    maximum = *std::max_element(c.functionSizes.begin(), c.functionSizes.end());
+    os << "\nStatements per function (" << c.functions << " functions):" << std::endl;
+    for (size_t bucket = 0; bucket < CorpusCounters::SIZE_BUCKETS; bucket++) {
+        if (c.functionSizes[bucket] > 0) {
+            printRow(os, sizeBucketLabel(bucket), c.functionSizes[bucket], c.functions, maximum);
+        }
+    }
+    os << std::defaultfloat;
+}
@@ -0,0 +1,858 @@
+#include "../include/CostEstimator.h"
+#include "../include/IntervalAnalyzer.h"
+#include "../include/ASTWalker.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const double EPSILON = 1e-9;
+
+// 比较if两个分支时未知符号取的值
+const double BRANCH_ASSUMED = 100.0;
+
+std::string formatNumber(double value) {
+    char buffer[32];
+    if (std::fabs(value - std::round(value)) < EPSILON && std::fabs(value) < 1e15) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f", value);
+    } else if (std::fabs(value) < 1e6) {
+        std::snprintf(buffer, sizeof(buffer), "%.2f", value);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.3g", value);
+    }
+    return buffer;
+}
+
+// 0^p + 1^p + ... + (count-1)^p：Faulhaber公式展开为count的多项式
+CostExpression powerSum(size_t power, const CostExpression& count) {
+    static const double BERNOULLI[] = {1.0, -1.0 / 2, 1.0 / 6, 0.0, -1.0 / 30, 0.0, 1.0 / 42, 0.0, -1.0 / 30, 0.0, 5.0 / 66};
+    CostExpression result;
+    if (power >= sizeof(BERNOULLI) / sizeof(BERNOULLI[0])) {
+        // 次数过高时取上界 count^(power+1)
+        result = CostExpression::constant(1);
+        for (size_t i = 0; i <= power; i++) {
+            result = result * count;
+        }
+        return result;
+    }
+    double binomial = 1.0;  // C(power+1, j)
+    for (size_t j = 0; j <= power; j++) {
+        CostExpression term = CostExpression::constant(binomial * BERNOULLI[j] / static_cast<double>(power + 1));
+        for (size_t i = j; i <= power; i++) {
+            term = term * count;
+        }
+        result = result + term;
+        binomial = binomial * static_cast<double>(power + 1 - j) / static_cast<double>(j + 1);
+    }
+    return result;
+}
+
+// 节点是自增自减时返回变量名与步长
+bool incrementOf(const ASTNode& node, std::string& variable, int& delta) {
+    bool prefix;
+    return node.getKind() == ASTNodeKind::Identifier &&
+           splitIncrement(static_cast<const IdentifierNode&>(node).name, variable, delta, prefix);
+}
+
+// 赋值语句 "x = ..." 的右边，不是赋值时返回nullptr
+const ASTNode* assignmentTo(const ASTNode& node, std::string& variable) {
+    const ASTNode* current = &node;
+    if (current->getKind() == ASTNodeKind::ExpressionStatement) {
+        current = static_cast<const ExpressionStatementNode*>(current)->expression.get();
+    }
+    if (!current) {
+        return nullptr;
+    }
+    if (current->getKind() == ASTNodeKind::Assignment) {
+        const auto* assignment = static_cast<const AssignmentNode*>(current);
+        variable = assignment->identifier;
+        return assignment->expression.get();
+    }
+    if (current->getKind() == ASTNodeKind::BinaryExpression) {
+        const auto* binary = static_cast<const BinaryExpressionNode*>(current);
+        if (binary->operator_ == "=" && binary->left && binary->left->getKind() == ASTNodeKind::Identifier) {
+            variable = static_cast<const IdentifierNode&>(*binary->left).name;
+            return binary->right.get();
+        }
+    }
+    return nullptr;
+}
+
+// 一条步进语句：i++ / ++i / i-- / --i / i = i + c / i = i - c
+bool stepOf(const ASTNode& node, const std::string& variable, int64_t& delta) {
+    const ASTNode* current = &node;
+    if (current->getKind() == ASTNodeKind::ExpressionStatement) {
+        current = static_cast<const ExpressionStatementNode*>(current)->expression.get();
+    }
+    if (!current) {
+        return false;
+    }
+    std::string name;
+    int unit;
+    if (incrementOf(*current, name, unit)) {
+        delta = unit;
+        return name == variable;
+    }
+    const ASTNode* value = assignmentTo(*current, name);
+    if (!value || name != variable || value->getKind() != ASTNodeKind::BinaryExpression) {
+        return false;
+    }
+    const auto& binary = static_cast<const BinaryExpressionNode&>(*value);
+    if ((binary.operator_ != "+" && binary.operator_ != "-") || !binary.left || !binary.right ||
+        binary.left->getKind() != ASTNodeKind::Identifier ||
+        static_cast<const IdentifierNode&>(*binary.left).name != variable ||
+        binary.right->getKind() != ASTNodeKind::Literal ||
+        static_cast<const LiteralNode&>(*binary.right).type != TokenType::INTEGER) {
+        return false;
+    }
+    delta = std::strtoll(static_cast<const LiteralNode&>(*binary.right).value.c_str(), nullptr, 10);
+    if (binary.operator_ == "-") {
+        delta = -delta;
+    }
+    return delta != 0;
+}
+
+// 子树中对variable的写入次数（赋值、自增自减与重新声明）
+size_t writesTo(const ASTNode* root, const std::string& variable) {
+    size_t count = 0;
+    if (!root) {
+        return count;
+    }
+    walkAST(*root, [&count, &variable](const ASTNode& node) {
+        std::string name;
+        int delta;
+        if (node.getKind() == ASTNodeKind::ExpressionStatement) {
+            return true;  // 赋值在表达式节点上计数
+        }
+        if (incrementOf(node, name, delta) || assignmentTo(node, name)) {
+            count += name == variable;
+        } else if (node.getKind() == ASTNodeKind::VarDeclaration) {
+            count += static_cast<const VarDeclarationNode&>(node).identifier == variable;
+        }
+        return true;
+    });
+    return count;
+}
+
+/**
+ * 按嵌套组合一个函数的代价
+ */
+class CostBuilder {
+private:
+    const FunctionDefinitionNode& function;
+    const std::vector<Token>& tokens;
+    std::vector<LoopHeadState> heads;
+    FunctionCost& result;
+
+    const LoopHeadState* headOf(const ASTNode* loop) const {
+        for (const auto& head : heads) {
+            if (head.loop == loop) {
+                return &head;
+            }
+        }
+        return nullptr;
+    }
+
+    static Interval rangeAt(const LoopHeadState* head, const std::string& name) {
+        if (head) {
+            for (const auto& bound : head->bounds) {
+                if (bound.first == name) {
+                    return bound.second;
+                }
+            }
+        }
+        return Interval::top();
+    }
+
+    // 表达式中每个调用计入被调用函数的代价：记为符号 "name(实参)"，实参相同的调用共用一个符号
+    CostExpression callsIn(const ASTNode* node) {
+        CostExpression cost;
+        if (!node) {
+            return cost;
+        }
+        walkAST(*node, [this, &cost](const ASTNode& current) {
+            if (current.getKind() != ASTNodeKind::FunctionCall) {
+                return true;
+            }
+            const auto& call = static_cast<const FunctionCallNode&>(current);
+            CallSite site;
+            site.callee = call.name;
+            site.symbol = call.name + "(";
+            for (size_t i = 0; i < call.arguments.size(); i++) {
+                site.arguments.push_back(toExpression(call.arguments[i].get(), nullptr));
+                site.symbol += (i > 0 ? ", " : "") + site.arguments.back().toString();
+            }
+            site.symbol += ")";
+            auto known = std::find_if(result.calls.begin(), result.calls.end(),
+                                      [&site](const CallSite& other) { return other.symbol == site.symbol; });
+            if (known == result.calls.end()) {
+                result.calls.push_back(site);
+            }
+            cost = cost + CostExpression::symbol(site.symbol);
+            return true;
+        });
+        return cost;
+    }
+
+    // 循环头处为常量的变量直接代入，其余保留为符号；无法表示为多项式的部分整体作为一个符号
+    CostExpression toExpression(const ASTNode* node, const LoopHeadState* head) const {
+        if (!node) {
+            return CostExpression::constant(0);
+        }
+        switch (node->getKind()) {
+            case ASTNodeKind::Literal: {
+                const auto* literal = static_cast<const LiteralNode*>(node);
+                if (literal->type == TokenType::INTEGER) {
+                    return CostExpression::constant(std::strtod(literal->value.c_str(), nullptr));
+                }
+                break;
+            }
+            case ASTNodeKind::Identifier: {
+                const std::string& name = static_cast<const IdentifierNode*>(node)->name;
+                std::string variable;
+                int delta;
+                if (incrementOf(*node, variable, delta)) {
+                    break;
+                }
+                Interval range = rangeAt(head, name);
+                return range.isConstant() ? CostExpression::constant(static_cast<double>(range.lo))
+                                          : CostExpression::symbol(name);
+            }
+            case ASTNodeKind::UnaryExpression: {
+                const auto* unary = static_cast<const UnaryExpressionNode*>(node);
+                if (unary->operator_ == "-") {
+                    return toExpression(unary->operand.get(), head).scaled(-1);
+                }
+                break;
+            }
+            case ASTNodeKind::BinaryExpression: {
+                const auto* binary = static_cast<const BinaryExpressionNode*>(node);
+                if (binary->operator_ == "+") {
+                    return toExpression(binary->left.get(), head) + toExpression(binary->right.get(), head);
+                }
+                if (binary->operator_ == "-") {
+                    return toExpression(binary->left.get(), head) - toExpression(binary->right.get(), head);
+                }
+                if (binary->operator_ == "*") {
+                    return toExpression(binary->left.get(), head) * toExpression(binary->right.get(), head);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        return CostExpression::symbol("(" + sourceText(*node, tokens, 40) + ")");
+    }
+
+    // 循环开始前最后一次给variable赋的值：for的初始化，或同一语句块中前面最近的声明与赋值
+    static const ASTNode* initialValue(const ASTNode* loop, const std::string& variable,
+                                       const std::vector<std::unique_ptr<ASTNode>>* siblings, size_t index) {
+        if (loop->getKind() == ASTNodeKind::ForStatement) {
+            const ASTNode* init = static_cast<const ForStatementNode*>(loop)->initialization.get();
+            if (init && init->getKind() == ASTNodeKind::VarDeclaration) {
+                const auto* var = static_cast<const VarDeclarationNode*>(init);
+                return var->identifier == variable ? var->initializer.get() : nullptr;
+            }
+            if (init) {
+                return nullptr;
+            }
+        }
+        for (size_t i = index; siblings && i-- > 0;) {
+            const ASTNode* statement = (*siblings)[i].get();
+            if (!statement || writesTo(statement, variable) == 0) {
+                continue;
+            }
+            if (statement->getKind() == ASTNodeKind::VarDeclaration) {
+                return static_cast<const VarDeclarationNode*>(statement)->initializer.get();
+            }
+            std::string name;
+            return assignmentTo(*statement, name);
+        }
+        return nullptr;
+    }
+
+    // 识别计数循环并求出次数
+    bool countedTrips(const ASTNode* loop, const std::vector<std::unique_ptr<ASTNode>>* siblings, size_t index,
+                      std::string& variable, CostExpression& trips, CostExpression& first, int64_t& step) const {
+        const ASTNode* condition = nullptr;
+        const ASTNode* body = nullptr;
+        const ASTNode* update = nullptr;
+        if (loop->getKind() == ASTNodeKind::ForStatement) {
+            const auto* forStmt = static_cast<const ForStatementNode*>(loop);
+            condition = forStmt->condition.get();
+            body = forStmt->body.get();
+            update = forStmt->update.get();
+        } else {
+            const auto* whileStmt = static_cast<const WhileStatementNode*>(loop);
+            condition = whileStmt->condition.get();
+            body = whileStmt->body.get();
+        }
+        if (!condition || condition->getKind() != ASTNodeKind::BinaryExpression) {
+            return false;
+        }
+        const auto& comparison = static_cast<const BinaryExpressionNode&>(*condition);
+        if (!isComparison(comparison.operator_) || !comparison.left || !comparison.right) {
+            return false;
+        }
+
+        // 计数变量：比较的一边，且由for的更新部分或循环体顶层的一条步进语句修改
+        std::vector<const ASTNode*> steps;
+        if (update) {
+            steps.push_back(update);
+        }
+        if (body && body->getKind() == ASTNodeKind::CompoundStatement) {
+            for (const auto& statement : static_cast<const CompoundStatementNode*>(body)->statements) {
+                steps.push_back(statement.get());
+            }
+        } else if (body) {
+            steps.push_back(body);
+        }
+        const ASTNode* sides[2] = {comparison.left.get(), comparison.right.get()};
+        for (int side = 0; side < 2; side++) {
+            if (sides[side]->getKind() != ASTNodeKind::Identifier) {
+                continue;
+            }
+            std::string name = static_cast<const IdentifierNode*>(sides[side])->name;
+            int64_t delta = 0;
+            size_t stepCount = 0;
+            for (const ASTNode* statement : steps) {
+                int64_t step;
+                if (statement && stepOf(*statement, name, step)) {
+                    delta = step;
+                    stepCount++;
+                }
+            }
+            if (stepCount != 1 || writesTo(body, name) + writesTo(update, name) != 1) {
+                continue;
+            }
+            const ASTNode* boundNode = sides[1 - side];
+            // 终点不能在循环中改变
+            bool invariant = true;
+            walkAST(*boundNode, [&](const ASTNode& node) {
+                if (node.getKind() == ASTNodeKind::Identifier &&
+                    (writesTo(body, static_cast<const IdentifierNode&>(node).name) > 0 ||
+                     writesTo(update, static_cast<const IdentifierNode&>(node).name) > 0)) {
+                    invariant = false;
+                }
+                return invariant;
+            });
+            std::string op = side == 0 ? comparison.operator_ : swapComparison(comparison.operator_);
+            bool increasing = delta > 0;
+            bool matches = op == "!=" ? (delta == 1 || delta == -1)
+                                      : increasing ? (op == "<" || op == "<=") : (op == ">" || op == ">=");
+            if (!invariant || !matches) {
+                continue;
+            }
+
+            // 起点：循环头处区间在出发方向上的端点即初值，否则用初始化表达式，再否则为符号
+            const LoopHeadState* head = headOf(loop);
+            Interval range = rangeAt(head, name);
+            CostExpression start;
+            if (increasing && range.lo != Interval::NEG_INF && !range.isBottom()) {
+                start = CostExpression::constant(static_cast<double>(range.lo));
+            } else if (!increasing && range.hi != Interval::POS_INF && !range.isBottom()) {
+                start = CostExpression::constant(static_cast<double>(range.hi));
+            } else if (const ASTNode* init = initialValue(loop, name, siblings, index)) {
+                start = toExpression(init, head);
+            } else {
+                start = CostExpression::symbol(name);
+            }
+            CostExpression end = toExpression(boundNode, head);
+            CostExpression distance = increasing ? end - start : start - end;
+            if (op == "<=" || op == ">=") {
+                distance = distance + CostExpression::constant(1);
+            }
+            double stride = static_cast<double>(delta > 0 ? delta : -delta);
+            if (distance.isConstant()) {
+                double value = distance.constantTerm();
+                trips = CostExpression::constant(value <= 0 ? 0 : std::ceil(value / stride));
+            } else {
+                trips = distance.scaled(1.0 / stride);
+            }
+            variable = name;
+            first = start;
+            step = delta;
+            return true;
+        }
+        return false;
+    }
+
+    CostExpression loopCost(const ASTNode* loop, const std::vector<std::unique_ptr<ASTNode>>* siblings,
+                            size_t index) {
+        size_t slot = result.loops.size();
+        result.loops.emplace_back();
+        LoopEstimate estimate;
+        estimate.line = loop->line;
+        estimate.kind = loop->getKind() == ASTNodeKind::ForStatement ? "for" : "while";
+        CostExpression first;
+        int64_t step = 0;
+        estimate.counted = countedTrips(loop, siblings, index, estimate.variable, estimate.trips, first, step);
+        if (!estimate.counted) {
+            estimate.trips = CostExpression::symbol("loop@" + std::to_string(loop->line));
+        }
+
+        CostExpression once;       // 只执行一次：初始化与最后一次不成立的判断
+        CostExpression iteration;  // 每次迭代：判断、循环体与更新
+        if (loop->getKind() == ASTNodeKind::ForStatement) {
+            const auto* forStmt = static_cast<const ForStatementNode*>(loop);
+            if (forStmt->initialization) {
+                once = CostExpression::constant(1) + callsIn(forStmt->initialization.get());
+            }
+            CostExpression check = CostExpression::constant(1) + callsIn(forStmt->condition.get());
+            once = once + check;
+            iteration = check + statementCost(forStmt->body.get(), nullptr, 0);
+            if (forStmt->update) {
+                iteration = iteration + CostExpression::constant(1) + callsIn(forStmt->update.get());
+            }
+        } else {
+            const auto* whileStmt = static_cast<const WhileStatementNode*>(loop);
+            CostExpression check = CostExpression::constant(1) + callsIn(whileStmt->condition.get());
+            once = check;
+            iteration = check + statementCost(whileStmt->body.get(), nullptr, 0);
+        }
+        CostExpression trips = estimate.trips;
+        std::string variable = estimate.variable;
+        result.loops[slot] = std::move(estimate);
+        if (variable.empty()) {
+            return once + trips * iteration;
+        }
+        // 计数循环按计数变量的每个取值求和；调用的代价可能依赖计数变量，展开后才能求和
+        if (pending(iteration)) {
+            LoopSum sum;
+            sum.symbol = "sum#" + std::to_string(result.sums.size());
+            sum.variable = variable;
+            sum.first = first;
+            sum.step = static_cast<double>(step);
+            sum.trips = trips;
+            sum.iteration = iteration;
+            result.sums.push_back(sum);
+            return once + CostExpression::symbol(sum.symbol);
+        }
+        return once + iteration.summed(variable, first, static_cast<double>(step), trips);
+    }
+
+    // 含尚未展开的调用或求和
+    bool pending(const CostExpression& cost) const {
+        for (const auto& name : cost.symbols()) {
+            if (name.compare(0, 4, "sum#") == 0 ||
+                std::any_of(result.calls.begin(), result.calls.end(),
+                            [&name](const CallSite& site) { return site.symbol == name; })) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    CostBuilder(const FunctionDefinitionNode& function, const std::vector<Token>& tokens, FunctionCost& result)
+        : function(function), tokens(tokens), result(result) {
+        std::vector<IntervalFinding> findings;
+        IntervalStats stats;
+        IntervalAnalyzer::analyzeFunction(function, tokens, findings, stats, &heads);
+    }
+
+    CostExpression statementCost(const ASTNode* node, const std::vector<std::unique_ptr<ASTNode>>* siblings,
+                                 size_t index) {
+        if (!node) {
+            return CostExpression();
+        }
+        switch (node->getKind()) {
+            case ASTNodeKind::CompoundStatement: {
+                const auto& statements = static_cast<const CompoundStatementNode*>(node)->statements;
+                CostExpression total;
+                for (size_t i = 0; i < statements.size(); i++) {
+                    total = total + statementCost(statements[i].get(), &statements, i);
+                }
+                return total;
+            }
+            case ASTNodeKind::IfStatement: {
+                const auto* ifStmt = static_cast<const IfStatementNode*>(node);
+                CostExpression thenCost = statementCost(ifStmt->thenStatement.get(), nullptr, 0);
+                CostExpression elseCost = statementCost(ifStmt->elseStatement.get(), nullptr, 0);
+                std::unordered_map<std::string, double> none;
+                bool thenHeavier = thenCost.evaluate(none, BRANCH_ASSUMED) >= elseCost.evaluate(none, BRANCH_ASSUMED);
+                return CostExpression::constant(1) + callsIn(ifStmt->condition.get()) +
+                       (thenHeavier ? thenCost : elseCost);
+            }
+            case ASTNodeKind::ForStatement:
+            case ASTNodeKind::WhileStatement:
+                return loopCost(node, siblings, index);
+            case ASTNodeKind::PreprocessorDirective:
+            case ASTNodeKind::FunctionDeclaration:
+            case ASTNodeKind::FunctionDefinition:
+                return CostExpression();
+            default:
+                return CostExpression::constant(1) + callsIn(node);
+        }
+    }
+
+    void build() {
+        result.name = function.name;
+        result.line = function.line;
+        for (const auto& parameter : function.parameters) {
+            result.parameters.push_back(parameter->getKind() == ASTNodeKind::ArrayDeclaration
+                                            ? static_cast<const ArrayDeclarationNode&>(*parameter).identifier
+                                            : static_cast<const VarDeclarationNode&>(*parameter).identifier);
+        }
+        result.cost = statementCost(function.body.get(), nullptr, 0);
+    }
+};
+
+} // namespace
+
+// CostExpression实现
+CostExpression CostExpression::constant(double value) {
+    CostExpression result;
+    if (std::fabs(value) > EPSILON) {
+        result.terms[{}] = value;
+    }
+    return result;
+}
+
+CostExpression CostExpression::symbol(const std::string& name) {
+    CostExpression result;
+    result.terms[{name}] = 1.0;
+    return result;
+}
+
+CostExpression CostExpression::operator+(const CostExpression& other) const {
+    CostExpression result = *this;
+    for (const auto& term : other.terms) {
+        double& coefficient = result.terms[term.first];
+        coefficient += term.second;
+        if (std::fabs(coefficient) <= EPSILON) {
+            result.terms.erase(term.first);
+        }
+    }
+    return result;
+}
+
+CostExpression CostExpression::operator-(const CostExpression& other) const {
+    return *this + other.scaled(-1);
+}
+
+CostExpression CostExpression::operator*(const CostExpression& other) const {
+    CostExpression result;
+    for (const auto& left : terms) {
+        for (const auto& right : other.terms) {
+            std::vector<std::string> monomial = left.first;
+            monomial.insert(monomial.end(), right.first.begin(), right.first.end());
+            std::sort(monomial.begin(), monomial.end());
+            CostExpression product;
+            product.terms[monomial] = left.second * right.second;
+            result = result + product;
+        }
+    }
+    return result;
+}
+
+CostExpression CostExpression::scaled(double factor) const {
+    CostExpression result;
+    if (std::fabs(factor) <= EPSILON) {
+        return result;
+    }
+    for (const auto& term : terms) {
+        result.terms[term.first] = term.second * factor;
+    }
+    return result;
+}
+
+bool CostExpression::isConstant() const {
+    return terms.empty() || (terms.size() == 1 && terms.begin()->first.empty());
+}
+
+double CostExpression::constantTerm() const {
+    auto it = terms.find({});
+    return it == terms.end() ? 0.0 : it->second;
+}
+
+std::vector<std::string> CostExpression::symbols() const {
+    std::vector<std::string> result;
+    for (const auto& term : terms) {
+        result.insert(result.end(), term.first.begin(), term.first.end());
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+CostExpression CostExpression::substitute(const std::unordered_map<std::string, CostExpression>& values) const {
+    CostExpression result;
+    for (const auto& term : terms) {
+        CostExpression product = constant(term.second);
+        for (const auto& name : term.first) {
+            auto it = values.find(name);
+            product = product * (it == values.end() ? symbol(name) : it->second);
+        }
+        result = result + product;
+    }
+    return result;
+}
+
+CostExpression CostExpression::summed(const std::string& variable, const CostExpression& first, double step,
+                                      const CostExpression& count) const {
+    // variable = first + step*k，k = 0 .. count-1；按k的次数分组后逐组用幂和公式求和
+    const std::string index = "#k";
+    CostExpression expanded = substitute({{variable, first + symbol(index).scaled(step)}});
+    std::vector<CostExpression> byPower;
+    for (const auto& term : expanded.terms) {
+        std::vector<std::string> names;
+        size_t power = 0;
+        for (const auto& name : term.first) {
+            if (name == index) {
+                power++;
+            } else {
+                names.push_back(name);
+            }
+        }
+        if (byPower.size() <= power) {
+            byPower.resize(power + 1);
+        }
+        CostExpression part;
+        part.terms[names] = term.second;
+        byPower[power] = byPower[power] + part;
+    }
+    CostExpression result;
+    for (size_t power = 0; power < byPower.size(); power++) {
+        result = result + byPower[power] * powerSum(power, count);
+    }
+    return result;
+}
+
+double CostExpression::evaluate(const std::unordered_map<std::string, double>& values, double assumed) const {
+    double total = 0.0;
+    for (const auto& term : terms) {
+        double product = term.second;
+        for (const auto& name : term.first) {
+            auto it = values.find(name);
+            product *= it == values.end() ? assumed : it->second;
+        }
+        total += product;
+    }
+    return total;
+}
+
+std::string CostExpression::toString() const {
+    if (terms.empty()) {
+        return "0";
+    }
+    // 次数高的项在前，同次数中正系数在前
+    std::vector<const std::pair<const std::vector<std::string>, double>*> ordered;
+    for (const auto& term : terms) {
+        ordered.push_back(&term);
+    }
+    std::stable_sort(ordered.begin(), ordered.end(), [](const auto* a, const auto* b) {
+        if (a->first.size() != b->first.size()) {
+            return a->first.size() > b->first.size();
+        }
+        return (a->second > 0) > (b->second > 0);
+    });
+    std::string text;
+    for (const auto* term : ordered) {
+        double coefficient = term->second;
+        if (text.empty()) {
+            text = coefficient < 0 ? "-" : "";
+        } else {
+            text += coefficient < 0 ? " - " : " + ";
+        }
+        coefficient = std::fabs(coefficient);
+        std::string factors;
+        const std::vector<std::string>& names = term->first;
+        for (size_t i = 0; i < names.size();) {
+            size_t j = i;
+            while (j < names.size() && names[j] == names[i]) {
+                j++;
+            }
+            factors += (factors.empty() ? "" : "*") + names[i];
+            if (j - i > 1) {
+                factors += "^" + std::to_string(j - i);
+            }
+            i = j;
+        }
+        if (factors.empty()) {
+            text += formatNumber(coefficient);
+        } else if (std::fabs(coefficient - 1.0) <= EPSILON) {
+            text += factors;
+        } else {
+            text += formatNumber(coefficient) + "*" + factors;
+        }
+    }
+    return text;
+}
+
+// CostEstimator类实现
+CostEstimator::CostEstimator(size_t threadCount, double limit, double assumed, bool assumeUnbounded)
+    : threadCount(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount), limit(limit),
+      assumed(assumed), assumeUnbounded(assumeUnbounded) {}
+
+FunctionCost CostEstimator::estimateFunction(const FunctionDefinitionNode& function,
+                                             const std::vector<Token>& tokens) {
+    FunctionCost result;
+    CostBuilder builder(function, tokens, result);
+    builder.build();
+    return result;
+}
+
+void CostEstimator::analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, CostStats& stats) {
+    stats = CostStats();
+    stats.files = paths.size();
+    functions.clear();
+    diagnostics.clear();
+
+    std::vector<std::vector<FunctionCost>> perFile(paths.size());
+    stats.failed = frontEnd.parseUnits(paths, threadCount, [&](size_t i, const ParsedUnit& unit) {
+        const std::vector<Token>& tokens = unit.tokens;
+        for (const FunctionDefinitionNode* function : unit.definedFunctions()) {
+            perFile[i].push_back(estimateFunction(*function, tokens));
+            perFile[i].back().file = paths[i];
+        }
+    }, diagnostics);
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        for (auto& function : perFile[i]) {
+            functions.push_back(std::move(function));
+        }
+    }
+    resolveCalls();
+
+    stats.functions = functions.size();
+    for (const auto& function : functions) {
+        stats.loops += function.loops.size();
+        for (const auto& loop : function.loops) {
+            stats.countedLoops += loop.counted;
+        }
+        stats.overLimit += function.overLimit;
+    }
+}
+
+void CostEstimator::resolveCalls() {
+    // 同名函数取第一个定义；输入之外的函数按1计
+    std::unordered_map<std::string, size_t> byName;
+    for (size_t i = 0; i < functions.size(); i++) {
+        byName.emplace(functions[i].name, i);
+    }
+    enum class State { Pending, Active, Done };
+    std::vector<State> states(functions.size(), State::Pending);
+    std::vector<size_t> active;
+    std::unordered_set<std::string> unresolved;  // 保留为符号的调用
+
+    // 按调用关系深度优先：先求出被调用函数的多项式，把实参代入形参后替换调用者中的调用符号
+    std::function<void(size_t)> resolve = [&](size_t index) {
+        FunctionCost& function = functions[index];
+        if (states[index] != State::Pending) {
+            return;
+        }
+        states[index] = State::Active;
+        active.push_back(index);
+        std::unordered_map<std::string, CostExpression> calls;
+        for (const auto& site : function.calls) {
+            auto it = byName.find(site.callee);
+            if (it == byName.end()) {
+                calls[site.symbol] = CostExpression::constant(1);
+                continue;
+            }
+            const FunctionCost& callee = functions[it->second];
+            if (states[it->second] == State::Active) {
+                // 调用环：环上的函数都标记为递归，这次调用保留为符号
+                for (auto rit = active.rbegin(); rit != active.rend(); ++rit) {
+                    functions[*rit].recursive = true;
+                    if (*rit == it->second) {
+                        break;
+                    }
+                }
+                unresolved.insert(site.symbol);
+                continue;
+            }
+            resolve(it->second);
+            if (callee.parameters.size() != site.arguments.size()) {
+                unresolved.insert(site.symbol);  // 实参与形参对不上时保留为符号
+                continue;
+            }
+            std::unordered_map<std::string, CostExpression> arguments;
+            for (size_t i = 0; i < site.arguments.size(); i++) {
+                arguments[callee.parameters[i]] = site.arguments[i];
+            }
+            calls[site.symbol] = callee.cost.substitute(arguments);
+        }
+        // 调用展开后由内向外对依赖计数变量的循环求和
+        for (const auto& sum : function.sums) {
+            CostExpression iteration = sum.iteration.substitute(calls);
+            calls[sum.symbol] = iteration.summed(sum.variable, sum.first, sum.step, sum.trips);
+        }
+        function.cost = function.cost.substitute(calls);
+        for (const auto& name : function.cost.symbols()) {
+            if (name.compare(0, 5, "loop@") == 0 || unresolved.count(name) > 0) {
+                function.unbounded = true;
+            }
+        }
+        function.estimate = function.unbounded && !assumeUnbounded
+                                ? HUGE_VAL
+                                : std::max(0.0, function.cost.evaluate({}, assumed));
+        function.overLimit = function.estimate > limit;
+        active.pop_back();
+        states[index] = State::Done;
+    };
+    for (size_t i = 0; i < functions.size(); i++) {
+        resolve(i);
+    }
+}
+
+const std::vector<FunctionCost>& CostEstimator::getFunctions() const {
+    return functions;
+}
+
+const std::vector<std::string>& CostEstimator::getDiagnostics() const {
+    return diagnostics;
+}
+
+void CostEstimator::printReport(std::ostream& os, const CostStats& stats) const {
+    os << "\n=== Cost Estimate ===" << std::endl;
+    os << "Files: " << stats.files << ", functions: " << stats.functions << ", loops: " << stats.loops << " ("
+       << stats.countedLoops << " counted) (threads: " << threadCount << ")" << std::endl;
+    os << "Limit: " << formatNumber(limit) << "; unknown sizes";
+    if (assumeUnbounded) {
+        os << ", recursion and trip counts assumed to be " << formatNumber(assumed) << std::endl;
+    } else {
+        os << " assumed to be " << formatNumber(assumed)
+           << "; recursion and uncounted loops are unbounded (set --cost-assume to bound them)" << std::endl;
+    }
+    for (const auto& diagnostic : diagnostics) {
+        os << "  [error] " << diagnostic << std::endl;
+    }
+    if (functions.empty()) {
+        os << "No function definitions found." << std::endl;
+        return;
+    }
+    for (const auto& function : functions) {
+        os << function.file << ":" << function.line << ": " << function.name << ": cost " << function.cost.toString()
+           << " ~ " << (std::isinf(function.estimate) ? "unbounded" : formatNumber(function.estimate));
+        if (function.recursive) {
+            os << " [recursive]";
+        }
+        if (function.overLimit) {
+            os << " ✗ over limit";
+        }
+        os << std::endl;
+        for (const auto& loop : function.loops) {
+            os << "    line " << loop.line << ": " << loop.kind;
+            if (loop.counted) {
+                os << " (" << loop.variable << ") trips " << loop.trips.toString();
+            } else {
+                os << " not a counted loop, trips " << loop.trips.toString();
+            }
+            os << std::endl;
+        }
+    }
+    if (stats.overLimit == 0) {
+        os << "✓ All functions are within the limit." << std::endl;
+    } else {
+        os << "Summary: " << stats.overLimit << " of " << stats.functions << " function(s) over the limit."
+           << std::endl;
+    }
+}
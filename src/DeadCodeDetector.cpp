@@ -0,0 +1,567 @@
+#include "../include/DeadCodeDetector.h"
+#include "../include/ControlFlowGraph.h"
+#include "../include/ASTWalker.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
+namespace {
+
+// 标识符节点引用的变量名（自增自减取其变量）
+std::string referencedName(const IdentifierNode& identifier) {
+    std::string target = incrementTarget(identifier.name);
+    return target.empty() ? identifier.name : target;
+}
+
+// 表达式中是否有函数调用或自增自减；有的写入即使无用也不能删除
+bool hasSideEffects(const ASTNode* node) {
+    if (!node) {
+        return false;
+    }
+    bool found = false;
+    walkAST(*node, [&found](const ASTNode& current) {
+        if (current.getKind() == ASTNodeKind::FunctionCall ||
+            (current.getKind() == ASTNodeKind::Identifier &&
+             !incrementTarget(static_cast<const IdentifierNode&>(current).name).empty())) {
+            found = true;
+        }
+        return !found;
+    });
+    return found;
+}
+
+/**
+ * 按变量编号的位集
+ */
+class LiveSet {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    explicit LiveSet(size_t size = 0) : words((size + 63) / 64, 0) {}
+
+    bool test(int id) const {
+        return (words[id >> 6] >> (id & 63)) & 1;
+    }
+
+    void set(int id) {
+        words[id >> 6] |= uint64_t(1) << (id & 63);
+    }
+
+    void reset(int id) {
+        words[id >> 6] &= ~(uint64_t(1) << (id & 63));
+    }
+
+    // 并入other，有变化时返回true
+    bool merge(const LiveSet& other) {
+        bool changed = false;
+        for (size_t i = 0; i < words.size(); i++) {
+            uint64_t merged = words[i] | other.words[i];
+            changed = changed || merged != words[i];
+            words[i] = merged;
+        }
+        return changed;
+    }
+};
+
+/**
+ * 语句对单个变量的写入：带初始化的声明、"x = e" 与语句级的自增自减
+ */
+struct Store {
+    bool valid = false;
+    std::string variable;
+    const ASTNode* value = nullptr;  // 写入的表达式，自增自减为空
+    const VarDeclarationNode* declaration = nullptr;
+    std::string increment;           // 自增自减的写法，如 "i++"
+};
+
+Store storeOf(const ASTNode& statement) {
+    Store store;
+    const ASTNode* node = &statement;
+    if (node->getKind() == ASTNodeKind::VarDeclaration) {
+        const auto& var = static_cast<const VarDeclarationNode&>(statement);
+        if (var.initializer) {
+            store.valid = true;
+            store.variable = var.identifier;
+            store.value = var.initializer.get();
+            store.declaration = &var;
+        }
+        return store;
+    }
+    if (node->getKind() == ASTNodeKind::ExpressionStatement) {
+        node = static_cast<const ExpressionStatementNode&>(statement).expression.get();
+        if (!node) {
+            return store;
+        }
+    }
+    if (node->getKind() == ASTNodeKind::BinaryExpression) {
+        const auto& binary = static_cast<const BinaryExpressionNode&>(*node);
+        if (binary.operator_ == "=" && binary.left && binary.left->getKind() == ASTNodeKind::Identifier) {
+            store.valid = true;
+            store.variable = static_cast<const IdentifierNode&>(*binary.left).name;
+            store.value = binary.right.get();
+        }
+    } else if (node->getKind() == ASTNodeKind::Identifier) {
+        const std::string& name = static_cast<const IdentifierNode&>(*node).name;
+        store.variable = incrementTarget(name);
+        if (!store.variable.empty()) {
+            store.valid = true;
+            store.increment = name;
+        }
+    }
+    return store;
+}
+
+/**
+ * 单个函数的检测：控制流图上的可达性与逆向活跃变量分析
+ */
+class FunctionDeadCode {
+private:
+    const FunctionDefinitionNode& function;
+    const std::vector<Token>& tokens;
+    ControlFlowGraph cfg;
+    std::unordered_map<std::string, int> variables;
+    std::unordered_set<const ASTNode*> compoundMembers;  // 直接出现在复合语句中的语句
+    std::vector<LiveSet> liveIn;
+    std::vector<LiveSet> liveOut;
+    std::vector<const VarDeclarationNode*> deadDeclarations;
+    bool reporting = false;
+
+    // 形参与局部变量中只声明一次的才参与分析，重名的声明可能属于不同作用域
+    void collectVariables() {
+        std::unordered_map<std::string, int> declarations;
+        for (const auto& parameter : function.parameters) {
+            if (parameter && parameter->getKind() == ASTNodeKind::VarDeclaration) {
+                declarations[static_cast<const VarDeclarationNode&>(*parameter).identifier]++;
+            }
+        }
+        if (function.body) {
+            walkAST(*function.body, [this, &declarations](const ASTNode& node) {
+                if (node.getKind() == ASTNodeKind::VarDeclaration) {
+                    declarations[static_cast<const VarDeclarationNode&>(node).identifier]++;
+                } else if (node.getKind() == ASTNodeKind::CompoundStatement) {
+                    for (const auto& statement : static_cast<const CompoundStatementNode&>(node).statements) {
+                        compoundMembers.insert(statement.get());
+                    }
+                }
+                return true;
+            });
+        }
+        for (const auto& entry : declarations) {
+            if (entry.second == 1) {
+                int id = static_cast<int>(variables.size());
+                variables.emplace(entry.first, id);
+            }
+        }
+    }
+
+    int variableOf(const std::string& name) const {
+        auto it = variables.find(name);
+        return it == variables.end() ? -1 : it->second;
+    }
+
+    void addUses(const ASTNode* node, LiveSet& live) const {
+        if (!node) {
+            return;
+        }
+        walkAST(*node, [this, &live](const ASTNode& current) {
+            if (current.getKind() == ASTNodeKind::Identifier) {
+                int id = variableOf(referencedName(static_cast<const IdentifierNode&>(current)));
+                if (id >= 0) {
+                    live.set(id);
+                }
+            }
+            return true;
+        });
+    }
+
+    // 逆向转移：live由语句之后的活跃变量变为语句之前的活跃变量
+    void transfer(const ASTNode& statement, LiveSet& live) {
+        Store store = storeOf(statement);
+        if (!store.valid) {
+            if (statement.getKind() == ASTNodeKind::VarDeclaration) {
+                int id = variableOf(static_cast<const VarDeclarationNode&>(statement).identifier);
+                if (id >= 0) {
+                    live.reset(id);
+                }
+            } else {
+                addUses(&statement, live);
+            }
+            return;
+        }
+        int id = variableOf(store.variable);
+        bool sideEffects = hasSideEffects(store.value);
+        if (id >= 0 && !live.test(id)) {
+            if (reporting) {
+                reportDeadStore(statement, store, sideEffects);
+            }
+            if (!sideEffects) {
+                return;  // 无用且无副作用的写入不读取任何变量
+            }
+        }
+        // 自增自减同时读取变量，变量保持活跃
+        if (id >= 0 && store.increment.empty()) {
+            live.reset(id);
+        }
+        addUses(store.value, live);
+    }
+
+    void transferBlock(int block, LiveSet& live) {
+        const ControlFlowGraph::Block& current = cfg.getBlocks()[block];
+        addUses(current.condition, live);  // 条件在块中的语句之后求值
+        for (auto it = current.statements.rbegin(); it != current.statements.rend(); ++it) {
+            transfer(**it, live);
+        }
+    }
+
+    // 在可达块上迭代到不动点，每遍按弱拓扑序的逆序处理
+    void solveLiveness() {
+        const auto& blocks = cfg.getBlocks();
+        const std::vector<int>& order = cfg.getOrder();
+        liveIn.assign(blocks.size(), LiveSet(variables.size()));
+        liveOut.assign(blocks.size(), LiveSet(variables.size()));
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto it = order.rbegin(); it != order.rend(); ++it) {
+                int block = *it;
+                for (int successor : blocks[block].successors) {
+                    liveOut[block].merge(liveIn[successor]);
+                }
+                LiveSet live = liveOut[block];
+                transferBlock(block, live);
+                changed = liveIn[block].merge(live) || changed;
+            }
+        }
+    }
+
+    void reportDeadStore(const ASTNode& statement, const Store& store, bool sideEffects) {
+        DeadCodeFinding finding;
+        finding.function = function.name;
+        finding.line = statement.line;
+        finding.column = statement.column;
+        finding.endLine = statement.line;
+        finding.kind = DeadCodeKind::DeadStore;
+        if (store.declaration) {
+            finding.message = "initial value of '" + store.variable + "' is never read";
+        } else if (!store.increment.empty()) {
+            finding.message = "value of '" + store.variable + "' after '" + store.increment + "' is never read";
+        } else {
+            finding.message = "value assigned to '" + store.variable + "' is never read";
+        }
+        if (sideEffects) {
+            finding.message += " (kept for the side effects of its right-hand side)";
+        } else if (compoundMembers.count(&statement)) {
+            if (store.declaration) {
+                deadDeclarations.push_back(store.declaration);
+            } else {
+                removable.insert(&statement);
+            }
+        }
+        findings.push_back(std::move(finding));
+    }
+
+    void reportUnreachable(const std::vector<std::unique_ptr<ASTNode>>& statements, size_t first) {
+        const char* after = nullptr;
+        for (size_t i = first; i-- > 0;) {
+            if (!statements[i]) {
+                continue;
+            }
+            switch (statements[i]->getKind()) {
+                case ASTNodeKind::ReturnStatement: after = "return"; break;
+                case ASTNodeKind::BreakStatement: after = "break"; break;
+                case ASTNodeKind::ContinueStatement: after = "continue"; break;
+                default: break;
+            }
+            break;
+        }
+        size_t count = 0;
+        const ASTNode* last = nullptr;
+        for (size_t i = first; i < statements.size(); i++) {
+            if (statements[i]) {
+                count++;
+                last = statements[i].get();
+                removable.insert(last);
+            }
+        }
+        DeadCodeFinding finding;
+        finding.function = function.name;
+        finding.line = statements[first]->line;
+        finding.column = statements[first]->column;
+        finding.endLine = last->lastToken < tokens.size() ? tokens[last->lastToken].line : last->line;
+        finding.kind = DeadCodeKind::Unreachable;
+        finding.message = count == 1 ? "unreachable statement" : std::to_string(count) + " unreachable statements";
+        if (after) {
+            finding.message += std::string(" after '") + after + "'";
+        }
+        if (finding.endLine > finding.line) {
+            finding.message += ", through line " + std::to_string(finding.endLine);
+        }
+        findings.push_back(std::move(finding));
+    }
+
+    // 不可达语句总是延续到所在复合语句的末尾（没有goto与标号），每段只报告一次，不再进入其内部
+    void findUnreachable(const ASTNode& node) {
+        if (node.getKind() != ASTNodeKind::CompoundStatement) {
+            forEachChild(node, [this](const ASTNode& child) {
+                findUnreachable(child);
+            });
+            return;
+        }
+        const auto& statements = static_cast<const CompoundStatementNode&>(node).statements;
+        for (size_t i = 0; i < statements.size(); i++) {
+            if (!statements[i]) {
+                continue;
+            }
+            if (!cfg.isReachable(cfg.blockOf(statements[i].get()))) {
+                reportUnreachable(statements, i);
+                return;
+            }
+            findUnreachable(*statements[i]);
+        }
+    }
+
+    // 删除其余可删除语句后，变量在函数中是否仍被引用
+    bool referencedElsewhere(const VarDeclarationNode& declaration) const {
+        bool found = false;
+        walkAST(*function.body, [this, &declaration, &found](const ASTNode& node) {
+            if (found || &node == &declaration || removable.count(&node)) {
+                return false;
+            }
+            if (node.getKind() == ASTNodeKind::Identifier &&
+                referencedName(static_cast<const IdentifierNode&>(node)) == declaration.identifier) {
+                found = true;
+            }
+            return !found;
+        });
+        return found;
+    }
+
+    bool hasComma(const ASTNode& node) const {
+        for (size_t i = node.firstToken; i <= node.lastToken && i < tokens.size(); i++) {
+            if (tokens[i].type == TokenType::COMMA) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    std::vector<DeadCodeFinding> findings;
+    std::unordered_set<const ASTNode*> removable;            // 可整条删除的语句
+    std::vector<const VarDeclarationNode*> initializers;     // 只删去初始化部分的声明
+
+    FunctionDeadCode(const FunctionDefinitionNode& function, const std::vector<Token>& tokens)
+        : function(function), tokens(tokens), cfg(function) {}
+
+    void run() {
+        if (!function.body) {
+            return;
+        }
+        collectVariables();
+        findUnreachable(*function.body);
+        solveLiveness();
+        reporting = true;
+        for (int block : cfg.getOrder()) {
+            LiveSet live = liveOut[block];
+            transferBlock(block, live);
+        }
+        // 多变量声明只有第一个变量在语法树中，不删除以免破坏其余变量
+        for (const VarDeclarationNode* declaration : deadDeclarations) {
+            if (hasComma(*declaration)) {
+                continue;
+            }
+            if (referencedElsewhere(*declaration)) {
+                initializers.push_back(declaration);
+            } else {
+                removable.insert(declaration);
+            }
+        }
+        std::stable_sort(findings.begin(), findings.end(), [](const DeadCodeFinding& a, const DeadCodeFinding& b) {
+            return a.line != b.line ? a.line < b.line : a.column < b.column;
+        });
+    }
+};
+
+void markRemoved(std::vector<bool>& removed, size_t first, size_t last) {
+    for (size_t i = first; i <= last && i < removed.size(); i++) {
+        removed[i] = true;
+    }
+}
+
+// 按分析结果修改函数的语法树，被删除的token记入removed，返回删除的语句与初始化表达式个数
+size_t applyStrip(const FunctionDeadCode& analysis, const FunctionDefinitionNode& function,
+                  const std::vector<Token>& tokens, std::vector<bool>& removed) {
+    size_t count = 0;
+    for (const VarDeclarationNode* declaration : analysis.initializers) {
+        auto& var = const_cast<VarDeclarationNode&>(*declaration);
+        size_t assign = var.firstToken;
+        while (assign < var.initializer->firstToken && tokens[assign].type != TokenType::ASSIGN) {
+            assign++;
+        }
+        size_t end = tokens[var.lastToken].type == TokenType::SEMICOLON ? var.lastToken - 1
+                                                                          : var.initializer->lastToken;
+        markRemoved(removed, assign, end);
+        var.initializer.reset();
+        count++;
+    }
+
+    // 先收集再修改：不进入将被删除的语句，避免访问已释放的子树
+    std::vector<const CompoundStatementNode*> compounds;
+    walkAST(*function.body, [&analysis, &compounds](const ASTNode& node) {
+        if (analysis.removable.count(&node)) {
+            return false;
+        }
+        if (node.getKind() == ASTNodeKind::CompoundStatement) {
+            compounds.push_back(static_cast<const CompoundStatementNode*>(&node));
+        }
+        return true;
+    });
+    for (const CompoundStatementNode* compound : compounds) {
+        auto& statements = const_cast<CompoundStatementNode*>(compound)->statements;
+        auto end = std::remove_if(statements.begin(), statements.end(),
+                                  [&](const std::unique_ptr<ASTNode>& statement) {
+                                      if (!statement || !analysis.removable.count(statement.get())) {
+                                          return false;
+                                      }
+                                      size_t first = statement->firstToken;
+                                      size_t last = statement->lastToken;
+                                      // 语句独占一行时连同行尾换行一起删除
+                                      bool lineStart = first == 0 || tokens[first - 1].type == TokenType::NEWLINE;
+                                      if (lineStart && last + 1 < tokens.size() &&
+                                          tokens[last + 1].type == TokenType::NEWLINE) {
+                                          last++;
+                                      }
+                                      markRemoved(removed, first, last);
+                                      count++;
+                                      return true;
+                                  });
+        statements.erase(end, statements.end());
+    }
+    return count;
+}
+
+} // namespace
+
+// DeadCodeDetector类实现
+DeadCodeDetector::DeadCodeDetector(size_t threadCount)
+    : threadCount(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount) {}
+
+void DeadCodeDetector::detectFunction(const FunctionDefinitionNode& function, const std::vector<Token>& tokens,
+                                      std::vector<DeadCodeFinding>& out) {
+    FunctionDeadCode analysis(function, tokens);
+    analysis.run();
+    out.insert(out.end(), analysis.findings.begin(), analysis.findings.end());
+}
+
+size_t DeadCodeDetector::strip(ProgramNode& program, std::vector<Token>& tokens) {
+    // 删除一段语句可能使前面的写入变为无用，反复分析直到没有变化；期间token下标保持原样
+    std::vector<bool> removed(tokens.size(), false);
+    size_t total = 0;
+    size_t count = 0;
+    do {
+        count = 0;
+        for (const auto& statement : program.statements) {
+            if (!statement || statement->getKind() != ASTNodeKind::FunctionDefinition) {
+                continue;
+            }
+            const auto& function = static_cast<const FunctionDefinitionNode&>(*statement);
+            if (!function.body) {
+                continue;
+            }
+            FunctionDeadCode analysis(function, tokens);
+            analysis.run();
+            count += applyStrip(analysis, function, tokens, removed);
+        }
+        total += count;
+    } while (count > 0);
+    if (total == 0) {
+        return 0;
+    }
+
+    // kept[i]：下标i之前保留的token个数，即旧下标到新下标的映射
+    std::vector<size_t> kept(tokens.size() + 1, 0);
+    for (size_t i = 0; i < tokens.size(); i++) {
+        kept[i + 1] = kept[i] + (removed[i] ? 0 : 1);
+    }
+    walkAST(program, [&kept](const ASTNode& node) {
+        auto& mutableNode = const_cast<ASTNode&>(node);
+        size_t last = std::min(mutableNode.lastToken + 1, kept.size() - 1);
+        mutableNode.firstToken = kept[std::min(mutableNode.firstToken, kept.size() - 1)];
+        mutableNode.lastToken = kept[last] > 0 ? kept[last] - 1 : 0;
+        return true;
+    });
+    size_t next = 0;
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (!removed[i]) {
+            if (next != i) {
+                tokens[next] = std::move(tokens[i]);
+            }
+            next++;
+        }
+    }
+    tokens.resize(next);
+    return total;
+}
+
+void DeadCodeDetector::analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, DeadCodeStats& stats) {
+    stats = DeadCodeStats();
+    stats.files = paths.size();
+    findings.clear();
+    diagnostics.clear();
+
+    std::vector<std::vector<DeadCodeFinding>> perFile(paths.size());
+    std::vector<size_t> perFileFunctions(paths.size(), 0);
+    stats.failed = frontEnd.parseUnits(paths, threadCount, [&](size_t i, const ParsedUnit& unit) {
+        const std::vector<Token>& tokens = unit.tokens;
+        for (const FunctionDefinitionNode* function : unit.definedFunctions()) {
+            perFileFunctions[i]++;
+            detectFunction(*function, tokens, perFile[i]);
+        }
+        for (auto& finding : perFile[i]) {
+            finding.file = paths[i];
+        }
+    }, diagnostics);
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        stats.functions += perFileFunctions[i];
+        for (auto& finding : perFile[i]) {
+            if (finding.kind == DeadCodeKind::Unreachable) {
+                stats.unreachable++;
+            } else {
+                stats.deadStores++;
+            }
+            findings.push_back(std::move(finding));
+        }
+    }
+}
+
+const std::vector<DeadCodeFinding>& DeadCodeDetector::getFindings() const {
+    return findings;
+}
+
+const std::vector<std::string>& DeadCodeDetector::getDiagnostics() const {
+    return diagnostics;
+}
+
+void DeadCodeDetector::printReport(std::ostream& os, const DeadCodeStats& stats) const {
+    os << "\n=== Dead Code ===" << std::endl;
+    os << "Files: " << stats.files << ", functions: " << stats.functions << " (threads: " << threadCount << ")"
+       << std::endl;
+    for (const auto& diagnostic : diagnostics) {
+        os << "  [error] " << diagnostic << std::endl;
+    }
+    for (const auto& finding : findings) {
+        os << finding.file << ":" << finding.line << ":" << finding.column << ": warning: " << finding.message
+           << " [in " << finding.function << "]" << std::endl;
+    }
+    if (findings.empty()) {
+        os << "✓ No dead code found." << std::endl;
+        return;
+    }
+    os << "Summary: " << stats.unreachable << " unreachable code region(s), " << stats.deadStores
+       << " dead store(s)." << std::endl;
+}
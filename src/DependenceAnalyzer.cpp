@@ -0,0 +1,449 @@
+#include "../include/DependenceAnalyzer.h"
+#include "../include/ASTWalker.h"
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+bool isName(const ASTNode* node, const std::string& name) {
+    return node && node->getKind() == ASTNodeKind::Identifier &&
+           static_cast<const IdentifierNode*>(node)->name == name;
+}
+
+bool integerLiteral(const ASTNode* node, int64_t& value) {
+    if (!node || node->getKind() != ASTNodeKind::Literal ||
+        static_cast<const LiteralNode*>(node)->type != TokenType::INTEGER) {
+        return false;
+    }
+    const std::string& text = static_cast<const LiteralNode*>(node)->value;
+    errno = 0;
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return errno == 0 && end && *end == '\0';
+}
+
+// 下标形如 i、i + c、c + i、i - c 时给出偏移c
+bool inductionOffset(const ASTNode* index, const std::string& induction, int64_t& offset) {
+    if (isName(index, induction)) {
+        offset = 0;
+        return true;
+    }
+    if (!index || index->getKind() != ASTNodeKind::BinaryExpression) {
+        return false;
+    }
+    const auto& binary = static_cast<const BinaryExpressionNode&>(*index);
+    int64_t constant;
+    if (binary.operator_ == "+") {
+        if (isName(binary.left.get(), induction) && integerLiteral(binary.right.get(), constant)) {
+            offset = constant;
+            return true;
+        }
+        if (isName(binary.right.get(), induction) && integerLiteral(binary.left.get(), constant)) {
+            offset = constant;
+            return true;
+        }
+    } else if (binary.operator_ == "-" && isName(binary.left.get(), induction) &&
+               integerLiteral(binary.right.get(), constant) && constant != INT64_MIN) {
+        offset = -constant;
+        return true;
+    }
+    return false;
+}
+
+struct ArrayAccess {
+    std::string array;
+    const ASTNode* index;
+    bool write;
+};
+
+/**
+ * 收集循环体中的声明、写入、名字出现次数与数组访问
+ */
+class LoopBodyScanner {
+public:
+    std::string problem;  // 遇到的第一个不可并行的结构
+    std::vector<std::string> declared;
+    std::vector<std::string> written;  // 按首次写入的顺序
+    std::unordered_map<std::string, int> uses;
+    std::unordered_map<std::string, int> reductionUses;  // 出现在归约语句中的次数
+    std::vector<ArrayAccess> accesses;
+
+    void statement(const ASTNode* node) {
+        if (!node || !problem.empty()) {
+            return;
+        }
+        switch (node->getKind()) {
+            case ASTNodeKind::VarDeclaration: {
+                const auto& var = static_cast<const VarDeclarationNode&>(*node);
+                declared.push_back(var.identifier);
+                expression(var.initializer.get());
+                break;
+            }
+            case ASTNodeKind::ArrayDeclaration:
+                declared.push_back(static_cast<const ArrayDeclarationNode&>(*node).identifier);
+                break;
+            case ASTNodeKind::ExpressionStatement:
+                statementExpression(static_cast<const ExpressionStatementNode&>(*node).expression.get());
+                break;
+            case ASTNodeKind::Identifier:
+            case ASTNodeKind::Assignment:
+            case ASTNodeKind::FunctionCall:
+            case ASTNodeKind::BinaryExpression:
+            case ASTNodeKind::UnaryExpression:
+            case ASTNodeKind::Literal:
+            case ASTNodeKind::IndexExpression:
+                statementExpression(node);
+                break;
+            case ASTNodeKind::IfStatement: {
+                const auto& ifStmt = static_cast<const IfStatementNode&>(*node);
+                expression(ifStmt.condition.get());
+                statement(ifStmt.thenStatement.get());
+                statement(ifStmt.elseStatement.get());
+                break;
+            }
+            case ASTNodeKind::WhileStatement: {
+                const auto& whileStmt = static_cast<const WhileStatementNode&>(*node);
+                expression(whileStmt.condition.get());
+                depth++;
+                statement(whileStmt.body.get());
+                depth--;
+                break;
+            }
+            case ASTNodeKind::ForStatement: {
+                const auto& forStmt = static_cast<const ForStatementNode&>(*node);
+                statement(forStmt.initialization.get());
+                expression(forStmt.condition.get());
+                statementExpression(forStmt.update.get());
+                depth++;
+                statement(forStmt.body.get());
+                depth--;
+                break;
+            }
+            case ASTNodeKind::CompoundStatement:
+                for (const auto& child : static_cast<const CompoundStatementNode&>(*node).statements) {
+                    statement(child.get());
+                }
+                break;
+            case ASTNodeKind::ReturnStatement:
+                problem = "the loop body contains a return statement";
+                break;
+            case ASTNodeKind::BreakStatement:
+                if (depth == 0) {
+                    problem = "the loop body contains a break statement";
+                }
+                break;
+            case ASTNodeKind::ContinueStatement:
+            case ASTNodeKind::PreprocessorDirective:
+                break;
+            default:
+                problem = "the loop body contains an unsupported statement";
+                break;
+        }
+    }
+
+private:
+    int depth = 0;  // 循环体内嵌套循环的层数（其中的break不跳出本循环）
+    std::unordered_set<std::string> writtenSet;
+
+    void noteWrite(const std::string& name) {
+        if (writtenSet.insert(name).second) {
+            written.push_back(name);
+        }
+    }
+
+    // 语句位置上的表达式：先识别归约形式，再按普通表达式收集
+    void statementExpression(const ASTNode* node) {
+        if (!node) {
+            return;
+        }
+        std::string variable;
+        if (node->getKind() == ASTNodeKind::Identifier &&
+            splitIncrement(static_cast<const IdentifierNode*>(node)->name, variable)) {
+            reductionUses[variable]++;
+        } else if (node->getKind() == ASTNodeKind::BinaryExpression) {
+            const auto& assignment = static_cast<const BinaryExpressionNode&>(*node);
+            const ASTNode* value = assignment.right.get();
+            if (assignment.operator_ == "=" && assignment.left &&
+                assignment.left->getKind() == ASTNodeKind::Identifier && value &&
+                value->getKind() == ASTNodeKind::BinaryExpression) {
+                const std::string& name = static_cast<const IdentifierNode&>(*assignment.left).name;
+                const auto& update = static_cast<const BinaryExpressionNode&>(*value);
+                if ((update.operator_ == "+" || update.operator_ == "-") && isName(update.left.get(), name)) {
+                    reductionUses[name] += 2;
+                } else if (update.operator_ == "+" && isName(update.right.get(), name)) {
+                    reductionUses[name] += 2;
+                }
+            }
+        }
+        expression(node);
+    }
+
+    void expression(const ASTNode* node) {
+        if (!node || !problem.empty()) {
+            return;
+        }
+        switch (node->getKind()) {
+            case ASTNodeKind::Identifier: {
+                std::string name = static_cast<const IdentifierNode*>(node)->name;
+                std::string variable;
+                if (splitIncrement(name, variable)) {
+                    noteWrite(variable);
+                    name = variable;
+                }
+                uses[name]++;
+                break;
+            }
+            case ASTNodeKind::Assignment: {
+                const auto& assignment = static_cast<const AssignmentNode&>(*node);
+                noteWrite(assignment.identifier);
+                uses[assignment.identifier]++;
+                expression(assignment.expression.get());
+                break;
+            }
+            case ASTNodeKind::BinaryExpression: {
+                const auto& binary = static_cast<const BinaryExpressionNode&>(*node);
+                if (binary.operator_ == "=" && binary.left &&
+                    binary.left->getKind() == ASTNodeKind::IndexExpression) {
+                    element(static_cast<const IndexExpressionNode&>(*binary.left), true);
+                } else if (binary.operator_ == "=" && binary.left &&
+                           binary.left->getKind() == ASTNodeKind::Identifier) {
+                    const std::string& name = static_cast<const IdentifierNode&>(*binary.left).name;
+                    noteWrite(name);
+                    uses[name]++;
+                } else {
+                    expression(binary.left.get());
+                }
+                expression(binary.right.get());
+                break;
+            }
+            case ASTNodeKind::IndexExpression:
+                element(static_cast<const IndexExpressionNode&>(*node), false);
+                break;
+            case ASTNodeKind::FunctionCall:
+                problem = "the loop body calls '" + static_cast<const FunctionCallNode*>(node)->name + "'";
+                break;
+            default:
+                forEachChild(*node, [this](const ASTNode& child) {
+                    expression(&child);
+                });
+                break;
+        }
+    }
+
+    void element(const IndexExpressionNode& node, bool write) {
+        if (!node.array || node.array->getKind() != ASTNodeKind::Identifier) {
+            problem = "the loop body subscripts something that is not an array name";
+            return;
+        }
+        const std::string& name = static_cast<const IdentifierNode&>(*node.array).name;
+        uses[name]++;
+        accesses.push_back({name, node.index.get(), write});
+        expression(node.index.get());
+    }
+};
+
+// 上界只能由整数字面量、循环中不写入的整数标量与算术运算组成
+bool invariantBound(const ASTNode& bound, const LoopBodyScanner& body, const DependenceAnalyzer::Lookup& lookup) {
+    bool invariant = true;
+    std::unordered_set<std::string> written(body.written.begin(), body.written.end());
+    walkAST(bound, [&](const ASTNode& node) {
+        switch (node.getKind()) {
+            case ASTNodeKind::Literal:
+                invariant = invariant && static_cast<const LiteralNode&>(node).type == TokenType::INTEGER;
+                break;
+            case ASTNodeKind::Identifier: {
+                const std::string& name = static_cast<const IdentifierNode&>(node).name;
+                LoopVariableInfo info = lookup(name);
+                invariant = invariant && !written.count(name) && info.storage != LoopStorage::Unknown &&
+                            info.isInteger;
+                break;
+            }
+            case ASTNodeKind::BinaryExpression: {
+                const std::string& op = static_cast<const BinaryExpressionNode&>(node).operator_;
+                invariant = invariant && (op == "+" || op == "-" || op == "*" || op == "/" || op == "%");
+                break;
+            }
+            case ASTNodeKind::UnaryExpression:
+                invariant = invariant && static_cast<const UnaryExpressionNode&>(node).operator_ == "-";
+                break;
+            default:
+                invariant = false;
+                break;
+        }
+        return invariant;
+    });
+    return invariant;
+}
+
+LoopDependence serial(const std::string& reason) {
+    LoopDependence result;
+    result.reason = reason;
+    return result;
+}
+
+} // namespace
+
+// DependenceAnalyzer类实现
+LoopDependence DependenceAnalyzer::analyzeLoop(const ForStatementNode& loop, const Lookup& lookup) {
+    // 规范形式：初始化、条件与步进
+    std::string induction;
+    const ASTNode* init = loop.initialization.get();
+    if (init && init->getKind() == ASTNodeKind::VarDeclaration) {
+        const auto& var = static_cast<const VarDeclarationNode&>(*init);
+        if (var.type == "float") {
+            return serial("the loop variable is not an integer");
+        }
+        induction = var.identifier;
+    } else if (init && init->getKind() == ASTNodeKind::BinaryExpression &&
+               static_cast<const BinaryExpressionNode*>(init)->operator_ == "=") {
+        const ASTNode* target = static_cast<const BinaryExpressionNode*>(init)->left.get();
+        std::string variable;
+        if (!target || target->getKind() != ASTNodeKind::Identifier ||
+            splitIncrement(static_cast<const IdentifierNode*>(target)->name, variable)) {
+            return serial("the loop does not start by assigning a loop variable");
+        }
+        induction = static_cast<const IdentifierNode*>(target)->name;
+        LoopVariableInfo info = lookup(induction);
+        if (info.storage == LoopStorage::Global) {
+            return serial("the loop variable '" + induction + "' is a global");
+        }
+        if (info.storage == LoopStorage::Unknown || !info.isInteger) {
+            return serial("the loop variable is not an integer");
+        }
+    } else {
+        return serial("the loop does not start by assigning a loop variable");
+    }
+
+    LoopDependence result;
+    result.induction = induction;
+    const ASTNode* condition = loop.condition.get();
+    if (!condition || condition->getKind() != ASTNodeKind::BinaryExpression) {
+        return serial("the loop condition is not a comparison of '" + induction + "' with a bound");
+    }
+    const auto& compare = static_cast<const BinaryExpressionNode&>(*condition);
+    if ((compare.operator_ == "<" || compare.operator_ == "<=") && isName(compare.left.get(), induction)) {
+        result.upper = compare.right.get();
+        result.inclusive = compare.operator_ == "<=";
+    } else if ((compare.operator_ == ">" || compare.operator_ == ">=") && isName(compare.right.get(), induction)) {
+        result.upper = compare.left.get();
+        result.inclusive = compare.operator_ == ">=";
+    } else {
+        return serial("the loop condition is not '" + induction + " < bound' or '" + induction + " <= bound'");
+    }
+    if (!result.upper) {
+        return serial("the loop condition has no bound");
+    }
+
+    const ASTNode* update = loop.update.get();
+    bool unitStep = false;
+    if (update && update->getKind() == ASTNodeKind::Identifier) {
+        const std::string& name = static_cast<const IdentifierNode*>(update)->name;
+        unitStep = name == induction + "++" || name == "++" + induction;
+    } else if (update && update->getKind() == ASTNodeKind::BinaryExpression) {
+        const auto& assignment = static_cast<const BinaryExpressionNode&>(*update);
+        const ASTNode* value = assignment.right.get();
+        int64_t step = 0;
+        if (assignment.operator_ == "=" && isName(assignment.left.get(), induction) && value &&
+            value->getKind() == ASTNodeKind::BinaryExpression &&
+            static_cast<const BinaryExpressionNode*>(value)->operator_ == "+") {
+            const auto& sum = static_cast<const BinaryExpressionNode&>(*value);
+            unitStep = (isName(sum.left.get(), induction) && integerLiteral(sum.right.get(), step) && step == 1) ||
+                       (isName(sum.right.get(), induction) && integerLiteral(sum.left.get(), step) && step == 1);
+        }
+    }
+    if (!unitStep) {
+        return serial("the loop variable is not incremented by one");
+    }
+
+    // 循环体
+    LoopBodyScanner body;
+    body.statement(loop.body.get());
+    if (!body.problem.empty()) {
+        return serial(body.problem);
+    }
+    std::unordered_set<std::string> privates;
+    for (const auto& name : body.declared) {
+        if (name == induction || lookup(name).storage != LoopStorage::Unknown) {
+            return serial("'" + name + "' declared in the loop body hides a variable of the same name");
+        }
+        privates.insert(name);
+    }
+    if (!invariantBound(*result.upper, body, lookup)) {
+        return serial("the loop bound is not a loop-invariant integer expression");
+    }
+
+    for (const auto& name : body.written) {
+        if (privates.count(name)) {
+            continue;
+        }
+        if (name == induction) {
+            return serial("the loop variable '" + induction + "' is modified in the loop body");
+        }
+        LoopVariableInfo info = lookup(name);
+        if (info.storage == LoopStorage::Global) {
+            return serial("the global variable '" + name + "' is written in the loop body");
+        }
+        auto reduction = body.reductionUses.find(name);
+        bool reductionShape = reduction != body.reductionUses.end() && reduction->second == body.uses[name];
+        if (!reductionShape) {
+            return serial("'" + name + "' carries a value from one iteration to the next");
+        }
+        if (!info.isInteger) {
+            return serial("reordering the floating-point sum '" + name + "' would change its rounding");
+        }
+        result.reductions.push_back(name);
+    }
+
+    // 被写入的循环外数组：所有访问的下标都是 i 加同一个常量，且没有别名
+    std::map<std::string, LoopStorage> arrays;
+    for (const auto& access : body.accesses) {
+        if (!privates.count(access.array)) {
+            arrays.emplace(access.array, lookup(access.array).storage);
+        }
+    }
+    std::unordered_set<std::string> checked;
+    for (const auto& store : body.accesses) {
+        if (!store.write || privates.count(store.array) || !checked.insert(store.array).second) {
+            continue;
+        }
+        bool first = true;
+        int64_t expected = 0;
+        for (const auto& access : body.accesses) {
+            if (access.array != store.array) {
+                continue;
+            }
+            int64_t offset;
+            if (!inductionOffset(access.index, induction, offset)) {
+                return serial("'" + store.array + "' is written and also accessed at an index other than '" +
+                              induction + "' plus a constant");
+            }
+            if (!first && offset != expected) {
+                return serial("'" + store.array + "' is written and accessed at different offsets from '" +
+                              induction + "'");
+            }
+            expected = offset;
+            first = false;
+        }
+        LoopStorage storage = arrays[store.array];
+        for (const auto& other : arrays) {
+            if (other.first == store.array) {
+                continue;
+            }
+            bool mayAlias = (storage == LoopStorage::Parameter &&
+                             (other.second == LoopStorage::Parameter || other.second == LoopStorage::Global)) ||
+                            (storage == LoopStorage::Global && other.second == LoopStorage::Parameter);
+            if (mayAlias) {
+                std::string first = std::min(store.array, other.first);
+                std::string second = std::max(store.array, other.first);
+                return serial("'" + first + "' and '" + second + "' may refer to the same array");
+            }
+        }
+    }
+
+    result.parallel = true;
+    return result;
+}
@@ -26,13 +26,14 @@ void ErrorHandler::setSourceCode(const std::string& sourceCode) {
 }
 
 void ErrorHandler::addLexicalError(const LexicalError& lexError) {
-    std::string context = extractSourceContext(lexError.line, lexError.column);
+    // 来自被包含文件的错误无法从主文件源码中取上下文
+    std::string context = lexError.fileId == 0 ? extractSourceContext(lexError.line, lexError.column) : "";
     errors.emplace_back(ErrorType::LEXICAL_ERROR, lexError.message, 
                        lexError.line, lexError.column, context);
 }
 
 void ErrorHandler::addSyntaxError(const SyntaxError& syntaxError) {
-    std::string context = extractSourceContext(syntaxError.line, syntaxError.column);
+    std::string context = syntaxError.fileId == 0 ? extractSourceContext(syntaxError.line, syntaxError.column) : "";
     errors.emplace_back(ErrorType::SYNTAX_ERROR, syntaxError.message, 
                        syntaxError.line, syntaxError.column, context);
 }
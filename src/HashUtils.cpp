@@ -0,0 +1,47 @@
+#include "../include/HashUtils.h"
+#include <fstream>
+#include <vector>
+
+// HashUtils类实现
+uint64_t HashUtils::hashBytes(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t HashUtils::hashString(const std::string& str, uint64_t seed) {
+    // 末尾混入长度，避免 "ab"+"c" 与 "a"+"bc" 连续哈希时冲突
+    return combine(hashBytes(str.data(), str.size(), seed), str.size());
+}
+
+uint64_t HashUtils::combine(uint64_t seed, uint64_t value) {
+    return hashBytes(&value, sizeof(value), seed);
+}
+
+bool HashUtils::hashFile(const std::string& path, uint64_t& hash) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::vector<char> buffer(1 << 16);
+    hash = FNV_OFFSET;
+    while (in) {
+        in.read(buffer.data(), buffer.size());
+        hash = hashBytes(buffer.data(), static_cast<size_t>(in.gcount()), hash);
+    }
+    return true;
+}
+
+std::string HashUtils::toHex(uint64_t hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string result(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        result[i] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return result;
+}
@@ -0,0 +1,280 @@
+#include "../include/HtmlExporter.h"
+#include "../include/Lexer.h"
+#include "../include/OutputBuffer.h"
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+namespace {
+
+const char* const STYLE =
+    "body{margin:0;background:#fdfdfd}\n"
+    "pre.code{margin:0;padding:8px;font:13px/1.4 monospace;color:#222}\n"
+    ".k{color:#a626a4;font-weight:bold}.t{color:#0184bc}.f{color:#4078f2}.n{color:#986801}\n"
+    ".s{color:#50a14f}.o{color:#c18401}.c{color:#a0a1a7;font-style:italic}.pp{color:#e45649}\n"
+    ".e{color:#fff;background:#e45649}\n"
+    "a.ln{display:inline-block;width:6ch;margin-right:1ch;text-align:right;color:#9d9d9f;"
+    "text-decoration:none;user-select:none}\n"
+    "a.ln:target,a.ln:hover{color:#222;background:#ffef9f}\n";
+
+/**
+ * 带缓冲的输出：写满一块再整体写到流中，并合并相同类别的相邻片段
+ */
+class HtmlSink {
+private:
+    OutputBuffer buffer;
+    const char* openClass = nullptr;  // 当前未闭合的 <span> 的类别
+    bool lineAnchors;
+    size_t line = 1;
+    bool lineStart = false;  // 刚输出换行，下一个字节开始新的一行；末尾的换行不产生空行号
+
+    void raw(const char* data, size_t size) {
+        buffer.write(data, size);
+    }
+
+    void raw(const char* text) {
+        buffer.write(text);
+    }
+
+public:
+    HtmlSink(std::ostream& out, size_t bufferSize, bool lineAnchors)
+        : buffer(out, bufferSize), lineAnchors(lineAnchors) {}
+
+    void closeSpan() {
+        if (openClass) {
+            raw("</span>", 7);
+            openClass = nullptr;
+        }
+    }
+
+    void anchor() {
+        raw("<a class=\"ln\" id=\"L");
+        buffer.writeNumber(line);
+        raw("\" href=\"#L");
+        buffer.writeNumber(line);
+        raw("\">", 2);
+        buffer.writeNumber(line);
+        raw("</a>", 4);
+    }
+
+    void beginDocument(const std::string& title) {
+        raw("<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>");
+        text(nullptr, title.data(), title.size());
+        raw("</title>\n<style>\n");
+        raw(STYLE);
+        raw("</style>\n</head>\n<body>\n<pre class=\"code\">");
+        if (lineAnchors) {
+            anchor();
+        }
+    }
+
+    void endDocument() {
+        closeSpan();
+        raw("</pre>\n</body>\n</html>\n");
+        buffer.flush();
+    }
+
+    size_t lines() const {
+        return line;
+    }
+
+    size_t written() const {
+        return buffer.written();
+    }
+
+    /**
+     * 输出一段源码文本：转义 & < >，cls为空表示不加 <span>；开启行号时在每个换行后写下一行的锚点
+     * cls 必须指向静态字符串，按指针比较是否与当前 <span> 同类
+     */
+    void text(const char* cls, const char* data, size_t size) {
+        const char* end = data + size;
+        while (data < end) {
+            if (lineStart) {
+                line++;
+                lineStart = false;
+                if (lineAnchors) {
+                    anchor();
+                }
+            }
+            if (cls != openClass) {
+                closeSpan();
+                if (cls) {
+                    raw("<span class=\"", 13);
+                    raw(cls);
+                    raw("\">", 2);
+                    openClass = cls;
+                }
+            }
+            const char* run = data;
+            while (data < end && *data != '&' && *data != '<' && *data != '>' && *data != '\n') {
+                data++;
+            }
+            raw(run, static_cast<size_t>(data - run));
+            if (data == end) {
+                break;
+            }
+            switch (*data++) {
+                case '&': raw("&amp;", 5); break;
+                case '<': raw("&lt;", 4); break;
+                case '>': raw("&gt;", 4); break;
+                default:
+                    if (lineAnchors) {
+                        closeSpan();  // 行号不放进跨行的注释或字符串的 <span> 中
+                    }
+                    raw("\n", 1);
+                    lineStart = true;
+                    break;
+            }
+        }
+    }
+};
+
+/**
+ * 逐行前进的定位器：由token的行列号求字节偏移（列号按字节计，与Lexer一致）
+ */
+class Locator {
+private:
+    const std::string& source;
+    int line = 1;
+    size_t lineStart = 0;
+
+public:
+    explicit Locator(const std::string& source) : source(source) {}
+
+    size_t offsetOf(int targetLine, int column) {
+        while (line < targetLine) {
+            const void* newline = std::memchr(source.data() + lineStart, '\n', source.size() - lineStart);
+            if (!newline) {
+                return source.size();
+            }
+            lineStart = static_cast<const char*>(newline) - source.data() + 1;
+            line++;
+        }
+        return std::min(lineStart + static_cast<size_t>(std::max(column, 1)) - 1, source.size());
+    }
+};
+
+const char* tokenClass(TokenType type, TokenType next, bool preprocessor) {
+    if (preprocessor) {
+        return type == TokenType::ERROR ? "e" : "pp";
+    }
+    switch (type) {
+        case TokenType::IF: case TokenType::ELSE: case TokenType::WHILE: case TokenType::FOR:
+        case TokenType::RETURN: case TokenType::BREAK: case TokenType::CONTINUE:
+            return "k";
+        case TokenType::INT: case TokenType::FLOAT_KW: case TokenType::CHAR: case TokenType::VOID:
+            return "t";
+        case TokenType::IDENTIFIER:
+            return next == TokenType::LPAREN ? "f" : nullptr;
+        case TokenType::INTEGER: case TokenType::FLOAT:
+            return "n";
+        case TokenType::STRING:
+            return "s";
+        case TokenType::HASH: case TokenType::INCLUDE: case TokenType::DEFINE:
+            return "pp";
+        case TokenType::ERROR:
+            return "e";
+        case TokenType::SEMICOLON: case TokenType::COMMA: case TokenType::LPAREN: case TokenType::RPAREN:
+        case TokenType::LBRACE: case TokenType::RBRACE: case TokenType::NEWLINE: case TokenType::WHITESPACE:
+        case TokenType::EOF_TOKEN:
+            return nullptr;
+        default:
+            return "o";
+    }
+}
+
+// token在源码中的长度；字符串的值已去掉引号与转义，需要重新扫描；错误token的位置不可靠，按0处理
+size_t lexemeLength(const Token& token, const std::string& source, size_t start) {
+    switch (token.type) {
+        case TokenType::STRING: {
+            char quote = source[start];
+            size_t i = start + 1;
+            while (i < source.size() && source[i] != quote) {
+                i += source[i] == '\\' ? 2 : 1;
+            }
+            return std::min(i + 1, source.size()) - start;
+        }
+        case TokenType::ERROR:
+        case TokenType::EOF_TOKEN:
+            return 0;
+        default:
+            return token.value.size();
+    }
+}
+
+// token之间的文本：空白原样输出，注释为 c 类，其余字符（词法错误留下的）为 e 类
+void emitTrivia(HtmlSink& sink, const char* data, const char* end, bool preprocessor) {
+    while (data < end) {
+        const char* start = data;
+        if (data[0] == '/' && data + 1 < end && data[1] == '/') {
+            data = static_cast<const char*>(std::memchr(data, '\n', end - data));
+            data = data ? data : end;
+            sink.text("c", start, data - start);
+        } else if (data[0] == '/' && data + 1 < end && data[1] == '*') {
+            data += 2;
+            while (data + 1 < end && !(data[0] == '*' && data[1] == '/')) {
+                data++;
+            }
+            data = std::min(data + 2, end);
+            sink.text("c", start, data - start);
+        } else if (std::isspace(static_cast<unsigned char>(*data))) {
+            while (data < end && std::isspace(static_cast<unsigned char>(*data))) {
+                data++;
+            }
+            sink.text(nullptr, start, data - start);
+        } else {
+            data++;
+            while (data < end && !std::isspace(static_cast<unsigned char>(*data)) && *data != '/') {
+                data++;
+            }
+            sink.text(preprocessor ? "pp" : "e", start, data - start);
+        }
+    }
+}
+
+} // namespace
+
+// HtmlExporter类实现
+HtmlExporter::HtmlExporter(const HtmlExportOptions& options) : options(options) {}
+
+bool HtmlExporter::exportSource(const std::string& source, const std::string& title, std::ostream& out,
+                                HtmlExportStats& stats) const {
+    stats = HtmlExportStats();
+    stats.inputBytes = source.size();
+    HtmlSink sink(out, options.bufferSize, options.lineAnchors);
+    sink.beginDocument(title);
+
+    // 延迟一个token输出：知道下一个token的位置后才能确定当前token之后的空白与注释，
+    // 知道下一个token的种类后才能区分函数名
+    Lexer lexer(source);
+    Locator locator(source);
+    Token pending = lexer.getNextToken();
+    size_t pendingStart = locator.offsetOf(pending.line, pending.column);
+    emitTrivia(sink, source.data(), source.data() + pendingStart, false);
+    bool preprocessor = false;
+    while (pending.type != TokenType::EOF_TOKEN) {
+        Token next = lexer.getNextToken();
+        size_t nextStart = std::max(locator.offsetOf(next.line, next.column), pendingStart);
+        if (next.type == TokenType::EOF_TOKEN) {
+            nextStart = source.size();
+        }
+        stats.tokens++;
+        if (pending.type == TokenType::HASH) {
+            preprocessor = true;
+        } else if (pending.type == TokenType::NEWLINE) {
+            preprocessor = false;
+        }
+        size_t pendingEnd = std::min(pendingStart + lexemeLength(pending, source, pendingStart), nextStart);
+        sink.text(tokenClass(pending.type, next.type, preprocessor), source.data() + pendingStart,
+                  pendingEnd - pendingStart);
+        emitTrivia(sink, source.data() + pendingEnd, source.data() + nextStart,
+                   preprocessor && pending.type != TokenType::NEWLINE);
+        pending = std::move(next);
+        pendingStart = nextStart;
+    }
+
+    sink.endDocument();
+    stats.lines = sink.lines();
+    stats.outputBytes = sink.written();
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,417 @@
+#include "../include/IncludeResolver.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 预处理指令行的位置信息：[begin, end) 覆盖从 # 到行尾换行符（含）的token
+struct DirectiveLine {
+    size_t begin;
+    size_t end;
+    std::string name;      // 指令名，如 ifndef / define / endif / pragma
+    std::string argument;  // 指令后的第一个token
+};
+
+bool isLineStart(const std::vector<Token>& tokens, size_t index) {
+    return index == 0 || tokens[index - 1].type == TokenType::NEWLINE;
+}
+
+std::vector<DirectiveLine> collectDirectives(const std::vector<Token>& tokens) {
+    std::vector<DirectiveLine> directives;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (tokens[i].type != TokenType::HASH || !isLineStart(tokens, i)) {
+            continue;
+        }
+        DirectiveLine directive;
+        directive.begin = i;
+        size_t j = i + 1;
+        if (j < tokens.size() && tokens[j].type != TokenType::NEWLINE && tokens[j].type != TokenType::EOF_TOKEN) {
+            directive.name = tokens[j].value;
+            ++j;
+            if (j < tokens.size() && tokens[j].type != TokenType::NEWLINE && tokens[j].type != TokenType::EOF_TOKEN) {
+                directive.argument = tokens[j].value;
+            }
+        }
+        while (j < tokens.size() && tokens[j].type != TokenType::NEWLINE && tokens[j].type != TokenType::EOF_TOKEN) {
+            ++j;
+        }
+        if (j < tokens.size() && tokens[j].type == TokenType::NEWLINE) {
+            ++j;
+        }
+        directive.end = j;
+        directives.push_back(directive);
+        i = j - 1;
+    }
+    return directives;
+}
+
+bool isConditionalStart(const std::string& name) {
+    return name == "if" || name == "ifdef" || name == "ifndef";
+}
+
+// 第一个有效token的下标（跳过换行）
+size_t firstSignificant(const std::vector<Token>& tokens, size_t from) {
+    while (from < tokens.size() && tokens[from].type == TokenType::NEWLINE) {
+        ++from;
+    }
+    return from;
+}
+
+} // namespace
+
+// IncludeResolver类实现
+IncludeResolver::IncludeResolver() : lexCount(0), cacheHits(0) {
+    fileNames.push_back("");  // fileId 0 保留给主文件
+}
+
+void IncludeResolver::addSearchPath(const std::string& path) {
+    searchPaths.push_back(path);
+}
+
+const std::vector<std::string>& IncludeResolver::getSearchPaths() const {
+    return searchPaths;
+}
+
+std::string IncludeResolver::resolvePath(const std::string& name, bool angled,
+                                         const std::string& includingFile) const {
+    std::vector<fs::path> candidates;
+    // "..." 形式先在包含者所在目录查找
+    if (!angled) {
+        fs::path base = fs::path(includingFile).parent_path();
+        candidates.push_back(base / name);
+    }
+    for (const auto& dir : searchPaths) {
+        candidates.push_back(fs::path(dir) / name);
+    }
+
+    for (const auto& candidate : candidates) {
+        std::error_code ec;
+        if (fs::is_regular_file(candidate, ec)) {
+            fs::path canonical = fs::weakly_canonical(candidate, ec);
+            return ec ? candidate.lexically_normal().string() : canonical.string();
+        }
+    }
+    return "";
+}
+
+std::shared_ptr<IncludeResolver::CacheEntry> IncludeResolver::findOrCreateEntry(const std::string& path,
+                                                                               bool& created) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(path);
+    if (it != cache.end()) {
+        created = false;
+        return it->second;
+    }
+    auto entry = std::make_shared<CacheEntry>();
+    fileNames.push_back(path);
+    entry->fileId = static_cast<int>(fileNames.size() - 1);
+    cache.emplace(path, entry);
+    created = true;
+    return entry;
+}
+
+std::shared_ptr<const IncludedFile> IncludeResolver::lexFile(const std::string& path, int fileId) const {
+    auto file = std::make_shared<IncludedFile>();
+    file->path = path;
+    file->fileId = fileId;
+
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        file->tokens = std::make_shared<const std::vector<Token>>();
+        return file;
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    file->found = true;
+
+    Lexer lexer(buffer.str());
+    std::vector<Token> tokens = lexer.tokenize();
+    for (const auto& error : lexer.getErrors()) {
+        file->errors.emplace_back(error.message, error.line, error.column, fileId);
+    }
+    for (auto& token : tokens) {
+        token.fileId = fileId;
+    }
+
+    // 识别 #pragma once 与头文件保护宏，并从共享token流中去掉这些指令行
+    std::vector<DirectiveLine> directives = collectDirectives(tokens);
+    std::vector<bool> removed(tokens.size(), false);
+    auto removeLine = [&removed](const DirectiveLine& directive) {
+        for (size_t k = directive.begin; k < directive.end; ++k) {
+            removed[k] = true;
+        }
+    };
+
+    for (const auto& directive : directives) {
+        if (directive.name == "pragma" && directive.argument == "once") {
+            file->includeOnce = true;
+            removeLine(directive);
+        }
+    }
+
+    // 保护宏形式：文件以 #ifndef G / #define G 开头，且与之匹配的 #endif 之后只剩空行
+    size_t first = firstSignificant(tokens, 0);
+    if (directives.size() >= 3) {
+        size_t start = 0;
+        while (start < directives.size() && directives[start].name == "pragma") {
+            first = firstSignificant(tokens, directives[start].end);
+            ++start;
+        }
+        if (start + 2 < directives.size() &&
+            directives[start].begin == first &&
+            directives[start].name == "ifndef" &&
+            directives[start + 1].name == "define" &&
+            directives[start + 1].begin == firstSignificant(tokens, directives[start].end) &&
+            directives[start + 1].argument == directives[start].argument) {
+            int depth = 0;
+            size_t matching = directives.size();
+            for (size_t k = start; k < directives.size(); ++k) {
+                if (isConditionalStart(directives[k].name)) {
+                    ++depth;
+                } else if (directives[k].name == "endif") {
+                    if (--depth == 0) {
+                        matching = k;
+                        break;
+                    }
+                }
+            }
+            if (matching < directives.size()) {
+                size_t rest = firstSignificant(tokens, directives[matching].end);
+                if (rest >= tokens.size() || tokens[rest].type == TokenType::EOF_TOKEN) {
+                    file->includeOnce = true;
+                    file->guardMacro = directives[start].argument;
+                    removeLine(directives[start]);
+                    removeLine(directives[start + 1]);
+                    removeLine(directives[matching]);
+                }
+            }
+        }
+    }
+
+    auto shared = std::make_shared<std::vector<Token>>();
+    shared->reserve(tokens.size());
+    for (size_t k = 0; k < tokens.size(); ++k) {
+        if (!removed[k] && tokens[k].type != TokenType::EOF_TOKEN) {
+            shared->push_back(tokens[k]);
+        }
+    }
+    file->tokens = shared;
+    return file;
+}
+
+std::shared_ptr<const IncludedFile> IncludeResolver::load(const std::string& path) {
+    bool created = false;
+    std::shared_ptr<CacheEntry> entry = findOrCreateEntry(path, created);
+
+    // 其他线程若正在分析同一文件，会在这里等待其完成
+    bool lexed = false;
+    std::call_once(entry->loaded, [&]() {
+        entry->file = lexFile(path, entry->fileId);
+        lexed = true;
+    });
+    if (lexed) {
+        ++lexCount;
+    } else {
+        ++cacheHits;
+    }
+    return entry->file;
+}
+
+int IncludeResolver::getFileId(const std::string& path) {
+    bool created = false;
+    return findOrCreateEntry(path, created)->fileId;
+}
+
+void IncludeResolver::addEdge(const std::string& from, const IncludeEdge& edge) {
+    std::lock_guard<std::mutex> lock(graphMutex);
+    auto it = graph.find(from);
+    if (it == graph.end()) {
+        graphOrder.push_back(from);
+        graph[from].push_back(edge);
+        return;
+    }
+    // 同一个头文件会在多个翻译单元中被展开，这里去重
+    for (const auto& existing : it->second) {
+        if (existing.line == edge.line && existing.spelled == edge.spelled) {
+            return;
+        }
+    }
+    it->second.push_back(edge);
+}
+
+std::string IncludeResolver::readIncludeTarget(const std::vector<Token>& tokens, size_t& index) {
+    if (index >= tokens.size()) {
+        return "";
+    }
+    if (tokens[index].type == TokenType::STRING) {
+        return "\"" + tokens[index++].value + "\"";
+    }
+    if (tokens[index].type == TokenType::LANGLE) {
+        std::string name;
+        size_t j = index + 1;
+        while (j < tokens.size() && tokens[j].type != TokenType::RANGLE &&
+               tokens[j].type != TokenType::NEWLINE && tokens[j].type != TokenType::EOF_TOKEN) {
+            name += tokens[j].value;
+            ++j;
+        }
+        if (j < tokens.size() && tokens[j].type == TokenType::RANGLE) {
+            index = j + 1;
+            return "<" + name + ">";
+        }
+    }
+    return "";
+}
+
+void IncludeResolver::expandInto(const std::vector<Token>& input, const std::string& filename,
+                                 std::vector<Token>& output, IncludeState& state,
+                                 std::vector<std::string>& includeStack, std::vector<LexicalError>& errors) {
+    // 被包含文件中的错误在消息前加上文件名，主文件的错误保持原样
+    const std::string errorPrefix = includeStack.size() > 1 ? filename + ": " : "";
+    size_t i = 0;
+    while (i < input.size()) {
+        const Token& token = input[i];
+        bool isInclude = token.type == TokenType::HASH && isLineStart(input, i) &&
+                         i + 1 < input.size() && input[i + 1].type == TokenType::INCLUDE;
+        if (!isInclude) {
+            output.push_back(token);
+            ++i;
+            continue;
+        }
+
+        // 指令本身原样保留，供语法分析生成预处理指令节点
+        size_t targetIndex = i + 2;
+        std::string spelled = readIncludeTarget(input, targetIndex);
+        output.insert(output.end(), input.begin() + i, input.begin() + targetIndex);
+        i = targetIndex;
+        if (spelled.empty()) {
+            continue;  // 格式错误留给语法分析报告
+        }
+
+        bool angled = spelled[0] == '<';
+        std::string name = spelled.substr(1, spelled.size() - 2);
+        std::string resolved = resolvePath(name, angled, filename);
+        IncludeEdge edge{spelled, resolved, token.line};
+        addEdge(filename, edge);
+        state.edges.emplace_back(filename, edge);
+
+        if (resolved.empty()) {
+            // 找不到的系统头文件保持原样，找不到的 "..." 头文件视为错误
+            if (!angled) {
+                errors.emplace_back(errorPrefix + "Cannot open include file " + spelled,
+                                    token.line, token.column, token.fileId);
+            }
+            continue;
+        }
+
+        if (std::find(includeStack.begin(), includeStack.end(), resolved) != includeStack.end()) {
+            errors.emplace_back(errorPrefix + "Circular include of " + spelled,
+                                token.line, token.column, token.fileId);
+            continue;
+        }
+
+        if (state.onceIncluded.count(resolved)) {
+            continue;  // 带保护的文件已在本翻译单元中展开过
+        }
+        std::shared_ptr<const IncludedFile> included = load(resolved);
+        if (!included->found) {
+            errors.emplace_back(errorPrefix + "Cannot read include file " + spelled,
+                                token.line, token.column, token.fileId);
+            continue;
+        }
+        if (included->includeOnce) {
+            state.onceIncluded.insert(resolved);
+        }
+        if (std::find(state.includedFiles.begin(), state.includedFiles.end(), resolved) == state.includedFiles.end()) {
+            state.includedFiles.push_back(resolved);
+        }
+        for (const auto& error : included->errors) {
+            errors.emplace_back(resolved + ": " + error.message, error.line, error.column, error.fileId);
+        }
+
+        // 被包含文件的内容单独成行插入
+        output.push_back(Token(TokenType::NEWLINE, "\n", token.line, token.column));
+        output.back().fileId = token.fileId;
+        output.back().offset = token.offset;
+        includeStack.push_back(resolved);
+        expandInto(*included->tokens, resolved, output, state, includeStack, errors);
+        includeStack.pop_back();
+    }
+}
+
+std::vector<Token> IncludeResolver::expand(const std::vector<Token>& tokens, const std::string& filename,
+                                           std::vector<LexicalError>& errors, IncludeState* state) {
+    std::vector<Token> output;
+    output.reserve(tokens.size());
+    IncludeState localState;
+    std::vector<std::string> includeStack;
+
+    std::error_code ec;
+    fs::path canonical = fs::weakly_canonical(fs::path(filename), ec);
+    includeStack.push_back(ec ? filename : canonical.string());
+
+    expandInto(tokens, filename, output, state ? *state : localState, includeStack, errors);
+    return output;
+}
+
+std::string IncludeResolver::getFileName(int fileId) const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (fileId <= 0 || fileId >= static_cast<int>(fileNames.size())) {
+        return "";
+    }
+    return fileNames[fileId];
+}
+
+size_t IncludeResolver::getLexCount() const {
+    return lexCount;
+}
+
+size_t IncludeResolver::getCacheHits() const {
+    return cacheHits;
+}
+
+void IncludeResolver::printIncludeGraph(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(graphMutex);
+    os << "\n=== Include Graph ===" << std::endl;
+    if (graphOrder.empty()) {
+        os << "No #include directives found." << std::endl;
+    }
+    for (const auto& from : graphOrder) {
+        os << from << std::endl;
+        for (const auto& edge : graph.at(from)) {
+            os << "  -> " << edge.spelled << " (line " << edge.line << ")";
+            if (edge.resolved.empty()) {
+                os << " [not found]";
+            } else {
+                os << " => " << edge.resolved;
+            }
+            os << std::endl;
+        }
+    }
+    os << "Files lexed: " << lexCount << ", cache hits: " << cacheHits << std::endl;
+}
+
+void IncludeResolver::printIncludeGraphDot(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(graphMutex);
+    os << "digraph includes {" << std::endl;
+    os << "    node [shape=box];" << std::endl;
+    for (const auto& from : graphOrder) {
+        for (const auto& edge : graph.at(from)) {
+            std::string target = edge.resolved.empty() ? edge.spelled : edge.resolved;
+            std::string escaped;
+            for (char c : target) {
+                if (c == '"') escaped += '\\';
+                escaped += c;
+            }
+            os << "    \"" << from << "\" -> \"" << escaped << "\"";
+            if (edge.resolved.empty()) {
+                os << " [style=dashed]";
+            }
+            os << ";" << std::endl;
+        }
+    }
+    os << "}" << std::endl;
+}
@@ -0,0 +1,981 @@
+#include "../include/IntervalAnalyzer.h"
+#include "../include/ControlFlowGraph.h"
+#include "../include/ASTWalker.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <unordered_map>
+#include <cerrno>
+#include <cstdlib>
+
+namespace {
+
+constexpr int64_t NEG_INF = Interval::NEG_INF;
+constexpr int64_t POS_INF = Interval::POS_INF;
+
+bool isInfinite(int64_t value) {
+    return value == NEG_INF || value == POS_INF;
+}
+
+int64_t negateBound(int64_t value) {
+    if (value == NEG_INF) {
+        return POS_INF;
+    }
+    if (value == POS_INF) {
+        return NEG_INF;
+    }
+    return -value;
+}
+
+// 扩展整数上的运算：溢出按无穷处理，结果只会更宽，因此仍是安全的近似
+int64_t addBound(int64_t a, int64_t b) {
+    if (isInfinite(a)) {
+        return a;
+    }
+    if (isInfinite(b)) {
+        return b;
+    }
+    int64_t result;
+    if (__builtin_add_overflow(a, b, &result)) {
+        return b > 0 ? POS_INF : NEG_INF;
+    }
+    return result;
+}
+
+int64_t mulBound(int64_t a, int64_t b) {
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    bool positive = (a > 0) == (b > 0);
+    if (isInfinite(a) || isInfinite(b)) {
+        return positive ? POS_INF : NEG_INF;
+    }
+    int64_t result;
+    if (__builtin_mul_overflow(a, b, &result)) {
+        return positive ? POS_INF : NEG_INF;
+    }
+    return result;
+}
+
+// C语言的除法向零取整；b不为0
+int64_t divBound(int64_t a, int64_t b) {
+    if (isInfinite(b)) {
+        return isInfinite(a) ? ((a > 0) == (b > 0) ? POS_INF : NEG_INF) : 0;
+    }
+    if (isInfinite(a)) {
+        return (a > 0) == (b > 0) ? POS_INF : NEG_INF;
+    }
+    return a / b;
+}
+
+// 对四个端点组合取最小与最大值；适用于在每个参数上分段单调的运算
+template <typename Op>
+Interval corners(const Interval& a, const Interval& b, Op op) {
+    int64_t values[4] = {op(a.lo, b.lo), op(a.lo, b.hi), op(a.hi, b.lo), op(a.hi, b.hi)};
+    return Interval::range(*std::min_element(values, values + 4), *std::max_element(values, values + 4));
+}
+
+Interval add(const Interval& a, const Interval& b) {
+    return Interval::range(addBound(a.lo, b.lo), addBound(a.hi, b.hi));
+}
+
+Interval negate(const Interval& a) {
+    return Interval::range(negateBound(a.hi), negateBound(a.lo));
+}
+
+Interval multiply(const Interval& a, const Interval& b) {
+    return corners(a, b, mulBound);
+}
+
+// 除数的区间去掉0之后分成负、正两段分别计算
+Interval divide(const Interval& a, const Interval& b) {
+    Interval result = Interval::bottom();
+    Interval negative = b.meet(Interval::range(NEG_INF, -1));
+    Interval positive = b.meet(Interval::range(1, POS_INF));
+    if (!negative.isBottom()) {
+        result = result.join(corners(a, negative, divBound));
+    }
+    if (!positive.isBottom()) {
+        result = result.join(corners(a, positive, divBound));
+    }
+    return result.isBottom() ? Interval::top() : result;
+}
+
+// 余数的绝对值小于除数的绝对值，符号与被除数相同
+Interval modulo(const Interval& a, const Interval& b) {
+    if (a.isConstant() && b.isConstant() && b.lo != 0) {
+        return Interval::constant(a.lo % b.lo);
+    }
+    Interval divisor = b.meet(Interval::range(NEG_INF, -1)).join(b.meet(Interval::range(1, POS_INF)));
+    if (divisor.isBottom()) {
+        return Interval::top();
+    }
+    int64_t limit = std::max(negateBound(divisor.lo), divisor.hi);
+    limit = isInfinite(limit) ? POS_INF : limit - 1;
+    int64_t lo = a.lo >= 0 ? 0 : std::max(a.lo, negateBound(limit));
+    int64_t hi = a.hi <= 0 ? 0 : std::min(a.hi, limit);
+    return Interval::range(lo, hi);
+}
+
+// 比较的结果：确定成立为1，确定不成立为0，否则为[0, 1]
+Interval truth(bool always, bool never) {
+    return always ? Interval::constant(1) : never ? Interval::constant(0) : Interval::range(0, 1);
+}
+
+Interval compare(const std::string& op, const Interval& a, const Interval& b) {
+    if (op == "<") {
+        return truth(a.hi < b.lo, a.lo >= b.hi);
+    }
+    if (op == "<=") {
+        return truth(a.hi <= b.lo, a.lo > b.hi);
+    }
+    if (op == ">") {
+        return truth(a.lo > b.hi, a.hi <= b.lo);
+    }
+    if (op == ">=") {
+        return truth(a.lo >= b.hi, a.hi < b.lo);
+    }
+    bool disjoint = a.meet(b).isBottom();
+    bool same = a.isConstant() && b.isConstant() && a.lo == b.lo;
+    if (op == "==") {
+        return truth(same, disjoint);
+    }
+    return truth(disjoint, same);  // !=
+}
+
+// 满足 x op y 的x的取值
+Interval constrain(const Interval& x, const std::string& op, const Interval& y) {
+    if (op == "<") {
+        return x.meet(Interval::range(NEG_INF, addBound(y.hi, -1)));
+    }
+    if (op == "<=") {
+        return x.meet(Interval::range(NEG_INF, y.hi));
+    }
+    if (op == ">") {
+        return x.meet(Interval::range(addBound(y.lo, 1), POS_INF));
+    }
+    if (op == ">=") {
+        return x.meet(Interval::range(y.lo, POS_INF));
+    }
+    if (op == "==") {
+        return x.meet(y);
+    }
+    // !=：只有y为常量且恰好是x的端点时才能缩小
+    Interval result = x;
+    if (y.isConstant() && !result.isBottom()) {
+        if (result.lo == y.lo) {
+            result.lo = addBound(result.lo, 1);
+        }
+        if (result.hi == y.lo) {
+            result.hi = addBound(result.hi, -1);
+        }
+    }
+    return result;
+}
+
+/**
+ * 基本块入口处的抽象状态：只保存不是⊤的变量，按变量编号排序
+ */
+struct AbstractState {
+    bool reachable = false;
+    std::vector<std::pair<uint32_t, Interval>> bounds;
+
+    Interval get(uint32_t variable) const {
+        auto it = std::lower_bound(bounds.begin(), bounds.end(), variable,
+                                   [](const std::pair<uint32_t, Interval>& entry, uint32_t key) {
+                                       return entry.first < key;
+                                   });
+        return it != bounds.end() && it->first == variable ? it->second : Interval::top();
+    }
+
+    void set(uint32_t variable, const Interval& value) {
+        if (value.isBottom()) {
+            reachable = false;
+            bounds.clear();
+            return;
+        }
+        auto it = std::lower_bound(bounds.begin(), bounds.end(), variable,
+                                   [](const std::pair<uint32_t, Interval>& entry, uint32_t key) {
+                                       return entry.first < key;
+                                   });
+        bool present = it != bounds.end() && it->first == variable;
+        if (value.isTop()) {
+            if (present) {
+                bounds.erase(it);
+            }
+        } else if (present) {
+            it->second = value;
+        } else {
+            bounds.insert(it, {variable, value});
+        }
+    }
+
+    bool operator==(const AbstractState& other) const {
+        return reachable == other.reachable && bounds == other.bounds;
+    }
+};
+
+// 合并两个状态：两边都有界的变量取并，缺少的一方为⊤，结果也为⊤而不保存
+template <typename Combine>
+AbstractState mergeCommon(const AbstractState& a, const AbstractState& b, Combine combine) {
+    if (!a.reachable) {
+        return b;
+    }
+    if (!b.reachable) {
+        return a;
+    }
+    AbstractState result;
+    result.reachable = true;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.bounds.size() && j < b.bounds.size()) {
+        if (a.bounds[i].first < b.bounds[j].first) {
+            i++;
+        } else if (b.bounds[j].first < a.bounds[i].first) {
+            j++;
+        } else {
+            Interval value = combine(a.bounds[i].second, b.bounds[j].second);
+            if (!value.isTop()) {
+                result.bounds.emplace_back(a.bounds[i].first, value);
+            }
+            i++;
+            j++;
+        }
+    }
+    return result;
+}
+
+AbstractState join(const AbstractState& a, const AbstractState& b) {
+    return mergeCommon(a, b, [](const Interval& x, const Interval& y) { return x.join(y); });
+}
+
+AbstractState widen(const AbstractState& previous, const AbstractState& next) {
+    return mergeCommon(previous, next, [](const Interval& x, const Interval& y) { return x.widen(y); });
+}
+
+// 收窄：旧状态中为⊤的变量可以取得新状态中的界，因此按两边变量的并集合并
+AbstractState narrow(const AbstractState& previous, const AbstractState& next) {
+    if (!previous.reachable || !next.reachable) {
+        return next;
+    }
+    AbstractState result;
+    result.reachable = true;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < previous.bounds.size() || j < next.bounds.size()) {
+        if (j == next.bounds.size() ||
+            (i < previous.bounds.size() && previous.bounds[i].first < next.bounds[j].first)) {
+            result.bounds.push_back(previous.bounds[i++]);
+        } else if (i == previous.bounds.size() || next.bounds[j].first < previous.bounds[i].first) {
+            result.bounds.push_back(next.bounds[j++]);
+        } else {
+            Interval value = previous.bounds[i].second.narrow(next.bounds[j].second);
+            if (value.isBottom()) {
+                return AbstractState();
+            }
+            result.bounds.emplace_back(previous.bounds[i].first, value);
+            i++;
+            j++;
+        }
+    }
+    return result;
+}
+
+// 条件中是否有赋值或自增自减；有副作用的条件不按结构细化
+bool hasSideEffects(const ASTNode& node) {
+    bool found = false;
+    walkAST(node, [&found](const ASTNode& current) {
+        if (current.getKind() == ASTNodeKind::Identifier) {
+            std::string variable;
+            int delta;
+            bool prefix;
+            found = found || splitIncrement(static_cast<const IdentifierNode&>(current).name, variable, delta, prefix);
+        } else if (current.getKind() == ASTNodeKind::Assignment ||
+                   (current.getKind() == ASTNodeKind::BinaryExpression &&
+                    static_cast<const BinaryExpressionNode&>(current).operator_ == "=")) {
+            found = true;
+        }
+        return !found;
+    });
+    return found;
+}
+
+// 只由字面量组成的条件（如 while (1)）是有意写成的，不报告
+bool mentionsVariable(const ASTNode& node) {
+    bool found = false;
+    walkAST(node, [&found](const ASTNode& current) {
+        found = found || current.getKind() == ASTNodeKind::Identifier;
+        return !found;
+    });
+    return found;
+}
+
+/**
+ * 一个函数的不动点求解
+ */
+class FunctionAnalysis {
+private:
+    const FunctionDefinitionNode& function;
+    const std::vector<Token>& tokens;
+    ControlFlowGraph cfg;
+    std::unordered_map<std::string, uint32_t> variables;
+    std::vector<std::string> names;  // 变量编号到名字
+    std::vector<AbstractState> entry;
+    std::vector<std::vector<AbstractState>> exits;
+    std::vector<IntervalFinding>* report = nullptr;  // 仅在最后的检查遍历中非空
+    std::vector<IndexRange>* indexRanges = nullptr;
+    size_t iterations = 0;
+
+    // 函数中只以int/char声明的变量（含形参）参与分析
+    void collectVariables() {
+        std::unordered_map<std::string, bool> integral;
+        auto declare = [&integral](const VarDeclarationNode& var) {
+            bool isIntegral = var.type == "int" || var.type == "char";
+            auto it = integral.find(var.identifier);
+            if (it == integral.end()) {
+                integral[var.identifier] = isIntegral;
+            } else {
+                it->second = it->second && isIntegral;
+            }
+        };
+        for (const auto& parameter : function.parameters) {
+            if (parameter && parameter->getKind() == ASTNodeKind::VarDeclaration) {
+                declare(static_cast<const VarDeclarationNode&>(*parameter));
+            }
+        }
+        if (function.body) {
+            walkAST(*function.body, [&declare](const ASTNode& node) {
+                if (node.getKind() == ASTNodeKind::VarDeclaration) {
+                    declare(static_cast<const VarDeclarationNode&>(node));
+                }
+                return true;
+            });
+        }
+        for (const auto& entry : integral) {
+            if (entry.second) {
+                uint32_t id = static_cast<uint32_t>(variables.size());
+                variables.emplace(entry.first, id);
+                names.push_back(entry.first);
+            }
+        }
+    }
+
+    int variableOf(const std::string& name) const {
+        auto it = variables.find(name);
+        return it == variables.end() ? -1 : static_cast<int>(it->second);
+    }
+
+    void assign(const std::string& name, const Interval& value, AbstractState& state) const {
+        int variable = variableOf(name);
+        if (variable >= 0) {
+            state.set(static_cast<uint32_t>(variable), value);
+        }
+    }
+
+    void addFinding(const ASTNode& node, IntervalFindingKind kind, const std::string& message) {
+        IntervalFinding finding;
+        finding.function = function.name;
+        finding.line = node.line;
+        finding.column = node.column;
+        finding.kind = kind;
+        finding.message = message;
+        report->push_back(std::move(finding));
+    }
+
+    void checkDivisor(const BinaryExpressionNode& node, const Interval& divisor) {
+        if (!report || !divisor.contains(0) || divisor.isTop()) {
+            return;
+        }
+        std::string expression = node.right ? sourceText(*node.right, tokens) : "";
+        if (divisor.isConstant()) {
+            addFinding(node, IntervalFindingKind::DivisionByZero,
+                       "division by zero: divisor '" + expression + "' is always 0");
+        } else {
+            addFinding(node, IntervalFindingKind::PossibleDivisionByZero,
+                       "possible division by zero: divisor '" + expression + "' in " + divisor.toString());
+        }
+    }
+
+    void recordIndex(const IndexExpressionNode& access, const Interval& index, const AbstractState& state) {
+        if (report && indexRanges && state.reachable) {
+            indexRanges->push_back({&access, index});
+        }
+    }
+
+    // 求值并执行其中的赋值与自增自减
+    Interval evaluate(const ASTNode* node, AbstractState& state) {
+        if (!node || !state.reachable) {
+            return Interval::top();
+        }
+        switch (node->getKind()) {
+            case ASTNodeKind::Literal: {
+                const auto* literal = static_cast<const LiteralNode*>(node);
+                if (literal->type != TokenType::INTEGER) {
+                    return Interval::top();
+                }
+                errno = 0;
+                char* end = nullptr;
+                long long value = std::strtoll(literal->value.c_str(), &end, 10);
+                if (errno != 0 || !end || *end != '\0' || isInfinite(value)) {
+                    return Interval::top();
+                }
+                return Interval::constant(value);
+            }
+            case ASTNodeKind::Identifier: {
+                const std::string& name = static_cast<const IdentifierNode*>(node)->name;
+                std::string variable;
+                int delta;
+                bool prefix;
+                if (!splitIncrement(name, variable, delta, prefix)) {
+                    int id = variableOf(name);
+                    return id >= 0 ? state.get(static_cast<uint32_t>(id)) : Interval::top();
+                }
+                int id = variableOf(variable);
+                if (id < 0) {
+                    return Interval::top();
+                }
+                Interval before = state.get(static_cast<uint32_t>(id));
+                Interval after = add(before, Interval::constant(delta));
+                state.set(static_cast<uint32_t>(id), after);
+                return prefix ? after : before;
+            }
+            case ASTNodeKind::UnaryExpression: {
+                const auto* unary = static_cast<const UnaryExpressionNode*>(node);
+                Interval operand = evaluate(unary->operand.get(), state);
+                if (unary->operator_ == "-") {
+                    return negate(operand);
+                }
+                if (unary->operator_ == "!") {
+                    return truth(operand == Interval::constant(0), !operand.contains(0));
+                }
+                return Interval::top();
+            }
+            case ASTNodeKind::BinaryExpression:
+                return evaluateBinary(static_cast<const BinaryExpressionNode&>(*node), state);
+            case ASTNodeKind::Assignment: {
+                const auto* assignment = static_cast<const AssignmentNode*>(node);
+                Interval value = evaluate(assignment->expression.get(), state);
+                assign(assignment->identifier, value, state);
+                return value;
+            }
+            case ASTNodeKind::FunctionCall:
+                for (const auto& argument : static_cast<const FunctionCallNode*>(node)->arguments) {
+                    evaluate(argument.get(), state);
+                }
+                return Interval::top();
+            case ASTNodeKind::IndexExpression: {
+                // 数组元素不跟踪，取值未知
+                const auto* access = static_cast<const IndexExpressionNode*>(node);
+                recordIndex(*access, evaluate(access->index.get(), state), state);
+                return Interval::top();
+            }
+            default:
+                return Interval::top();
+        }
+    }
+
+    Interval evaluateBinary(const BinaryExpressionNode& node, AbstractState& state) {
+        const std::string& op = node.operator_;
+        if (op == "=") {
+            if (node.left && node.left->getKind() == ASTNodeKind::IndexExpression) {
+                // 先求下标再求值，与执行引擎的求值顺序一致
+                evaluate(node.left.get(), state);
+            }
+            Interval value = evaluate(node.right.get(), state);
+            if (node.left && node.left->getKind() == ASTNodeKind::Identifier) {
+                assign(static_cast<const IdentifierNode&>(*node.left).name, value, state);
+            }
+            return value;
+        }
+        if (op == "&&" || op == "||") {
+            // 短路求值：右边只在左边不能决定结果时执行
+            Interval left = evaluate(node.left.get(), state);
+            bool leftTrue = !left.contains(0);
+            bool leftFalse = left == Interval::constant(0);
+            if ((op == "&&" && leftFalse) || (op == "||" && leftTrue)) {
+                return Interval::constant(op == "&&" ? 0 : 1);
+            }
+            AbstractState evaluated = state;
+            Interval right = evaluate(node.right.get(), evaluated);
+            bool rightTrue = !right.contains(0);
+            bool rightFalse = right == Interval::constant(0);
+            state = (leftTrue || leftFalse) ? evaluated : join(state, evaluated);
+            if (op == "&&") {
+                return truth(leftTrue && rightTrue, rightFalse);
+            }
+            return truth(rightTrue, leftFalse && rightFalse);
+        }
+        Interval left = evaluate(node.left.get(), state);
+        Interval right = evaluate(node.right.get(), state);
+        if (!state.reachable) {
+            return Interval::top();
+        }
+        if (op == "+") {
+            return add(left, right);
+        }
+        if (op == "-") {
+            return add(left, negate(right));
+        }
+        if (op == "*") {
+            return multiply(left, right);
+        }
+        if (op == "/" || op == "%") {
+            checkDivisor(node, right);
+            return op == "/" ? divide(left, right) : modulo(left, right);
+        }
+        if (isComparison(op)) {
+            return compare(op, left, right);
+        }
+        return Interval::top();
+    }
+
+    void execute(const ASTNode* statement, AbstractState& state) {
+        switch (statement->getKind()) {
+            case ASTNodeKind::VarDeclaration: {
+                const auto* var = static_cast<const VarDeclarationNode*>(statement);
+                // 未初始化的变量取值未知
+                Interval value = var->initializer ? evaluate(var->initializer.get(), state) : Interval::top();
+                if (state.reachable) {
+                    assign(var->identifier, value, state);
+                }
+                break;
+            }
+            case ASTNodeKind::ExpressionStatement:
+                evaluate(static_cast<const ExpressionStatementNode*>(statement)->expression.get(), state);
+                break;
+            case ASTNodeKind::ReturnStatement:
+                evaluate(static_cast<const ReturnStatementNode*>(statement)->expression.get(), state);
+                break;
+            default:
+                evaluate(statement, state);
+                break;
+        }
+    }
+
+    // 假设条件取值为truth，缩小其中变量的区间；无副作用的条件才调用
+    void refine(const ASTNode* condition, bool truth, AbstractState& state) {
+        if (!condition || !state.reachable) {
+            return;
+        }
+        switch (condition->getKind()) {
+            case ASTNodeKind::UnaryExpression: {
+                const auto* unary = static_cast<const UnaryExpressionNode*>(condition);
+                if (unary->operator_ == "!") {
+                    refine(unary->operand.get(), !truth, state);
+                }
+                break;
+            }
+            case ASTNodeKind::Identifier: {
+                int id = variableOf(static_cast<const IdentifierNode*>(condition)->name);
+                if (id >= 0) {
+                    Interval value = state.get(static_cast<uint32_t>(id));
+                    state.set(static_cast<uint32_t>(id), constrain(value, truth ? "!=" : "==", Interval::constant(0)));
+                }
+                break;
+            }
+            case ASTNodeKind::BinaryExpression: {
+                const auto& binary = static_cast<const BinaryExpressionNode&>(*condition);
+                const std::string& op = binary.operator_;
+                if (op == "&&" || op == "||") {
+                    if ((op == "&&") == truth) {
+                        // a && b 成立或 a || b 不成立：两边都取truth
+                        refine(binary.left.get(), truth, state);
+                        refine(binary.right.get(), truth, state);
+                    } else {
+                        // 否则左边取truth，或者左边取!truth而右边取truth
+                        AbstractState shortCircuit = state;
+                        refine(binary.left.get(), truth, shortCircuit);
+                        refine(binary.left.get(), !truth, state);
+                        refine(binary.right.get(), truth, state);
+                        state = join(shortCircuit, state);
+                    }
+                } else if (isComparison(op)) {
+                    Interval left = evaluate(binary.left.get(), state);
+                    Interval right = evaluate(binary.right.get(), state);
+                    std::string holds = truth ? op : negateComparison(op);
+                    int leftVariable = binary.left && binary.left->getKind() == ASTNodeKind::Identifier
+                                           ? variableOf(static_cast<const IdentifierNode&>(*binary.left).name)
+                                           : -1;
+                    int rightVariable = binary.right && binary.right->getKind() == ASTNodeKind::Identifier
+                                            ? variableOf(static_cast<const IdentifierNode&>(*binary.right).name)
+                                            : -1;
+                    if (leftVariable >= 0) {
+                        state.set(static_cast<uint32_t>(leftVariable), constrain(left, holds, right));
+                    }
+                    if (rightVariable >= 0 && state.reachable) {
+                        state.set(static_cast<uint32_t>(rightVariable),
+                                  constrain(right, swapComparison(holds), left));
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        if (state.reachable) {
+            Interval value = evaluate(condition, state);
+            if ((truth && value == Interval::constant(0)) || (!truth && !value.contains(0))) {
+                state = AbstractState();
+            }
+        }
+    }
+
+    AbstractState branch(const ASTNode* condition, bool truth, const AbstractState& state, const Interval& value) {
+        if ((truth && value == Interval::constant(0)) || (!truth && !value.contains(0))) {
+            return AbstractState();
+        }
+        AbstractState result = state;
+        if (!hasSideEffects(*condition)) {
+            std::vector<IntervalFinding>* saved = report;
+            report = nullptr;  // 细化时的重复求值不再报告
+            refine(condition, truth, result);
+            report = saved;
+        }
+        return result;
+    }
+
+    void checkLoopBound(const ControlFlowGraph::Block& block, const AbstractState& state) {
+        if (!block.condition || block.condition->getKind() != ASTNodeKind::BinaryExpression) {
+            return;
+        }
+        const auto& condition = static_cast<const BinaryExpressionNode&>(*block.condition);
+        if (!isComparison(condition.operator_) || hasSideEffects(condition)) {
+            return;
+        }
+        AbstractState scratch = state;
+        const ASTNode* sides[2] = {condition.left.get(), condition.right.get()};
+        for (int i = 0; i < 2; i++) {
+            const ASTNode* side = sides[i];
+            const ASTNode* other = sides[1 - i];
+            if (!side || !other || side->getKind() != ASTNodeKind::Identifier) {
+                continue;
+            }
+            const std::string& name = static_cast<const IdentifierNode*>(side)->name;
+            int id = variableOf(name);
+            if (id < 0) {
+                continue;
+            }
+            Interval range = state.get(static_cast<uint32_t>(id));
+            std::vector<IntervalFinding>* saved = report;
+            report = nullptr;
+            bool constantBound = evaluate(other, scratch).isConstant();
+            report = saved;
+            if (constantBound && range.isFinite()) {
+                addFinding(*block.loop, IntervalFindingKind::LoopBound,
+                           "constant loop bound: '" + sourceText(condition, tokens) + "', " + name + " in " +
+                               range.toString() + " at loop head");
+                return;
+            }
+        }
+    }
+
+    void transfer(int id) {
+        const ControlFlowGraph::Block& block = cfg.getBlocks()[id];
+        AbstractState state = entry[id];
+        iterations++;
+        for (const ASTNode* statement : block.statements) {
+            if (!state.reachable) {
+                break;
+            }
+            execute(statement, state);
+        }
+        std::vector<AbstractState>& out = exits[id];
+        out.assign(block.successors.size(), state);
+        if (!block.condition || block.successors.size() != 2 || !state.reachable) {
+            return;
+        }
+        if (report && block.loop) {
+            checkLoopBound(block, state);
+        }
+        Interval value = evaluate(block.condition, state);
+        if (report && state.reachable && mentionsVariable(*block.condition)) {
+            std::string text = "condition '" + sourceText(*block.condition, tokens) + "' is always ";
+            if (!value.contains(0)) {
+                addFinding(*block.condition, IntervalFindingKind::AlwaysTrue, text + "true");
+            } else if (value == Interval::constant(0)) {
+                addFinding(*block.condition, IntervalFindingKind::AlwaysFalse, text + "false");
+            }
+        }
+        out[0] = branch(block.condition, true, state, value);
+        out[1] = branch(block.condition, false, state, value);
+    }
+
+    // 所有前驱沿边传来的状态的并
+    AbstractState incoming(int id) const {
+        AbstractState result;
+        for (int predecessor : cfg.getBlocks()[id].predecessors) {
+            const std::vector<int>& successors = cfg.getBlocks()[predecessor].successors;
+            const std::vector<AbstractState>& out = exits[predecessor];
+            for (size_t k = 0; k < successors.size() && k < out.size(); k++) {
+                if (successors[k] == id) {
+                    result = join(result, out[k]);
+                }
+            }
+        }
+        return result;
+    }
+
+    void update(int id) {
+        if (id != ControlFlowGraph::ENTRY) {
+            entry[id] = incoming(id);
+        }
+        transfer(id);
+    }
+
+    // 按弱拓扑序依次处理 [begin, end) 中的元素，分量递归地求稳定
+    void iterate(size_t begin, size_t end) {
+        const std::vector<int>& order = cfg.getOrder();
+        const std::vector<int>& componentEnd = cfg.getComponentEnd();
+        size_t i = begin;
+        while (i < end) {
+            if (componentEnd[i] >= 0) {
+                stabilize(i);
+                i = static_cast<size_t>(componentEnd[i]);
+            } else {
+                update(order[i]);
+                i++;
+            }
+        }
+    }
+
+    void stabilize(size_t position) {
+        int head = cfg.getOrder()[position];
+        size_t end = static_cast<size_t>(cfg.getComponentEnd()[position]);
+        for (size_t round = 0;; round++) {
+            AbstractState next = incoming(head);
+            if (round > 0) {
+                next = widen(entry[head], next);
+                if (next == entry[head]) {
+                    break;
+                }
+            }
+            entry[head] = std::move(next);
+            transfer(head);
+            iterate(position + 1, end);
+        }
+    }
+
+public:
+    FunctionAnalysis(const FunctionDefinitionNode& function, const std::vector<Token>& tokens)
+        : function(function), tokens(tokens), cfg(function) {
+        collectVariables();
+    }
+
+    void run(std::vector<IntervalFinding>& out, IntervalStats& stats, std::vector<LoopHeadState>* loopHeads,
+             std::vector<IndexRange>* ranges) {
+        size_t count = cfg.getBlocks().size();
+        entry.assign(count, AbstractState());
+        exits.assign(count, {});
+        entry[ControlFlowGraph::ENTRY].reachable = true;
+        const std::vector<int>& order = cfg.getOrder();
+
+        iterate(0, order.size());
+        // 两遍收窄找回被加宽推到无穷的界
+        for (int pass = 0; pass < 2; pass++) {
+            for (int id : order) {
+                if (id != ControlFlowGraph::ENTRY) {
+                    entry[id] = narrow(entry[id], incoming(id));
+                }
+                transfer(id);
+            }
+        }
+        if (loopHeads) {
+            for (int id : order) {
+                const ControlFlowGraph::Block& block = cfg.getBlocks()[id];
+                if (!block.loop || !entry[id].reachable) {
+                    continue;
+                }
+                LoopHeadState head;
+                head.loop = block.loop;
+                for (const auto& bound : entry[id].bounds) {
+                    head.bounds.emplace_back(names[bound.first], bound.second);
+                }
+                loopHeads->push_back(std::move(head));
+            }
+        }
+        // 在不动点上检查一遍
+        report = &out;
+        indexRanges = ranges;
+        for (int id : order) {
+            transfer(id);
+        }
+        report = nullptr;
+        indexRanges = nullptr;
+
+        stats.blocks += count;
+        stats.iterations += iterations;
+    }
+};
+
+const char* kindLabel(IntervalFindingKind kind) {
+    return kind == IntervalFindingKind::LoopBound ? "note" : "warning";
+}
+
+} // namespace
+
+// Interval实现
+Interval Interval::top() {
+    return Interval();
+}
+
+Interval Interval::bottom() {
+    return range(1, 0);
+}
+
+Interval Interval::constant(int64_t value) {
+    return range(value, value);
+}
+
+Interval Interval::range(int64_t lo, int64_t hi) {
+    Interval result;
+    result.lo = lo;
+    result.hi = hi;
+    return result;
+}
+
+bool Interval::isTop() const {
+    return lo == NEG_INF && hi == POS_INF;
+}
+
+bool Interval::isBottom() const {
+    return lo > hi;
+}
+
+bool Interval::isConstant() const {
+    return lo == hi && !isInfinite(lo);
+}
+
+bool Interval::isFinite() const {
+    return !isBottom() && !isInfinite(lo) && !isInfinite(hi);
+}
+
+bool Interval::contains(int64_t value) const {
+    return lo <= value && value <= hi;
+}
+
+Interval Interval::join(const Interval& other) const {
+    if (isBottom()) {
+        return other;
+    }
+    if (other.isBottom()) {
+        return *this;
+    }
+    return range(std::min(lo, other.lo), std::max(hi, other.hi));
+}
+
+Interval Interval::meet(const Interval& other) const {
+    if (isBottom() || other.isBottom()) {
+        return bottom();
+    }
+    Interval result = range(std::max(lo, other.lo), std::min(hi, other.hi));
+    return result.isBottom() ? bottom() : result;
+}
+
+Interval Interval::widen(const Interval& next) const {
+    if (isBottom()) {
+        return next;
+    }
+    if (next.isBottom()) {
+        return *this;
+    }
+    return range(next.lo < lo ? NEG_INF : lo, next.hi > hi ? POS_INF : hi);
+}
+
+Interval Interval::narrow(const Interval& next) const {
+    if (isBottom() || next.isBottom()) {
+        return bottom();
+    }
+    return range(lo == NEG_INF ? next.lo : lo, hi == POS_INF ? next.hi : hi);
+}
+
+bool Interval::operator==(const Interval& other) const {
+    return (isBottom() && other.isBottom()) || (lo == other.lo && hi == other.hi);
+}
+
+bool Interval::operator!=(const Interval& other) const {
+    return !(*this == other);
+}
+
+std::string Interval::toString() const {
+    if (isBottom()) {
+        return "empty";
+    }
+    std::string low = lo == NEG_INF ? "-inf" : std::to_string(lo);
+    std::string high = hi == POS_INF ? "+inf" : std::to_string(hi);
+    return "[" + low + ", " + high + "]";
+}
+
+// IntervalAnalyzer类实现
+IntervalAnalyzer::IntervalAnalyzer(size_t threadCount)
+    : threadCount(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount) {}
+
+void IntervalAnalyzer::analyzeFunction(const FunctionDefinitionNode& function, const std::vector<Token>& tokens,
+                                       std::vector<IntervalFinding>& out, IntervalStats& stats,
+                                       std::vector<LoopHeadState>* loopHeads, std::vector<IndexRange>* indexRanges) {
+    FunctionAnalysis analysis(function, tokens);
+    analysis.run(out, stats, loopHeads, indexRanges);
+}
+
+void IntervalAnalyzer::analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, IntervalStats& stats) {
+    stats = IntervalStats();
+    stats.files = paths.size();
+    findings.clear();
+    diagnostics.clear();
+
+    std::vector<std::vector<IntervalFinding>> perFile(paths.size());
+    std::vector<IntervalStats> perFileStats(paths.size());
+    stats.failed = frontEnd.parseUnits(paths, threadCount, [&](size_t i, const ParsedUnit& unit) {
+        const std::vector<Token>& tokens = unit.tokens;
+        for (const FunctionDefinitionNode* function : unit.definedFunctions()) {
+            perFileStats[i].functions++;
+            analyzeFunction(*function, tokens, perFile[i], perFileStats[i]);
+        }
+        for (auto& finding : perFile[i]) {
+            finding.file = paths[i];
+        }
+        std::stable_sort(perFile[i].begin(), perFile[i].end(),
+                         [](const IntervalFinding& a, const IntervalFinding& b) {
+                             return a.line != b.line ? a.line < b.line : a.column < b.column;
+                         });
+    }, diagnostics);
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        stats.functions += perFileStats[i].functions;
+        stats.blocks += perFileStats[i].blocks;
+        stats.iterations += perFileStats[i].iterations;
+        for (auto& finding : perFile[i]) {
+            findings.push_back(std::move(finding));
+        }
+    }
+}
+
+const std::vector<IntervalFinding>& IntervalAnalyzer::getFindings() const {
+    return findings;
+}
+
+const std::vector<std::string>& IntervalAnalyzer::getDiagnostics() const {
+    return diagnostics;
+}
+
+void IntervalAnalyzer::printReport(std::ostream& os, const IntervalStats& stats) const {
+    os << "\n=== Interval Analysis ===" << std::endl;
+    os << "Files: " << stats.files << ", functions: " << stats.functions << ", basic blocks: " << stats.blocks
+       << ", block transfers: " << stats.iterations << " (threads: " << threadCount << ")" << std::endl;
+    for (const auto& diagnostic : diagnostics) {
+        os << "  [error] " << diagnostic << std::endl;
+    }
+
+    size_t counts[5] = {0, 0, 0, 0, 0};
+    for (const auto& finding : findings) {
+        counts[static_cast<int>(finding.kind)]++;
+        os << finding.file << ":" << finding.line << ":" << finding.column << ": " << kindLabel(finding.kind)
+           << ": " << finding.message << " [in " << finding.function << "]" << std::endl;
+    }
+    if (findings.empty()) {
+        os << "✓ No findings." << std::endl;
+        return;
+    }
+    os << "Summary: " << counts[0] << " division(s) by zero, " << counts[1] << " possible division(s) by zero, "
+       << counts[2] << " always-true and " << counts[3] << " always-false condition(s), " << counts[4]
+       << " constant loop bound(s)." << std::endl;
+}
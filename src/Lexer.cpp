@@ -2,10 +2,11 @@
 #include <iostream>
 #include <cctype>
 #include <sstream>
+#include <algorithm>
 
 // LexicalError类实现
-LexicalError::LexicalError(const std::string& msg, int line, int column)
-    : message(msg), line(line), column(column) {}
+LexicalError::LexicalError(const std::string& msg, int line, int column, int fileId)
+    : message(msg), line(line), column(column), fileId(fileId) {}
 
 const char* LexicalError::what() const noexcept {
     return message.c_str();
@@ -264,6 +265,8 @@ Token Lexer::getNextToken() {
             case ')': singleCharType = TokenType::RPAREN; break;
             case '{': singleCharType = TokenType::LBRACE; break;
             case '}': singleCharType = TokenType::RBRACE; break;
+            case '[': singleCharType = TokenType::LBRACKET; break;
+            case ']': singleCharType = TokenType::RBRACKET; break;
             case '#': singleCharType = TokenType::HASH; break;
             case '.': singleCharType = TokenType::ERROR; break; // 点号单独出现时作为错误处理
             default: found = false; break;
@@ -287,8 +290,19 @@ std::vector<Token> Lexer::tokenize() {
     tokens.clear();
     errors.clear();
     
+    // 每行起始的字节偏移，用于由行列号换算token的偏移
+    std::vector<size_t> lineStarts(1, 0);
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') {
+            lineStarts.push_back(i + 1);
+        }
+    }
+    
     while (true) {
         Token token = getNextToken();
+        if (token.line >= 1 && static_cast<size_t>(token.line) <= lineStarts.size()) {
+            token.offset = std::min(lineStarts[token.line - 1] + token.column - 1, text.size());
+        }
         tokens.push_back(token);
         
         if (token.type == TokenType::EOF_TOKEN) {
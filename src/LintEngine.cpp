@@ -0,0 +1,562 @@
+#include "../include/LintEngine.h"
+#include "../include/ASTWalker.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+namespace {
+
+// 不截断的源码文本，用于比较两棵子树是否写法相同
+std::string fullText(const ASTNode& node, const std::vector<Token>& tokens) {
+    return sourceText(node, tokens, std::string::npos);
+}
+
+bool isEmptyCompound(const ASTNode* node) {
+    return node && node->getKind() == ASTNodeKind::CompoundStatement &&
+           static_cast<const CompoundStatementNode*>(node)->statements.empty();
+}
+
+bool containsCall(const ASTNode& node) {
+    bool found = false;
+    walkAST(node, [&found](const ASTNode& current) {
+        found = found || current.getKind() == ASTNodeKind::FunctionCall;
+        return !found;
+    });
+    return found;
+}
+
+const char* statementName(ASTNodeKind kind) {
+    switch (kind) {
+        case ASTNodeKind::IfStatement: return "if";
+        case ASTNodeKind::WhileStatement: return "while";
+        case ASTNodeKind::ForStatement: return "for";
+        default: return "statement";
+    }
+}
+
+bool isControlStatement(const ASTNode& node) {
+    ASTNodeKind kind = node.getKind();
+    return kind == ASTNodeKind::IfStatement || kind == ASTNodeKind::WhileStatement ||
+           kind == ASTNodeKind::ForStatement;
+}
+
+// if/while/for 的循环体或then分支为空
+class EmptyBodyRule : public LintRule {
+public:
+    std::string name() const override { return "empty-body"; }
+    std::string description() const override { return "if/while/for with an empty body"; }
+    std::vector<ASTNodeKind> kinds() const override {
+        return {ASTNodeKind::IfStatement, ASTNodeKind::WhileStatement, ASTNodeKind::ForStatement};
+    }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const ASTNode* body = nullptr;
+        switch (node.getKind()) {
+            case ASTNodeKind::IfStatement: {
+                const auto& ifStmt = static_cast<const IfStatementNode&>(node);
+                if (ifStmt.elseStatement) {
+                    return;  // if (c) {} else {...} 视为有意的写法
+                }
+                body = ifStmt.thenStatement.get();
+                break;
+            }
+            case ASTNodeKind::WhileStatement:
+                body = static_cast<const WhileStatementNode&>(node).body.get();
+                break;
+            default:
+                body = static_cast<const ForStatementNode&>(node).body.get();
+                break;
+        }
+        if (!body || isEmptyCompound(body)) {
+            context.report(node, std::string("empty body of '") + statementName(node.getKind()) + "'");
+        }
+    }
+};
+
+// 条件是字面量
+class ConstantConditionRule : public LintRule {
+public:
+    std::string name() const override { return "constant-condition"; }
+    std::string description() const override { return "if/while condition is a literal"; }
+    std::vector<ASTNodeKind> kinds() const override {
+        return {ASTNodeKind::IfStatement, ASTNodeKind::WhileStatement};
+    }
+    void check(const ASTNode& node, LintContext& context) const override {
+        bool isIf = node.getKind() == ASTNodeKind::IfStatement;
+        const ASTNode* condition = isIf ? static_cast<const IfStatementNode&>(node).condition.get()
+                                        : static_cast<const WhileStatementNode&>(node).condition.get();
+        if (!condition || condition->getKind() != ASTNodeKind::Literal) {
+            return;
+        }
+        const auto& literal = static_cast<const LiteralNode&>(*condition);
+        bool zero = literal.value.find_first_not_of("0.") == std::string::npos;
+        if (!isIf && !zero) {
+            return;  // while (1) 是有意的无限循环
+        }
+        context.report(*condition, std::string("condition of '") + (isIf ? "if" : "while") + "' is always " +
+                                       (zero ? "false" : "true"));
+    }
+};
+
+// x = x
+class SelfAssignmentRule : public LintRule {
+public:
+    std::string name() const override { return "self-assignment"; }
+    std::string description() const override { return "variable assigned to itself"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::BinaryExpression}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const auto& binary = static_cast<const BinaryExpressionNode&>(node);
+        if (binary.operator_ != "=" || !binary.left || !binary.right ||
+            binary.left->getKind() != ASTNodeKind::Identifier ||
+            binary.right->getKind() != ASTNodeKind::Identifier) {
+            return;
+        }
+        const std::string& name = static_cast<const IdentifierNode&>(*binary.left).name;
+        if (name == static_cast<const IdentifierNode&>(*binary.right).name) {
+            context.report(node, "'" + name + "' is assigned to itself");
+        }
+    }
+};
+
+// 两边写法相同的比较、减法、除法与逻辑运算
+class IdenticalOperandsRule : public LintRule {
+public:
+    std::string name() const override { return "identical-operands"; }
+    std::string description() const override { return "binary operator with identical operands"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::BinaryExpression}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const auto& binary = static_cast<const BinaryExpressionNode&>(node);
+        static const char* const operators[] = {"==", "!=", "<", "<=", ">", ">=", "-", "/", "%", "&&", "||"};
+        if (!binary.left || !binary.right ||
+            std::find(std::begin(operators), std::end(operators), binary.operator_) == std::end(operators)) {
+            return;
+        }
+        if (binary.left->getKind() != binary.right->getKind() || binary.left->getKind() == ASTNodeKind::Literal ||
+            containsCall(*binary.left)) {
+            return;  // 字面量之间与含调用的两边可能有意为之
+        }
+        std::string left = fullText(*binary.left, context.tokens);
+        if (left == fullText(*binary.right, context.tokens)) {
+            context.report(node, "both operands of '" + binary.operator_ + "' are '" +
+                                     sourceText(*binary.left, context.tokens, 30) + "'");
+        }
+    }
+};
+
+// 除以字面量0
+class DivisionByZeroRule : public LintRule {
+public:
+    std::string name() const override { return "division-by-zero"; }
+    std::string description() const override { return "division or remainder by a literal zero"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::BinaryExpression}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const auto& binary = static_cast<const BinaryExpressionNode&>(node);
+        if ((binary.operator_ != "/" && binary.operator_ != "%") || !binary.right ||
+            binary.right->getKind() != ASTNodeKind::Literal) {
+            return;
+        }
+        const std::string& value = static_cast<const LiteralNode&>(*binary.right).value;
+        if (value.find_first_not_of("0.") == std::string::npos) {
+            context.report(node, "'" + binary.operator_ + "' by literal zero");
+        }
+    }
+};
+
+// 浮点字面量的相等比较
+class FloatEqualityRule : public LintRule {
+public:
+    std::string name() const override { return "float-equality"; }
+    std::string description() const override { return "== or != against a floating-point literal"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::BinaryExpression}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const auto& binary = static_cast<const BinaryExpressionNode&>(node);
+        if (binary.operator_ != "==" && binary.operator_ != "!=") {
+            return;
+        }
+        for (const ASTNode* side : {binary.left.get(), binary.right.get()}) {
+            if (side && side->getKind() == ASTNodeKind::Literal &&
+                static_cast<const LiteralNode*>(side)->type == TokenType::FLOAT) {
+                context.report(node, "exact comparison with floating-point literal " +
+                                         static_cast<const LiteralNode*>(side)->value);
+                return;
+            }
+        }
+    }
+};
+
+// if与else分支写法相同
+class IdenticalBranchesRule : public LintRule {
+public:
+    std::string name() const override { return "identical-branches"; }
+    std::string description() const override { return "if and else branches are identical"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::IfStatement}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const auto& ifStmt = static_cast<const IfStatementNode&>(node);
+        if (!ifStmt.thenStatement || !ifStmt.elseStatement) {
+            return;
+        }
+        if (fullText(*ifStmt.thenStatement, context.tokens) == fullText(*ifStmt.elseStatement, context.tokens)) {
+            context.report(node, "both branches of 'if' are identical");
+        }
+    }
+};
+
+// if (!c) A else B
+class NegatedIfElseRule : public LintRule {
+public:
+    std::string name() const override { return "negated-if-else"; }
+    std::string description() const override { return "negated if condition with an else branch"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::IfStatement}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const auto& ifStmt = static_cast<const IfStatementNode&>(node);
+        if (!ifStmt.elseStatement || ifStmt.elseStatement->getKind() == ASTNodeKind::IfStatement ||
+            !ifStmt.condition) {
+            return;
+        }
+        bool negated = ifStmt.condition->getKind() == ASTNodeKind::UnaryExpression &&
+                       static_cast<const UnaryExpressionNode&>(*ifStmt.condition).operator_ == "!";
+        if (negated) {
+            context.report(node, "negated condition with 'else'; swap the branches");
+        }
+    }
+};
+
+// 控制语句嵌套过深，每条嵌套链只在超过上限的第一层报告
+class DeepNestingRule : public LintRule {
+private:
+    static constexpr int LIMIT = 4;
+
+public:
+    std::string name() const override { return "deep-nesting"; }
+    std::string description() const override { return "if/while/for nested more than 4 levels"; }
+    std::vector<ASTNodeKind> kinds() const override {
+        return {ASTNodeKind::IfStatement, ASTNodeKind::WhileStatement, ASTNodeKind::ForStatement};
+    }
+    void check(const ASTNode& node, LintContext& context) const override {
+        int depth = 0;
+        for (const ASTNode* ancestor : context.ancestors) {
+            // else if 链不算嵌套
+            bool elseIf = ancestor->getKind() == ASTNodeKind::IfStatement &&
+                          node.getKind() == ASTNodeKind::IfStatement &&
+                          static_cast<const IfStatementNode*>(ancestor)->elseStatement.get() == &node;
+            if (isControlStatement(*ancestor) && !elseIf) {
+                depth++;
+            }
+        }
+        if (depth == LIMIT) {
+            context.report(node, "nesting depth " + std::to_string(depth + 1) + " exceeds " +
+                                     std::to_string(LIMIT));
+        }
+    }
+};
+
+// 参数过多
+class TooManyParametersRule : public LintRule {
+private:
+    static constexpr size_t LIMIT = 5;
+
+public:
+    std::string name() const override { return "too-many-parameters"; }
+    std::string description() const override { return "function with more than 5 parameters"; }
+    std::vector<ASTNodeKind> kinds() const override {
+        return {ASTNodeKind::FunctionDefinition, ASTNodeKind::FunctionDeclaration};
+    }
+    void check(const ASTNode& node, LintContext& context) const override {
+        bool definition = node.getKind() == ASTNodeKind::FunctionDefinition;
+        size_t count = definition ? static_cast<const FunctionDefinitionNode&>(node).parameters.size()
+                                  : static_cast<const FunctionDeclarationNode&>(node).parameters.size();
+        const std::string& name = definition ? static_cast<const FunctionDefinitionNode&>(node).name
+                                             : static_cast<const FunctionDeclarationNode&>(node).name;
+        if (count > LIMIT) {
+            context.report(node, "'" + name + "' has " + std::to_string(count) + " parameters (limit " +
+                                     std::to_string(LIMIT) + ")");
+        }
+    }
+};
+
+// 函数过长
+class LongFunctionRule : public LintRule {
+private:
+    static constexpr int LIMIT = 80;
+
+public:
+    std::string name() const override { return "long-function"; }
+    std::string description() const override { return "function body longer than 80 lines"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::FunctionDefinition}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+        if (node.lastToken >= context.tokens.size()) {
+            return;
+        }
+        int lines = context.tokens[node.lastToken].line - node.line + 1;
+        if (lines > LIMIT) {
+            context.report(node, "'" + function.name + "' is " + std::to_string(lines) + " lines long (limit " +
+                                     std::to_string(LIMIT) + ")");
+        }
+    }
+};
+
+// 函数体为空
+class EmptyFunctionRule : public LintRule {
+public:
+    std::string name() const override { return "empty-function"; }
+    std::string description() const override { return "function definition with an empty body"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::FunctionDefinition}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+        if (isEmptyCompound(function.body.get())) {
+            context.report(node, "'" + function.name + "' has an empty body");
+        }
+    }
+};
+
+// 非void函数的最后一条语句不是return（两个分支都有的if与无条件循环除外）
+class MissingReturnRule : public LintRule {
+public:
+    std::string name() const override { return "missing-return"; }
+    std::string description() const override { return "non-void function may end without return"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::FunctionDefinition}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+        if (function.returnType == "void" || function.name == "main" || !function.body ||
+            function.body->getKind() != ASTNodeKind::CompoundStatement) {
+            return;
+        }
+        const auto& statements = static_cast<const CompoundStatementNode&>(*function.body).statements;
+        const ASTNode* last = statements.empty() ? nullptr : statements.back().get();
+        if (last) {
+            switch (last->getKind()) {
+                case ASTNodeKind::ReturnStatement:
+                    return;
+                case ASTNodeKind::IfStatement:
+                    if (static_cast<const IfStatementNode*>(last)->elseStatement) {
+                        return;
+                    }
+                    break;
+                case ASTNodeKind::WhileStatement: {
+                    const ASTNode* condition = static_cast<const WhileStatementNode*>(last)->condition.get();
+                    if (condition && condition->getKind() == ASTNodeKind::Literal &&
+                        static_cast<const LiteralNode*>(condition)->value != "0") {
+                        return;
+                    }
+                    break;
+                }
+                case ASTNodeKind::ForStatement:
+                    if (!static_cast<const ForStatementNode*>(last)->condition) {
+                        return;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        context.report(node, "'" + function.name + "' returns " + function.returnType +
+                                 " but may reach the end without 'return'");
+    }
+};
+
+// 局部变量与形参同名
+class ShadowedParameterRule : public LintRule {
+public:
+    std::string name() const override { return "shadowed-parameter"; }
+    std::string description() const override { return "local variable with the same name as a parameter"; }
+    std::vector<ASTNodeKind> kinds() const override { return {ASTNodeKind::VarDeclaration}; }
+    void check(const ASTNode& node, LintContext& context) const override {
+        const ASTNode* parent = context.parent();
+        if (!context.function || !parent || parent->getKind() == ASTNodeKind::FunctionDefinition) {
+            return;  // 全局变量或形参本身
+        }
+        const std::string& name = static_cast<const VarDeclarationNode&>(node).identifier;
+        for (const auto& parameter : context.function->parameters) {
+            if (parameter && parameter->getKind() == ASTNodeKind::VarDeclaration &&
+                static_cast<const VarDeclarationNode&>(*parameter).identifier == name) {
+                context.report(node, "'" + name + "' shadows a parameter of '" + context.function->name + "'");
+                return;
+            }
+        }
+    }
+};
+
+} // namespace
+
+// LintContext实现
+LintContext::LintContext(const std::vector<Token>& tokens, std::vector<LintFinding>& out)
+    : out(out), tokens(tokens) {}
+
+const ASTNode* LintContext::parent() const {
+    return ancestors.empty() ? nullptr : ancestors.back();
+}
+
+void LintContext::report(const ASTNode& node, const std::string& message) {
+    LintFinding finding;
+    finding.rule = rule ? *rule : "";
+    finding.line = node.line;
+    finding.column = node.column;
+    finding.message = message;
+    out.push_back(std::move(finding));
+}
+
+// LintEngine类实现
+LintEngine::LintEngine(size_t threadCount)
+    : threadCount(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount) {}
+
+std::vector<std::unique_ptr<LintRule>> LintEngine::builtinRules() {
+    std::vector<std::unique_ptr<LintRule>> builtin;
+    builtin.push_back(std::make_unique<EmptyBodyRule>());
+    builtin.push_back(std::make_unique<ConstantConditionRule>());
+    builtin.push_back(std::make_unique<SelfAssignmentRule>());
+    builtin.push_back(std::make_unique<IdenticalOperandsRule>());
+    builtin.push_back(std::make_unique<DivisionByZeroRule>());
+    builtin.push_back(std::make_unique<FloatEqualityRule>());
+    builtin.push_back(std::make_unique<IdenticalBranchesRule>());
+    builtin.push_back(std::make_unique<NegatedIfElseRule>());
+    builtin.push_back(std::make_unique<DeepNestingRule>());
+    builtin.push_back(std::make_unique<TooManyParametersRule>());
+    builtin.push_back(std::make_unique<LongFunctionRule>());
+    builtin.push_back(std::make_unique<EmptyFunctionRule>());
+    builtin.push_back(std::make_unique<MissingReturnRule>());
+    builtin.push_back(std::make_unique<ShadowedParameterRule>());
+    return builtin;
+}
+
+void LintEngine::addRule(std::unique_ptr<LintRule> rule) {
+    size_t index = rules.size();
+    for (ASTNodeKind kind : rule->kinds()) {
+        std::vector<size_t>& subscribers = dispatch[static_cast<size_t>(kind)];
+        if (std::find(subscribers.begin(), subscribers.end(), index) == subscribers.end()) {
+            subscribers.push_back(index);
+        }
+    }
+    ruleNames.push_back(rule->name());
+    rules.push_back(std::move(rule));
+}
+
+const std::vector<std::unique_ptr<LintRule>>& LintEngine::getRules() const {
+    return rules;
+}
+
+void LintEngine::visit(const ASTNode& node, LintContext& context, std::vector<LintRuleTiming>& timing,
+                       LintStats& stats) const {
+    if (node.fileId != 0) {
+        return;  // 包含进来的代码由以该文件为输入的检查负责
+    }
+    stats.nodes++;
+    const FunctionDefinitionNode* enclosing = context.function;
+    if (node.getKind() == ASTNodeKind::FunctionDefinition) {
+        context.function = static_cast<const FunctionDefinitionNode*>(&node);
+    }
+    for (size_t index : dispatch[static_cast<size_t>(node.getKind())]) {
+        context.rule = &ruleNames[index];
+        size_t before = context.out.size();
+        auto start = std::chrono::steady_clock::now();
+        rules[index]->check(node, context);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        timing[index].calls++;
+        timing[index].nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        timing[index].findings += context.out.size() - before;
+        stats.calls++;
+    }
+    context.rule = nullptr;
+    context.ancestors.push_back(&node);
+    forEachChild(node, [&](const ASTNode& child) {
+        visit(child, context, timing, stats);
+    });
+    context.ancestors.pop_back();
+    context.function = enclosing;
+}
+
+void LintEngine::run(const ProgramNode& program, const std::vector<Token>& tokens, std::vector<LintFinding>& out,
+                     std::vector<LintRuleTiming>& timing, LintStats& stats) const {
+    if (timing.size() < rules.size()) {
+        timing.resize(rules.size());
+    }
+    LintContext context(tokens, out);
+    visit(program, context, timing, stats);
+}
+
+void LintEngine::analyze(const std::vector<std::string>& paths, const ProjectAnalyzer& frontEnd, LintStats& stats) {
+    stats = LintStats();
+    stats.files = paths.size();
+    findings.clear();
+    diagnostics.clear();
+    timings.assign(rules.size(), LintRuleTiming());
+    for (size_t i = 0; i < rules.size(); i++) {
+        timings[i].rule = rules[i]->name();
+    }
+
+    std::vector<std::vector<LintFinding>> perFile(paths.size());
+    std::vector<std::vector<LintRuleTiming>> perFileTimings(paths.size());
+    std::vector<LintStats> perFileStats(paths.size());
+    stats.failed = frontEnd.parseUnits(paths, threadCount, [&](size_t i, const ParsedUnit& unit) {
+        const std::vector<Token>& tokens = unit.tokens;
+        run(*unit.program, tokens, perFile[i], perFileTimings[i], perFileStats[i]);
+        for (auto& finding : perFile[i]) {
+            finding.file = paths[i];
+        }
+        std::stable_sort(perFile[i].begin(), perFile[i].end(), [](const LintFinding& a, const LintFinding& b) {
+            return a.line != b.line ? a.line < b.line : a.column < b.column;
+        });
+    }, diagnostics);
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        stats.nodes += perFileStats[i].nodes;
+        stats.calls += perFileStats[i].calls;
+        for (size_t r = 0; r < perFileTimings[i].size(); r++) {
+            timings[r].calls += perFileTimings[i][r].calls;
+            timings[r].nanoseconds += perFileTimings[i][r].nanoseconds;
+            timings[r].findings += perFileTimings[i][r].findings;
+        }
+        for (auto& finding : perFile[i]) {
+            findings.push_back(std::move(finding));
+        }
+    }
+}
+
+const std::vector<LintFinding>& LintEngine::getFindings() const {
+    return findings;
+}
+
+const std::vector<LintRuleTiming>& LintEngine::getTimings() const {
+    return timings;
+}
+
+const std::vector<std::string>& LintEngine::getDiagnostics() const {
+    return diagnostics;
+}
+
+void LintEngine::printReport(std::ostream& os, const LintStats& stats) const {
+    os << "\n=== Lint ===" << std::endl;
+    os << "Files: " << stats.files << ", rules: " << rules.size() << ", nodes visited: " << stats.nodes
+       << ", rule calls: " << stats.calls << " (threads: " << threadCount << ")" << std::endl;
+    for (const auto& diagnostic : diagnostics) {
+        os << "  [error] " << diagnostic << std::endl;
+    }
+    for (const auto& finding : findings) {
+        os << finding.file << ":" << finding.line << ":" << finding.column << ": warning: " << finding.message
+           << " [" << finding.rule << "]" << std::endl;
+    }
+    if (findings.empty()) {
+        os << "✓ No findings." << std::endl;
+    } else {
+        os << "Summary: " << findings.size() << " finding(s)." << std::endl;
+    }
+
+    // 按耗时从高到低列出各规则
+    std::vector<const LintRuleTiming*> sorted;
+    for (const auto& timing : timings) {
+        sorted.push_back(&timing);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const LintRuleTiming* a, const LintRuleTiming* b) {
+        return a->nanoseconds > b->nanoseconds;
+    });
+    os << "\nRule timing:" << std::endl;
+    os << "  " << std::left << std::setw(22) << "rule" << std::right << std::setw(10) << "calls" << std::setw(12)
+       << "time (ms)" << std::setw(10) << "findings" << std::endl;
+    for (const LintRuleTiming* timing : sorted) {
+        os << "  " << std::left << std::setw(22) << timing->rule << std::right << std::setw(10) << timing->calls
+           << std::setw(12) << std::fixed << std::setprecision(3) << timing->nanoseconds / 1e6 << std::setw(10)
+           << timing->findings << std::endl;
+    }
+    os << std::defaultfloat;
+}
@@ -0,0 +1,539 @@
+#include "../include/LoopOptimizer.h"
+#include <algorithm>
+
+namespace {
+
+const size_t MAX_ROTATED_HEADER = 8;  // 复制到循环底部的条件最多的指令数
+const size_t UNROLL_BUDGET = 64;      // 展开后循环体最多的指令数
+const int64_t MAX_UNROLL = 8;
+
+int targetSlot(Opcode op) {
+    for (int slot = 0; slot < 3; slot++) {
+        if (operandKind(op, slot) == OperandKind::Target) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+int32_t& operand(Instruction& instruction, int slot) {
+    return slot == 0 ? instruction.a : slot == 1 ? instruction.b : instruction.c;
+}
+
+int32_t target(const Instruction& instruction) {
+    int slot = targetSlot(instruction.op);
+    return slot == 0 ? instruction.a : slot == 1 ? instruction.b : instruction.c;
+}
+
+// 之后不一定顺序执行下一条指令
+bool endsBlock(Opcode op) {
+    return targetSlot(op) >= 0 || op == Opcode::RET || op == Opcode::RETV;
+}
+
+// 可能顺序执行到下一条指令
+bool fallsThrough(Opcode op) {
+    return op != Opcode::JMP && op != Opcode::RET && op != Opcode::RETV;
+}
+
+bool isConditional(Opcode op) {
+    return op == Opcode::JZ || op == Opcode::JNZ || op == Opcode::JLT || op == Opcode::JLE || op == Opcode::JEQ ||
+           op == Opcode::JNE;
+}
+
+// 条件取反的跳转，目标不变
+Instruction invert(const Instruction& branch) {
+    Instruction inverted = branch;
+    switch (branch.op) {
+        case Opcode::JZ: inverted.op = Opcode::JNZ; break;
+        case Opcode::JNZ: inverted.op = Opcode::JZ; break;
+        case Opcode::JEQ: inverted.op = Opcode::JNE; break;
+        case Opcode::JNE: inverted.op = Opcode::JEQ; break;
+        case Opcode::JLT:  // !(a < b) 即 b <= a
+            inverted.op = Opcode::JLE;
+            inverted.a = branch.b;
+            inverted.b = branch.a;
+            break;
+        case Opcode::JLE:
+            inverted.op = Opcode::JLT;
+            inverted.a = branch.b;
+            inverted.b = branch.a;
+            break;
+        default:
+            break;
+    }
+    return inverted;
+}
+
+Instruction make(Opcode op, int32_t a, int32_t b, int32_t c = 0) {
+    Instruction instruction;
+    instruction.op = op;
+    instruction.a = a;
+    instruction.b = b;
+    instruction.c = c;
+    return instruction;
+}
+
+/**
+ * 指令读写的寄存器
+ */
+struct RegisterUse {
+    std::vector<int32_t> reads;
+    std::vector<int32_t> writes;
+};
+
+RegisterUse registerUse(const BytecodeModule& module, const BytecodeFunction& function,
+                        const Instruction& instruction) {
+    RegisterUse use;
+    auto readRange = [&use](int32_t first, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            use.reads.push_back(first + static_cast<int32_t>(i));
+        }
+    };
+    switch (instruction.op) {
+        case Opcode::CALL:
+            use.writes.push_back(instruction.a);
+            readRange(instruction.c, module.functions[instruction.b].parameterTypes.size());
+            return use;
+        case Opcode::PRINTF:
+            use.writes.push_back(instruction.a);
+            readRange(instruction.c, module.formats[instruction.b].argumentCount);
+            return use;
+        case Opcode::PARFOR: {
+            const ParallelLoop& loop = function.parallelLoops[instruction.b];
+            use.reads = {instruction.a, loop.upper};
+            use.reads.insert(use.reads.end(), loop.captures.begin(), loop.captures.end());
+            use.reads.insert(use.reads.end(), loop.reductions.begin(), loop.reductions.end());
+            use.writes = loop.reductions;
+            use.writes.push_back(instruction.a);
+            return use;
+        }
+        default:
+            break;
+    }
+    bool writesFirst = !(isConditional(instruction.op) || instruction.op == Opcode::CHECKLEN ||
+                         instruction.op == Opcode::STOREELEM || instruction.op == Opcode::STOREELEM_U ||
+                         instruction.op == Opcode::RET);
+    const int32_t operands[3] = {instruction.a, instruction.b, instruction.c};
+    for (int slot = 0; slot < 3; slot++) {
+        if (operandKind(instruction.op, slot) != OperandKind::Register) {
+            continue;
+        }
+        (slot == 0 && writesFirst ? use.writes : use.reads).push_back(operands[slot]);
+    }
+    return use;
+}
+
+bool contains(const std::vector<int32_t>& registers, int32_t reg) {
+    return std::find(registers.begin(), registers.end(), reg) != registers.end();
+}
+
+/**
+ * 按原来的指令顺序重建函数代码
+ * 复制的指令与未标明已解析的插入指令，跳转目标按原来的下标解释，完成时换算为新下标；
+ * 删除的指令的下标对应到下一条写出的指令。marks与代码一一对应，随指令一起复制。
+ */
+class CodeRewriter {
+private:
+    BytecodeFunction& function;
+    std::vector<uint8_t>& marks;
+    std::vector<Instruction> code;
+    std::vector<int> lines;
+    std::vector<uint8_t> newMarks;
+    std::vector<bool> resolved;
+    std::vector<int32_t> position;
+
+public:
+    CodeRewriter(BytecodeFunction& function, std::vector<uint8_t>& marks)
+        : function(function), marks(marks), position(function.code.size() + 1, -1) {}
+
+    int32_t size() const {
+        return static_cast<int32_t>(code.size());
+    }
+
+    void copy(size_t pc) {
+        position[pc] = size();
+        insert(function.code[pc], function.lines[pc], false, marks[pc]);
+    }
+
+    void drop(size_t pc) {
+        position[pc] = size();
+    }
+
+    // 插入一条指令，返回它的新下标
+    size_t insert(const Instruction& instruction, int line, bool targetResolved = false, uint8_t mark = 0) {
+        code.push_back(instruction);
+        lines.push_back(line);
+        newMarks.push_back(mark);
+        resolved.push_back(targetResolved);
+        return code.size() - 1;
+    }
+
+    Instruction& at(size_t index) {
+        return code[index];
+    }
+
+    void finish() {
+        position[function.code.size()] = size();
+        for (size_t i = 0; i < code.size(); i++) {
+            int slot = targetSlot(code[i].op);
+            if (slot >= 0 && !resolved[i]) {
+                operand(code[i], slot) = position[operand(code[i], slot)];
+            }
+        }
+        function.code = std::move(code);
+        function.lines = std::move(lines);
+        marks = std::move(newMarks);
+    }
+};
+
+// 每条指令是否为某个跳转的目标
+std::vector<bool> jumpTargets(const BytecodeFunction& function) {
+    std::vector<bool> targets(function.code.size() + 1, false);
+    for (const auto& instruction : function.code) {
+        if (targetSlot(instruction.op) >= 0) {
+            targets[target(instruction)] = true;
+        }
+    }
+    return targets;
+}
+
+/**
+ * 旋转后的计数循环
+ * top: 循环体; increment: ADDK i, i, 1; [ADD t, t, c ...]; bottom: JLT/JLE i, bound, top
+ */
+struct CountedLoop {
+    size_t top = 0;
+    size_t increment = 0;
+    size_t bottom = 0;
+    int32_t induction = 0;
+    int32_t bound = 0;
+};
+
+bool countedLoop(const BytecodeModule& module, const BytecodeFunction& function, size_t bottom, CountedLoop& loop) {
+    const auto& code = function.code;
+    const Instruction& branch = code[bottom];
+    if ((branch.op != Opcode::JLT && branch.op != Opcode::JLE) || branch.c >= static_cast<int32_t>(bottom) ||
+        branch.c <= 0) {
+        return false;
+    }
+    loop.top = static_cast<size_t>(branch.c);
+    loop.bottom = bottom;
+    loop.induction = branch.a;
+    loop.bound = branch.b;
+    if (loop.induction == loop.bound) {
+        return false;
+    }
+    // 向上越过强度削减加入的 ADD t, t, c，找到归纳变量的加一
+    size_t k = bottom - 1;
+    std::vector<int32_t> updated{loop.induction};
+    std::vector<int32_t> steps;
+    while (k > loop.top && code[k].op == Opcode::ADD && code[k].a == code[k].b) {
+        updated.push_back(code[k].a);
+        steps.push_back(code[k].c);
+        k--;
+    }
+    const Instruction& increment = code[k];
+    if (k < loop.top || increment.op != Opcode::ADDK || increment.a != loop.induction ||
+        increment.b != loop.induction || increment.c != 1) {
+        return false;
+    }
+    loop.increment = k;
+
+    // 循环体不写归纳变量、界、步长与强度削减的寄存器，也不跳到循环外（跳出循环的break除外）
+    for (size_t pc = loop.top; pc < loop.increment; pc++) {
+        RegisterUse use = registerUse(module, function, code[pc]);
+        for (int32_t reg : use.writes) {
+            if (reg == loop.bound || contains(updated, reg) || contains(steps, reg)) {
+                return false;
+            }
+        }
+        if (targetSlot(code[pc].op) >= 0) {
+            size_t to = static_cast<size_t>(target(code[pc]));
+            if ((to < loop.top || to > loop.increment) && to != bottom + 1) {
+                return false;
+            }
+        }
+    }
+    // 循环外只能从顶部之前顺序进入
+    if (loop.top == 0 || !fallsThrough(code[loop.top - 1].op)) {
+        return false;
+    }
+    for (size_t pc = 0; pc < code.size(); pc++) {
+        if ((pc >= loop.top && pc <= bottom) || targetSlot(code[pc].op) < 0) {
+            continue;
+        }
+        size_t to = static_cast<size_t>(target(code[pc]));
+        if (to >= loop.top && to <= bottom) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 从start起的某条路径在写入reg之前读取它
+bool liveAt(const BytecodeModule& module, const BytecodeFunction& function, size_t start, int32_t reg) {
+    std::vector<bool> visited(function.code.size() + 1, false);
+    std::vector<size_t> pending{start};
+    while (!pending.empty()) {
+        size_t pc = pending.back();
+        pending.pop_back();
+        if (pc >= function.code.size() || visited[pc]) {
+            continue;
+        }
+        visited[pc] = true;
+        const Instruction& instruction = function.code[pc];
+        RegisterUse use = registerUse(module, function, instruction);
+        if (contains(use.reads, reg)) {
+            return true;
+        }
+        if (contains(use.writes, reg)) {
+            continue;
+        }
+        if (targetSlot(instruction.op) >= 0) {
+            pending.push_back(static_cast<size_t>(target(instruction)));
+        }
+        if (fallsThrough(instruction.op)) {
+            pending.push_back(pc + 1);
+        }
+    }
+    return false;
+}
+
+bool isConstantRegister(const BytecodeFunction& function, int32_t reg) {
+    return reg >= static_cast<int32_t>(function.firstConstant()) &&
+           reg < static_cast<int32_t>(function.firstConstant() + function.constants.size());
+}
+
+// 为函数增加一个寄存器：数组区整体后移一个槽位
+int32_t addRegister(BytecodeFunction& function) {
+    int32_t reg = static_cast<int32_t>(function.registerCount++);
+    function.frameSize++;
+    for (auto& instruction : function.code) {
+        if (instruction.op == Opcode::ARRAY) {
+            instruction.b++;
+        }
+    }
+    return reg;
+}
+
+} // namespace
+
+// LoopOptimizer类实现
+LoopOptimizer::LoopOptimizer(const BytecodeModule& module) : module(module) {}
+
+void LoopOptimizer::optimize(BytecodeFunction& function) {
+    std::vector<uint8_t> marks(function.code.size(), 0);  // 1表示已展开过的循环的底部跳转
+    while (rotateOne(function, marks)) {
+        stats.rotated++;
+    }
+    while (reduceOne(function, marks)) {
+        stats.reduced++;
+    }
+    while (unrollOne(function, marks)) {
+        stats.unrolled++;
+    }
+}
+
+const LoopOptimizerStats& LoopOptimizer::getStats() const {
+    return stats;
+}
+
+bool LoopOptimizer::rotateOne(BytecodeFunction& function, std::vector<uint8_t>& marks) {
+    const auto& code = function.code;
+    std::vector<bool> targets = jumpTargets(function);
+    for (size_t back = 0; back < code.size(); back++) {
+        if (code[back].op != Opcode::JMP || code[back].a > static_cast<int32_t>(back)) {
+            continue;
+        }
+        // 循环头：从head起的直线代码，以跳到循环出口的条件跳转结束
+        size_t head = static_cast<size_t>(code[back].a);
+        size_t test = head;
+        while (test < back && !endsBlock(code[test].op)) {
+            test++;
+        }
+        if (test == back || !isConditional(code[test].op) || target(code[test]) != static_cast<int32_t>(back + 1) ||
+            test - head + 1 > MAX_ROTATED_HEADER) {
+            continue;
+        }
+        bool enteredInside = false;
+        for (size_t pc = head + 1; pc <= test; pc++) {
+            enteredInside = enteredInside || targets[pc];
+        }
+        if (enteredInside) {
+            continue;
+        }
+
+        CodeRewriter rewriter(function, marks);
+        for (size_t pc = 0; pc < code.size(); pc++) {
+            if (pc != back) {
+                rewriter.copy(pc);
+                continue;
+            }
+            rewriter.drop(back);
+            for (size_t q = head; q < test; q++) {
+                rewriter.insert(code[q], function.lines[q]);
+            }
+            Instruction again = invert(code[test]);
+            operand(again, targetSlot(again.op)) = static_cast<int32_t>(test + 1);
+            rewriter.insert(again, function.lines[test]);
+        }
+        rewriter.finish();
+        return true;
+    }
+    return false;
+}
+
+bool LoopOptimizer::reduceOne(BytecodeFunction& function, std::vector<uint8_t>& marks) {
+    const auto& code = function.code;
+    std::vector<bool> targets = jumpTargets(function);
+    for (size_t bottom = 0; bottom < code.size(); bottom++) {
+        CountedLoop loop;
+        if (!countedLoop(module, function, bottom, loop)) {
+            continue;
+        }
+        std::vector<int32_t> written;
+        for (size_t pc = loop.top; pc <= loop.bottom; pc++) {
+            RegisterUse use = registerUse(module, function, code[pc]);
+            written.insert(written.end(), use.writes.begin(), use.writes.end());
+        }
+        for (size_t multiply = loop.top; multiply < loop.increment; multiply++) {
+            const Instruction& mul = code[multiply];
+            if (mul.op != Opcode::MUL) {
+                continue;
+            }
+            int32_t product = mul.a;
+            int32_t step = mul.b == loop.induction && !contains(written, mul.c)   ? mul.c
+                           : mul.c == loop.induction && !contains(written, mul.b) ? mul.b
+                                                                                  : -1;
+            if (step < 0 || product == loop.induction || product == loop.bound || product == step) {
+                continue;
+            }
+            // 乘积在循环中只由这条指令写入，只在同一基本块中的后续指令里读取，出循环后不再使用
+            size_t blockEnd = multiply;
+            while (blockEnd < loop.bottom && !targets[blockEnd + 1] && !endsBlock(code[blockEnd].op)) {
+                blockEnd++;
+            }
+            bool usable = true;
+            for (size_t pc = loop.top; pc <= loop.bottom && usable; pc++) {
+                RegisterUse use = registerUse(module, function, code[pc]);
+                usable = !(contains(use.writes, product) && pc != multiply) &&
+                         !(contains(use.reads, product) && (pc <= multiply || pc > blockEnd));
+            }
+            usable = usable && !liveAt(module, function, loop.bottom + 1, product);
+            if (!usable) {
+                continue;
+            }
+
+            CodeRewriter rewriter(function, marks);
+            for (size_t pc = 0; pc < code.size(); pc++) {
+                if (pc == loop.top) {
+                    rewriter.insert(mul, function.lines[multiply]);  // 进入循环前计算一次
+                }
+                if (pc == loop.bottom) {
+                    rewriter.insert(make(Opcode::ADD, product, product, step), function.lines[loop.increment]);
+                }
+                if (pc == multiply) {
+                    rewriter.drop(pc);
+                } else {
+                    rewriter.copy(pc);
+                }
+            }
+            rewriter.finish();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LoopOptimizer::unrollOne(BytecodeFunction& function, std::vector<uint8_t>& marks) {
+    for (size_t bottom = 0; bottom < function.code.size(); bottom++) {
+        CountedLoop loop;
+        if (marks[bottom] || !countedLoop(module, function, bottom, loop)) {
+            continue;
+        }
+        const auto& code = function.code;
+        bool innermost = true;
+        for (size_t pc = loop.top; pc < loop.increment; pc++) {
+            innermost = innermost && !(targetSlot(code[pc].op) >= 0 && target(code[pc]) <= static_cast<int32_t>(pc));
+            innermost = innermost && code[pc].op != Opcode::PARFOR;
+        }
+        if (!innermost) {
+            continue;
+        }
+
+        // 代价模型：展开后的循环体不超过预算；迭代次数可知时至少执行两轮展开后的循环
+        size_t unit = loop.bottom - loop.top;
+        int64_t factor = MAX_UNROLL;
+        while (factor >= 2 && static_cast<size_t>(factor) * unit > UNROLL_BUDGET) {
+            factor /= 2;
+        }
+        bool inclusive = code[bottom].op == Opcode::JLE;
+        if (loop.top >= 2 && isConstantRegister(function, loop.bound)) {
+            const Instruction& init = code[loop.top - 2];  // 初始化之后是进入循环前的条件检查
+            int64_t first = 0;
+            bool known = false;
+            if (init.op == Opcode::MOVE && init.a == loop.induction && isConstantRegister(function, init.b)) {
+                first = function.constants[init.b - function.firstConstant()].i;
+                known = true;
+            } else if (init.op == Opcode::LOADI && init.a == loop.induction) {
+                first = init.b;
+                known = true;
+            }
+            int64_t last = function.constants[loop.bound - function.firstConstant()].i;
+            if (known && last > INT64_MIN + 1 && first < INT64_MAX - 1) {
+                int64_t trips = std::max<int64_t>(0, last - first + (inclusive ? 1 : 0));
+                while (factor >= 2 && trips < 2 * factor) {
+                    factor /= 2;
+                }
+            }
+        }
+        if (factor < 2) {
+            continue;
+        }
+
+        int32_t limit = addRegister(function);
+        int32_t line = function.lines[loop.bottom];
+        Opcode compare = code[bottom].op;
+        marks[loop.bottom] = 1;  // 展开后剩余迭代的循环
+        CodeRewriter rewriter(function, marks);
+        for (size_t pc = 0; pc < code.size(); pc++) {
+            if (pc != loop.top) {
+                rewriter.copy(pc);
+                continue;
+            }
+            // limit = bound - (k-1)；回绕时（limit > bound）跳过展开的循环
+            rewriter.insert(make(Opcode::ADDK, limit, loop.bound, static_cast<int32_t>(1 - factor)), line);
+            size_t wrapped = rewriter.insert(make(Opcode::JLT, loop.bound, limit), line, true);
+            size_t skip = rewriter.insert(compare == Opcode::JLT ? make(Opcode::JLE, limit, loop.induction)
+                                                                 : make(Opcode::JLT, limit, loop.induction),
+                                          line, true);
+            int32_t unrolledTop = rewriter.size();
+            for (int64_t copy = 0; copy < factor; copy++) {
+                int32_t base = rewriter.size();
+                for (size_t q = loop.top; q < loop.bottom; q++) {
+                    Instruction instruction = code[q];
+                    int slot = targetSlot(instruction.op);
+                    bool internal = slot >= 0 && operand(instruction, slot) >= static_cast<int32_t>(loop.top) &&
+                                    operand(instruction, slot) < static_cast<int32_t>(loop.bottom);
+                    if (internal) {
+                        operand(instruction, slot) = base + operand(instruction, slot) - static_cast<int32_t>(loop.top);
+                    }
+                    rewriter.insert(instruction, function.lines[q], internal);
+                }
+            }
+            rewriter.insert(make(compare, loop.induction, limit, unrolledTop), line, true, 1);
+            int32_t remainder = rewriter.size();
+            rewriter.at(wrapped).c = remainder;
+            rewriter.at(skip).c = remainder;
+            // 剩余的迭代：原来的循环，先检查是否还有迭代
+            rewriter.insert(compare == Opcode::JLT ? make(Opcode::JLE, loop.bound, loop.induction)
+                                                   : make(Opcode::JLT, loop.bound, loop.induction),
+                            line);
+            rewriter.at(rewriter.size() - 1).c = static_cast<int32_t>(loop.bottom + 1);
+            rewriter.copy(pc);
+        }
+        rewriter.finish();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,490 @@
+#include "../include/MacroExpander.h"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+bool contains(const std::vector<uint32_t>& ids, uint32_t id) {
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+// 替换列表中紧挨着的两个 # 构成 ## 粘贴运算符
+bool isPasteOperator(const std::vector<Token>& body, size_t k) {
+    return k + 1 < body.size() &&
+           body[k].type == TokenType::HASH && body[k + 1].type == TokenType::HASH &&
+           body[k].line == body[k + 1].line && body[k + 1].column == body[k].column + 1;
+}
+
+std::string spell(const Token& token) {
+    return token.type == TokenType::STRING ? "\"" + token.value + "\"" : token.value;
+}
+
+} // namespace
+
+// MacroExpander类实现
+MacroExpander::MacroExpander(StringInterner& interner)
+    : interner(interner), expansionCount(0), cacheHitCount(0) {}
+
+const MacroDefinition* MacroExpander::findMacro(const Token& token) const {
+    if (token.type != TokenType::IDENTIFIER || macros.empty()) {
+        return nullptr;
+    }
+    uint32_t id = interner.lookup(token.value);
+    if (id == StringInterner::npos) {
+        return nullptr;
+    }
+    auto it = macros.find(id);
+    return it != macros.end() ? &it->second : nullptr;
+}
+
+void MacroExpander::define(const MacroDefinition& macro) {
+    macros[macro.name] = macro;
+    expansionCache.clear();
+}
+
+void MacroExpander::undefine(const std::string& name) {
+    uint32_t id = interner.lookup(name);
+    if (id != StringInterner::npos && macros.erase(id) > 0) {
+        expansionCache.clear();
+    }
+}
+
+bool MacroExpander::isDefined(const std::string& name) const {
+    uint32_t id = interner.lookup(name);
+    return id != StringInterner::npos && macros.count(id) > 0;
+}
+
+const std::unordered_map<uint32_t, MacroDefinition>& MacroExpander::getMacros() const {
+    return macros;
+}
+
+void MacroExpander::defineFromTokens(const std::vector<Token>& tokens, size_t begin, size_t end) {
+    if (begin >= end || tokens[begin].type != TokenType::IDENTIFIER) {
+        const Token& where = begin < tokens.size() ? tokens[begin] : tokens.back();
+        errors.emplace_back("Expected macro name after #define", where.line, where.column, where.fileId);
+        return;
+    }
+
+    const Token& nameToken = tokens[begin];
+    MacroDefinition macro;
+    macro.name = interner.intern(nameToken.value);
+    macro.line = nameToken.line;
+    macro.column = nameToken.column;
+    macro.fileId = nameToken.fileId;
+
+    size_t k = begin + 1;
+    // 宏名后紧跟 ( 才是函数宏，中间有空格则 ( 属于替换列表
+    if (k < end && tokens[k].type == TokenType::LPAREN && tokens[k].line == nameToken.line &&
+        tokens[k].column == nameToken.column + static_cast<int>(nameToken.value.size())) {
+        macro.functionLike = true;
+        ++k;
+        while (k < end && tokens[k].type != TokenType::RPAREN) {
+            if (tokens[k].type == TokenType::IDENTIFIER) {
+                macro.parameters.push_back(interner.intern(tokens[k].value));
+                ++k;
+                if (k < end && tokens[k].type == TokenType::COMMA) {
+                    ++k;
+                    continue;
+                }
+                if (k < end && tokens[k].type == TokenType::RPAREN) {
+                    break;
+                }
+            }
+            const Token& bad = k < end ? tokens[k] : tokens[end - 1];
+            errors.emplace_back("Invalid parameter list in definition of macro '" + nameToken.value + "'",
+                                bad.line, bad.column, bad.fileId);
+            return;
+        }
+        if (k >= end) {
+            errors.emplace_back("Missing ')' in definition of macro '" + nameToken.value + "'",
+                                nameToken.line, nameToken.column, nameToken.fileId);
+            return;
+        }
+        ++k;  // 跳过 )
+    }
+
+    macro.body.assign(tokens.begin() + k, tokens.begin() + end);
+    define(macro);
+}
+
+void MacroExpander::markOrigin(std::vector<Token>& tokens) {
+    for (auto& token : tokens) {
+        if (token.originLine == 0) {
+            token.originLine = token.line;
+            token.originColumn = token.column;
+        }
+    }
+}
+
+void MacroExpander::placeAt(std::vector<Token>& tokens, size_t from, const Token& site) {
+    for (size_t k = from; k < tokens.size(); ++k) {
+        tokens[k].line = site.line;
+        tokens[k].column = site.column;
+        tokens[k].fileId = site.fileId;
+        tokens[k].offset = site.offset;
+    }
+}
+
+Token MacroExpander::pasteTokens(const Token& left, const Token& right) {
+    std::string text = left.value + right.value;
+    Lexer lexer(text);
+    std::vector<Token> pasted = lexer.tokenize();
+    if (lexer.hasErrors() || pasted.size() != 2) {
+        errors.emplace_back("Pasting '" + left.value + "' and '" + right.value + "' does not give a valid token",
+                            left.line, left.column, left.fileId);
+        return left;
+    }
+    Token result = pasted[0];
+    result.line = left.line;
+    result.column = left.column;
+    result.fileId = left.fileId;
+    result.originLine = left.originLine;
+    result.originColumn = left.originColumn;
+    return result;
+}
+
+bool MacroExpander::collectArguments(const MacroDefinition& macro, const std::vector<Token>& input,
+                                     size_t& index, std::vector<std::vector<Token>>& arguments) {
+    const Token& open = input[index];
+    int depth = 1;
+    ++index;  // 跳过 (
+    std::vector<Token> current;
+    while (index < input.size() && input[index].type != TokenType::EOF_TOKEN) {
+        const Token& token = input[index++];
+        if (token.type == TokenType::NEWLINE) {
+            continue;  // 参数可以跨行
+        }
+        if (token.type == TokenType::LPAREN) {
+            ++depth;
+        } else if (token.type == TokenType::RPAREN) {
+            if (--depth == 0) {
+                arguments.push_back(std::move(current));
+                return true;
+            }
+        } else if (token.type == TokenType::COMMA && depth == 1) {
+            arguments.push_back(std::move(current));
+            current.clear();
+            continue;
+        }
+        current.push_back(token);
+    }
+    errors.emplace_back("Unterminated invocation of macro '" + interner.str(macro.name) + "'",
+                        open.line, open.column, open.fileId);
+    return false;
+}
+
+void MacroExpander::substitute(const MacroDefinition& macro, const std::vector<std::vector<Token>>& arguments,
+                               std::vector<Token>& result, std::vector<uint32_t>& active,
+                               std::vector<uint32_t>& dependencies) {
+    const std::vector<Token>& body = macro.body;
+    // 实参在替换前完整展开一次，同一形参多次出现时复用
+    std::vector<std::vector<Token>> expandedArguments(arguments.size());
+    std::vector<bool> expandedReady(arguments.size(), false);
+
+    auto parameterIndex = [&](const Token& token) -> int {
+        if (token.type != TokenType::IDENTIFIER) {
+            return -1;
+        }
+        uint32_t id = interner.lookup(token.value);
+        for (size_t p = 0; p < macro.parameters.size(); ++p) {
+            if (macro.parameters[p] == id) {
+                return static_cast<int>(p);
+            }
+        }
+        return -1;
+    };
+
+    bool pasteNext = false;
+    for (size_t k = 0; k < body.size(); ++k) {
+        if (isPasteOperator(body, k)) {
+            pasteNext = true;
+            ++k;
+            continue;
+        }
+
+        std::vector<Token> piece;
+        int param = parameterIndex(body[k]);
+        if (body[k].type == TokenType::HASH && k + 1 < body.size() && parameterIndex(body[k + 1]) >= 0) {
+            // #param：把实参原文转成字符串
+            const std::vector<Token>& argument = arguments[parameterIndex(body[k + 1])];
+            std::string text;
+            for (size_t a = 0; a < argument.size(); ++a) {
+                if (a > 0) text += " ";
+                text += spell(argument[a]);
+            }
+            piece.push_back(Token(TokenType::STRING, text, body[k].line, body[k].column));
+            ++k;
+        } else if (param >= 0) {
+            // 参与 ## 的形参使用未展开的实参
+            if (pasteNext || isPasteOperator(body, k + 1)) {
+                piece = arguments[param];
+            } else {
+                if (!expandedReady[param]) {
+                    expandRange(arguments[param], expandedArguments[param], active, dependencies);
+                    expandedReady[param] = true;
+                }
+                piece = expandedArguments[param];
+            }
+        } else {
+            piece.push_back(body[k]);
+        }
+
+        if (pasteNext && !result.empty() && !piece.empty()) {
+            result.back() = pasteTokens(result.back(), piece.front());
+            result.insert(result.end(), piece.begin() + 1, piece.end());
+        } else {
+            result.insert(result.end(), piece.begin(), piece.end());
+        }
+        pasteNext = false;
+    }
+}
+
+bool MacroExpander::expandCall(const MacroDefinition& macro, const Token& site, const std::vector<Token>& input,
+                               size_t& cursor, std::vector<Token>& output, std::vector<uint32_t>& active,
+                               std::vector<uint32_t>& dependencies, bool& deferred) {
+    // cursor指向实参列表的 ( ，成功时移到 ) 之后
+    size_t open = cursor;
+    std::vector<std::vector<Token>> arguments;
+    if (!collectArguments(macro, input, cursor, arguments)) {
+        cursor = open;
+        return false;
+    }
+    if (macro.parameters.empty() && arguments.size() == 1 && arguments[0].empty()) {
+        arguments.clear();
+    }
+    if (arguments.size() != macro.parameters.size()) {
+        std::ostringstream oss;
+        oss << "Macro '" << interner.str(macro.name) << "' expects " << macro.parameters.size()
+            << " argument(s), got " << arguments.size();
+        errors.emplace_back(oss.str(), site.line, site.column, site.fileId);
+        output.push_back(site);
+        output.insert(output.end(), input.begin() + open, input.begin() + cursor);
+        deferred = false;
+        return true;
+    }
+
+    std::vector<Token> substituted;
+    substitute(macro, arguments, substituted, active, dependencies);
+
+    std::vector<Token> result;
+    active.push_back(macro.name);
+    deferred = expandRange(substituted, result, active, dependencies);
+    active.pop_back();
+    markOrigin(result);
+
+    output.insert(output.end(), result.begin(), result.end());
+    ++expansionCount;
+    return true;
+}
+
+bool MacroExpander::expandMacro(const MacroDefinition& macro, const std::vector<Token>& input, size_t& index,
+                                std::vector<Token>& output, std::vector<uint32_t>& active,
+                                std::vector<uint32_t>& dependencies, bool& deferred) {
+    const Token site = input[index];
+    size_t start = output.size();
+
+    if (!macro.functionLike) {
+        auto cached = expansionCache.find(macro.name);
+        bool usable = cached != expansionCache.end() &&
+                      std::none_of(active.begin(), active.end(), [&](uint32_t id) {
+                          return contains(cached->second.dependencies, id);
+                      });
+        if (usable) {
+            output.insert(output.end(), cached->second.tokens.begin(), cached->second.tokens.end());
+            dependencies.insert(dependencies.end(), cached->second.dependencies.begin(),
+                                cached->second.dependencies.end());
+            deferred = cached->second.deferred;
+            ++cacheHitCount;
+        } else {
+            std::vector<Token> result;
+            std::vector<uint32_t> localDependencies;
+            active.push_back(macro.name);
+            deferred = expandRange(macro.body, result, active, localDependencies);
+            active.pop_back();
+            markOrigin(result);
+
+            // 展开过程没有碰到外层正在展开的宏时，结果与在最外层展开相同，可以缓存
+            bool cacheable = std::none_of(active.begin(), active.end(), [&](uint32_t id) {
+                return contains(localDependencies, id);
+            });
+
+            std::sort(localDependencies.begin(), localDependencies.end());
+            localDependencies.erase(std::unique(localDependencies.begin(), localDependencies.end()),
+                                    localDependencies.end());
+            output.insert(output.end(), result.begin(), result.end());
+            dependencies.insert(dependencies.end(), localDependencies.begin(), localDependencies.end());
+            if (cacheable) {
+                expansionCache[macro.name] =
+                    CachedExpansion{std::move(result), std::move(localDependencies), deferred};
+            }
+        }
+        ++index;
+        ++expansionCount;
+    } else {
+        // 函数宏：名字后（可跨行）必须紧跟 ( 才是一次调用
+        size_t cursor = index + 1;
+        while (cursor < input.size() && input[cursor].type == TokenType::NEWLINE) {
+            ++cursor;
+        }
+        if (cursor >= input.size() || input[cursor].type != TokenType::LPAREN ||
+            !expandCall(macro, site, input, cursor, output, active, dependencies, deferred)) {
+            return false;
+        }
+        index = cursor;
+    }
+
+    // 重新扫描：展开结果以函数宏名结尾时，与输入中随后的token一起扫描，
+    // 例如 #define F G 与 #define G(x) (x+1) 时，F(1) 展开为 (1+1)
+    while (deferred) {
+        size_t cursor = index;
+        while (cursor < input.size() && input[cursor].type == TokenType::NEWLINE) {
+            ++cursor;
+        }
+        if (cursor >= input.size()) {
+            break;  // 本层输入已结束，交给外层继续找 (
+        }
+        deferred = false;
+        const Token name = output.back();
+        const MacroDefinition* next = findMacro(name);
+        if (input[cursor].type != TokenType::LPAREN || !next || contains(active, next->name)) {
+            break;
+        }
+        output.pop_back();
+        if (!expandCall(*next, name, input, cursor, output, active, dependencies, deferred)) {
+            output.push_back(name);
+            deferred = false;
+            break;
+        }
+        dependencies.push_back(next->name);
+        index = cursor;
+    }
+    placeAt(output, start, site);
+    return true;
+}
+
+bool MacroExpander::expandRange(const std::vector<Token>& input, std::vector<Token>& output,
+                                std::vector<uint32_t>& active, std::vector<uint32_t>& dependencies) {
+    bool deferred = false;
+    size_t index = 0;
+    while (index < input.size()) {
+        const MacroDefinition* macro = findMacro(input[index]);
+        deferred = false;
+        if (macro) {
+            dependencies.push_back(macro->name);
+            // 正在展开的宏在重新扫描时不再展开，避免无限递归
+            if (!contains(active, macro->name)) {
+                if (expandMacro(*macro, input, index, output, active, dependencies, deferred)) {
+                    continue;
+                }
+                // 函数宏名位于输入末尾：调用的 ( 可能在外层随后的token中
+                deferred = macro->functionLike && std::all_of(input.begin() + index + 1, input.end(),
+                                                              [](const Token& token) {
+                                                                  return token.type == TokenType::NEWLINE;
+                                                              });
+            }
+        }
+        output.push_back(input[index]);
+        ++index;
+    }
+    return deferred;
+}
+
+std::vector<Token> MacroExpander::expand(const std::vector<Token>& tokens) {
+    std::vector<Token> output;
+    output.reserve(tokens.size());
+    std::vector<uint32_t> active;
+    std::vector<uint32_t> dependencies;
+
+    size_t index = 0;
+    while (index < tokens.size()) {
+        const Token& token = tokens[index];
+
+        // 预处理指令行：记录宏定义，指令内容本身不展开
+        if (token.type == TokenType::HASH && (index == 0 || tokens[index - 1].type == TokenType::NEWLINE)) {
+            size_t end = index;
+            while (end < tokens.size() && tokens[end].type != TokenType::NEWLINE &&
+                   tokens[end].type != TokenType::EOF_TOKEN) {
+                ++end;
+            }
+            if (index + 1 < end) {
+                const Token& directive = tokens[index + 1];
+                if (directive.type == TokenType::DEFINE) {
+                    defineFromTokens(tokens, index + 2, end);
+                } else if (directive.value == "undef" && index + 2 < end) {
+                    undefine(tokens[index + 2].value);
+                }
+            }
+            output.insert(output.end(), tokens.begin() + index, tokens.begin() + end);
+            index = end;
+            continue;
+        }
+
+        const MacroDefinition* macro = findMacro(token);
+        if (macro) {
+            dependencies.clear();
+            bool deferred = false;
+            if (expandMacro(*macro, tokens, index, output, active, dependencies, deferred)) {
+                continue;
+            }
+        }
+        output.push_back(token);
+        ++index;
+    }
+    return output;
+}
+
+const std::vector<LexicalError>& MacroExpander::getErrors() const {
+    return errors;
+}
+
+bool MacroExpander::hasErrors() const {
+    return !errors.empty();
+}
+
+size_t MacroExpander::getExpansionCount() const {
+    return expansionCount;
+}
+
+size_t MacroExpander::getCacheHitCount() const {
+    return cacheHitCount;
+}
+
+void MacroExpander::printMacroTable(std::ostream& os) const {
+    os << "\n=== Macro Table ===" << std::endl;
+    if (macros.empty()) {
+        os << "No macros defined." << std::endl;
+        return;
+    }
+
+    // 按名字排序输出，保证结果稳定
+    std::vector<const MacroDefinition*> sorted;
+    for (const auto& entry : macros) {
+        sorted.push_back(&entry.second);
+    }
+    std::sort(sorted.begin(), sorted.end(), [this](const MacroDefinition* a, const MacroDefinition* b) {
+        return interner.str(a->name) < interner.str(b->name);
+    });
+
+    for (const MacroDefinition* macro : sorted) {
+        os << interner.str(macro->name);
+        if (macro->functionLike) {
+            os << "(";
+            for (size_t p = 0; p < macro->parameters.size(); ++p) {
+                if (p > 0) os << ", ";
+                os << interner.str(macro->parameters[p]);
+            }
+            os << ")";
+        }
+        os << " ->";
+        for (size_t k = 0; k < macro->body.size(); ++k) {
+            if (isPasteOperator(macro->body, k)) {
+                os << " ##";
+                ++k;
+                continue;
+            }
+            os << " " << spell(macro->body[k]);
+        }
+        os << "  (line " << macro->line << ")" << std::endl;
+    }
+    os << "Expansions: " << expansionCount << ", memoised: " << cacheHitCount << std::endl;
+}
@@ -0,0 +1,55 @@
+#include "../include/MappedFile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// MappedFile类实现
+MappedFile::MappedFile() : data(nullptr), size(0) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // 映射建立后即可关闭文件描述符
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    data = mapped;
+    size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data) {
+        munmap(data, size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+bool MappedFile::isOpen() const {
+    return data != nullptr;
+}
+
+const char* MappedFile::getData() const {
+    return static_cast<const char*>(data);
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
@@ -1,10 +1,11 @@
 #include "../include/Parser.h"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 // SyntaxError类实现
-SyntaxError::SyntaxError(const std::string& msg, int line, int column)
-    : message(msg), line(line), column(column) {}
+SyntaxError::SyntaxError(const std::string& msg, int line, int column, int fileId)
+    : message(msg), line(line), column(column), fileId(fileId) {}
 
 const char* SyntaxError::what() const noexcept {
     return message.c_str();
@@ -24,28 +25,15 @@ void ASTNode::print(int indent) const {
     std::cout << toString() << std::endl;
 }
 
-void ASTNode::printChinese(int indent) const {
-    // 默认实现，子类可以重写来提供更详细的中文输出
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << toString() << std::endl;
+// ProgramNode实现
+ASTNodeKind ProgramNode::getKind() const {
+    return ASTNodeKind::Program;
 }
 
-// ProgramNode实现
 std::string ProgramNode::toString() const {
     return "Program";
 }
 
-void ProgramNode::printChinese(int indent) const {
-    // 直接打印所有语句，不需要额外的"Program"标识
-    for (const auto& stmt : statements) {
-        if (stmt) {
-            stmt->printChinese(indent);
-        }
-    }
-}
-
 void ProgramNode::addStatement(std::unique_ptr<ASTNode> stmt) {
     statements.push_back(std::move(stmt));
 }
@@ -54,93 +42,54 @@ void ProgramNode::addStatement(std::unique_ptr<ASTNode> stmt) {
 VarDeclarationNode::VarDeclarationNode(const std::string& type, const std::string& id)
     : type(type), identifier(id) {}
 
-std::string VarDeclarationNode::toString() const {
-    return "变量声明: " + type;
+ASTNodeKind VarDeclarationNode::getKind() const {
+    return ASTNodeKind::VarDeclaration;
 }
 
-void VarDeclarationNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "变量声明: " << type << std::endl;
-    
-    // 打印标识符
-    for (int i = 0; i < indent + 1; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "标识符: " << identifier << std::endl;
-    
-    // 如果有初始化表达式，打印运算符=和值
-    if (initializer) {
-        for (int i = 0; i < indent + 2; ++i) {
-            std::cout << "  ";
-        }
-        std::cout << "运算符: =" << std::endl;
-        initializer->printChinese(indent + 3);
-    }
+std::string VarDeclarationNode::toString() const {
+    return "变量声明: " + type;
 }
 
 // AssignmentNode实现
 AssignmentNode::AssignmentNode(const std::string& id) : identifier(id) {}
 
-std::string AssignmentNode::toString() const {
-    return "赋值: " + identifier;
+ASTNodeKind AssignmentNode::getKind() const {
+    return ASTNodeKind::Assignment;
 }
 
-void AssignmentNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "标识符: " << identifier << std::endl;
-    
-    if (expression) {
-        expression->printChinese(indent);
-    }
+std::string AssignmentNode::toString() const {
+    return "赋值: " + identifier;
 }
 
 // BinaryExpressionNode实现
 BinaryExpressionNode::BinaryExpressionNode(const std::string& op) : operator_(op) {}
 
-std::string BinaryExpressionNode::toString() const {
-    return "运算符: " + operator_;
+ASTNodeKind BinaryExpressionNode::getKind() const {
+    return ASTNodeKind::BinaryExpression;
 }
 
-void BinaryExpressionNode::printChinese(int indent) const {
-    if (left) {
-        left->printChinese(indent);
-    }
-    
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "运算符: " << operator_ << std::endl;
-    
-    if (right) {
-        right->printChinese(indent + 1);
-    }
+std::string BinaryExpressionNode::toString() const {
+    return "运算符: " + operator_;
 }
 
 // UnaryExpressionNode实现
 UnaryExpressionNode::UnaryExpressionNode(const std::string& op) : operator_(op) {}
 
-std::string UnaryExpressionNode::toString() const {
-    return "运算符: " + operator_;
+ASTNodeKind UnaryExpressionNode::getKind() const {
+    return ASTNodeKind::UnaryExpression;
 }
 
-void UnaryExpressionNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "运算符: " << operator_ << std::endl;
-    
-    if (operand) {
-        operand->printChinese(indent);
-    }
+std::string UnaryExpressionNode::toString() const {
+    return "运算符: " + operator_;
 }
 
 // LiteralNode实现
 LiteralNode::LiteralNode(const std::string& val, TokenType t) : value(val), type(t) {}
 
+ASTNodeKind LiteralNode::getKind() const {
+    return ASTNodeKind::Literal;
+}
+
 std::string LiteralNode::toString() const {
     if (type == TokenType::INTEGER || type == TokenType::FLOAT) {
         return "数字: " + value;
@@ -151,138 +100,55 @@ std::string LiteralNode::toString() const {
     }
 }
 
-void LiteralNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    
-    if (type == TokenType::INTEGER || type == TokenType::FLOAT) {
-        std::cout << "数字: " << value << std::endl;
-    } else if (type == TokenType::STRING) {
-        std::cout << "字符串: " << value << std::endl;
-    } else if (type == TokenType::BREAK) {
-        std::cout << "break语句: break" << std::endl;
-    } else if (type == TokenType::CONTINUE) {
-        std::cout << "continue语句: continue" << std::endl;
-    } else {
-        std::cout << value << std::endl;
-    }
-}
-
 // IdentifierNode实现
 IdentifierNode::IdentifierNode(const std::string& n) : name(n) {}
 
+ASTNodeKind IdentifierNode::getKind() const {
+    return ASTNodeKind::Identifier;
+}
+
 std::string IdentifierNode::toString() const {
     return "标识符: " + name;
 }
 
-void IdentifierNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "标识符: " << name << std::endl;
+// IfStatementNode实现
+ASTNodeKind IfStatementNode::getKind() const {
+    return ASTNodeKind::IfStatement;
 }
 
-// IfStatementNode实现
 std::string IfStatementNode::toString() const {
     return "if语句: if";
 }
 
-void IfStatementNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "if语句: if" << std::endl;
-    
-    // 打印条件
-    for (int i = 0; i < indent + 1; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "表达式:" << std::endl;
-    
-    if (condition) {
-        condition->printChinese(indent + 2);
-    }
-    
-    // 打印then语句
-    if (thenStatement) {
-        thenStatement->printChinese(indent + 1);
-    }
-    
-    // 打印else语句
-    if (elseStatement) {
-        for (int i = 0; i < indent + 1; ++i) {
-            std::cout << "  ";
-        }
-        std::cout << "关键字: else" << std::endl;
-        elseStatement->printChinese(indent + 2);
-    }
+// WhileStatementNode实现
+ASTNodeKind WhileStatementNode::getKind() const {
+    return ASTNodeKind::WhileStatement;
 }
 
-// WhileStatementNode实现
 std::string WhileStatementNode::toString() const {
     return "while语句: while";
 }
 
-void WhileStatementNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "while语句: while" << std::endl;
-    
-    // 打印条件
-    for (int i = 0; i < indent + 1; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "表达式:" << std::endl;
-    
-    if (condition) {
-        condition->printChinese(indent + 2);
-    }
-    
-    // 打印循环体
-    if (body) {
-        body->printChinese(indent + 1);
-    }
+// CompoundStatementNode实现
+ASTNodeKind CompoundStatementNode::getKind() const {
+    return ASTNodeKind::CompoundStatement;
 }
 
-// CompoundStatementNode实现
 std::string CompoundStatementNode::toString() const {
     return "复合语句:";
 }
 
-void CompoundStatementNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "复合语句:" << std::endl;
-    
-    // 打印所有子语句
-    for (const auto& stmt : statements) {
-        if (stmt) {
-            stmt->printChinese(indent + 1);
-        }
-    }
-}
-
 void CompoundStatementNode::addStatement(std::unique_ptr<ASTNode> stmt) {
     statements.push_back(std::move(stmt));
 }
 
 // ReturnStatementNode实现
-std::string ReturnStatementNode::toString() const {
-    return "return语句: return";
+ASTNodeKind ReturnStatementNode::getKind() const {
+    return ASTNodeKind::ReturnStatement;
 }
 
-void ReturnStatementNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "return语句: return" << std::endl;
-    
-    if (expression) {
-        expression->printChinese(indent + 1);
-    }
+std::string ReturnStatementNode::toString() const {
+    return "return语句: return";
 }
 
 // Parser类实现
@@ -344,7 +210,14 @@ Token Parser::consume(TokenType type, const std::string& errorMessage) {
 
 void Parser::recordError(const std::string& message) {
     const Token& token = getCurrentToken();
-    errors.emplace_back(message, token.line, token.column);
+    if (token.originLine > 0) {
+        // 宏展开得到的token：位置指向宏的使用处，同时给出宏定义中的位置
+        std::ostringstream oss;
+        oss << message << " (in macro expansion, defined at " << token.originLine << ":" << token.originColumn << ")";
+        errors.emplace_back(oss.str(), token.line, token.column, token.fileId);
+        return;
+    }
+    errors.emplace_back(message, token.line, token.column, token.fileId);
 }
 
 void Parser::synchronize() {
@@ -372,6 +245,19 @@ void Parser::synchronize() {
     }
 }
 
+void Parser::markRange(ASTNode* node, size_t first) const {
+    if (!node || tokens.empty()) {
+        return;
+    }
+    first = std::min(first, tokens.size() - 1);
+    const Token& token = tokens[first];
+    node->line = token.line;
+    node->column = token.column;
+    node->fileId = token.fileId;
+    node->firstToken = first;
+    node->lastToken = currentToken > first ? std::min(currentToken, tokens.size()) - 1 : first;
+}
+
 std::unique_ptr<ProgramNode> Parser::parseProgram() {
     auto program = std::make_unique<ProgramNode>();
     
@@ -400,6 +286,7 @@ std::unique_ptr<ProgramNode> Parser::parseProgram() {
         }
     }
     
+    markRange(program.get(), 0);
     return program;
 }
 
@@ -412,6 +299,8 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
         return nullptr;
     }
     
+    size_t start = currentToken;
+    
     // 预处理指令（改进的处理）
     if (match(TokenType::HASH)) {
         if (match(TokenType::INCLUDE)) {
@@ -436,7 +325,9 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
                 recordError("Expected '<filename>' or \"filename\" after #include");
             }
             
-            return std::make_unique<PreprocessorDirectiveNode>("include", content);
+            auto directive = std::make_unique<PreprocessorDirectiveNode>("include", content);
+            markRange(directive.get(), start);
+            return directive;
         } else if (match(TokenType::DEFINE)) {
             // 处理 #define 指令
             std::string content = "";
@@ -445,7 +336,9 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
                 content += getCurrentToken().value;
                 advance();
             }
-            return std::make_unique<PreprocessorDirectiveNode>("define", content);
+            auto directive = std::make_unique<PreprocessorDirectiveNode>("define", content);
+            markRange(directive.get(), start);
+            return directive;
         } else {
             // 其他预处理指令
             std::string content = "";
@@ -454,7 +347,9 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
                 content += getCurrentToken().value;
                 advance();
             }
-            return std::make_unique<PreprocessorDirectiveNode>("unknown", content);
+            auto directive = std::make_unique<PreprocessorDirectiveNode>("unknown", content);
+            markRange(directive.get(), start);
+            return directive;
         }
     }
     
@@ -480,11 +375,24 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
                 std::string paramType = getCurrentToken().value;
                 advance();
                 if (check(TokenType::IDENTIFIER)) {
+                    size_t paramStart = currentToken - 1;
                     std::string paramName = getCurrentToken().value;
                     advance();
-                    funcNode->parameters.push_back(
-                        std::make_unique<VarDeclarationNode>(paramType, paramName)
-                    );
+                    if (match(TokenType::LBRACKET)) {
+                        // 数组形参：int a[] 或 int a[N]，按引用传递
+                        size_t size = 0;
+                        if (!check(TokenType::RBRACKET)) {
+                            size = parseArraySize();
+                        }
+                        consume(TokenType::RBRACKET, "Expected ']' after array parameter");
+                        auto param = std::make_unique<ArrayDeclarationNode>(paramType, paramName, size);
+                        markRange(param.get(), paramStart);
+                        funcNode->parameters.push_back(std::move(param));
+                    } else {
+                        auto param = std::make_unique<VarDeclarationNode>(paramType, paramName);
+                        markRange(param.get(), paramStart);
+                        funcNode->parameters.push_back(std::move(param));
+                    }
                 }
             } else if (check(TokenType::IDENTIFIER)) {
                 // 如果遇到标识符作为类型，这可能是错误的类型名
@@ -506,13 +414,15 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
         // 检查是函数声明还是定义
         if (check(TokenType::SEMICOLON)) {
             advance(); // 消费分号，这是函数声明
-            return std::move(funcNode);
+            markRange(funcNode.get(), start);
+            return funcNode;
         } else {
             // 这是函数定义，需要解析函数体
             auto funcDefNode = std::make_unique<FunctionDefinitionNode>(returnType, functionName);
             funcDefNode->parameters = std::move(funcNode->parameters);
             funcDefNode->body = parseCompoundStatement();
-            return std::move(funcDefNode);
+            markRange(funcDefNode.get(), start);
+            return funcDefNode;
         }
     }
     
@@ -549,13 +459,17 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
     // break语句（简单处理）
     if (match(TokenType::BREAK)) {
         consume(TokenType::SEMICOLON, "Expected ';' after break");
-        return std::make_unique<BreakStatementNode>();
+        auto breakStmt = std::make_unique<BreakStatementNode>();
+        markRange(breakStmt.get(), start);
+        return breakStmt;
     }
     
     // continue语句（简单处理）
     if (match(TokenType::CONTINUE)) {
         consume(TokenType::SEMICOLON, "Expected ';' after continue");
-        return std::make_unique<ContinueStatementNode>();
+        auto continueStmt = std::make_unique<ContinueStatementNode>();
+        markRange(continueStmt.get(), start);
+        return continueStmt;
     }
     
     // 赋值或表达式语句
@@ -577,10 +491,30 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
 }
 
 std::unique_ptr<ASTNode> Parser::parseVarDeclaration() {
+    size_t start = currentToken;
     std::string type = getCurrentToken().value;
     advance(); // 消费类型token
     
     Token identifier = consume(TokenType::IDENTIFIER, "Expected variable name");
+    
+    // 定长数组声明
+    if (match(TokenType::LBRACKET)) {
+        size_t size = parseArraySize();
+        consume(TokenType::RBRACKET, "Expected ']' after array size");
+        if (size == 0) {
+            recordError("Array size must be a positive integer constant");
+        }
+        if (check(TokenType::ASSIGN)) {
+            recordError("Array initializers are not supported; elements start as 0");
+            advance();
+            parseExpression();
+        }
+        auto arrayDecl = std::make_unique<ArrayDeclarationNode>(type, identifier.value, size);
+        consume(TokenType::SEMICOLON, "Expected ';' after array declaration");
+        markRange(arrayDecl.get(), start);
+        return arrayDecl;
+    }
+    
     auto varDecl = std::make_unique<VarDeclarationNode>(type, identifier.value);
     
     // 检查是否有初始化
@@ -597,10 +531,28 @@ std::unique_ptr<ASTNode> Parser::parseVarDeclaration() {
     }
     
     consume(TokenType::SEMICOLON, "Expected ';' after variable declaration");
-    return std::move(varDecl);
+    markRange(varDecl.get(), start);
+    return varDecl;
+}
+
+size_t Parser::parseArraySize() {
+    if (!check(TokenType::INTEGER)) {
+        recordError("Expected array size");
+        return 0;
+    }
+    const std::string& text = getCurrentToken().value;
+    size_t size = 0;
+    try {
+        size = std::stoul(text);
+    } catch (const std::exception&) {
+        recordError("Array size '" + text + "' is out of range");
+    }
+    advance();
+    return size;
 }
 
 std::unique_ptr<ASTNode> Parser::parseAssignment() {
+    size_t start = currentToken;
     Token identifier = consume(TokenType::IDENTIFIER, "Expected identifier");
     
     consume(TokenType::ASSIGN, "Expected '='");
@@ -609,15 +561,21 @@ std::unique_ptr<ASTNode> Parser::parseAssignment() {
     // 创建二元表达式节点表示赋值
     auto assignment = std::make_unique<BinaryExpressionNode>("=");
     assignment->left = std::make_unique<IdentifierNode>(identifier.value);
+    markRange(assignment->left.get(), start);
+    assignment->left->lastToken = start;
     assignment->right = std::move(expression);
+    markRange(assignment.get(), start);
     
     consume(TokenType::SEMICOLON, "Expected ';' after assignment");
     
     // 包装在表达式语句中
-    return std::make_unique<ExpressionStatementNode>(std::move(assignment));
+    auto statement = std::make_unique<ExpressionStatementNode>(std::move(assignment));
+    markRange(statement.get(), start);
+    return statement;
 }
 
 std::unique_ptr<ASTNode> Parser::parseIfStatement() {
+    size_t start = currentToken - 1;  // 关键字已被消费
     auto ifStmt = std::make_unique<IfStatementNode>();
     
     consume(TokenType::LPAREN, "Expected '(' after 'if'");
@@ -633,10 +591,12 @@ std::unique_ptr<ASTNode> Parser::parseIfStatement() {
         ifStmt->elseStatement = parseStatement();
     }
     
-    return std::move(ifStmt);
+    markRange(ifStmt.get(), start);
+    return ifStmt;
 }
 
 std::unique_ptr<ASTNode> Parser::parseWhileStatement() {
+    size_t start = currentToken - 1;  // 关键字已被消费
     auto whileStmt = std::make_unique<WhileStatementNode>();
     
     consume(TokenType::LPAREN, "Expected '(' after 'while'");
@@ -645,10 +605,12 @@ std::unique_ptr<ASTNode> Parser::parseWhileStatement() {
     
     whileStmt->body = parseStatement();
     
-    return std::move(whileStmt);
+    markRange(whileStmt.get(), start);
+    return whileStmt;
 }
 
 std::unique_ptr<ASTNode> Parser::parseForStatement() {
+    size_t start = currentToken - 1;  // 关键字已被消费
     auto forStmt = std::make_unique<ForStatementNode>();
     
     consume(TokenType::LPAREN, "Expected '(' after 'for'");
@@ -657,7 +619,7 @@ std::unique_ptr<ASTNode> Parser::parseForStatement() {
     if (check(TokenType::INT) || check(TokenType::FLOAT_KW) || check(TokenType::CHAR)) {
         forStmt->initialization = parseVarDeclaration();
     } else if (!check(TokenType::SEMICOLON)) {
-        forStmt->initialization = parseExpression();
+        forStmt->initialization = parseAssignmentOrExpression();
         consume(TokenType::SEMICOLON, "Expected ';' after for loop initialization");
     } else {
         consume(TokenType::SEMICOLON, "Expected ';' after for loop initialization");
@@ -671,17 +633,19 @@ std::unique_ptr<ASTNode> Parser::parseForStatement() {
     
     // 解析更新部分
     if (!check(TokenType::RPAREN)) {
-        forStmt->update = parseExpression();
+        forStmt->update = parseAssignmentOrExpression();
     }
     consume(TokenType::RPAREN, "Expected ')' after for loop");
     
     // 解析循环体
     forStmt->body = parseStatement();
     
-    return std::move(forStmt);
+    markRange(forStmt.get(), start);
+    return forStmt;
 }
 
 std::unique_ptr<ASTNode> Parser::parseCompoundStatement() {
+    size_t start = currentToken;
     auto compound = std::make_unique<CompoundStatementNode>();
     
     consume(TokenType::LBRACE, "Expected '{'");
@@ -708,10 +672,12 @@ std::unique_ptr<ASTNode> Parser::parseCompoundStatement() {
     }
     
     consume(TokenType::RBRACE, "Expected '}'");
-    return std::move(compound);
+    markRange(compound.get(), start);
+    return compound;
 }
 
 std::unique_ptr<ASTNode> Parser::parseReturnStatement() {
+    size_t start = currentToken - 1;  // 关键字已被消费
     auto returnStmt = std::make_unique<ReturnStatementNode>();
     
     if (!check(TokenType::SEMICOLON)) {
@@ -719,7 +685,8 @@ std::unique_ptr<ASTNode> Parser::parseReturnStatement() {
     }
     
     consume(TokenType::SEMICOLON, "Expected ';' after return statement");
-    return std::move(returnStmt);
+    markRange(returnStmt.get(), start);
+    return returnStmt;
 }
 
 std::unique_ptr<ASTNode> Parser::parseExpressionStatement() {
@@ -734,6 +701,8 @@ std::unique_ptr<ASTNode> Parser::parseExpressionStatement() {
         return nullptr;
     }
     
+    size_t start = currentToken;
+    
     // 处理独立的INCREMENT/DECREMENT语句 (前缀)
     if (check(TokenType::INCREMENT) || check(TokenType::DECREMENT)) {
         TokenType opType = getCurrentToken().type;
@@ -744,7 +713,9 @@ std::unique_ptr<ASTNode> Parser::parseExpressionStatement() {
             advance(); // 消费标识符
             consume(TokenType::SEMICOLON, "Expected ';' after increment/decrement");
             std::string op = (opType == TokenType::INCREMENT) ? "++" : "--";
-            return std::make_unique<IdentifierNode>(op + varName);
+            auto increment = std::make_unique<IdentifierNode>(op + varName);
+            markRange(increment.get(), start);
+            return increment;
         } else {
             std::string opName = (opType == TokenType::INCREMENT) ? "increment" : "decrement";
             std::string msg = "Expected identifier after " + opName + " operator";
@@ -754,10 +725,12 @@ std::unique_ptr<ASTNode> Parser::parseExpressionStatement() {
     }
     
     try {
-        auto expr = parseExpression();
+        auto expr = parseAssignmentOrExpression();
         if (expr) {
             consume(TokenType::SEMICOLON, "Expected ';' after expression");
-            return std::make_unique<ExpressionStatementNode>(std::move(expr));
+            auto statement = std::make_unique<ExpressionStatementNode>(std::move(expr));
+            markRange(statement.get(), start);
+            return statement;
         }
         return nullptr;
     } catch (const std::exception& e) {
@@ -772,6 +745,21 @@ std::unique_ptr<ASTNode> Parser::parseExpressionStatement() {
     }
 }
 
+std::unique_ptr<ASTNode> Parser::parseAssignmentOrExpression() {
+    size_t start = currentToken;
+    auto expr = parseExpression();
+    if (expr && (expr->getKind() == ASTNodeKind::Identifier || expr->getKind() == ASTNodeKind::IndexExpression) &&
+        match(TokenType::ASSIGN)) {
+        // 变量或数组元素赋值：x = 值、a[i] = 值
+        auto assignment = std::make_unique<BinaryExpressionNode>("=");
+        assignment->left = std::move(expr);
+        assignment->right = parseExpression();
+        markRange(assignment.get(), start);
+        return assignment;
+    }
+    return expr;
+}
+
 std::unique_ptr<ASTNode> Parser::parseExpression() {
     return parseLogicalOr();
 }
@@ -785,6 +773,7 @@ std::unique_ptr<ASTNode> Parser::parseLogicalOr() {
         auto binaryExpr = std::make_unique<BinaryExpressionNode>(operator_);
         binaryExpr->left = std::move(expr);
         binaryExpr->right = std::move(right);
+        markRange(binaryExpr.get(), binaryExpr->left ? binaryExpr->left->firstToken : currentToken - 1);
         expr = std::move(binaryExpr);
     }
     
@@ -800,6 +789,7 @@ std::unique_ptr<ASTNode> Parser::parseLogicalAnd() {
         auto binaryExpr = std::make_unique<BinaryExpressionNode>(operator_);
         binaryExpr->left = std::move(expr);
         binaryExpr->right = std::move(right);
+        markRange(binaryExpr.get(), binaryExpr->left ? binaryExpr->left->firstToken : currentToken - 1);
         expr = std::move(binaryExpr);
     }
     
@@ -815,6 +805,7 @@ std::unique_ptr<ASTNode> Parser::parseEquality() {
         auto binaryExpr = std::make_unique<BinaryExpressionNode>(operator_);
         binaryExpr->left = std::move(expr);
         binaryExpr->right = std::move(right);
+        markRange(binaryExpr.get(), binaryExpr->left ? binaryExpr->left->firstToken : currentToken - 1);
         expr = std::move(binaryExpr);
     }
     
@@ -831,6 +822,7 @@ std::unique_ptr<ASTNode> Parser::parseComparison() {
         auto binaryExpr = std::make_unique<BinaryExpressionNode>(operator_);
         binaryExpr->left = std::move(expr);
         binaryExpr->right = std::move(right);
+        markRange(binaryExpr.get(), binaryExpr->left ? binaryExpr->left->firstToken : currentToken - 1);
         expr = std::move(binaryExpr);
     }
     
@@ -846,6 +838,7 @@ std::unique_ptr<ASTNode> Parser::parseAddition() {
         auto binaryExpr = std::make_unique<BinaryExpressionNode>(operator_);
         binaryExpr->left = std::move(expr);
         binaryExpr->right = std::move(right);
+        markRange(binaryExpr.get(), binaryExpr->left ? binaryExpr->left->firstToken : currentToken - 1);
         expr = std::move(binaryExpr);
     }
     
@@ -861,6 +854,7 @@ std::unique_ptr<ASTNode> Parser::parseMultiplication() {
         auto binaryExpr = std::make_unique<BinaryExpressionNode>(operator_);
         binaryExpr->left = std::move(expr);
         binaryExpr->right = std::move(right);
+        markRange(binaryExpr.get(), binaryExpr->left ? binaryExpr->left->firstToken : currentToken - 1);
         expr = std::move(binaryExpr);
     }
     
@@ -869,11 +863,13 @@ std::unique_ptr<ASTNode> Parser::parseMultiplication() {
 
 std::unique_ptr<ASTNode> Parser::parseUnary() {
     if (match(TokenType::NOT) || match(TokenType::MINUS)) {
+        size_t start = currentToken - 1;
         std::string operator_ = tokens[currentToken - 1].value;
         auto operand = parseUnary();
         auto unaryExpr = std::make_unique<UnaryExpressionNode>(operator_);
         unaryExpr->operand = std::move(operand);
-        return std::move(unaryExpr);
+        markRange(unaryExpr.get(), start);
+        return unaryExpr;
     }
     
     return parsePrimary();
@@ -883,17 +879,22 @@ std::unique_ptr<ASTNode> Parser::parsePrimary() {
     // 数字字面量
     if (match(TokenType::INTEGER) || match(TokenType::FLOAT)) {
         Token token = tokens[currentToken - 1];
-        return std::make_unique<LiteralNode>(token.value, token.type);
+        auto literal = std::make_unique<LiteralNode>(token.value, token.type);
+        markRange(literal.get(), currentToken - 1);
+        return literal;
     }
     
     // 字符串字面量
     if (match(TokenType::STRING)) {
         Token token = tokens[currentToken - 1];
-        return std::make_unique<LiteralNode>(token.value, token.type);
+        auto literal = std::make_unique<LiteralNode>(token.value, token.type);
+        markRange(literal.get(), currentToken - 1);
+        return literal;
     }
     
     // 标识符
     if (match(TokenType::IDENTIFIER)) {
+        size_t start = currentToken - 1;
         Token token = tokens[currentToken - 1];
         
         // 检查是否有函数调用
@@ -914,16 +915,33 @@ std::unique_ptr<ASTNode> Parser::parsePrimary() {
                 break;
             }
             consume(TokenType::RPAREN, "Expected ')' after function arguments");
-            return std::move(funcCall);
+            markRange(funcCall.get(), start);
+            return funcCall;
+        }
+        
+        // 下标表达式
+        if (match(TokenType::LBRACKET)) {
+            auto indexExpr = std::make_unique<IndexExpressionNode>();
+            indexExpr->array = std::make_unique<IdentifierNode>(token.value);
+            markRange(indexExpr->array.get(), start);
+            indexExpr->array->lastToken = start;
+            indexExpr->index = parseExpression();
+            consume(TokenType::RBRACKET, "Expected ']' after array index");
+            markRange(indexExpr.get(), start);
+            return indexExpr;
         }
         
         // 检查是否有后缀++
         if (check(TokenType::INCREMENT)) {
             advance(); // 消费++
-            return std::make_unique<IdentifierNode>(token.value + "++");
+            auto increment = std::make_unique<IdentifierNode>(token.value + "++");
+            markRange(increment.get(), start);
+            return increment;
         }
         
-        return std::make_unique<IdentifierNode>(token.value);
+        auto identifier = std::make_unique<IdentifierNode>(token.value);
+        markRange(identifier.get(), start);
+        return identifier;
     }
     
     // 括号表达式
@@ -971,180 +989,105 @@ void Parser::reset(const std::vector<Token>& newTokens) {
 PreprocessorDirectiveNode::PreprocessorDirectiveNode(const std::string& dir, const std::string& cont)
     : directive(dir), content(cont) {}
 
-std::string PreprocessorDirectiveNode::toString() const {
-    return "预处理指令: # " + directive + " " + content;
+ASTNodeKind PreprocessorDirectiveNode::getKind() const {
+    return ASTNodeKind::PreprocessorDirective;
 }
 
-void PreprocessorDirectiveNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "预处理指令: # " << directive << " " << content << std::endl;
+std::string PreprocessorDirectiveNode::toString() const {
+    return "预处理指令: # " + directive + " " + content;
 }
 
 // FunctionDeclarationNode实现
 FunctionDeclarationNode::FunctionDeclarationNode(const std::string& retType, const std::string& funcName)
     : returnType(retType), name(funcName) {}
 
-std::string FunctionDeclarationNode::toString() const {
-    return "函数声明: " + returnType;
+ASTNodeKind FunctionDeclarationNode::getKind() const {
+    return ASTNodeKind::FunctionDeclaration;
 }
 
-void FunctionDeclarationNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "函数声明: " << returnType << std::endl;
-    
-    for (int i = 0; i < indent + 1; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "标识符: " << name << std::endl;
-    
-    // 打印参数
-    for (const auto& param : parameters) {
-        if (param) {
-            param->printChinese(indent + 1);
-        }
-    }
+std::string FunctionDeclarationNode::toString() const {
+    return "函数声明: " + returnType;
 }
 
 // FunctionDefinitionNode实现
 FunctionDefinitionNode::FunctionDefinitionNode(const std::string& retType, const std::string& funcName)
     : returnType(retType), name(funcName) {}
 
-std::string FunctionDefinitionNode::toString() const {
-    return "函数定义: " + returnType;
+ASTNodeKind FunctionDefinitionNode::getKind() const {
+    return ASTNodeKind::FunctionDefinition;
 }
 
-void FunctionDefinitionNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "函数定义: " << returnType << std::endl;
-    
-    for (int i = 0; i < indent + 1; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "标识符: " << name << std::endl;
-    
-    // 打印参数
-    for (const auto& param : parameters) {
-        if (param) {
-            param->printChinese(indent + 1);
-        }
-    }
-    
-    // 打印函数体
-    if (body) {
-        body->printChinese(indent + 1);
-    }
+std::string FunctionDefinitionNode::toString() const {
+    return "函数定义: " + returnType;
 }
 
 // ExpressionStatementNode实现
 ExpressionStatementNode::ExpressionStatementNode(std::unique_ptr<ASTNode> expr)
     : expression(std::move(expr)) {}
 
-std::string ExpressionStatementNode::toString() const {
-    return "表达式语句:";
+ASTNodeKind ExpressionStatementNode::getKind() const {
+    return ASTNodeKind::ExpressionStatement;
 }
 
-void ExpressionStatementNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "表达式语句:" << std::endl;
-    
-    if (expression) {
-        for (int i = 0; i < indent + 1; ++i) {
-            std::cout << "  ";
-        }
-        std::cout << "表达式:" << std::endl;
-        expression->printChinese(indent + 2);
-    }
+std::string ExpressionStatementNode::toString() const {
+    return "表达式语句:";
 }
 
 // FunctionCallNode实现
 FunctionCallNode::FunctionCallNode(const std::string& funcName) : name(funcName) {}
 
+ASTNodeKind FunctionCallNode::getKind() const {
+    return ASTNodeKind::FunctionCall;
+}
+
 std::string FunctionCallNode::toString() const {
     return "函数调用: " + name;
 }
 
-void FunctionCallNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "函数调用: " << name << std::endl;
-    
-    // 打印参数
-    for (const auto& arg : arguments) {
-        if (arg) {
-            arg->printChinese(indent + 1);
-        }
-    }
+// ForStatementNode实现
+ASTNodeKind ForStatementNode::getKind() const {
+    return ASTNodeKind::ForStatement;
 }
 
-// ForStatementNode实现
 std::string ForStatementNode::toString() const {
     return "for语句: for";
 }
 
-void ForStatementNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "for语句: for" << std::endl;
-    
-    // 打印初始化
-    if (initialization) {
-        initialization->printChinese(indent + 1);
-    }
-    
-    // 打印条件
-    if (condition) {
-        for (int i = 0; i < indent + 1; ++i) {
-            std::cout << "  ";
-        }
-        std::cout << "表达式:" << std::endl;
-        condition->printChinese(indent + 2);
-    }
-    
-    // 打印更新表达式
-    if (update) {
-        for (int i = 0; i < indent + 1; ++i) {
-            std::cout << "  ";
-        }
-        std::cout << "表达式:" << std::endl;
-        update->printChinese(indent + 2);
-    }
-    
-    // 打印循环体
-    if (body) {
-        body->printChinese(indent + 1);
-    }
+// BreakStatementNode实现
+ASTNodeKind BreakStatementNode::getKind() const {
+    return ASTNodeKind::BreakStatement;
 }
 
-// BreakStatementNode实现
 std::string BreakStatementNode::toString() const {
     return "break语句: break";
 }
 
-void BreakStatementNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "break语句: break" << std::endl;
+// ContinueStatementNode实现
+ASTNodeKind ContinueStatementNode::getKind() const {
+    return ASTNodeKind::ContinueStatement;
 }
 
-// ContinueStatementNode实现
 std::string ContinueStatementNode::toString() const {
     return "continue语句: continue";
 }
 
-void ContinueStatementNode::printChinese(int indent) const {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-    std::cout << "continue语句: continue" << std::endl;
+// ArrayDeclarationNode实现
+ArrayDeclarationNode::ArrayDeclarationNode(const std::string& type, const std::string& id, size_t size)
+    : type(type), identifier(id), size(size) {}
+
+ASTNodeKind ArrayDeclarationNode::getKind() const {
+    return ASTNodeKind::ArrayDeclaration;
+}
+
+std::string ArrayDeclarationNode::toString() const {
+    return "数组声明: " + type;
+}
+
+// IndexExpressionNode实现
+ASTNodeKind IndexExpressionNode::getKind() const {
+    return ASTNodeKind::IndexExpression;
+}
+
+std::string IndexExpressionNode::toString() const {
+    return "下标:";
 }
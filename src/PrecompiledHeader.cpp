@@ -0,0 +1,443 @@
+#include "../include/PrecompiledHeader.h"
+#include "../include/BinaryFormat.h"
+#include "../include/MappedFile.h"
+#include "../include/HashUtils.h"
+#include <filesystem>
+#include <cstring>
+
+namespace {
+
+// 快照文件格式版本，磁盘结构变化时递增
+const char PCH_MAGIC[8] = {'C', 'A', 'P', 'C', 'H', '0', '1', '\0'};
+const uint32_t PCH_VERSION = 4;
+
+// 各数据段
+enum PchSection {
+    SECTION_FILES,          // StringRef：文件表，fileId n 对应第 n-1 项
+    SECTION_DEPENDENCIES,   // DiskDependency
+    SECTION_TOKENS,         // DiskToken：前缀token流
+    SECTION_MACROS,         // DiskMacro
+    SECTION_MACRO_PARAMS,   // StringRef：所有宏的形参依次排列
+    SECTION_MACRO_TOKENS,   // DiskToken：所有宏的替换列表依次排列
+    SECTION_ONCE,           // uint32_t：文件表下标
+    SECTION_EDGES,          // DiskEdge
+    SECTION_STRINGS,        // 字符串表（count为字节数）
+    SECTION_COUNT
+};
+
+struct DiskHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t key;
+    SectionInfo sections[SECTION_COUNT];
+};
+
+struct DiskToken {
+    uint32_t type;
+    uint32_t file;  // 0为主文件，否则为文件表下标+1
+    StringRef value;
+    int32_t line;
+    int32_t column;
+    int32_t originLine;
+    int32_t originColumn;
+    uint64_t offset;
+};
+
+struct DiskDependency {
+    uint32_t file;
+    uint32_t reserved;
+    uint64_t hash;
+};
+
+struct DiskMacro {
+    StringRef name;
+    uint32_t functionLike;
+    uint32_t file;
+    int32_t line;
+    int32_t column;
+    uint32_t paramBegin;
+    uint32_t paramCount;
+    uint32_t bodyBegin;
+    uint32_t bodyCount;
+};
+
+struct DiskEdge {
+    StringRef from;  // 空串表示主文件
+    StringRef spelled;
+    StringRef resolved;
+    int32_t line;
+    uint32_t reserved;
+};
+
+/**
+ * 写盘时的文件表：把本次运行的fileId换成文件表下标
+ */
+class FileTable {
+private:
+    std::unordered_map<int, uint32_t> index;
+
+public:
+    std::vector<StringRef> entries;
+
+    uint32_t add(int fileId, const std::string& name, BinaryWriter& writer) {
+        if (fileId == 0) {
+            return 0;
+        }
+        auto it = index.find(fileId);
+        if (it != index.end()) {
+            return it->second;
+        }
+        entries.push_back(writer.addString(name));
+        uint32_t slot = static_cast<uint32_t>(entries.size());
+        index.emplace(fileId, slot);
+        return slot;
+    }
+};
+
+bool tokenTypeValid(uint32_t type) {
+    return type <= static_cast<uint32_t>(TokenType::ERROR);
+}
+
+} // namespace
+
+// PrecompiledHeaderCache类实现
+PrecompiledHeaderCache::PrecompiledHeaderCache(const std::string& directory, IncludeResolver* resolver)
+    : directory(directory), includeResolver(resolver), hitCount(0), missCount(0), writeCount(0) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+}
+
+size_t PrecompiledHeaderCache::findPrefixEnd(const std::vector<Token>& tokens) {
+    size_t index = 0;
+    size_t prefixEnd = 0;
+    bool hasInclude = false;
+    while (index < tokens.size()) {
+        const Token& token = tokens[index];
+        if (token.type == TokenType::NEWLINE) {
+            index++;
+            continue;
+        }
+        if (token.type != TokenType::HASH) {
+            break;
+        }
+        // 整条指令行都属于前缀
+        if (index + 1 < tokens.size() && tokens[index + 1].type == TokenType::INCLUDE) {
+            hasInclude = true;
+        }
+        while (index < tokens.size() && tokens[index].type != TokenType::NEWLINE &&
+               tokens[index].type != TokenType::EOF_TOKEN) {
+            index++;
+        }
+        if (index >= tokens.size() || tokens[index].type != TokenType::NEWLINE) {
+            break;  // 文件末尾没有换行的指令不放入前缀
+        }
+        index++;
+        prefixEnd = index;
+    }
+    return hasInclude ? prefixEnd : 0;
+}
+
+uint64_t PrecompiledHeaderCache::computeKey(const std::vector<Token>& tokens, size_t prefixEnd,
+                                            const std::string& filename, uint64_t options) const {
+    uint64_t key = HashUtils::hashString("pch");
+    for (size_t i = 0; i < prefixEnd && i < tokens.size(); i++) {
+        const Token& token = tokens[i];
+        key = HashUtils::combine(key, static_cast<uint64_t>(token.type));
+        key = HashUtils::combine(key, HashUtils::hashString(token.value));
+        key = HashUtils::combine(key, static_cast<uint64_t>(static_cast<uint32_t>(token.line)));
+        key = HashUtils::combine(key, static_cast<uint64_t>(static_cast<uint32_t>(token.column)));
+    }
+    // "..." 形式的包含按主文件所在目录查找，搜索路径影响 <...> 的结果
+    std::string mainDirectory = std::filesystem::path(filename).parent_path().lexically_normal().string();
+    key = HashUtils::combine(key, HashUtils::hashString(mainDirectory));
+    if (includeResolver) {
+        for (const auto& path : includeResolver->getSearchPaths()) {
+            key = HashUtils::combine(key, HashUtils::hashString(path));
+        }
+    }
+    return HashUtils::combine(key, options);
+}
+
+std::shared_ptr<const PchSnapshot> PrecompiledHeaderCache::load(uint64_t key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = loaded.find(key);
+        if (it != loaded.end()) {
+            hitCount++;
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<PchSnapshot> snapshot = readSnapshot(snapshotPath(key), key);
+    if (!snapshot || !dependenciesUnchanged(*snapshot)) {
+        missCount++;
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto result = loaded.emplace(key, std::move(snapshot));
+    hitCount++;
+    return result.first->second;
+}
+
+bool PrecompiledHeaderCache::store(const PchSnapshot& snapshot) {
+    if (!writeSnapshot(snapshotPath(snapshot.key), snapshot)) {
+        return false;
+    }
+    writeCount++;
+    std::lock_guard<std::mutex> lock(mutex);
+    loaded[snapshot.key] = std::make_shared<const PchSnapshot>(snapshot);
+    return true;
+}
+
+const std::string& PrecompiledHeaderCache::getDirectory() const {
+    return directory;
+}
+
+size_t PrecompiledHeaderCache::getHitCount() const {
+    return hitCount;
+}
+
+size_t PrecompiledHeaderCache::getMissCount() const {
+    return missCount;
+}
+
+size_t PrecompiledHeaderCache::getWriteCount() const {
+    return writeCount;
+}
+
+std::string PrecompiledHeaderCache::snapshotPath(uint64_t key) const {
+    return (std::filesystem::path(directory) / (HashUtils::toHex(key) + ".pch")).string();
+}
+
+std::string PrecompiledHeaderCache::fileName(int fileId) const {
+    return includeResolver ? includeResolver->getFileName(fileId) : std::string();
+}
+
+int PrecompiledHeaderCache::fileId(const std::string& path) const {
+    return includeResolver ? includeResolver->getFileId(path) : 0;
+}
+
+bool PrecompiledHeaderCache::dependenciesUnchanged(const PchSnapshot& snapshot) const {
+    for (const auto& dependency : snapshot.dependencies) {
+        uint64_t hash = 0;
+        if (!HashUtils::hashFile(dependency.first, hash) || hash != dependency.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PrecompiledHeaderCache::writeSnapshot(const std::string& path, const PchSnapshot& snapshot) const {
+    BinaryWriter writer(sizeof(DiskHeader));
+    FileTable files;
+
+    auto convertTokens = [&](const std::vector<Token>& tokens, std::vector<DiskToken>& out) {
+        for (const auto& token : tokens) {
+            DiskToken disk;
+            disk.type = static_cast<uint32_t>(token.type);
+            disk.file = files.add(token.fileId, fileName(token.fileId), writer);
+            disk.value = writer.addString(token.value);
+            disk.line = token.line;
+            disk.column = token.column;
+            disk.originLine = token.originLine;
+            disk.originColumn = token.originColumn;
+            disk.offset = token.offset;
+            out.push_back(disk);
+        }
+    };
+
+    std::vector<DiskDependency> dependencies;
+    for (const auto& dependency : snapshot.dependencies) {
+        DiskDependency disk;
+        disk.file = files.add(fileId(dependency.first), dependency.first, writer);
+        disk.reserved = 0;
+        disk.hash = dependency.second;
+        dependencies.push_back(disk);
+    }
+
+    std::vector<DiskToken> tokens;
+    convertTokens(snapshot.tokens, tokens);
+
+    std::vector<DiskMacro> macros;
+    std::vector<StringRef> macroParams;
+    std::vector<DiskToken> macroTokens;
+    for (const auto& macro : snapshot.macros) {
+        DiskMacro disk;
+        disk.name = writer.addString(macro.name);
+        disk.functionLike = macro.functionLike ? 1 : 0;
+        disk.file = files.add(macro.fileId, fileName(macro.fileId), writer);
+        disk.line = macro.line;
+        disk.column = macro.column;
+        disk.paramBegin = static_cast<uint32_t>(macroParams.size());
+        disk.paramCount = static_cast<uint32_t>(macro.parameters.size());
+        for (const auto& parameter : macro.parameters) {
+            macroParams.push_back(writer.addString(parameter));
+        }
+        disk.bodyBegin = static_cast<uint32_t>(macroTokens.size());
+        disk.bodyCount = static_cast<uint32_t>(macro.body.size());
+        convertTokens(macro.body, macroTokens);
+        macros.push_back(disk);
+    }
+
+    std::vector<uint32_t> once;
+    for (const auto& path : snapshot.onceIncluded) {
+        once.push_back(files.add(fileId(path), path, writer));
+    }
+
+    std::vector<DiskEdge> edges;
+    for (const auto& edge : snapshot.edges) {
+        DiskEdge disk;
+        disk.from = writer.addString(edge.first);
+        disk.spelled = writer.addString(edge.second.spelled);
+        disk.resolved = writer.addString(edge.second.resolved);
+        disk.line = edge.second.line;
+        disk.reserved = 0;
+        edges.push_back(disk);
+    }
+
+    DiskHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, PCH_MAGIC, sizeof(PCH_MAGIC));
+    header.version = PCH_VERSION;
+    header.key = snapshot.key;
+    header.sections[SECTION_FILES] = writer.addSection(files.entries);
+    header.sections[SECTION_DEPENDENCIES] = writer.addSection(dependencies);
+    header.sections[SECTION_TOKENS] = writer.addSection(tokens);
+    header.sections[SECTION_MACROS] = writer.addSection(macros);
+    header.sections[SECTION_MACRO_PARAMS] = writer.addSection(macroParams);
+    header.sections[SECTION_MACRO_TOKENS] = writer.addSection(macroTokens);
+    header.sections[SECTION_ONCE] = writer.addSection(once);
+    header.sections[SECTION_EDGES] = writer.addSection(edges);
+    header.sections[SECTION_STRINGS] = writer.addStringTable();
+    writer.setHeader(&header, sizeof(header));
+    return writer.writeAtomically(path);
+}
+
+std::shared_ptr<PchSnapshot> PrecompiledHeaderCache::readSnapshot(const std::string& path, uint64_t key) {
+    MappedFile file;
+    if (!file.open(path) || file.getSize() < sizeof(DiskHeader)) {
+        return nullptr;
+    }
+
+    DiskHeader header;
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (std::memcmp(header.magic, PCH_MAGIC, sizeof(PCH_MAGIC)) != 0 ||
+        header.version != PCH_VERSION || header.key != key) {
+        return nullptr;
+    }
+
+    BinaryReader reader(file.getData(), file.getSize());
+    const SectionInfo* sections = header.sections;
+    if (!reader.checkSection<StringRef>(sections[SECTION_FILES]) ||
+        !reader.checkSection<DiskDependency>(sections[SECTION_DEPENDENCIES]) ||
+        !reader.checkSection<DiskToken>(sections[SECTION_TOKENS]) ||
+        !reader.checkSection<DiskMacro>(sections[SECTION_MACROS]) ||
+        !reader.checkSection<StringRef>(sections[SECTION_MACRO_PARAMS]) ||
+        !reader.checkSection<DiskToken>(sections[SECTION_MACRO_TOKENS]) ||
+        !reader.checkSection<uint32_t>(sections[SECTION_ONCE]) ||
+        !reader.checkSection<DiskEdge>(sections[SECTION_EDGES]) ||
+        !reader.checkSection<char>(sections[SECTION_STRINGS])) {
+        return nullptr;
+    }
+    reader.setStringTable(sections[SECTION_STRINGS]);
+
+    // 文件表：快照中的文件下标 -> 本次运行的fileId
+    const StringRef* fileRefs = reader.section<StringRef>(sections[SECTION_FILES]);
+    std::vector<std::string> filePaths;
+    std::vector<int> fileIds(1, 0);
+    for (uint64_t i = 0; i < sections[SECTION_FILES].count; i++) {
+        if (!reader.checkString(fileRefs[i])) {
+            return nullptr;
+        }
+        filePaths.push_back(reader.getString(fileRefs[i]));
+        fileIds.push_back(fileId(filePaths.back()));
+    }
+
+    bool valid = true;
+    auto readString = [&](const StringRef& ref) {
+        if (!reader.checkString(ref)) {
+            valid = false;
+            return std::string();
+        }
+        return reader.getString(ref);
+    };
+    auto mapFile = [&](uint32_t file) {
+        if (file >= fileIds.size()) {
+            valid = false;
+            return 0;
+        }
+        return fileIds[file];
+    };
+    auto convertTokens = [&](const DiskToken* disk, uint64_t count, std::vector<Token>& out) {
+        out.reserve(out.size() + count);
+        for (uint64_t i = 0; i < count && valid; i++) {
+            if (!tokenTypeValid(disk[i].type)) {
+                valid = false;
+                break;
+            }
+            Token token(static_cast<TokenType>(disk[i].type), readString(disk[i].value), disk[i].line, disk[i].column);
+            token.fileId = mapFile(disk[i].file);
+            token.originLine = disk[i].originLine;
+            token.originColumn = disk[i].originColumn;
+            token.offset = static_cast<size_t>(disk[i].offset);
+            out.push_back(std::move(token));
+        }
+    };
+    auto inRange = [](uint32_t begin, uint32_t count, uint64_t total) {
+        return static_cast<uint64_t>(begin) + count <= total;
+    };
+
+    auto snapshot = std::make_shared<PchSnapshot>();
+    snapshot->key = key;
+
+    const DiskDependency* dependencies = reader.section<DiskDependency>(sections[SECTION_DEPENDENCIES]);
+    for (uint64_t i = 0; i < sections[SECTION_DEPENDENCIES].count; i++) {
+        if (dependencies[i].file == 0 || dependencies[i].file > filePaths.size()) {
+            return nullptr;
+        }
+        snapshot->dependencies.emplace_back(filePaths[dependencies[i].file - 1], dependencies[i].hash);
+    }
+
+    convertTokens(reader.section<DiskToken>(sections[SECTION_TOKENS]), sections[SECTION_TOKENS].count,
+                  snapshot->tokens);
+
+    const DiskMacro* macros = reader.section<DiskMacro>(sections[SECTION_MACROS]);
+    const StringRef* macroParams = reader.section<StringRef>(sections[SECTION_MACRO_PARAMS]);
+    const DiskToken* macroTokens = reader.section<DiskToken>(sections[SECTION_MACRO_TOKENS]);
+    for (uint64_t i = 0; i < sections[SECTION_MACROS].count && valid; i++) {
+        const DiskMacro& disk = macros[i];
+        if (!inRange(disk.paramBegin, disk.paramCount, sections[SECTION_MACRO_PARAMS].count) ||
+            !inRange(disk.bodyBegin, disk.bodyCount, sections[SECTION_MACRO_TOKENS].count)) {
+            return nullptr;
+        }
+        PchMacro macro;
+        macro.name = readString(disk.name);
+        macro.functionLike = disk.functionLike != 0;
+        macro.fileId = mapFile(disk.file);
+        macro.line = disk.line;
+        macro.column = disk.column;
+        for (uint32_t p = 0; p < disk.paramCount; p++) {
+            macro.parameters.push_back(readString(macroParams[disk.paramBegin + p]));
+        }
+        convertTokens(macroTokens + disk.bodyBegin, disk.bodyCount, macro.body);
+        snapshot->macros.push_back(std::move(macro));
+    }
+
+    const uint32_t* once = reader.section<uint32_t>(sections[SECTION_ONCE]);
+    for (uint64_t i = 0; i < sections[SECTION_ONCE].count; i++) {
+        if (once[i] == 0 || once[i] > filePaths.size()) {
+            return nullptr;
+        }
+        snapshot->onceIncluded.push_back(filePaths[once[i] - 1]);
+    }
+
+    const DiskEdge* edges = reader.section<DiskEdge>(sections[SECTION_EDGES]);
+    for (uint64_t i = 0; i < sections[SECTION_EDGES].count && valid; i++) {
+        IncludeEdge edge{readString(edges[i].spelled), readString(edges[i].resolved), edges[i].line};
+        snapshot->edges.emplace_back(readString(edges[i].from), edge);
+    }
+
+    return valid ? snapshot : nullptr;
+}
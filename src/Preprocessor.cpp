@@ -0,0 +1,259 @@
+#include "../include/Preprocessor.h"
+#include "../include/HashUtils.h"
+#include <algorithm>
+
+namespace {
+
+// token的源码写法；字符串的值已去掉引号与转义，按双引号重新转义
+std::string spelling(const Token& token) {
+    if (token.type != TokenType::STRING) {
+        return token.value;
+    }
+    std::string text = "\"";
+    for (char c : token.value) {
+        switch (c) {
+            case '\n': text += "\\n"; break;
+            case '\t': text += "\\t"; break;
+            case '\r': text += "\\r"; break;
+            case '\\': text += "\\\\"; break;
+            case '"': text += "\\\""; break;
+            default: text += c; break;
+        }
+    }
+    return text + "\"";
+}
+
+} // namespace
+
+// Preprocessor类实现
+Preprocessor::Preprocessor(StringInterner& interner)
+    : interner(interner), macroExpander(interner) {}
+
+void Preprocessor::setIncludeResolver(IncludeResolver* resolver) {
+    includeResolver = resolver;
+}
+
+void Preprocessor::setPrecompiledHeaderCache(PrecompiledHeaderCache* cache) {
+    pchCache = cache;
+}
+
+void Preprocessor::setExpandMacros(bool enabled) {
+    expandMacros = enabled;
+}
+
+bool Preprocessor::run(const std::vector<Token>& tokens, const std::string& filename, std::vector<Token>& output) {
+    errors.clear();
+    includeFailed = false;
+    includeState = IncludeState();
+    precompiledHeader.reset();
+    precompiledHeaderLoaded = false;
+
+    // 预编译头只对含 #include 的前缀有意义
+    if (pchCache && includeResolver) {
+        size_t prefixEnd = PrecompiledHeaderCache::findPrefixEnd(tokens);
+        if (prefixEnd > 0) {
+            return runWithPrecompiledHeader(tokens, prefixEnd, filename, output);
+        }
+    }
+
+    bool modified = false;
+    std::vector<Token> included;
+    if (includeResolver) {
+        included = includeResolver->expand(tokens, filename, errors, &includeState);
+        modified = true;
+        if (!errors.empty()) {
+            includeFailed = true;
+            output = std::move(included);
+            return true;
+        }
+    }
+
+    // 展开宏（没有任何 #define 时跳过，避免复制token流）
+    const std::vector<Token>& source = modified ? included : tokens;
+    bool hasDefine = std::any_of(source.begin(), source.end(), [](const Token& token) {
+        return token.type == TokenType::DEFINE;
+    });
+    if (expandMacros && hasDefine) {
+        output = macroExpander.expand(source);
+        errors.insert(errors.end(), macroExpander.getErrors().begin(), macroExpander.getErrors().end());
+        return true;
+    }
+    if (modified) {
+        output = std::move(included);
+    }
+    return modified;
+}
+
+bool Preprocessor::runWithPrecompiledHeader(const std::vector<Token>& tokens, size_t prefixEnd,
+                                            const std::string& filename, std::vector<Token>& output) {
+    uint64_t key = pchCache->computeKey(tokens, prefixEnd, filename, expandMacros ? 1 : 0);
+    IncludeState& state = includeState;
+    std::vector<Token> prefix;
+
+    precompiledHeader = pchCache->load(key);
+    if (precompiledHeader) {
+        // 前缀直接取自快照，被包含的头文件不再读取、词法分析或展开
+        restoreSnapshot(*precompiledHeader, filename, state);
+        prefix = precompiledHeader->tokens;
+        precompiledHeaderLoaded = true;
+    } else {
+        std::vector<Token> prefixTokens(tokens.begin(), tokens.begin() + prefixEnd);
+        prefix = processRange(prefixTokens, filename, &state);
+        if (!errors.empty()) {
+            output = std::move(prefix);
+            return true;
+        }
+        std::shared_ptr<PchSnapshot> snapshot = createSnapshot(key, prefix, filename, state);
+        pchCache->store(*snapshot);
+        precompiledHeader = std::move(snapshot);
+    }
+
+    std::vector<Token> suffixTokens(tokens.begin() + prefixEnd, tokens.end());
+    std::vector<Token> suffix = processRange(suffixTokens, filename, &state);
+    output = std::move(prefix);
+    output.insert(output.end(), suffix.begin(), suffix.end());
+    return true;
+}
+
+std::vector<Token> Preprocessor::processRange(const std::vector<Token>& tokens, const std::string& filename,
+                                              IncludeState* state) {
+    std::vector<Token> included = includeResolver->expand(tokens, filename, errors, state);
+    includeFailed = !errors.empty();
+    if (includeFailed || !expandMacros) {
+        return included;
+    }
+    size_t previousErrors = macroExpander.getErrors().size();
+    std::vector<Token> expanded = macroExpander.expand(included);
+    errors.insert(errors.end(), macroExpander.getErrors().begin() + previousErrors, macroExpander.getErrors().end());
+    return expanded;
+}
+
+std::shared_ptr<PchSnapshot> Preprocessor::createSnapshot(uint64_t key, const std::vector<Token>& prefix,
+                                                          const std::string& filename,
+                                                          const IncludeState& state) const {
+    auto snapshot = std::make_shared<PchSnapshot>();
+    snapshot->key = key;
+    snapshot->tokens = prefix;
+
+    for (const auto& path : state.includedFiles) {
+        uint64_t hash = 0;
+        if (HashUtils::hashFile(path, hash)) {
+            snapshot->dependencies.emplace_back(path, hash);
+        }
+    }
+
+    for (const auto& entry : macroExpander.getMacros()) {
+        const MacroDefinition& definition = entry.second;
+        PchMacro macro;
+        macro.name = interner.str(definition.name);
+        macro.functionLike = definition.functionLike;
+        for (uint32_t parameter : definition.parameters) {
+            macro.parameters.push_back(interner.str(parameter));
+        }
+        macro.body = definition.body;
+        macro.line = definition.line;
+        macro.column = definition.column;
+        macro.fileId = definition.fileId;
+        snapshot->macros.push_back(std::move(macro));
+    }
+    // 按名字排序，同一前缀生成的快照内容稳定
+    std::sort(snapshot->macros.begin(), snapshot->macros.end(), [](const PchMacro& a, const PchMacro& b) {
+        return a.name < b.name;
+    });
+
+    snapshot->onceIncluded.assign(state.onceIncluded.begin(), state.onceIncluded.end());
+    std::sort(snapshot->onceIncluded.begin(), snapshot->onceIncluded.end());
+    for (const auto& edge : state.edges) {
+        // 主文件记为空串，同目录下的其他源文件也能使用这份快照
+        snapshot->edges.emplace_back(edge.first == filename ? std::string() : edge.first, edge.second);
+    }
+    return snapshot;
+}
+
+void Preprocessor::restoreSnapshot(const PchSnapshot& snapshot, const std::string& filename, IncludeState& state) {
+    for (const auto& macro : snapshot.macros) {
+        MacroDefinition definition;
+        definition.name = interner.intern(macro.name);
+        definition.functionLike = macro.functionLike;
+        for (const auto& parameter : macro.parameters) {
+            definition.parameters.push_back(interner.intern(parameter));
+        }
+        definition.body = macro.body;
+        definition.line = macro.line;
+        definition.column = macro.column;
+        definition.fileId = macro.fileId;
+        macroExpander.define(definition);
+    }
+
+    state.onceIncluded.insert(snapshot.onceIncluded.begin(), snapshot.onceIncluded.end());
+    for (const auto& dependency : snapshot.dependencies) {
+        state.includedFiles.push_back(dependency.first);
+    }
+    for (const auto& edge : snapshot.edges) {
+        std::string from = edge.first.empty() ? filename : edge.first;
+        includeResolver->addEdge(from, edge.second);
+        state.edges.emplace_back(from, edge.second);
+    }
+}
+
+const MacroExpander& Preprocessor::getMacroExpander() const {
+    return macroExpander;
+}
+
+const std::vector<std::string>& Preprocessor::getIncludedFiles() const {
+    return includeState.includedFiles;
+}
+
+const std::vector<LexicalError>& Preprocessor::getErrors() const {
+    return errors;
+}
+
+bool Preprocessor::hasErrors() const {
+    return !errors.empty();
+}
+
+bool Preprocessor::hasIncludeErrors() const {
+    return includeFailed;
+}
+
+std::shared_ptr<const PchSnapshot> Preprocessor::getPrecompiledHeader() const {
+    return precompiledHeader;
+}
+
+bool Preprocessor::loadedPrecompiledHeader() const {
+    return precompiledHeaderLoaded;
+}
+
+void Preprocessor::print(const std::vector<Token>& tokens, std::ostream& os) {
+    std::string line;
+    const Token* previous = nullptr;  // 本行上一个输出的token
+    size_t previousEnd = 0;           // 它在源码行中结束的列
+    for (const auto& token : tokens) {
+        if (token.type == TokenType::EOF_TOKEN) {
+            break;
+        }
+        if (token.type == TokenType::NEWLINE) {
+            os << line << '\n';
+            line.clear();
+            previous = nullptr;
+            continue;
+        }
+        std::string text = spelling(token);
+        bool fromSource = token.originLine == 0;
+        if (!previous) {
+            // 行首保留缩进（宏展开得到的token位于使用处的列）
+            line.append(token.column > 1 ? token.column - 1 : 0, ' ');
+        } else if (fromSource && previous->originLine == 0 && previous->fileId == token.fileId &&
+                   previous->line == token.line && static_cast<size_t>(token.column) >= previousEnd) {
+            line.append(token.column - previousEnd, ' ');
+        } else {
+            line += ' ';
+        }
+        line += text;
+        previous = &token;
+        previousEnd = static_cast<size_t>(token.column) + text.size();
+    }
+    if (!line.empty()) {
+        os << line << '\n';
+    }
+}
@@ -0,0 +1,385 @@
+#include "../include/ProjectAnalyzer.h"
+#include "../include/ProjectCache.h"
+#include "../include/ThreadPool.h"
+#include "../include/Preprocessor.h"
+#include "../include/StringInterner.h"
+#include "../include/Lexer.h"
+#include "../include/Parser.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <set>
+
+namespace {
+
+// 符号出现的稳定顺序：翻译单元、文件、行、列
+bool occurrenceLess(const SymbolOccurrence& a, const SymbolOccurrence& b) {
+    if (a.unit != b.unit) return a.unit < b.unit;
+    if (a.file != b.file) return a.file < b.file;
+    if (a.line != b.line) return a.line < b.line;
+    return a.column < b.column;
+}
+
+bool isSourceFile(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    return extension == ".txt" || extension == ".c" || extension == ".cc" || extension == ".cpp";
+}
+
+} // namespace
+
+// ProjectAnalyzer类实现
+ProjectAnalyzer::ProjectAnalyzer(size_t threadCount)
+    : threadCount(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount) {}
+
+void ProjectAnalyzer::setIncludeResolver(IncludeResolver* resolver) {
+    includeResolver = resolver;
+}
+
+void ProjectAnalyzer::setPrecompiledHeaderCache(PrecompiledHeaderCache* cache) {
+    pchCache = cache;
+}
+
+void ProjectAnalyzer::setExpandMacros(bool enabled) {
+    expandMacros = enabled;
+}
+
+void ProjectAnalyzer::setCache(ProjectCache* projectCache) {
+    cache = projectCache;
+}
+
+std::vector<std::string> ProjectAnalyzer::collectSourceFiles(const std::vector<std::string>& inputs) {
+    std::set<std::string> files;
+    for (const auto& input : inputs) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(input, ec)) {
+            for (auto it = std::filesystem::recursive_directory_iterator(input, ec);
+                 it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) {
+                    break;
+                }
+                if (it->is_regular_file(ec) && isSourceFile(it->path())) {
+                    files.insert(it->path().lexically_normal().string());
+                }
+            }
+        } else {
+            files.insert(std::filesystem::path(input).lexically_normal().string());
+        }
+    }
+    return std::vector<std::string>(files.begin(), files.end());
+}
+
+void ProjectAnalyzer::analyze(const std::vector<std::string>& files) {
+    units.clear();
+    units.resize(files.size());
+    symbolTable.clear();
+    linkDiagnostics.clear();
+
+    // 前端并行：每个翻译单元独立地词法分析、预处理、语法分析，
+    // 符号直接合并进分段加锁的符号表。自身与被包含文件都未变化的单元直接取缓存结果。
+    // 链接检查依赖全部单元的符号，每次都重新进行。
+    std::atomic<size_t> reused(0);
+    ThreadPool pool(std::min(threadCount, std::max<size_t>(1, files.size())));
+    pool.parallelFor(files.size(), [&](size_t i) {
+        if (cache && cache->lookup(files[i], i, units[i])) {
+            reused++;
+        } else {
+            units[i] = analyzeUnit(files[i], i);
+        }
+        mergeSymbols(units[i]);
+    });
+    reusedCount = reused;
+
+    checkLinkage();
+}
+
+std::vector<const FunctionDefinitionNode*> ParsedUnit::definedFunctions() const {
+    std::vector<const FunctionDefinitionNode*> functions;
+    if (!program) {
+        return functions;
+    }
+    for (const auto& statement : program->statements) {
+        if (statement && statement->fileId == 0 && statement->getKind() == ASTNodeKind::FunctionDefinition) {
+            functions.push_back(static_cast<const FunctionDefinitionNode*>(statement.get()));
+        }
+    }
+    return functions;
+}
+
+bool ProjectAnalyzer::parseUnit(const std::string& path, ParsedUnit& unit) const {
+    unit.path = path;
+    const IncludeResolver* resolver = includeResolver;
+    unit.fileName = [path, resolver](int fileId) {
+        if (fileId == 0 || !resolver) {
+            return path;
+        }
+        return resolver->getFileName(fileId);
+    };
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        unit.diagnostics.push_back(path + ": Cannot open file");
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    unit.source = buffer.str();
+    unit.loaded = true;
+
+    Lexer lexer(unit.source);
+    std::vector<Token> tokens = lexer.tokenize();
+    for (const auto& error : lexer.getErrors()) {
+        unit.diagnostics.push_back(path + ": " + error.getFullMessage());
+    }
+
+    StringInterner interner;
+    Preprocessor preprocessor(interner);
+    preprocessor.setIncludeResolver(includeResolver);
+    preprocessor.setPrecompiledHeaderCache(pchCache);
+    preprocessor.setExpandMacros(expandMacros);
+    std::vector<Token> preprocessed;
+    bool usePreprocessed = preprocessor.run(tokens, path, preprocessed);
+    for (const auto& error : preprocessor.getErrors()) {
+        unit.diagnostics.push_back(unit.fileName(error.fileId) + ": " + error.getFullMessage());
+    }
+    unit.tokens = usePreprocessed ? std::move(preprocessed) : std::move(tokens);
+    unit.includedFiles = preprocessor.getIncludedFiles();
+    unit.includesResolved = !preprocessor.hasIncludeErrors();
+
+    Parser parser(unit.tokens);
+    unit.program = parser.parse();
+    for (const auto& error : parser.getErrors()) {
+        unit.diagnostics.push_back(unit.fileName(error.fileId) + ": " + error.getFullMessage());
+    }
+    return true;
+}
+
+size_t ProjectAnalyzer::parseUnits(const std::vector<std::string>& files, size_t threads,
+                                   const std::function<void(size_t, const ParsedUnit&)>& fn,
+                                   std::vector<std::string>& diagnostics) const {
+    std::vector<std::vector<std::string>> perFile(files.size());
+    ThreadPool pool(std::min(threads == 0 ? ThreadPool::defaultThreadCount() : threads,
+                             std::max<size_t>(1, files.size())));
+    pool.parallelFor(files.size(), [&](size_t i) {
+        ParsedUnit unit;
+        bool loaded = parseUnit(files[i], unit);
+        perFile[i] = std::move(unit.diagnostics);
+        if (loaded && unit.program && perFile[i].empty()) {
+            fn(i, unit);  // 语法树不完整时分析结果不可靠
+        }
+    });
+    size_t failed = 0;
+    for (auto& fileDiagnostics : perFile) {
+        failed += fileDiagnostics.empty() ? 0 : 1;
+        diagnostics.insert(diagnostics.end(), fileDiagnostics.begin(), fileDiagnostics.end());
+    }
+    return failed;
+}
+
+TranslationUnitResult ProjectAnalyzer::analyzeUnit(const std::string& path, size_t unitIndex) const {
+    ParsedUnit parsed;
+    TranslationUnitResult result;
+    result.loaded = parseUnit(path, parsed);
+    result.path = path;
+    result.diagnostics = std::move(parsed.diagnostics);
+    if (!result.loaded) {
+        return result;
+    }
+    result.tokenCount = parsed.tokens.size();
+    result.includedFiles = std::move(parsed.includedFiles);
+    result.includesResolved = parsed.includesResolved;
+
+    if (parsed.program) {
+        result.symbols = SymbolCollector::collect(*parsed.program, parsed.tokens, parsed.fileName);
+        for (auto& symbol : result.symbols) {
+            symbol.unit = unitIndex;
+        }
+    }
+    return result;
+}
+
+void ProjectAnalyzer::mergeSymbols(const TranslationUnitResult& unit) {
+    for (const auto& symbol : unit.symbols) {
+        symbolTable.update(symbol.name, [&symbol](ProjectSymbol& entry) {
+            switch (symbol.kind) {
+                case SymbolKind::FunctionDeclaration: entry.declarations.push_back(symbol); break;
+                case SymbolKind::FunctionDefinition: entry.definitions.push_back(symbol); break;
+                case SymbolKind::Variable: entry.variables.push_back(symbol); break;
+                case SymbolKind::FunctionCall: entry.calls.push_back(symbol); break;
+                case SymbolKind::VariableReference: break;
+            }
+        });
+    }
+}
+
+void ProjectAnalyzer::checkLinkage() {
+    // 取出合并结果并按名字排序，保证报告与线程调度无关
+    std::vector<std::pair<std::string, ProjectSymbol>> symbols;
+    symbolTable.forEach([&symbols](const std::string& name, ProjectSymbol& entry) {
+        symbols.emplace_back(name, entry);
+    });
+    std::sort(symbols.begin(), symbols.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    for (auto& item : symbols) {
+        const std::string& name = item.first;
+        ProjectSymbol& entry = item.second;
+        std::sort(entry.declarations.begin(), entry.declarations.end(), occurrenceLess);
+        // 同一头文件中的声明被多个翻译单元包含时只保留一份
+        std::vector<SymbolOccurrence> uniqueDeclarations;
+        std::set<std::string> seenDeclarations;
+        for (const auto& declaration : entry.declarations) {
+            if (seenDeclarations.insert(location(declaration) + SymbolCollector::signature(declaration)).second) {
+                uniqueDeclarations.push_back(declaration);
+            }
+        }
+        entry.declarations = std::move(uniqueDeclarations);
+        std::sort(entry.definitions.begin(), entry.definitions.end(), occurrenceLess);
+        std::sort(entry.variables.begin(), entry.variables.end(), occurrenceLess);
+        std::sort(entry.calls.begin(), entry.calls.end(), occurrenceLess);
+
+        // 同名的函数与全局变量
+        if (!entry.variables.empty() && (!entry.definitions.empty() || !entry.declarations.empty())) {
+            LinkDiagnostic diagnostic{name, "'" + name + "' is declared both as a function and as a variable", {}};
+            diagnostic.sites.push_back(entry.variables.front());
+            diagnostic.sites.push_back(!entry.definitions.empty() ? entry.definitions.front()
+                                                                  : entry.declarations.front());
+            linkDiagnostics.push_back(std::move(diagnostic));
+        }
+
+        // 重复定义
+        if (entry.definitions.size() > 1) {
+            linkDiagnostics.push_back({name, "multiple definitions of function '" + name + "'", entry.definitions});
+        }
+        if (entry.variables.size() > 1) {
+            linkDiagnostics.push_back({name, "multiple definitions of variable '" + name + "'", entry.variables});
+        }
+
+        // 声明与定义（或其他声明）签名不一致
+        const SymbolOccurrence* reference = !entry.definitions.empty() ? &entry.definitions.front()
+                                          : !entry.declarations.empty() ? &entry.declarations.front() : nullptr;
+        if (reference) {
+            std::string expected = SymbolCollector::signature(*reference);
+            for (const auto& declaration : entry.declarations) {
+                if (&declaration == reference || SymbolCollector::signature(declaration) == expected) {
+                    continue;
+                }
+                linkDiagnostics.push_back({name, "conflicting signatures for '" + name + "': " +
+                                                 SymbolCollector::signature(declaration) + " vs " + expected,
+                                           {declaration, *reference}});
+            }
+            for (const auto& definition : entry.definitions) {
+                if (&definition == reference || SymbolCollector::signature(definition) == expected) {
+                    continue;
+                }
+                linkDiagnostics.push_back({name, "conflicting signatures for '" + name + "': " +
+                                                 SymbolCollector::signature(definition) + " vs " + expected,
+                                           {definition, *reference}});
+            }
+        }
+
+        if (entry.calls.empty()) {
+            continue;
+        }
+
+        // 调用了但没有任何翻译单元定义
+        if (entry.definitions.empty() && entry.variables.empty()) {
+            linkDiagnostics.push_back({name, "undefined reference to '" + name + "'", entry.calls});
+            continue;
+        }
+
+        // 实参个数与定义不符
+        if (!entry.definitions.empty()) {
+            size_t expectedCount = entry.definitions.front().parameterTypes.size();
+            for (const auto& call : entry.calls) {
+                if (call.argumentCount != expectedCount) {
+                    linkDiagnostics.push_back({name, "call to '" + name + "' passes " +
+                                                     std::to_string(call.argumentCount) + " argument(s), but it takes " +
+                                                     std::to_string(expectedCount),
+                                               {call, entry.definitions.front()}});
+                }
+            }
+        }
+    }
+}
+
+const std::vector<TranslationUnitResult>& ProjectAnalyzer::getUnits() const {
+    return units;
+}
+
+const std::vector<LinkDiagnostic>& ProjectAnalyzer::getLinkDiagnostics() const {
+    return linkDiagnostics;
+}
+
+bool ProjectAnalyzer::hasErrors() const {
+    if (!linkDiagnostics.empty()) {
+        return true;
+    }
+    return std::any_of(units.begin(), units.end(), [](const TranslationUnitResult& unit) {
+        return !unit.diagnostics.empty();
+    });
+}
+
+size_t ProjectAnalyzer::getReusedCount() const {
+    return reusedCount;
+}
+
+std::string ProjectAnalyzer::location(const SymbolOccurrence& symbol) {
+    return symbol.file + ":" + std::to_string(symbol.line) + ":" + std::to_string(symbol.column);
+}
+
+void ProjectAnalyzer::printReport(std::ostream& os) const {
+    os << "\n=== Project Analysis ===" << std::endl;
+    os << "Translation units: " << units.size() << " (threads: " << threadCount << ")" << std::endl;
+    if (cache) {
+        os << "Cache: " << reusedCount << " unit(s) reused, " << units.size() - reusedCount
+           << " analysed" << std::endl;
+    }
+
+    size_t functions = 0;
+    size_t variables = 0;
+    size_t calls = 0;
+    for (const auto& unit : units) {
+        os << (unit.diagnostics.empty() ? "  [ok]     " : "  [errors] ") << unit.path;
+        if (unit.loaded) {
+            os << " (" << unit.tokenCount << " tokens)";
+        }
+        os << std::endl;
+        for (const auto& diagnostic : unit.diagnostics) {
+            os << "      " << diagnostic << std::endl;
+        }
+        for (const auto& symbol : unit.symbols) {
+            switch (symbol.kind) {
+                case SymbolKind::FunctionDeclaration:
+                case SymbolKind::FunctionDefinition: functions++; break;
+                case SymbolKind::Variable: variables++; break;
+                case SymbolKind::FunctionCall: calls++; break;
+                case SymbolKind::VariableReference: break;
+            }
+        }
+    }
+    os << "Symbols: " << functions << " function declaration(s)/definition(s), " << variables
+       << " global variable(s), " << calls << " call(s)" << std::endl;
+
+    os << "\n=== Link Check ===" << std::endl;
+    if (linkDiagnostics.empty()) {
+        os << "✓ No link errors found." << std::endl;
+        return;
+    }
+    for (const auto& diagnostic : linkDiagnostics) {
+        os << "error: " << diagnostic.message << std::endl;
+        for (const auto& site : diagnostic.sites) {
+            os << "  " << SymbolCollector::kindName(site.kind) << " at " << location(site);
+            if (site.unit < units.size() && site.file != units[site.unit].path) {
+                os << " (included from " << units[site.unit].path << ")";
+            }
+            if (site.kind != SymbolKind::FunctionCall) {
+                os << "  " << SymbolCollector::signature(site);
+            }
+            os << std::endl;
+        }
+    }
+    os << "Link check: " << linkDiagnostics.size() << " problem(s) found." << std::endl;
+}
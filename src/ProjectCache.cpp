@@ -0,0 +1,328 @@
+#include "../include/ProjectCache.h"
+#include "../include/BinaryFormat.h"
+#include "../include/MappedFile.h"
+#include "../include/HashUtils.h"
+#include <filesystem>
+#include <cstring>
+#include <sys/stat.h>
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'C', 'A', 'P', 'R', 'J', '0', '1', '\0'};
+const uint32_t CACHE_VERSION = 2;
+
+enum CacheSection {
+    SECTION_FILES,        // DiskFile：单元及其依赖文件的状态
+    SECTION_UNITS,        // DiskUnit
+    SECTION_DEPENDENCIES, // uint32_t：文件表下标
+    SECTION_DIAGNOSTICS,  // StringRef
+    SECTION_SYMBOLS,      // DiskSymbol
+    SECTION_PARAMETERS,   // StringRef：形参类型
+    SECTION_STRINGS,
+    SECTION_COUNT
+};
+
+struct DiskHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t options;
+    SectionInfo sections[SECTION_COUNT];
+};
+
+struct DiskFile {
+    StringRef path;
+    uint64_t size;
+    int64_t mtime;
+    uint64_t hash;
+};
+
+struct DiskUnit {
+    StringRef path;
+    uint32_t loaded;
+    uint32_t dependencyBegin;
+    uint32_t dependencyCount;
+    uint32_t diagnosticBegin;
+    uint32_t diagnosticCount;
+    uint32_t symbolBegin;
+    uint32_t symbolCount;
+    uint32_t reserved;
+    uint64_t tokenCount;
+};
+
+struct DiskSymbol {
+    StringRef name;
+    StringRef type;
+    StringRef file;
+    uint32_t kind;
+    uint32_t parameterBegin;
+    uint32_t parameterCount;
+    uint32_t argumentCount;
+    int32_t line;
+    int32_t column;
+    uint64_t offset;
+};
+
+bool inRange(uint32_t begin, uint32_t count, uint64_t total) {
+    return static_cast<uint64_t>(begin) + count <= total;
+}
+
+} // namespace
+
+// ProjectCache类实现
+ProjectCache::ProjectCache(const std::string& path, uint64_t options) : path(path), options(options) {}
+
+uint64_t ProjectCache::computeOptions(const std::vector<std::string>& includePaths, bool expandMacros) {
+    uint64_t hash = HashUtils::hashString("project");
+    std::error_code ec;
+    hash = HashUtils::combine(hash, HashUtils::hashString(std::filesystem::current_path(ec).string()));
+    for (const auto& includePath : includePaths) {
+        hash = HashUtils::combine(hash, HashUtils::hashString(includePath));
+    }
+    return HashUtils::combine(hash, expandMacros ? 1 : 0);
+}
+
+bool ProjectCache::currentState(const std::string& file, FileState& state) {
+    if (currentFiles.find(file, state)) {
+        return true;
+    }
+    struct stat info;
+    if (stat(file.c_str(), &info) != 0) {
+        return false;
+    }
+    state.size = static_cast<uint64_t>(info.st_size);
+    state.mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+
+    // 大小与修改时间都与上次相同时沿用上次的哈希
+    auto it = previousFiles.find(file);
+    if (it != previousFiles.end() && it->second.size == state.size && it->second.mtime == state.mtime) {
+        state.hash = it->second.hash;
+    } else if (!HashUtils::hashFile(file, state.hash)) {
+        return false;
+    }
+    currentFiles.insert(file, state);
+    return true;
+}
+
+bool ProjectCache::fileChanged(const std::string& file) {
+    bool changed = false;
+    if (changedFiles.find(file, changed)) {
+        return changed;
+    }
+    FileState state;
+    auto it = previousFiles.find(file);
+    changed = it == previousFiles.end() || !currentState(file, state) || state.hash != it->second.hash;
+    changedFiles.insert(file, changed);
+    return changed;
+}
+
+bool ProjectCache::lookup(const std::string& unitPath, size_t unitIndex, TranslationUnitResult& result) {
+    auto it = previousUnits.find(unitPath);
+    if (it == previousUnits.end() || fileChanged(unitPath)) {
+        return false;
+    }
+    for (const auto& dependency : it->second.includedFiles) {
+        if (fileChanged(dependency)) {
+            return false;
+        }
+    }
+    result = it->second;
+    for (auto& symbol : result.symbols) {
+        symbol.unit = unitIndex;
+    }
+    return true;
+}
+
+bool ProjectCache::load() {
+    previousFiles.clear();
+    previousUnits.clear();
+
+    MappedFile file;
+    if (!file.open(path) || file.getSize() < sizeof(DiskHeader)) {
+        return false;
+    }
+    DiskHeader header;
+    std::memcpy(&header, file.getData(), sizeof(header));
+    BinaryReader reader(file.getData(), file.getSize());
+    const SectionInfo* sections = header.sections;
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION ||
+        header.options != options ||
+        !reader.checkSection<DiskFile>(sections[SECTION_FILES]) ||
+        !reader.checkSection<DiskUnit>(sections[SECTION_UNITS]) ||
+        !reader.checkSection<uint32_t>(sections[SECTION_DEPENDENCIES]) ||
+        !reader.checkSection<StringRef>(sections[SECTION_DIAGNOSTICS]) ||
+        !reader.checkSection<DiskSymbol>(sections[SECTION_SYMBOLS]) ||
+        !reader.checkSection<StringRef>(sections[SECTION_PARAMETERS]) ||
+        !reader.checkSection<char>(sections[SECTION_STRINGS])) {
+        return false;
+    }
+    reader.setStringTable(sections[SECTION_STRINGS]);
+
+    bool valid = true;
+    auto readString = [&](const StringRef& ref) {
+        if (!reader.checkString(ref)) {
+            valid = false;
+            return std::string();
+        }
+        return reader.getString(ref);
+    };
+
+    const DiskFile* files = reader.section<DiskFile>(sections[SECTION_FILES]);
+    std::vector<std::string> filePaths;
+    for (uint64_t i = 0; i < sections[SECTION_FILES].count; i++) {
+        filePaths.push_back(readString(files[i].path));
+        previousFiles[filePaths.back()] = FileState{files[i].size, files[i].mtime, files[i].hash};
+    }
+
+    const DiskUnit* units = reader.section<DiskUnit>(sections[SECTION_UNITS]);
+    const uint32_t* dependencies = reader.section<uint32_t>(sections[SECTION_DEPENDENCIES]);
+    const StringRef* diagnostics = reader.section<StringRef>(sections[SECTION_DIAGNOSTICS]);
+    const DiskSymbol* symbols = reader.section<DiskSymbol>(sections[SECTION_SYMBOLS]);
+    const StringRef* parameters = reader.section<StringRef>(sections[SECTION_PARAMETERS]);
+    for (uint64_t i = 0; i < sections[SECTION_UNITS].count && valid; i++) {
+        const DiskUnit& disk = units[i];
+        if (!inRange(disk.dependencyBegin, disk.dependencyCount, sections[SECTION_DEPENDENCIES].count) ||
+            !inRange(disk.diagnosticBegin, disk.diagnosticCount, sections[SECTION_DIAGNOSTICS].count) ||
+            !inRange(disk.symbolBegin, disk.symbolCount, sections[SECTION_SYMBOLS].count)) {
+            valid = false;
+            break;
+        }
+        TranslationUnitResult unit;
+        unit.path = readString(disk.path);
+        unit.includesResolved = true;
+        unit.loaded = disk.loaded != 0;
+        unit.tokenCount = static_cast<size_t>(disk.tokenCount);
+        for (uint32_t d = 0; d < disk.dependencyCount; d++) {
+            uint32_t index = dependencies[disk.dependencyBegin + d];
+            if (index >= filePaths.size()) {
+                valid = false;
+                break;
+            }
+            unit.includedFiles.push_back(filePaths[index]);
+        }
+        for (uint32_t d = 0; d < disk.diagnosticCount; d++) {
+            unit.diagnostics.push_back(readString(diagnostics[disk.diagnosticBegin + d]));
+        }
+        for (uint32_t s = 0; s < disk.symbolCount && valid; s++) {
+            const DiskSymbol& diskSymbol = symbols[disk.symbolBegin + s];
+            if (diskSymbol.kind > static_cast<uint32_t>(SymbolKind::VariableReference) ||
+                !inRange(diskSymbol.parameterBegin, diskSymbol.parameterCount, sections[SECTION_PARAMETERS].count)) {
+                valid = false;
+                break;
+            }
+            SymbolOccurrence symbol;
+            symbol.name = readString(diskSymbol.name);
+            symbol.type = readString(diskSymbol.type);
+            symbol.file = readString(diskSymbol.file);
+            symbol.kind = static_cast<SymbolKind>(diskSymbol.kind);
+            for (uint32_t p = 0; p < diskSymbol.parameterCount; p++) {
+                symbol.parameterTypes.push_back(readString(parameters[diskSymbol.parameterBegin + p]));
+            }
+            symbol.argumentCount = diskSymbol.argumentCount;
+            symbol.line = diskSymbol.line;
+            symbol.column = diskSymbol.column;
+            symbol.offset = static_cast<size_t>(diskSymbol.offset);
+            unit.symbols.push_back(std::move(symbol));
+        }
+        previousUnits[unit.path] = std::move(unit);
+    }
+
+    if (!valid) {
+        previousFiles.clear();
+        previousUnits.clear();
+        return false;
+    }
+    return true;
+}
+
+bool ProjectCache::save(const std::vector<TranslationUnitResult>& units) {
+    BinaryWriter writer(sizeof(DiskHeader));
+    std::vector<DiskFile> diskFiles;
+    std::unordered_map<std::string, uint32_t> fileIndex;
+    auto addFile = [&](const std::string& file, uint32_t& index) {
+        auto it = fileIndex.find(file);
+        if (it != fileIndex.end()) {
+            index = it->second;
+            return true;
+        }
+        FileState state;
+        if (!currentState(file, state)) {
+            return false;
+        }
+        index = static_cast<uint32_t>(diskFiles.size());
+        diskFiles.push_back({writer.addString(file), state.size, state.mtime, state.hash});
+        fileIndex.emplace(file, index);
+        return true;
+    };
+
+    std::vector<DiskUnit> diskUnits;
+    std::vector<uint32_t> dependencies;
+    std::vector<StringRef> diagnostics;
+    std::vector<DiskSymbol> symbols;
+    std::vector<StringRef> parameters;
+    for (const auto& unit : units) {
+        uint32_t index = 0;
+        if (!unit.loaded || !unit.includesResolved || !addFile(unit.path, index)) {
+            continue;  // 读不到的文件、缺少被包含文件的单元下次重新分析
+        }
+        DiskUnit disk;
+        std::memset(&disk, 0, sizeof(disk));
+        disk.path = writer.addString(unit.path);
+        disk.loaded = 1;
+        disk.tokenCount = unit.tokenCount;
+        disk.dependencyBegin = static_cast<uint32_t>(dependencies.size());
+        bool complete = true;
+        for (const auto& dependency : unit.includedFiles) {
+            if (!addFile(dependency, index)) {
+                complete = false;
+                break;
+            }
+            dependencies.push_back(index);
+        }
+        if (!complete) {
+            dependencies.resize(disk.dependencyBegin);
+            continue;
+        }
+        disk.dependencyCount = static_cast<uint32_t>(dependencies.size()) - disk.dependencyBegin;
+        disk.diagnosticBegin = static_cast<uint32_t>(diagnostics.size());
+        disk.diagnosticCount = static_cast<uint32_t>(unit.diagnostics.size());
+        for (const auto& diagnostic : unit.diagnostics) {
+            diagnostics.push_back(writer.addString(diagnostic));
+        }
+        disk.symbolBegin = static_cast<uint32_t>(symbols.size());
+        disk.symbolCount = static_cast<uint32_t>(unit.symbols.size());
+        for (const auto& symbol : unit.symbols) {
+            DiskSymbol diskSymbol;
+            diskSymbol.name = writer.addString(symbol.name);
+            diskSymbol.type = writer.addString(symbol.type);
+            diskSymbol.file = writer.addString(symbol.file);
+            diskSymbol.kind = static_cast<uint32_t>(symbol.kind);
+            diskSymbol.parameterBegin = static_cast<uint32_t>(parameters.size());
+            diskSymbol.parameterCount = static_cast<uint32_t>(symbol.parameterTypes.size());
+            for (const auto& type : symbol.parameterTypes) {
+                parameters.push_back(writer.addString(type));
+            }
+            diskSymbol.argumentCount = static_cast<uint32_t>(symbol.argumentCount);
+            diskSymbol.line = symbol.line;
+            diskSymbol.column = symbol.column;
+            diskSymbol.offset = symbol.offset;
+            symbols.push_back(diskSymbol);
+        }
+        diskUnits.push_back(disk);
+    }
+
+    DiskHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.options = options;
+    header.sections[SECTION_FILES] = writer.addSection(diskFiles);
+    header.sections[SECTION_UNITS] = writer.addSection(diskUnits);
+    header.sections[SECTION_DEPENDENCIES] = writer.addSection(dependencies);
+    header.sections[SECTION_DIAGNOSTICS] = writer.addSection(diagnostics);
+    header.sections[SECTION_SYMBOLS] = writer.addSection(symbols);
+    header.sections[SECTION_PARAMETERS] = writer.addSection(parameters);
+    header.sections[SECTION_STRINGS] = writer.addStringTable();
+    writer.setHeader(&header, sizeof(header));
+    return writer.writeAtomically(path);
+}
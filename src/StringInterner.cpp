@@ -0,0 +1,39 @@
+#include "../include/StringInterner.h"
+#include <mutex>
+
+// StringInterner类实现
+uint32_t StringInterner::intern(const std::string& str) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(str);
+        if (it != ids.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = ids.find(str);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.push_back(str);
+    ids.emplace(strings.back(), id);
+    return id;
+}
+
+uint32_t StringInterner::lookup(const std::string& str) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = ids.find(str);
+    return it != ids.end() ? it->second : npos;
+}
+
+const std::string& StringInterner::str(uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return strings[id];
+}
+
+size_t StringInterner::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return strings.size();
+}
@@ -0,0 +1,516 @@
+#include "../include/StructuralRewriter.h"
+#include "../include/ASTWalker.h"
+#include "../include/Lexer.h"
+#include "../include/HashUtils.h"
+#include "../include/ThreadPool.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+const std::string PLACEHOLDER_PREFIX = "__sr_";
+
+bool isPlaceholder(const std::string& name) {
+    return name.size() > PLACEHOLDER_PREFIX.size() && name.compare(0, PLACEHOLDER_PREFIX.size(), PLACEHOLDER_PREFIX) == 0;
+}
+
+bool isPlaceholder(const Token& token) {
+    return token.type == TokenType::IDENTIFIER && isPlaceholder(token.value);
+}
+
+std::vector<const ASTNode*> childSlots(const ASTNode& node) {
+    std::vector<const ASTNode*> slots;
+    forEachChildSlot(node, [&slots](const ASTNode* child) {
+        slots.push_back(child);
+    });
+    return slots;
+}
+
+// 节点覆盖的token（去掉换行）
+std::vector<Token> nodeTokens(const ASTNode& node, const std::vector<Token>& tokens) {
+    std::vector<Token> result;
+    for (size_t i = node.firstToken; i <= node.lastToken && i < tokens.size(); i++) {
+        if (tokens[i].type != TokenType::NEWLINE && tokens[i].type != TokenType::EOF_TOKEN) {
+            result.push_back(tokens[i]);
+        }
+    }
+    return result;
+}
+
+// token在源码中结束处的字节偏移；字符串的值已去掉引号与转义，需要重新扫描
+size_t tokenEnd(const Token& token, const std::string& source) {
+    size_t start = std::min(token.offset, source.size());
+    if (token.type != TokenType::STRING) {
+        return std::min(start + token.value.size(), source.size());
+    }
+    char quote = source[start];
+    size_t i = start + 1;
+    while (i < source.size() && source[i] != quote) {
+        i += source[i] == '\\' ? 2 : 1;
+    }
+    return std::min(i + 1, source.size());
+}
+
+bool isLayout(const Token& token) {
+    return token.type == TokenType::NEWLINE || token.type == TokenType::EOF_TOKEN;
+}
+
+bool sameTokens(const std::vector<Token>& a, const std::vector<Token>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const Token& x, const Token& y) {
+        return x.type == y.type && x.value == y.value;
+    });
+}
+
+// 运算优先级：赋值最低，一元运算次高；标识符、字面量、调用等不可再分
+const int ATOMIC_PRECEDENCE = 9;
+
+int binaryPrecedence(const std::string& op) {
+    if (op == "=") {
+        return 1;
+    }
+    if (op == "||") {
+        return 2;
+    }
+    if (op == "&&") {
+        return 3;
+    }
+    if (op == "==" || op == "!=") {
+        return 4;
+    }
+    if (op == "+" || op == "-") {
+        return 6;
+    }
+    if (op == "*" || op == "/" || op == "%") {
+        return 7;
+    }
+    return isComparison(op) ? 5 : 1;
+}
+
+int precedenceOf(const ASTNode& node) {
+    switch (node.getKind()) {
+        case ASTNodeKind::BinaryExpression:
+            return binaryPrecedence(static_cast<const BinaryExpressionNode&>(node).operator_);
+        case ASTNodeKind::UnaryExpression:
+            return 8;
+        case ASTNodeKind::Assignment:
+            return 1;
+        default:
+            return ATOMIC_PRECEDENCE;
+    }
+}
+
+// child直接作为parent的运算对象时，代入的表达式不加括号所需的最低优先级
+int requiredPrecedence(const ASTNode& parent, const ASTNode& child) {
+    if (parent.getKind() == ASTNodeKind::UnaryExpression) {
+        return ATOMIC_PRECEDENCE;  // 一元运算的运算对象不可再分，也避免 - -a 连成 --a
+    }
+    if (parent.getKind() != ASTNodeKind::BinaryExpression) {
+        return 0;
+    }
+    const auto& binary = static_cast<const BinaryExpressionNode&>(parent);
+    bool right = binary.right.get() == &child;
+    if (binary.operator_ == "=") {
+        return right ? 0 : ATOMIC_PRECEDENCE;
+    }
+    // 左结合：右边的运算对象优先级相同时也要加括号，如 10 - (a - 1)
+    int precedence = binaryPrecedence(binary.operator_);
+    return right ? precedence + 1 : precedence;
+}
+
+// 语法树中每个节点的父节点
+std::unordered_map<const ASTNode*, const ASTNode*> parentsOf(const ASTNode& root) {
+    std::unordered_map<const ASTNode*, const ASTNode*> parents;
+    walkAST(root, [&parents](const ASTNode& node) {
+        forEachChild(node, [&parents, &node](const ASTNode& child) {
+            parents[&child] = &node;
+        });
+        return true;
+    });
+    return parents;
+}
+
+// 替换文本无法单独解析时，代入占位符处这些相邻token不会改变运算表达式的结合方式
+bool isDelimiter(const Token* token) {
+    if (!token) {
+        return true;
+    }
+    switch (token->type) {
+        case TokenType::LPAREN:
+        case TokenType::RPAREN:
+        case TokenType::COMMA:
+        case TokenType::SEMICOLON:
+        case TokenType::ASSIGN:
+        case TokenType::LBRACE:
+        case TokenType::RBRACE:
+        case TokenType::RETURN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+// StructuralRewriter类实现
+StructuralRewriter::StructuralRewriter() = default;
+
+StructuralRewriter::~StructuralRewriter() = default;
+
+std::string StructuralRewriter::expandPlaceholders(const std::string& text) {
+    std::string result;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '$' && i + 1 < text.size() &&
+            (std::isalpha(static_cast<unsigned char>(text[i + 1])) || text[i + 1] == '_')) {
+            result += PLACEHOLDER_PREFIX;
+        } else {
+            result += text[i];
+        }
+    }
+    return result;
+}
+
+StructuralRewriter::Signature StructuralRewriter::signature(const std::vector<Token>& tokens) {
+    Signature bits;
+    for (const auto& token : tokens) {
+        if (token.type == TokenType::NEWLINE || token.type == TokenType::EOF_TOKEN || isPlaceholder(token)) {
+            continue;
+        }
+        uint64_t hash = HashUtils::combine(HashUtils::FNV_OFFSET, static_cast<uint64_t>(token.type));
+        if (token.type == TokenType::IDENTIFIER || token.type == TokenType::INTEGER ||
+            token.type == TokenType::FLOAT || token.type == TokenType::STRING) {
+            hash = HashUtils::hashString(token.value, hash);
+        }
+        bits.set(hash % bits.size());
+    }
+    return bits;
+}
+
+bool StructuralRewriter::compile(const std::string& patternText, const std::string& replacementText,
+                                 std::string& error) {
+    pattern = nullptr;
+    patternProgram.reset();
+    replacement.clear();
+    requiredAt.clear();
+    replacementRoot.clear();
+
+    // 表达式模式补上分号，按一条语句解析
+    std::string source = expandPlaceholders(patternText);
+    size_t last = source.find_last_not_of(" \t\r\n");
+    if (last != std::string::npos && source[last] != ';' && source[last] != '}') {
+        source += ";";
+    }
+    Lexer lexer(source);
+    patternTokens = lexer.tokenize();
+    if (lexer.hasErrors()) {
+        error = "cannot tokenize pattern: " + lexer.getErrors().front().getFullMessage();
+        return false;
+    }
+    Parser parser(patternTokens);
+    patternProgram = parser.parse();
+    if (parser.hasErrors() || !patternProgram) {
+        error = "cannot parse pattern" + (parser.hasErrors() ? ": " + parser.getErrors().front().getFullMessage() : "");
+        return false;
+    }
+    if (patternProgram->statements.size() != 1) {
+        error = "pattern must be a single expression or statement";
+        return false;
+    }
+    pattern = patternProgram->statements.front().get();
+    if (pattern->getKind() == ASTNodeKind::ExpressionStatement) {
+        const auto& statement = static_cast<const ExpressionStatementNode&>(*pattern);
+        if (statement.expression) {
+            pattern = statement.expression.get();
+        }
+    }
+    patternSignature = signature(nodeTokens(*pattern, patternTokens));
+
+    replacementSource = expandPlaceholders(replacementText);
+    Lexer replacementLexer(replacementSource);
+    for (const auto& token : replacementLexer.tokenize()) {
+        if (token.type != TokenType::EOF_TOKEN) {
+            replacement.push_back(token);
+        }
+    }
+    if (replacementLexer.hasErrors()) {
+        error = "cannot tokenize replacement: " + replacementLexer.getErrors().front().getFullMessage();
+        return false;
+    }
+    std::vector<Token> used = nodeTokens(*pattern, patternTokens);
+    for (const auto& token : replacement) {
+        if (isPlaceholder(token) && std::none_of(used.begin(), used.end(), [&token](const Token& t) {
+                return t.type == TokenType::IDENTIFIER && t.value == token.value;
+            })) {
+            error = "placeholder $" + token.value.substr(PLACEHOLDER_PREFIX.size()) + " is not bound by the pattern";
+            return false;
+        }
+    }
+
+    // 按替换文本的语法树记下每个占位符所在位置对优先级的要求，以及替换结果整体的优先级
+    std::string replacementStatement = replacementSource;
+    last = replacementStatement.find_last_not_of(" \t\r\n");
+    if (last != std::string::npos && replacementStatement[last] != ';' && replacementStatement[last] != '}') {
+        replacementStatement += ";";
+    }
+    Lexer statementLexer(replacementStatement);
+    std::vector<Token> statementTokens = statementLexer.tokenize();
+    Parser statementParser(statementTokens);
+    std::unique_ptr<ProgramNode> replacementProgram = statementParser.parse();
+    replacementParsed = !statementLexer.hasErrors() && !statementParser.hasErrors() && replacementProgram &&
+                        replacementProgram->statements.size() == 1;
+    if (!replacementParsed) {
+        replacementPrecedence = replacement.size() == 1 ? ATOMIC_PRECEDENCE : 0;
+        return true;
+    }
+    auto parents = parentsOf(*replacementProgram);
+    walkAST(*replacementProgram, [&](const ASTNode& node) {
+        auto parent = parents.find(&node);
+        if (node.getKind() == ASTNodeKind::Identifier && isPlaceholder(static_cast<const IdentifierNode&>(node).name) &&
+            parent != parents.end() && node.firstToken < statementTokens.size()) {
+            requiredAt[statementTokens[node.firstToken].offset] = requiredPrecedence(*parent->second, node);
+        }
+        return true;
+    });
+    const ASTNode* root = replacementProgram->statements.front().get();
+    if (root->getKind() == ASTNodeKind::ExpressionStatement &&
+        static_cast<const ExpressionStatementNode*>(root)->expression) {
+        root = static_cast<const ExpressionStatementNode*>(root)->expression.get();
+    }
+    if (root->getKind() == ASTNodeKind::Identifier && isPlaceholder(static_cast<const IdentifierNode*>(root)->name)) {
+        replacementRoot = static_cast<const IdentifierNode*>(root)->name;
+    }
+    replacementPrecedence = precedenceOf(*root);
+    return true;
+}
+
+bool StructuralRewriter::bind(const std::string& name, Binding value, Bindings& bindings) const {
+    auto it = bindings.find(name);
+    if (it == bindings.end()) {
+        bindings.emplace(name, std::move(value));
+        return true;
+    }
+    return sameTokens(it->second.tokens, value.tokens);
+}
+
+bool StructuralRewriter::matchNode(const ASTNode& patternNode, const ASTNode& target,
+                                   const std::vector<Token>& tokens, Bindings& bindings) const {
+    // 表达式位置上的占位符匹配任意子树
+    if (patternNode.getKind() == ASTNodeKind::Identifier) {
+        const std::string& name = static_cast<const IdentifierNode&>(patternNode).name;
+        if (isPlaceholder(name)) {
+            Binding binding;
+            binding.tokens = nodeTokens(target, tokens);
+            binding.first = target.firstToken;
+            binding.last = std::min(target.lastToken, tokens.size() - 1);
+            while (binding.first < binding.last && isLayout(tokens[binding.first])) {
+                binding.first++;
+            }
+            while (binding.last > binding.first && isLayout(tokens[binding.last])) {
+                binding.last--;
+            }
+            binding.ranged = !binding.tokens.empty();
+            binding.precedence = precedenceOf(target);
+            return bind(name, std::move(binding), bindings);
+        }
+    }
+    if (patternNode.getKind() != target.getKind()) {
+        return false;
+    }
+
+    // 名字位置上的占位符（如 $f(x) 中的函数名）匹配一个标识符
+    std::vector<std::string> patternFields = nodeFields(patternNode);
+    std::vector<std::string> targetFields = nodeFields(target);
+    for (size_t i = 0; i < patternFields.size(); i++) {
+        if (isPlaceholder(patternFields[i])) {
+            Binding binding;
+            binding.tokens.emplace_back(TokenType::IDENTIFIER, targetFields[i], target.line, target.column);
+            binding.precedence = ATOMIC_PRECEDENCE;
+            if (!bind(patternFields[i], std::move(binding), bindings)) {
+                return false;
+            }
+        } else if (patternFields[i] != targetFields[i]) {
+            return false;
+        }
+    }
+
+    std::vector<const ASTNode*> patternChildren = childSlots(patternNode);
+    std::vector<const ASTNode*> targetChildren = childSlots(target);
+    if (patternChildren.size() != targetChildren.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < patternChildren.size(); i++) {
+        if (!patternChildren[i] || !targetChildren[i]) {
+            if (patternChildren[i] != targetChildren[i]) {
+                return false;
+            }
+        } else if (!matchNode(*patternChildren[i], *targetChildren[i], tokens, bindings)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string StructuralRewriter::substitute(const Bindings& bindings, const std::vector<Token>& tokens,
+                                          const std::string& source, int& precedence) const {
+    // 替换文本原样保留，只把占位符换成绑定的代码在目标文件中的原文
+    precedence = replacementPrecedence;
+    auto root = replacementRoot.empty() ? bindings.end() : bindings.find(replacementRoot);
+    if (root != bindings.end()) {
+        precedence = root->second.precedence;
+    }
+    std::string output;
+    size_t cursor = 0;
+    for (size_t i = 0; i < replacement.size(); i++) {
+        const Token& token = replacement[i];
+        auto it = isPlaceholder(token) ? bindings.find(token.value) : bindings.end();
+        if (it == bindings.end()) {
+            continue;
+        }
+        output.append(replacementSource, cursor, token.offset - cursor);
+        cursor = token.offset + token.value.size();
+
+        const Binding& binding = it->second;
+        int required = 0;
+        if (replacementParsed) {
+            auto position = requiredAt.find(token.offset);
+            required = position == requiredAt.end() ? 0 : position->second;
+        } else {
+            const Token* previous = i > 0 ? &replacement[i - 1] : nullptr;
+            const Token* next = i + 1 < replacement.size() ? &replacement[i + 1] : nullptr;
+            required = isDelimiter(previous) && isDelimiter(next) ? 0 : ATOMIC_PRECEDENCE;
+        }
+        bool parenthesize = binding.precedence < required;
+        if (parenthesize) {
+            output += '(';
+        }
+        if (binding.ranged) {
+            size_t begin = tokens[binding.first].offset;
+            output.append(source, begin, tokenEnd(tokens[binding.last], source) - begin);
+        } else {
+            output += binding.tokens.front().value;
+        }
+        if (parenthesize) {
+            output += ')';
+        }
+    }
+    output.append(replacementSource, cursor, std::string::npos);
+
+    size_t first = output.find_first_not_of(" \t\r\n");
+    size_t last = output.find_last_not_of(" \t\r\n");
+    return first == std::string::npos ? std::string() : output.substr(first, last - first + 1);
+}
+
+RewriteResult StructuralRewriter::rewriteSource(const std::string& path, const std::string& source) const {
+    RewriteResult result;
+    result.path = path;
+    result.loaded = true;
+    if (!pattern) {
+        return result;
+    }
+
+    Lexer lexer(source);
+    std::vector<Token> tokens = lexer.tokenize();
+    // 预筛选：模式中的某种token在文件中不存在时不可能匹配
+    if ((patternSignature & ~signature(tokens)).any()) {
+        result.skipped = true;
+        return result;
+    }
+    for (const auto& error : lexer.getErrors()) {
+        result.diagnostics.push_back(path + ": " + error.getFullMessage());
+    }
+
+    Parser parser(tokens);
+    std::unique_ptr<ProgramNode> program = parser.parse();
+    for (const auto& error : parser.getErrors()) {
+        result.diagnostics.push_back(path + ": " + error.getFullMessage());
+    }
+    if (!program || !result.diagnostics.empty()) {
+        return result;  // 有错误的文件不重写，避免按错误的语法树改动代码
+    }
+
+    // 前序查找匹配的子树，匹配后不再进入其内部，保证各处替换互不重叠
+    // 替换结果的优先级低于原语法树中父节点的要求时整体加括号，如 scale(a + 1, 1) * 2 改写为 (a + 1) * 2
+    auto parents = parentsOf(*program);
+    struct Edit {
+        size_t begin;  // 原文中被替换的字节范围
+        size_t end;
+        std::string text;
+    };
+    std::vector<Edit> edits;
+    walkAST(*program, [&](const ASTNode& node) {
+        if (node.getKind() == ASTNodeKind::Program) {
+            return true;
+        }
+        Bindings bindings;
+        if (!matchNode(*pattern, node, tokens, bindings)) {
+            return true;
+        }
+        size_t first = node.firstToken;
+        size_t last = std::min(node.lastToken, tokens.size() - 1);
+        while (last > first && isLayout(tokens[last])) {
+            last--;
+        }
+        int precedence;
+        std::string text = substitute(bindings, tokens, source, precedence);
+        auto parent = parents.find(&node);
+        if (parent != parents.end() && precedence < requiredPrecedence(*parent->second, node)) {
+            text = "(" + text + ")";
+        }
+        edits.push_back(Edit{tokens[first].offset, tokenEnd(tokens[last], source), text});
+        return false;
+    });
+    result.edits = edits.size();
+    if (edits.empty()) {
+        return result;
+    }
+
+    std::string rewritten;
+    rewritten.reserve(source.size());
+    size_t next = 0;
+    for (const auto& edit : edits) {
+        rewritten.append(source, next, edit.begin - next);
+        rewritten += edit.text;
+        next = edit.end;
+    }
+    rewritten.append(source, next, std::string::npos);
+
+    // 替换可能引入语法错误（例如替换文本本身不完整），改写结果无法解析时不输出
+    Lexer checkLexer(rewritten);
+    std::vector<Token> checkTokens = checkLexer.tokenize();
+    Parser checkParser(checkTokens);
+    checkParser.parse();
+    for (const auto& error : checkLexer.getErrors()) {
+        result.diagnostics.push_back(path + ": rewritten code: " + error.getFullMessage());
+    }
+    for (const auto& error : checkParser.getErrors()) {
+        result.diagnostics.push_back(path + ": rewritten code: " + error.getFullMessage());
+    }
+    if (result.diagnostics.empty()) {
+        result.output = std::move(rewritten);
+    }
+    return result;
+}
+
+RewriteResult StructuralRewriter::rewriteFile(const std::string& path) const {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        RewriteResult result;
+        result.path = path;
+        result.diagnostics.push_back(path + ": Cannot open file");
+        return result;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    return rewriteSource(path, buffer.str());
+}
+
+std::vector<RewriteResult> StructuralRewriter::run(const std::vector<std::string>& files, size_t threadCount) const {
+    std::vector<RewriteResult> results(files.size());
+    ThreadPool pool(std::min(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount,
+                             std::max<size_t>(1, files.size())));
+    pool.parallelFor(files.size(), [&](size_t i) {
+        results[i] = rewriteFile(files[i]);
+    });
+    return results;
+}
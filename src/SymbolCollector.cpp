@@ -0,0 +1,248 @@
+#include "../include/SymbolCollector.h"
+#include "../include/ASTWalker.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+
+bool isTypeKeyword(TokenType type) {
+    return type == TokenType::INT || type == TokenType::FLOAT_KW ||
+           type == TokenType::CHAR || type == TokenType::VOID;
+}
+
+/**
+ * 带作用域的遍历：记录函数调用，以及没有被局部变量/形参遮蔽的标识符引用
+ */
+class ReferenceCollector {
+private:
+    const std::vector<Token>& tokens;
+    const std::function<std::string(int)>& fileName;
+    std::vector<SymbolOccurrence>& symbols;
+    std::vector<std::unordered_set<std::string>> scopes;  // 为空表示处于全局作用域
+
+    bool isLocal(const std::string& name) const {
+        for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+            if (it->count(name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void declare(const std::string& name) {
+        if (!scopes.empty()) {
+            scopes.back().insert(name);
+        }
+    }
+
+    void visitChildren(const ASTNode& node) {
+        forEachChild(node, [this](const ASTNode& child) {
+            visit(child);
+        });
+    }
+
+public:
+    ReferenceCollector(const std::vector<Token>& tokens, const std::function<std::string(int)>& fileName,
+                       std::vector<SymbolOccurrence>& symbols)
+        : tokens(tokens), fileName(fileName), symbols(symbols) {}
+
+    SymbolOccurrence occurrence(const std::string& name, SymbolKind kind, const ASTNode& node) const {
+        SymbolOccurrence symbol;
+        symbol.name = name;
+        symbol.kind = kind;
+        symbol.file = fileName(node.fileId);
+        symbol.line = node.line;
+        symbol.column = node.column;
+        if (node.firstToken < tokens.size()) {
+            symbol.offset = tokens[node.firstToken].offset;
+        }
+        // 位置取名字所在的token（如 "int f(...)" 中的 f）
+        size_t end = std::min(node.lastToken + 1, tokens.size());
+        for (size_t i = node.firstToken; i < end; i++) {
+            if (tokens[i].type == TokenType::IDENTIFIER && tokens[i].value == name) {
+                symbol.line = tokens[i].line;
+                symbol.column = tokens[i].column;
+                symbol.offset = tokens[i].offset;
+                break;
+            }
+        }
+        return symbol;
+    }
+
+    void visit(const ASTNode& node) {
+        switch (node.getKind()) {
+            case ASTNodeKind::FunctionDeclaration:
+                break;  // 原型中的形参名不是引用
+            case ASTNodeKind::FunctionDefinition: {
+                const auto& function = static_cast<const FunctionDefinitionNode&>(node);
+                scopes.emplace_back();
+                for (const auto& parameter : function.parameters) {
+                    if (parameter && parameter->getKind() == ASTNodeKind::VarDeclaration) {
+                        declare(static_cast<const VarDeclarationNode&>(*parameter).identifier);
+                    } else if (parameter && parameter->getKind() == ASTNodeKind::ArrayDeclaration) {
+                        declare(static_cast<const ArrayDeclarationNode&>(*parameter).identifier);
+                    }
+                }
+                if (function.body) {
+                    visit(*function.body);
+                }
+                scopes.pop_back();
+                break;
+            }
+            case ASTNodeKind::CompoundStatement:
+            case ASTNodeKind::ForStatement:
+                scopes.emplace_back();
+                visitChildren(node);
+                scopes.pop_back();
+                break;
+            case ASTNodeKind::VarDeclaration: {
+                const auto& var = static_cast<const VarDeclarationNode&>(node);
+                if (var.initializer) {
+                    visit(*var.initializer);
+                }
+                declare(var.identifier);
+                break;
+            }
+            case ASTNodeKind::ArrayDeclaration:
+                declare(static_cast<const ArrayDeclarationNode&>(node).identifier);
+                break;
+            case ASTNodeKind::Assignment: {
+                // 赋值目标也是对变量的引用
+                const auto& assignment = static_cast<const AssignmentNode&>(node);
+                if (!isLocal(assignment.identifier)) {
+                    symbols.push_back(occurrence(assignment.identifier, SymbolKind::VariableReference, node));
+                }
+                visitChildren(node);
+                break;
+            }
+            case ASTNodeKind::FunctionCall: {
+                const auto& call = static_cast<const FunctionCallNode&>(node);
+                SymbolOccurrence symbol = occurrence(call.name, SymbolKind::FunctionCall, call);
+                symbol.argumentCount = call.arguments.size();
+                symbols.push_back(std::move(symbol));
+                visitChildren(node);
+                break;
+            }
+            case ASTNodeKind::Identifier: {
+                // i++ / ++i 形式的名字带有运算符
+                std::string name = static_cast<const IdentifierNode&>(node).name;
+                if (name.size() > 2 && (name.compare(0, 2, "++") == 0 || name.compare(0, 2, "--") == 0)) {
+                    name = name.substr(2);
+                } else if (name.size() > 2 && (name.compare(name.size() - 2, 2, "++") == 0 ||
+                                               name.compare(name.size() - 2, 2, "--") == 0)) {
+                    name = name.substr(0, name.size() - 2);
+                }
+                if (!isLocal(name)) {
+                    symbols.push_back(occurrence(name, SymbolKind::VariableReference, node));
+                }
+                break;
+            }
+            default:
+                visitChildren(node);
+                break;
+        }
+    }
+};
+
+} // namespace
+
+// SymbolCollector类实现
+std::vector<SymbolOccurrence> SymbolCollector::collect(const ProgramNode& program, const std::vector<Token>& tokens,
+                                                       const std::function<std::string(int)>& fileName) {
+    std::vector<SymbolOccurrence> symbols;
+    ReferenceCollector references(tokens, fileName, symbols);
+
+    for (const auto& statement : program.statements) {
+        if (!statement) {
+            continue;
+        }
+        switch (statement->getKind()) {
+            case ASTNodeKind::FunctionDeclaration: {
+                const auto& function = static_cast<const FunctionDeclarationNode&>(*statement);
+                SymbolOccurrence symbol = references.occurrence(function.name, SymbolKind::FunctionDeclaration, function);
+                symbol.type = function.returnType;
+                symbol.parameterTypes = parameterTypes(function, tokens);
+                symbols.push_back(std::move(symbol));
+                break;
+            }
+            case ASTNodeKind::FunctionDefinition: {
+                const auto& function = static_cast<const FunctionDefinitionNode&>(*statement);
+                SymbolOccurrence symbol = references.occurrence(function.name, SymbolKind::FunctionDefinition, function);
+                symbol.type = function.returnType;
+                symbol.parameterTypes = parameterTypes(function, tokens);
+                symbols.push_back(std::move(symbol));
+                break;
+            }
+            case ASTNodeKind::VarDeclaration: {
+                const auto& var = static_cast<const VarDeclarationNode&>(*statement);
+                SymbolOccurrence symbol = references.occurrence(var.identifier, SymbolKind::Variable, var);
+                symbol.type = var.type;
+                symbols.push_back(std::move(symbol));
+                break;
+            }
+            case ASTNodeKind::ArrayDeclaration: {
+                const auto& array = static_cast<const ArrayDeclarationNode&>(*statement);
+                SymbolOccurrence symbol = references.occurrence(array.identifier, SymbolKind::Variable, array);
+                symbol.type = array.type + "[" + std::to_string(array.size) + "]";
+                symbols.push_back(std::move(symbol));
+                break;
+            }
+            default:
+                break;
+        }
+
+        // 顶层语句（包括函数体）中的调用与全局变量引用
+        references.visit(*statement);
+    }
+    return symbols;
+}
+
+std::vector<std::string> SymbolCollector::parameterTypes(const ASTNode& function, const std::vector<Token>& tokens) {
+    std::vector<std::string> types;
+    size_t index = function.firstToken;
+    size_t end = std::min(function.lastToken + 1, tokens.size());
+    while (index < end && tokens[index].type != TokenType::LPAREN) {
+        index++;
+    }
+    bool expectType = true;
+    for (index++; index < end && tokens[index].type != TokenType::RPAREN; index++) {
+        const Token& token = tokens[index];
+        if (token.type == TokenType::COMMA) {
+            expectType = true;
+        } else if (token.type == TokenType::LBRACKET && !types.empty()) {
+            types.back() += "[]";  // 数组形参
+        } else if (expectType && (isTypeKeyword(token.type) || token.type == TokenType::IDENTIFIER)) {
+            types.push_back(token.value);
+            expectType = false;
+        }
+    }
+    if (types.size() == 1 && types[0] == "void") {
+        types.clear();
+    }
+    return types;
+}
+
+std::string SymbolCollector::signature(const SymbolOccurrence& symbol) {
+    if (symbol.kind == SymbolKind::Variable) {
+        return symbol.type;
+    }
+    std::string result = symbol.type + "(";
+    for (size_t i = 0; i < symbol.parameterTypes.size(); i++) {
+        if (i > 0) {
+            result += ", ";
+        }
+        result += symbol.parameterTypes[i];
+    }
+    return result + ")";
+}
+
+const char* SymbolCollector::kindName(SymbolKind kind) {
+    switch (kind) {
+        case SymbolKind::FunctionDeclaration: return "declaration";
+        case SymbolKind::FunctionDefinition: return "definition";
+        case SymbolKind::Variable: return "variable";
+        case SymbolKind::FunctionCall: return "call";
+        case SymbolKind::VariableReference: return "reference";
+    }
+    return "unknown";
+}
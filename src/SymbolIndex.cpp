@@ -0,0 +1,428 @@
+#include "../include/SymbolIndex.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/ConcurrentHashMap.h"
+#include "../include/ThreadPool.h"
+#include "../include/HashUtils.h"
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+const char INDEX_MAGIC[8] = {'C', 'A', 'I', 'D', 'X', '0', '1', '\0'};
+const uint32_t INDEX_VERSION = 2;
+
+enum IndexSection {
+    SECTION_UNITS,         // DiskUnit
+    SECTION_DEPENDENCIES,  // DiskDependency
+    SECTION_RECORDS,       // DiskRecord：按翻译单元分组
+    SECTION_SORTED,        // uint32_t：按 (名字, 种类, 文件, 偏移) 排序的记录下标
+    SECTION_STRINGS,
+    SECTION_COUNT
+};
+
+struct DiskHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    SectionInfo sections[SECTION_COUNT];
+};
+
+struct DiskUnit {
+    StringRef path;
+    uint64_t hash;
+    uint32_t dependencyBegin;
+    uint32_t dependencyCount;
+    uint32_t recordBegin;
+    uint32_t recordCount;
+};
+
+struct DiskDependency {
+    StringRef path;
+    uint64_t hash;
+};
+
+struct DiskRecord {
+    StringRef name;
+    StringRef file;
+    uint32_t kind;
+    int32_t line;
+    int32_t column;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+/**
+ * 一个翻译单元在索引中的内容
+ */
+struct UnitData {
+    bool present = false;  // 文件能否读取
+    std::string path;
+    uint64_t hash = 0;
+    std::vector<std::pair<std::string, uint64_t>> dependencies;
+    std::vector<IndexEntry> entries;
+};
+
+int compareEntries(const IndexEntry& a, const IndexEntry& b) {
+    if (int c = a.name.compare(b.name)) return c;
+    if (a.kind != b.kind) return a.kind < b.kind ? -1 : 1;
+    if (int c = a.file.compare(b.file)) return c;
+    if (a.offset != b.offset) return a.offset < b.offset ? -1 : 1;
+    return 0;
+}
+
+} // namespace
+
+// SymbolIndex类实现
+SymbolIndex::SymbolIndex() : reader(nullptr, 0) {}
+
+bool SymbolIndex::open(const std::string& path) {
+    units = dependencies = records = nullptr;
+    sorted = nullptr;
+    unitCount = dependencyCount = recordCount = 0;
+    if (!file.open(path) || file.getSize() < sizeof(DiskHeader)) {
+        file.close();
+        return false;
+    }
+    data = file.getData();
+    size = file.getSize();
+
+    DiskHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    reader = BinaryReader(data, size);
+    const SectionInfo* sections = header.sections;
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || header.version != INDEX_VERSION ||
+        !reader.checkSection<DiskUnit>(sections[SECTION_UNITS]) ||
+        !reader.checkSection<DiskDependency>(sections[SECTION_DEPENDENCIES]) ||
+        !reader.checkSection<DiskRecord>(sections[SECTION_RECORDS]) ||
+        !reader.checkSection<uint32_t>(sections[SECTION_SORTED]) ||
+        !reader.checkSection<char>(sections[SECTION_STRINGS]) ||
+        sections[SECTION_SORTED].count != sections[SECTION_RECORDS].count) {
+        file.close();
+        return false;
+    }
+    reader.setStringTable(sections[SECTION_STRINGS]);
+
+    const DiskUnit* diskUnits = reader.section<DiskUnit>(sections[SECTION_UNITS]);
+    const DiskDependency* diskDependencies = reader.section<DiskDependency>(sections[SECTION_DEPENDENCIES]);
+    const DiskRecord* diskRecords = reader.section<DiskRecord>(sections[SECTION_RECORDS]);
+    const uint32_t* diskSorted = reader.section<uint32_t>(sections[SECTION_SORTED]);
+
+    units = diskUnits;
+    dependencies = diskDependencies;
+    records = diskRecords;
+    sorted = diskSorted;
+    unitCount = sections[SECTION_UNITS].count;
+    dependencyCount = sections[SECTION_DEPENDENCIES].count;
+    recordCount = sections[SECTION_RECORDS].count;
+    return true;
+}
+
+bool SymbolIndex::isOpen() const {
+    return file.isOpen();
+}
+
+bool SymbolIndex::validRecord(uint32_t record) const {
+    if (record >= recordCount) {
+        return false;
+    }
+    const DiskRecord& disk = static_cast<const DiskRecord*>(records)[record];
+    return reader.checkString(disk.name) && reader.checkString(disk.file) &&
+           disk.kind <= static_cast<uint32_t>(SymbolKind::VariableReference);
+}
+
+bool SymbolIndex::validUnit(uint64_t unit) const {
+    const DiskUnit& disk = static_cast<const DiskUnit*>(units)[unit];
+    return reader.checkString(disk.path) &&
+           static_cast<uint64_t>(disk.dependencyBegin) + disk.dependencyCount <= dependencyCount &&
+           static_cast<uint64_t>(disk.recordBegin) + disk.recordCount <= recordCount;
+}
+
+IndexEntry SymbolIndex::entryAt(uint32_t record) const {
+    const DiskRecord& disk = static_cast<const DiskRecord*>(records)[record];
+    IndexEntry entry;
+    entry.name = reader.getString(disk.name);
+    entry.kind = static_cast<SymbolKind>(disk.kind);
+    entry.file = reader.getString(disk.file);
+    entry.line = disk.line;
+    entry.column = disk.column;
+    entry.offset = static_cast<size_t>(disk.offset);
+    return entry;
+}
+
+std::pair<size_t, size_t> SymbolIndex::findRange(const std::string& name) const {
+    if (!isOpen()) {
+        return {0, 0};
+    }
+    const DiskRecord* diskRecords = static_cast<const DiskRecord*>(records);
+    // 直接比较字符串表中的字节，查询过程不分配内存；
+    // 打开时不逐条校验（否则查询耗时与索引大小成正比），越界的记录视为排在最后
+    auto compare = [&](uint32_t record) {
+        if (record >= recordCount || !reader.checkString(diskRecords[record].name)) {
+            return 1;
+        }
+        const StringRef& ref = diskRecords[record].name;
+        size_t common = std::min<size_t>(ref.length, name.size());
+        int c = std::memcmp(reader.stringData(ref), name.data(), common);
+        if (c != 0) return c;
+        if (ref.length == name.size()) return 0;
+        return ref.length < name.size() ? -1 : 1;
+    };
+    const uint32_t* begin = sorted;
+    const uint32_t* end = sorted + recordCount;
+    const uint32_t* lower = std::lower_bound(begin, end, 0, [&](uint32_t record, int) {
+        return compare(record) < 0;
+    });
+    const uint32_t* upper = std::upper_bound(lower, end, 0, [&](int, uint32_t record) {
+        return compare(record) > 0;
+    });
+    return {static_cast<size_t>(lower - begin), static_cast<size_t>(upper - begin)};
+}
+
+std::vector<IndexEntry> SymbolIndex::lookup(const std::string& name) const {
+    std::vector<IndexEntry> result;
+    std::pair<size_t, size_t> range = findRange(name);
+    for (size_t i = range.first; i < range.second; i++) {
+        if (!validRecord(sorted[i])) {
+            continue;
+        }
+        IndexEntry entry = entryAt(sorted[i]);
+        // 同一位置的记录来自包含同一头文件的不同单元，排序后相邻
+        if (!result.empty() && compareEntries(result.back(), entry) == 0) {
+            continue;
+        }
+        result.push_back(std::move(entry));
+    }
+    return result;
+}
+
+bool SymbolIndex::contains(const std::string& name) const {
+    std::pair<size_t, size_t> range = findRange(name);
+    return range.first < range.second;
+}
+
+std::vector<std::string> SymbolIndex::unitsReferencing(const std::string& name) const {
+    std::vector<std::string> result;
+    std::pair<size_t, size_t> range = findRange(name);
+    if (range.first == range.second) {
+        return result;
+    }
+    const DiskUnit* diskUnits = static_cast<const DiskUnit*>(units);
+    std::vector<bool> seen(unitCount, false);
+    for (size_t i = range.first; i < range.second; i++) {
+        uint32_t record = sorted[i];
+        if (!validRecord(record)) {
+            continue;
+        }
+        // 各单元的记录连续存放，按起始下标二分即可找到所属单元
+        const DiskUnit* unit = std::upper_bound(diskUnits, diskUnits + unitCount, record,
+                                                [](uint32_t value, const DiskUnit& u) {
+                                                    return value < u.recordBegin;
+                                                });
+        if (unit == diskUnits) {
+            continue;
+        }
+        --unit;
+        size_t unitIndex = static_cast<size_t>(unit - diskUnits);
+        if (record < unit->recordBegin + unit->recordCount && !seen[unitIndex] && validUnit(unitIndex)) {
+            seen[unitIndex] = true;
+            result.push_back(reader.getString(unit->path));
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::string> SymbolIndex::currentUnits() const {
+    std::vector<std::string> result;
+    const DiskUnit* diskUnits = static_cast<const DiskUnit*>(units);
+    const DiskDependency* diskDependencies = static_cast<const DiskDependency*>(dependencies);
+    std::unordered_map<std::string, bool> fileMatches;  // 头文件被很多单元包含，只哈希一次
+    auto matches = [&fileMatches](const std::string& path, uint64_t expected) {
+        auto it = fileMatches.find(path);
+        if (it != fileMatches.end()) {
+            return it->second;
+        }
+        uint64_t hash = 0;
+        bool same = HashUtils::hashFile(path, hash) && hash == expected;
+        fileMatches.emplace(path, same);
+        return same;
+    };
+    for (uint64_t i = 0; i < unitCount; i++) {
+        if (!validUnit(i)) {
+            continue;
+        }
+        const DiskUnit& unit = diskUnits[i];
+        std::string path = reader.getString(unit.path);
+        bool current = matches(path, unit.hash);
+        for (uint32_t d = 0; d < unit.dependencyCount && current; d++) {
+            const DiskDependency& dependency = diskDependencies[unit.dependencyBegin + d];
+            current = reader.checkString(dependency.path) &&
+                      matches(reader.getString(dependency.path), dependency.hash);
+        }
+        if (current) {
+            result.push_back(std::move(path));
+        }
+    }
+    return result;
+}
+
+size_t SymbolIndex::getUnitCount() const {
+    return static_cast<size_t>(unitCount);
+}
+
+size_t SymbolIndex::getRecordCount() const {
+    return static_cast<size_t>(recordCount);
+}
+
+bool SymbolIndex::update(const std::string& indexPath, const std::vector<std::string>& files,
+                         const ProjectAnalyzer& frontEnd, size_t threadCount, IndexBuildStats& stats) {
+    stats = IndexBuildStats();
+    stats.units = files.size();
+
+    // 旧索引中各单元的位置
+    SymbolIndex previous;
+    std::unordered_map<std::string, const DiskUnit*> previousUnits;
+    if (previous.open(indexPath)) {
+        const DiskUnit* diskUnits = static_cast<const DiskUnit*>(previous.units);
+        for (uint64_t i = 0; i < previous.unitCount; i++) {
+            if (previous.validUnit(i)) {
+                previousUnits.emplace(previous.reader.getString(diskUnits[i].path), &diskUnits[i]);
+            }
+        }
+    }
+
+    // 头文件被很多单元包含，其内容哈希只计算一次
+    ConcurrentHashMap<std::string, uint64_t> fileHashes;
+    auto hashOf = [&fileHashes](const std::string& path, uint64_t& hash) {
+        if (fileHashes.find(path, hash)) {
+            return true;
+        }
+        if (!HashUtils::hashFile(path, hash)) {
+            return false;
+        }
+        fileHashes.insert(path, hash);
+        return true;
+    };
+
+    std::vector<UnitData> unitData(files.size());
+    std::vector<char> reused(files.size(), 0);
+    ThreadPool pool(std::min(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount,
+                             std::max<size_t>(1, files.size())));
+    pool.parallelFor(files.size(), [&](size_t i) {
+        UnitData& unit = unitData[i];
+        unit.path = std::filesystem::absolute(files[i]).lexically_normal().string();
+        if (!hashOf(unit.path, unit.hash)) {
+            return;  // 文件无法读取，不进入索引
+        }
+        unit.present = true;
+
+        // 自身与所有被包含文件都没有变化时沿用旧记录
+        auto it = previousUnits.find(unit.path);
+        if (it != previousUnits.end() && it->second->hash == unit.hash) {
+            const DiskUnit& old = *it->second;
+            const DiskDependency* oldDependencies = static_cast<const DiskDependency*>(previous.dependencies);
+            bool unchanged = true;
+            for (uint32_t d = 0; d < old.dependencyCount && unchanged; d++) {
+                const DiskDependency& dependency = oldDependencies[old.dependencyBegin + d];
+                uint64_t hash = 0;
+                unchanged = previous.reader.checkString(dependency.path) && hashOf(previous.reader.getString(dependency.path), hash) && hash == dependency.hash;
+            }
+            if (unchanged) {
+                for (uint32_t d = 0; d < old.dependencyCount; d++) {
+                    const DiskDependency& dependency = oldDependencies[old.dependencyBegin + d];
+                    unit.dependencies.emplace_back(previous.reader.getString(dependency.path), dependency.hash);
+                }
+                for (uint32_t r = 0; r < old.recordCount; r++) {
+                    if (previous.validRecord(old.recordBegin + r)) {
+                        unit.entries.push_back(previous.entryAt(old.recordBegin + r));
+                    }
+                }
+                reused[i] = 1;
+                return;
+            }
+        }
+
+        TranslationUnitResult result = frontEnd.analyzeUnit(unit.path, i);
+        for (const auto& path : result.includedFiles) {
+            uint64_t hash = 0;
+            if (hashOf(path, hash)) {
+                unit.dependencies.emplace_back(path, hash);
+            }
+        }
+        for (const auto& symbol : result.symbols) {
+            IndexEntry entry;
+            entry.name = symbol.name;
+            entry.kind = symbol.kind;
+            entry.file = symbol.file;
+            entry.line = symbol.line;
+            entry.column = symbol.column;
+            entry.offset = symbol.offset;
+            unit.entries.push_back(std::move(entry));
+        }
+    });
+
+    // 写出新索引
+    BinaryWriter writer(sizeof(DiskHeader));
+    std::vector<DiskUnit> diskUnits;
+    std::vector<DiskDependency> diskDependencies;
+    std::vector<DiskRecord> diskRecords;
+    std::vector<const IndexEntry*> entries;
+    for (size_t i = 0; i < unitData.size(); i++) {
+        const UnitData& unit = unitData[i];
+        if (!unit.present) {
+            continue;
+        }
+        DiskUnit disk;
+        disk.path = writer.addString(unit.path);
+        disk.hash = unit.hash;
+        disk.dependencyBegin = static_cast<uint32_t>(diskDependencies.size());
+        disk.dependencyCount = static_cast<uint32_t>(unit.dependencies.size());
+        disk.recordBegin = static_cast<uint32_t>(diskRecords.size());
+        disk.recordCount = static_cast<uint32_t>(unit.entries.size());
+        for (const auto& dependency : unit.dependencies) {
+            diskDependencies.push_back({writer.addString(dependency.first), dependency.second});
+        }
+        for (const auto& entry : unit.entries) {
+            DiskRecord record;
+            record.name = writer.addString(entry.name);
+            record.file = writer.addString(entry.file);
+            record.kind = static_cast<uint32_t>(entry.kind);
+            record.line = entry.line;
+            record.column = entry.column;
+            record.reserved = 0;
+            record.offset = entry.offset;
+            diskRecords.push_back(record);
+            entries.push_back(&entry);
+        }
+        diskUnits.push_back(disk);
+        if (reused[i]) {
+            stats.reused++;
+        } else {
+            stats.reparsed++;
+        }
+    }
+
+    std::vector<uint32_t> sortedRecords(diskRecords.size());
+    for (size_t i = 0; i < sortedRecords.size(); i++) {
+        sortedRecords[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(sortedRecords.begin(), sortedRecords.end(), [&entries](uint32_t a, uint32_t b) {
+        int c = compareEntries(*entries[a], *entries[b]);
+        return c != 0 ? c < 0 : a < b;
+    });
+    stats.records = diskRecords.size();
+
+    DiskHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.sections[SECTION_UNITS] = writer.addSection(diskUnits);
+    header.sections[SECTION_DEPENDENCIES] = writer.addSection(diskDependencies);
+    header.sections[SECTION_RECORDS] = writer.addSection(diskRecords);
+    header.sections[SECTION_SORTED] = writer.addSection(sortedRecords);
+    header.sections[SECTION_STRINGS] = writer.addStringTable();
+    writer.setHeader(&header, sizeof(header));
+    return writer.writeAtomically(indexPath);
+}
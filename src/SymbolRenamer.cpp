@@ -0,0 +1,280 @@
+#include "../include/SymbolRenamer.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/SymbolIndex.h"
+#include "../include/SymbolCollector.h"
+#include "../include/ASTWalker.h"
+#include "../include/BinaryFormat.h"
+#include "../include/ThreadPool.h"
+#include "../include/Lexer.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <set>
+#include <mutex>
+#include <unordered_set>
+#include <cctype>
+
+namespace {
+
+std::string normalizePath(const std::string& path) {
+    return std::filesystem::absolute(path).lexically_normal().string();
+}
+
+bool readFile(const std::string& path, std::string& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    content = buffer.str();
+    return true;
+}
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool definesSymbol(SymbolKind kind) {
+    return kind == SymbolKind::FunctionDeclaration || kind == SymbolKind::FunctionDefinition ||
+           kind == SymbolKind::Variable;
+}
+
+std::string location(const std::string& file, int line, int column) {
+    return file + ":" + std::to_string(line) + ":" + std::to_string(column);
+}
+
+/**
+ * 一个翻译单元的改名结果
+ */
+struct UnitPlan {
+    std::vector<SymbolOccurrence> occurrences;  // 名字为旧名的全局符号出现
+    std::vector<std::string> conflicts;
+};
+
+} // namespace
+
+// SymbolRenamer类实现
+SymbolRenamer::SymbolRenamer(const ProjectAnalyzer& frontEnd, size_t threadCount)
+    : frontEnd(frontEnd), threadCount(threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount) {}
+
+bool SymbolRenamer::isIdentifier(const std::string& name) {
+    Lexer lexer(name);
+    std::vector<Token> tokens = lexer.tokenize();
+    return !lexer.hasErrors() && !tokens.empty() && tokens[0].type == TokenType::IDENTIFIER &&
+           tokens[0].value == name && (tokens.size() == 1 || tokens[1].type == TokenType::EOF_TOKEN);
+}
+
+bool SymbolRenamer::plan(const std::string& from, const std::string& to, const std::vector<std::string>& files,
+                         const SymbolIndex* index, RenameStats& stats) {
+    oldName = from;
+    newName = to;
+    edits.clear();
+    conflicts.clear();
+    warnings.clear();
+    stats = RenameStats();
+    stats.files = files.size();
+
+    if (!isIdentifier(to)) {
+        conflicts.push_back("'" + to + "' is not a valid identifier");
+        return false;
+    }
+    if (from == to) {
+        conflicts.push_back("old and new names are the same");
+        return false;
+    }
+
+    // 索引仍然有效、且没有出现过旧名的文件不需要改动
+    std::vector<char> candidate(files.size(), 1);
+    std::set<std::string> conflictSet;
+    if (index && index->isOpen()) {
+        std::vector<std::string> current = index->currentUnits();
+        std::unordered_set<std::string> upToDate(current.begin(), current.end());
+        std::vector<std::string> referencing = index->unitsReferencing(from);
+        std::unordered_set<std::string> mentioning(referencing.begin(), referencing.end());
+        for (size_t i = 0; i < files.size(); i++) {
+            std::string path = normalizePath(files[i]);
+            if (upToDate.count(path) && !mentioning.count(path)) {
+                candidate[i] = 0;
+                stats.skipped++;
+            }
+        }
+        for (const auto& entry : index->lookup(to)) {
+            if (definesSymbol(entry.kind)) {
+                conflictSet.insert("'" + to + "' already has a " + SymbolCollector::kindName(entry.kind) +
+                                   " at " + location(entry.file, entry.line, entry.column));
+            }
+        }
+    }
+
+    std::vector<UnitPlan> plans(files.size());
+    ThreadPool pool(std::min(threadCount, std::max<size_t>(1, files.size())));
+    pool.parallelFor(files.size(), [&](size_t i) {
+        if (!candidate[i]) {
+            return;
+        }
+        UnitPlan& unit = plans[i];
+        ParsedUnit parsed;
+        if (!frontEnd.parseUnit(files[i], parsed)) {
+            unit.conflicts.push_back("cannot read " + files[i]);
+            return;
+        }
+        if (!parsed.diagnostics.empty() || !parsed.program) {
+            // 语法树不完整时可能漏掉引用
+            unit.conflicts.push_back(files[i] + " has errors: " +
+                                     (parsed.diagnostics.empty() ? std::string("no syntax tree") : parsed.diagnostics.front()));
+            return;
+        }
+
+        std::vector<SymbolOccurrence> symbols = SymbolCollector::collect(*parsed.program, parsed.tokens, parsed.fileName);
+        for (auto& symbol : symbols) {
+            if (symbol.name == from) {
+                unit.occurrences.push_back(symbol);
+            } else if (symbol.name == to && definesSymbol(symbol.kind)) {
+                unit.conflicts.push_back("'" + to + "' already has a " + SymbolCollector::kindName(symbol.kind) +
+                                         " at " + location(symbol.file, symbol.line, symbol.column));
+            }
+        }
+
+        // 引用旧名的函数里若有同名于新名的局部变量或形参，改名后引用会被它遮蔽
+        for (const auto& statement : parsed.program->statements) {
+            if (!statement || statement->getKind() != ASTNodeKind::FunctionDefinition) {
+                continue;
+            }
+            const auto& function = static_cast<const FunctionDefinitionNode&>(*statement);
+            if (function.firstToken >= parsed.tokens.size() || function.lastToken >= parsed.tokens.size()) {
+                continue;
+            }
+            std::string file = parsed.fileName(function.fileId);
+            size_t begin = parsed.tokens[function.firstToken].offset;
+            size_t end = parsed.tokens[function.lastToken].offset;
+            bool referencesOld = std::any_of(symbols.begin(), symbols.end(), [&](const SymbolOccurrence& symbol) {
+                return symbol.name == from && !definesSymbol(symbol.kind) && symbol.file == file &&
+                       symbol.offset >= begin && symbol.offset <= end;
+            });
+            if (!referencesOld) {
+                continue;
+            }
+            walkAST(function, [&](const ASTNode& node) {
+                if (node.getKind() == ASTNodeKind::VarDeclaration &&
+                    static_cast<const VarDeclarationNode&>(node).identifier == to) {
+                    unit.conflicts.push_back("'" + to + "' would be shadowed by the local declared at " +
+                                             location(parsed.fileName(node.fileId), node.line, node.column) +
+                                             " in function " + function.name);
+                }
+                return true;
+            });
+        }
+    });
+
+    // 合并：同一头文件被多个单元包含时位置相同，只保留一次
+    bool global = false;
+    std::map<std::string, std::map<size_t, RenameLocation>> merged;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (candidate[i]) {
+            stats.analysed++;
+        }
+        for (const auto& conflict : plans[i].conflicts) {
+            conflictSet.insert(conflict);
+        }
+        for (const auto& symbol : plans[i].occurrences) {
+            global = global || definesSymbol(symbol.kind);
+            RenameLocation location;
+            location.line = symbol.line;
+            location.column = symbol.column;
+            location.offset = symbol.offset;
+            merged[normalizePath(symbol.file)].emplace(symbol.offset, location);
+        }
+    }
+    conflicts.assign(conflictSet.begin(), conflictSet.end());
+    if (!global && conflicts.empty()) {
+        conflicts.push_back("no global function or variable named '" + from + "'");
+    }
+
+    // 每个位置上必须确实写着旧名；宏展开产生的引用指向宏的使用处，不能在那里改名
+    for (const auto& file : merged) {
+        std::string content;
+        if (!readFile(file.first, content)) {
+            conflicts.push_back("cannot read " + file.first);
+            continue;
+        }
+        std::vector<RenameLocation> locations;
+        for (const auto& entry : file.second) {
+            const RenameLocation& location = entry.second;
+            size_t end = location.offset + from.size();
+            bool exact = end <= content.size() && content.compare(location.offset, from.size(), from) == 0 &&
+                         (location.offset == 0 || !isIdentifierChar(content[location.offset - 1])) &&
+                         (end == content.size() || !isIdentifierChar(content[end]));
+            if (exact) {
+                locations.push_back(location);
+            } else {
+                warnings.push_back("occurrence at " + ::location(file.first, location.line, location.column) +
+                                   " comes from a macro expansion and is not renamed");
+            }
+        }
+        if (!locations.empty()) {
+            edits.emplace(file.first, std::move(locations));
+        }
+    }
+    return conflicts.empty();
+}
+
+bool SymbolRenamer::applyEdits(std::string& content, const std::vector<RenameLocation>& locations,
+                               const std::string& from, const std::string& to) {
+    std::string result;
+    result.reserve(content.size() + locations.size() * (to.size() > from.size() ? to.size() - from.size() : 0));
+    size_t next = 0;
+    for (const auto& location : locations) {
+        if (location.offset < next || content.compare(location.offset, from.size(), from) != 0) {
+            return false;
+        }
+        result.append(content, next, location.offset - next);
+        result += to;
+        next = location.offset + from.size();
+    }
+    result.append(content, next, std::string::npos);
+    content = std::move(result);
+    return true;
+}
+
+bool SymbolRenamer::apply(std::vector<std::string>& failures) const {
+    std::vector<const std::pair<const std::string, std::vector<RenameLocation>>*> files;
+    for (const auto& file : edits) {
+        files.push_back(&file);
+    }
+    std::mutex failureMutex;
+    ThreadPool pool(std::min(threadCount, std::max<size_t>(1, files.size())));
+    pool.parallelFor(files.size(), [&](size_t i) {
+        const std::string& path = files[i]->first;
+        std::string content;
+        bool ok = readFile(path, content) && applyEdits(content, files[i]->second, oldName, newName) &&
+                  BinaryWriter::writeFileAtomically(path, content.data(), content.size());
+        if (!ok) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            failures.push_back(path);
+        }
+    });
+    std::sort(failures.begin(), failures.end());
+    return failures.empty();
+}
+
+const std::map<std::string, std::vector<RenameLocation>>& SymbolRenamer::getEdits() const {
+    return edits;
+}
+
+const std::vector<std::string>& SymbolRenamer::getConflicts() const {
+    return conflicts;
+}
+
+const std::vector<std::string>& SymbolRenamer::getWarnings() const {
+    return warnings;
+}
+
+size_t SymbolRenamer::getEditCount() const {
+    size_t count = 0;
+    for (const auto& file : edits) {
+        count += file.second.size();
+    }
+    return count;
+}
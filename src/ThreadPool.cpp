@@ -0,0 +1,140 @@
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+// ThreadPool类实现
+ThreadPool::ThreadPool(size_t threadCount) : pending(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;  // stopping且没有剩余任务
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            allDone.notify_all();
+        }
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+        pending++;
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || workers.size() == 1) {
+        for (size_t i = 0; i < count; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    // 每个线程反复领取一小块下标，耗时不均的任务也能保持负载均衡。
+    // 调用线程同样领取下标，只等待本次调用领取出的下标全部完成，因此可以在线程池的任务中嵌套调用；
+    // 下标分完后才开始的任务只访问共享的状态，随即结束。
+    // fn抛出的异常不能离开工作线程：记下第一个异常，其余下标不再执行但照常计数，等待结束后在调用线程重新抛出
+    struct Loop {
+        std::atomic<size_t> next{0};
+        size_t count = 0;
+        size_t chunk = 1;
+        const std::function<void(size_t)>* fn = nullptr;
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t remaining = 0;  // 尚未执行完的下标数
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;  // 第一个异常，由mutex保护
+    };
+    auto loop = std::make_shared<Loop>();
+    loop->count = count;
+    loop->chunk = std::max<size_t>(1, count / (workers.size() * 8));
+    loop->fn = &fn;
+    loop->remaining = count;
+    auto drain = [](Loop& state) {
+        while (true) {
+            size_t begin = state.next.fetch_add(state.chunk);
+            if (begin >= state.count) {
+                return;
+            }
+            size_t end = std::min(state.count, begin + state.chunk);
+            std::exception_ptr error;
+            try {
+                for (size_t i = begin; i < end && !state.failed.load(std::memory_order_relaxed); i++) {
+                    (*state.fn)(i);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (error && !state.error) {
+                state.error = error;
+                state.failed = true;
+            }
+            state.remaining -= end - begin;
+            if (state.remaining == 0) {
+                state.done.notify_all();
+            }
+        }
+    };
+    size_t blocks = (count + loop->chunk - 1) / loop->chunk;
+    size_t helpers = std::min(workers.size(), blocks - 1);
+    for (size_t t = 0; t < helpers; t++) {
+        submit([loop, drain] { drain(*loop); });
+    }
+    drain(*loop);
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->done.wait(lock, [&loop] { return loop->remaining == 0; });
+    if (loop->error) {
+        std::rethrow_exception(loop->error);
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
@@ -0,0 +1,104 @@
+#include "../include/TierManager.h"
+#include <algorithm>
+#include <chrono>
+
+// TierManager类实现
+TierManager::TierManager(const BytecodeModule& module, uint32_t callThreshold, uint32_t backEdgeThreshold,
+                         bool background)
+    : module(module), callThreshold(std::max<uint32_t>(callThreshold, 1)),
+      backEdgeThreshold(std::max<uint32_t>(backEdgeThreshold, 1)), background(background),
+      functions(module.functions.size()) {}
+
+const BytecodeFunction* TierManager::enter(int index) {
+    FunctionTier& tier = functions[index];
+    tier.calls++;
+    if (!tier.requested && tier.calls >= callThreshold) {
+        request(index, true);
+    }
+    const BytecodeFunction* optimized = tier.optimized.load(std::memory_order_acquire);
+    if (!optimized) {
+        return &module.functions[index];
+    }
+    if (tier.event.switchedAtCall == 0) {
+        tier.event.switchedAtCall = tier.calls;
+    }
+    tier.event.optimizedCalls++;
+    return optimized;
+}
+
+void TierManager::backEdge(int index, uint64_t count) {
+    FunctionTier& tier = functions[index];
+    tier.backEdges += count;
+    if (!tier.requested && tier.backEdges >= backEdgeThreshold) {
+        request(index, false);
+    }
+}
+
+void TierManager::request(int index, bool byCalls) {
+    FunctionTier& tier = functions[index];
+    tier.requested = true;
+    tier.event.function = index;
+    tier.event.byCalls = byCalls;
+    tier.event.calls = tier.calls;
+    tier.event.backEdges = tier.backEdges;
+    requests.push_back(index);
+    if (!background) {
+        compile(index);
+        return;
+    }
+    if (!compiler) {
+        compiler = std::make_unique<ThreadPool>(1);
+    }
+    compiler->submit([this, index] { compile(index); });
+}
+
+void TierManager::compile(int index) {
+    // 编译线程：只读取模块，只写入这个函数的version与优化结果
+    FunctionTier& tier = functions[index];
+    auto start = std::chrono::steady_clock::now();
+    auto version = std::make_unique<BytecodeFunction>(module.functions[index]);
+    LoopOptimizer optimizer(module);
+    optimizer.optimize(*version);
+    const LoopOptimizerStats& loops = optimizer.getStats();
+    tier.event.loops = loops;
+    tier.event.changed = loops.rotated + loops.reduced + loops.unrolled > 0;
+    tier.event.compileMs =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() /
+        1000.0;
+    if (tier.event.changed) {
+        tier.version = std::move(version);
+        tier.optimized.store(tier.version.get(), std::memory_order_release);
+    }
+}
+
+void TierManager::wait() {
+    if (compiler) {
+        compiler->wait();
+    }
+}
+
+TierStats TierManager::getStats() const {
+    TierStats stats;
+    for (int index : requests) {
+        const TierUp& event = functions[index].event;
+        stats.tierUps++;
+        (event.byCalls ? stats.byCalls : stats.byBackEdges)++;
+        (event.changed ? stats.optimized : stats.unchanged)++;
+        stats.switched += event.switchedAtCall > 0 ? 1 : 0;
+        stats.optimizedCalls += event.optimizedCalls;
+        stats.compileMs += event.compileMs;
+        stats.loops.rotated += event.loops.rotated;
+        stats.loops.reduced += event.loops.reduced;
+        stats.loops.unrolled += event.loops.unrolled;
+    }
+    return stats;
+}
+
+std::vector<TierUp> TierManager::getTierUps() const {
+    std::vector<TierUp> events;
+    events.reserve(requests.size());
+    for (int index : requests) {
+        events.push_back(functions[index].event);
+    }
+    return events;
+}
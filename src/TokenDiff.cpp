@@ -0,0 +1,394 @@
+#include "../include/TokenDiff.h"
+#include "../include/Lexer.h"
+#include "../include/ThreadPool.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+const ptrdiff_t NO_POSITION = std::numeric_limits<ptrdiff_t>::max();
+
+// 一次中间蛇形搜索的步数上限：编辑距离不超过它的区间一定得到最短编辑脚本，
+// 超过时改用启发式分割，使完全不同的大文件也能在近似线性的时间内完成
+const ptrdiff_t TOO_EXPENSIVE = 256;
+
+// 行号范围：起止行相同时只写一个
+std::string lineRange(int first, int last) {
+    return first == last ? std::to_string(first) : std::to_string(first) + "-" + std::to_string(last);
+}
+
+} // namespace
+
+// TokenDiff类实现
+bool TokenDiff::loadVersion(const std::string& path, Version& version) {
+    version = Version();
+    version.path = path;
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open()) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << input.rdbuf();
+    version.source = buffer.str();
+    version.loaded = true;
+
+    Lexer lexer(version.source);
+    std::vector<Token> tokens = lexer.tokenize();
+    version.tokens.reserve(tokens.size());
+    version.ids.reserve(tokens.size());
+    for (auto& token : tokens) {
+        if (token.type == TokenType::NEWLINE || token.type == TokenType::WHITESPACE ||
+            token.type == TokenType::EOF_TOKEN) {
+            continue;
+        }
+        // 关键字与运算符由种类唯一确定，只有标识符、字面量和无法识别的字符需要驻留取值
+        uint64_t id = static_cast<uint64_t>(token.type) << 32;
+        if (token.type == TokenType::IDENTIFIER || token.type == TokenType::INTEGER ||
+            token.type == TokenType::FLOAT || token.type == TokenType::STRING || token.type == TokenType::ERROR) {
+            id |= interner.intern(token.value);
+        }
+        version.ids.push_back(id);
+        version.tokens.push_back(std::move(token));
+    }
+    return true;
+}
+
+bool TokenDiff::compare(const std::string& oldPath, const std::string& newPath, TokenDiffStats& stats) {
+    stats = TokenDiffStats();
+    changes.clear();
+
+    // 两个版本并行地做词法分析，驻留表本身是线程安全的
+    ThreadPool pool(2);
+    pool.parallelFor(2, [&](size_t i) {
+        if (i == 0) {
+            loadVersion(oldPath, oldVersion);
+        } else {
+            loadVersion(newPath, newVersion);
+        }
+    });
+    if (!oldVersion.loaded || !newVersion.loaded) {
+        return false;
+    }
+
+    ptrdiff_t oldSize = static_cast<ptrdiff_t>(oldVersion.ids.size());
+    ptrdiff_t newSize = static_cast<ptrdiff_t>(newVersion.ids.size());
+    stats.oldTokens = oldVersion.ids.size();
+    stats.newTokens = newVersion.ids.size();
+    deleted.assign(oldVersion.ids.size(), 0);
+    inserted.assign(newVersion.ids.size(), 0);
+
+    // 对角线编号 k = x - y 的取值范围为 [-newSize-1, oldSize+1]
+    forward.assign(oldSize + newSize + 3, 0);
+    backward.assign(oldSize + newSize + 3, 0);
+    diagonalOffset = newSize + 1;
+
+    compareRange(0, oldSize, 0, newSize);
+    forward.clear();
+    forward.shrink_to_fit();
+    backward.clear();
+    backward.shrink_to_fit();
+
+    collectChanges();
+    stats.deleted = static_cast<size_t>(std::count(deleted.begin(), deleted.end(), 1));
+    stats.inserted = static_cast<size_t>(std::count(inserted.begin(), inserted.end(), 1));
+    return true;
+}
+
+void TokenDiff::compareRange(ptrdiff_t xoff, ptrdiff_t xlim, ptrdiff_t yoff, ptrdiff_t ylim) {
+    const uint64_t* xv = oldVersion.ids.data();
+    const uint64_t* yv = newVersion.ids.data();
+
+    // 去掉公共前缀与后缀
+    while (xoff < xlim && yoff < ylim && xv[xoff] == yv[yoff]) {
+        xoff++;
+        yoff++;
+    }
+    while (xoff < xlim && yoff < ylim && xv[xlim - 1] == yv[ylim - 1]) {
+        xlim--;
+        ylim--;
+    }
+
+    if (xoff == xlim) {
+        std::fill(inserted.begin() + yoff, inserted.begin() + ylim, 1);
+    } else if (yoff == ylim) {
+        std::fill(deleted.begin() + xoff, deleted.begin() + xlim, 1);
+    } else {
+        Partition middle = findMiddle(xoff, xlim, yoff, ylim);
+        compareRange(xoff, middle.x, yoff, middle.y);
+        compareRange(middle.x, xlim, middle.y, ylim);
+    }
+}
+
+TokenDiff::Partition TokenDiff::findMiddle(ptrdiff_t xoff, ptrdiff_t xlim, ptrdiff_t yoff, ptrdiff_t ylim) {
+    const uint64_t* xv = oldVersion.ids.data();
+    const uint64_t* yv = newVersion.ids.data();
+    ptrdiff_t* fd = forward.data() + diagonalOffset;
+    ptrdiff_t* bd = backward.data() + diagonalOffset;
+
+    const ptrdiff_t dmin = xoff - ylim;  // 有效对角线的范围
+    const ptrdiff_t dmax = xlim - yoff;
+    const ptrdiff_t fmid = xoff - yoff;  // 正向搜索的起始对角线
+    const ptrdiff_t bmid = xlim - ylim;  // 反向搜索的起始对角线
+    ptrdiff_t fmin = fmid;
+    ptrdiff_t fmax = fmid;
+    ptrdiff_t bmin = bmid;
+    ptrdiff_t bmax = bmid;
+    const bool odd = ((fmid - bmid) & 1) != 0;
+    fd[fmid] = xoff;
+    bd[bmid] = xlim;
+
+    Partition middle;
+    for (ptrdiff_t cost = 1;; cost++) {
+        // 正向搜索每条对角线前进一步
+        if (fmin > dmin) {
+            fd[--fmin - 1] = -1;
+        } else {
+            ++fmin;
+        }
+        if (fmax < dmax) {
+            fd[++fmax + 1] = -1;
+        } else {
+            --fmax;
+        }
+        for (ptrdiff_t d = fmax; d >= fmin; d -= 2) {
+            ptrdiff_t tlo = fd[d - 1];
+            ptrdiff_t thi = fd[d + 1];
+            ptrdiff_t x = tlo < thi ? thi : tlo + 1;
+            ptrdiff_t y = x - d;
+            while (x < xlim && y < ylim && xv[x] == yv[y]) {
+                x++;
+                y++;
+            }
+            fd[d] = x;
+            if (odd && bmin <= d && d <= bmax && bd[d] <= x) {
+                middle.x = x;
+                middle.y = y;
+                return middle;
+            }
+        }
+
+        // 反向搜索同样前进一步
+        if (bmin > dmin) {
+            bd[--bmin - 1] = NO_POSITION;
+        } else {
+            ++bmin;
+        }
+        if (bmax < dmax) {
+            bd[++bmax + 1] = NO_POSITION;
+        } else {
+            --bmax;
+        }
+        for (ptrdiff_t d = bmax; d >= bmin; d -= 2) {
+            ptrdiff_t tlo = bd[d - 1];
+            ptrdiff_t thi = bd[d + 1];
+            ptrdiff_t x = tlo < thi ? tlo : thi - 1;
+            ptrdiff_t y = x - d;
+            while (xoff < x && yoff < y && xv[x - 1] == yv[y - 1]) {
+                x--;
+                y--;
+            }
+            bd[d] = x;
+            if (!odd && fmin <= d && d <= fmax && x <= fd[d]) {
+                middle.x = x;
+                middle.y = y;
+                return middle;
+            }
+        }
+
+        if (cost < TOO_EXPENSIVE) {
+            continue;
+        }
+
+        // 代价过高：取两个方向中走得最远的位置作为分割点
+        ptrdiff_t forwardBest = -1;
+        ptrdiff_t forwardX = xoff;
+        for (ptrdiff_t d = fmax; d >= fmin; d -= 2) {
+            ptrdiff_t x = std::min(fd[d], xlim);
+            ptrdiff_t y = x - d;
+            if (ylim < y) {
+                x = ylim + d;
+                y = ylim;
+            }
+            if (forwardBest < x + y) {
+                forwardBest = x + y;
+                forwardX = x;
+            }
+        }
+        ptrdiff_t backwardBest = NO_POSITION;
+        ptrdiff_t backwardX = xlim;
+        for (ptrdiff_t d = bmax; d >= bmin; d -= 2) {
+            ptrdiff_t x = std::max(xoff, bd[d]);
+            ptrdiff_t y = x - d;
+            if (y < yoff) {
+                x = yoff + d;
+                y = yoff;
+            }
+            if (x + y < backwardBest) {
+                backwardBest = x + y;
+                backwardX = x;
+            }
+        }
+        if ((xlim + ylim) - backwardBest < forwardBest - (xoff + yoff)) {
+            middle.x = forwardX;
+            middle.y = forwardBest - forwardX;
+        } else {
+            middle.x = backwardX;
+            middle.y = backwardBest - backwardX;
+        }
+        return middle;
+    }
+}
+
+void TokenDiff::collectChanges() {
+    size_t i = 0;
+    size_t j = 0;
+    while (i < deleted.size() || j < inserted.size()) {
+        bool removing = i < deleted.size() && deleted[i];
+        bool adding = j < inserted.size() && inserted[j];
+        if (!removing && !adding) {
+            i++;
+            j++;
+            continue;
+        }
+        TokenChange change;
+        change.oldBegin = i;
+        change.newBegin = j;
+        while (i < deleted.size() && deleted[i]) {
+            i++;
+        }
+        while (j < inserted.size() && inserted[j]) {
+            j++;
+        }
+        change.oldEnd = i;
+        change.newEnd = j;
+        changes.push_back(change);
+    }
+}
+
+const std::vector<TokenChange>& TokenDiff::getChanges() const {
+    return changes;
+}
+
+std::string TokenDiff::tokenText(const Version& version, size_t index) const {
+    const Token& token = version.tokens[index];
+    const std::string& source = version.source;
+    if (token.type == TokenType::STRING) {
+        // 字符串的取值已去掉引号并处理了转义，按原文找到结束引号
+        if (token.offset < source.size() && (source[token.offset] == '"' || source[token.offset] == '\'')) {
+            char quote = source[token.offset];
+            size_t end = token.offset + 1;
+            while (end < source.size() && source[end] != quote && source[end] != '\n') {
+                end += source[end] == '\\' ? 2 : 1;
+            }
+            return source.substr(token.offset, std::min(end + 1, source.size()) - token.offset);
+        }
+        return "\"" + token.value + "\"";
+    }
+    return token.value;
+}
+
+std::string TokenDiff::rangeText(const Version& version, size_t begin, size_t end) const {
+    std::string text;
+    for (size_t i = begin; i < end; i++) {
+        if (i > begin) {
+            text += ' ';
+        }
+        text += tokenText(version, i);
+    }
+    return text;
+}
+
+void TokenDiff::printReport(std::ostream& os, const TokenDiffStats& stats, size_t context) const {
+    os << "\n=== Token Diff ===" << std::endl;
+    os << "--- " << oldVersion.path << " (" << stats.oldTokens << " tokens)" << std::endl;
+    os << "+++ " << newVersion.path << " (" << stats.newTokens << " tokens)" << std::endl;
+    if (changes.empty()) {
+        os << "✓ Token streams are identical." << std::endl;
+        return;
+    }
+
+    // 某个版本中位置 index 处的行号；区间为空时取相邻token的行
+    auto lineAt = [](const Version& version, size_t index) {
+        if (version.tokens.empty()) {
+            return 1;
+        }
+        return version.tokens[std::min(index, version.tokens.size() - 1)].line;
+    };
+
+    size_t hunks = 0;
+    size_t first = 0;
+    while (first < changes.size()) {
+        // 相距不超过 2*context 个相同token的改动合并为一段
+        size_t last = first;
+        while (last + 1 < changes.size() && changes[last + 1].oldBegin - changes[last].oldEnd <= 2 * context) {
+            last++;
+        }
+        const TokenChange& head = changes[first];
+        const TokenChange& tail = changes[last];
+        size_t before = std::min(context, head.oldBegin);
+        size_t after = std::min(context, oldVersion.tokens.size() - tail.oldEnd);
+        size_t oldBegin = head.oldBegin - before;
+        size_t oldEnd = tail.oldEnd + after;
+        size_t newBegin = head.newBegin - before;
+        size_t newEnd = tail.newEnd + after;
+        hunks++;
+
+        os << "@@ old ";
+        if (oldBegin < oldEnd) {
+            os << lineRange(oldVersion.tokens[oldBegin].line, oldVersion.tokens[oldEnd - 1].line);
+        } else {
+            os << lineAt(oldVersion, oldBegin) << " (empty)";
+        }
+        os << ", new ";
+        if (newBegin < newEnd) {
+            os << lineRange(newVersion.tokens[newBegin].line, newVersion.tokens[newEnd - 1].line);
+        } else {
+            os << lineAt(newVersion, newBegin) << " (empty)";
+        }
+        os << " @@" << std::endl;
+
+        // 按新版本的行分行输出；删除的token跟在它所在位置的行上
+        int currentLine = -1;
+        bool lineStarted = false;
+        auto startLine = [&](int line) {
+            if (line != currentLine || !lineStarted) {
+                if (lineStarted) {
+                    os << std::endl;
+                }
+                os << "  " << line << " | ";
+                currentLine = line;
+                lineStarted = true;
+            } else {
+                os << ' ';
+            }
+        };
+        auto equalRange = [&](size_t newFrom, size_t newTo) {
+            for (size_t j = newFrom; j < newTo; j++) {
+                startLine(newVersion.tokens[j].line);
+                os << tokenText(newVersion, j);
+            }
+        };
+
+        size_t newPosition = newBegin;
+        for (size_t c = first; c <= last; c++) {
+            const TokenChange& change = changes[c];
+            equalRange(newPosition, change.newBegin);
+            if (change.oldBegin < change.oldEnd) {
+                startLine(lineStarted ? currentLine : lineAt(newVersion, change.newBegin));
+                os << "[-" << rangeText(oldVersion, change.oldBegin, change.oldEnd) << "-]";
+            }
+            if (change.newBegin < change.newEnd) {
+                startLine(newVersion.tokens[change.newBegin].line);
+                os << "{+" << rangeText(newVersion, change.newBegin, change.newEnd) << "+}";
+            }
+            newPosition = change.newEnd;
+        }
+        equalRange(newPosition, newEnd);
+        os << std::endl;
+        first = last + 1;
+    }
+    os << hunks << " hunk(s), " << changes.size() << " change(s): " << stats.deleted << " token(s) deleted, "
+       << stats.inserted << " token(s) inserted." << std::endl;
+}
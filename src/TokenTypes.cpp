@@ -1,10 +1,13 @@
 #include "../include/TokenTypes.h"
 
 // Token类实现
-Token::Token() : type(TokenType::EOF_TOKEN), value(""), line(0), column(0) {}
+Token::Token()
+    : type(TokenType::EOF_TOKEN), value(""), line(0), column(0), fileId(0),
+      originLine(0), originColumn(0), offset(0) {}
 
 Token::Token(TokenType type, const std::string& value, int line, int column)
-    : type(type), value(value), line(line), column(column) {}
+    : type(type), value(value), line(line), column(column), fileId(0),
+      originLine(0), originColumn(0), offset(0) {}
 
 std::string Token::toString() const {
     return TokenTypeUtils::tokenTypeToString(type) + "(" + value + ") at " 
@@ -91,6 +94,8 @@ std::string TokenTypeUtils::tokenTypeToString(TokenType type) {
         case TokenType::RBRACE: return "RBRACE";
         case TokenType::LANGLE: return "LANGLE";
         case TokenType::RANGLE: return "RANGLE";
+        case TokenType::LBRACKET: return "LBRACKET";
+        case TokenType::RBRACKET: return "RBRACKET";
         case TokenType::HASH: return "HASH";
         case TokenType::INCLUDE: return "INCLUDE";
         case TokenType::DEFINE: return "DEFINE";
@@ -0,0 +1,1123 @@
+#include "../include/TraceJit.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define TRACE_JIT_NATIVE 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t MAX_TRACE_LENGTH = 512;     // 录制的最多操作数
+const uint32_t MAX_RECORD_ATTEMPTS = 3;  // 同一循环放弃录制几次后不再尝试
+
+// 机器码入口：registers为帧，返回出口下标，iterations为完成的迭代次数
+using TraceEntry = int32_t (*)(Value* registers, Value* globals, uint64_t* iterations);
+
+// 与解释器相同的整数回绕与浮点转整数
+inline int64_t wrapAdd(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+inline int64_t wrapSub(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+inline int64_t wrapMul(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+inline int64_t toInteger(double value) {
+    if (std::isnan(value)) {
+        return 0;
+    }
+    if (value >= 9.2233720368547758e18) {
+        return INT64_MAX;
+    }
+    if (value <= -9.2233720368547758e18) {
+        return INT64_MIN;
+    }
+    return static_cast<int64_t>(value);
+}
+
+// 只读写寄存器、不会出错的指令（DIV/MOD的除数不为0）
+bool isPure(Opcode op) {
+    switch (op) {
+        case Opcode::LOADI: case Opcode::MOVE: case Opcode::ADD: case Opcode::SUB: case Opcode::MUL:
+        case Opcode::DIV: case Opcode::MOD: case Opcode::ADDK: case Opcode::NEG: case Opcode::NOT:
+        case Opcode::FADD: case Opcode::FSUB: case Opcode::FMUL: case Opcode::FDIV: case Opcode::FNEG:
+        case Opcode::I2F: case Opcode::F2I: case Opcode::LT: case Opcode::LE: case Opcode::EQ: case Opcode::NE:
+        case Opcode::FLT: case Opcode::FLE: case Opcode::FEQ: case Opcode::FNE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Value evaluate(Opcode op, int32_t b, int32_t c, Value x, Value y) {
+    Value result;
+    result.i = 0;
+    switch (op) {
+        case Opcode::LOADI: result.i = b; break;
+        case Opcode::MOVE: result = x; break;
+        case Opcode::ADD: result.i = wrapAdd(x.i, y.i); break;
+        case Opcode::SUB: result.i = wrapSub(x.i, y.i); break;
+        case Opcode::MUL: result.i = wrapMul(x.i, y.i); break;
+        case Opcode::DIV: result.i = y.i == -1 ? wrapSub(0, x.i) : x.i / y.i; break;
+        case Opcode::MOD: result.i = y.i == -1 ? 0 : x.i % y.i; break;
+        case Opcode::ADDK: result.i = wrapAdd(x.i, c); break;
+        case Opcode::NEG: result.i = wrapSub(0, x.i); break;
+        case Opcode::NOT: result.i = x.i == 0; break;
+        case Opcode::FADD: result.f = x.f + y.f; break;
+        case Opcode::FSUB: result.f = x.f - y.f; break;
+        case Opcode::FMUL: result.f = x.f * y.f; break;
+        case Opcode::FDIV: result.f = x.f / y.f; break;
+        case Opcode::FNEG: result.f = -x.f; break;
+        case Opcode::I2F: result.f = static_cast<double>(x.i); break;
+        case Opcode::F2I: result.i = toInteger(x.f); break;
+        case Opcode::LT: result.i = x.i < y.i; break;
+        case Opcode::LE: result.i = x.i <= y.i; break;
+        case Opcode::EQ: result.i = x.i == y.i; break;
+        case Opcode::NE: result.i = x.i != y.i; break;
+        case Opcode::FLT: result.i = x.f < y.f; break;
+        case Opcode::FLE: result.i = x.f <= y.f; break;
+        case Opcode::FEQ: result.i = x.f == y.f; break;
+        case Opcode::FNE: result.i = x.f != y.f; break;
+        default: break;
+    }
+    return result;
+}
+
+bool isConditional(Opcode op) {
+    return op == Opcode::JZ || op == Opcode::JNZ || op == Opcode::JLT || op == Opcode::JLE || op == Opcode::JEQ ||
+           op == Opcode::JNE;
+}
+
+bool condition(Opcode op, Value x, Value y) {
+    switch (op) {
+        case Opcode::JZ: return x.i == 0;
+        case Opcode::JNZ: return x.i != 0;
+        case Opcode::JLT: return x.i < y.i;
+        case Opcode::JLE: return x.i <= y.i;
+        case Opcode::JEQ: return x.i == y.i;
+        case Opcode::JNE: return x.i != y.i;
+        default: return false;
+    }
+}
+
+int32_t branchTarget(const TraceOp& op) {
+    return op.op == Opcode::JZ || op.op == Opcode::JNZ ? op.b : op.c;
+}
+
+// 操作数slot是否为被读取的寄存器
+bool reads(const TraceOp& op, int slot) {
+    if (operandKind(op.op, slot) != OperandKind::Register) {
+        return false;
+    }
+    return slot > 0 || isConditional(op.op) || op.op == Opcode::STOREELEM || op.op == Opcode::STOREELEM_U;
+}
+
+// 写入的寄存器，没有时返回-1
+int32_t written(const TraceOp& op) {
+    return operandKind(op.op, 0) == OperandKind::Register && !reads(op, 0) ? op.a : -1;
+}
+
+/**
+ * 守卫成立的事实，用于冗余守卫消除
+ * 比较统一为 x < y、x <= y、x == y、x != y；Bounds为 0 <= y < x的长度
+ */
+enum class FactKind { Less, LessEqual, Equal, NotEqual, Zero, NonZero, Bounds };
+
+struct Fact {
+    FactKind kind;
+    int32_t x;
+    int32_t y;
+
+    bool operator==(const Fact& other) const {
+        return kind == other.kind && x == other.x && y == other.y;
+    }
+};
+
+bool guardFact(const TraceOp& op, Fact& fact) {
+    if (op.exit < 0) {
+        return false;
+    }
+    bool taken = op.taken;
+    switch (op.op) {
+        case Opcode::JZ: fact = {taken ? FactKind::Zero : FactKind::NonZero, op.a, 0}; return true;
+        case Opcode::JNZ: fact = {taken ? FactKind::NonZero : FactKind::Zero, op.a, 0}; return true;
+        case Opcode::JLT: fact = taken ? Fact{FactKind::Less, op.a, op.b} : Fact{FactKind::LessEqual, op.b, op.a}; return true;
+        case Opcode::JLE: fact = taken ? Fact{FactKind::LessEqual, op.a, op.b} : Fact{FactKind::Less, op.b, op.a}; return true;
+        case Opcode::JEQ:
+        case Opcode::JNE: {
+            bool equal = (op.op == Opcode::JEQ) == taken;
+            fact = {equal ? FactKind::Equal : FactKind::NotEqual, std::min(op.a, op.b), std::max(op.a, op.b)};
+            return true;
+        }
+        case Opcode::DIV:
+        case Opcode::MOD: fact = {FactKind::NonZero, op.c, 0}; return true;
+        case Opcode::LOADELEM: fact = {FactKind::Bounds, op.b, op.c}; return true;
+        case Opcode::STOREELEM: fact = {FactKind::Bounds, op.a, op.b}; return true;
+        default: return false;
+    }
+}
+
+void removeGuard(TraceOp& op) {
+    if (isConditional(op.op)) {
+        op.op = Opcode::NOP;
+    }
+    op.exit = -1;
+}
+
+/**
+ * x86-64机器码的字节缓冲区，只含轨迹用到的指令形式
+ * 内存操作数一律为 [base + disp32]（base不为rsp/r12），数组元素为 [base + index*8]（base不为rbp/r13）
+ */
+enum Reg { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R11 = 11, R12 = 12, R13 = 13, R14 = 14 };
+
+enum Condition : uint8_t { CC_E = 0x4, CC_NE = 0x5, CC_AE = 0x3, CC_A = 0x7, CC_P = 0xA, CC_NP = 0xB,
+                           CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+class Assembler {
+private:
+    std::vector<uint8_t> code;
+
+    void rex(bool wide, int reg, int index, int base) {
+        uint8_t prefix = static_cast<uint8_t>(0x40 | (wide ? 8 : 0) | ((reg & 8) >> 1) | ((index & 8) >> 2) |
+                                              ((base & 8) >> 3));
+        if (prefix != 0x40) {
+            emit(prefix);
+        }
+    }
+
+    void memory(int reg, int base, int32_t displacement) {
+        emit(static_cast<uint8_t>(0x80 | ((reg & 7) << 3) | (base & 7)));
+        emit32(displacement);
+    }
+
+    void direct(int reg, int rm) {
+        emit(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+    }
+
+public:
+    const std::vector<uint8_t>& bytes() const {
+        return code;
+    }
+
+    size_t size() const {
+        return code.size();
+    }
+
+    void emit(uint8_t byte) {
+        code.push_back(byte);
+    }
+
+    void emit32(int32_t value) {
+        for (int i = 0; i < 4; i++) {
+            emit(static_cast<uint8_t>(static_cast<uint32_t>(value) >> (8 * i)));
+        }
+    }
+
+    void emit64(int64_t value) {
+        for (int i = 0; i < 8; i++) {
+            emit(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+        }
+    }
+
+    void load(int reg, int base, int32_t displacement) {  // mov reg, [base+disp]
+        rex(true, reg, 0, base);
+        emit(0x8B);
+        memory(reg, base, displacement);
+    }
+
+    void store(int base, int32_t displacement, int reg) {  // mov [base+disp], reg
+        rex(true, reg, 0, base);
+        emit(0x89);
+        memory(reg, base, displacement);
+    }
+
+    void lea(int reg, int base, int32_t displacement) {
+        rex(true, reg, 0, base);
+        emit(0x8D);
+        memory(reg, base, displacement);
+    }
+
+    void move(int destination, int source) {
+        rex(true, source, 0, destination);
+        emit(0x89);
+        direct(source, destination);
+    }
+
+    void moveImmediate(int reg, int64_t value) {
+        if (value >= INT32_MIN && value <= INT32_MAX) {
+            rex(true, 0, 0, reg);
+            emit(0xC7);
+            direct(0, reg);
+            emit32(static_cast<int32_t>(value));
+        } else {
+            rex(true, 0, 0, reg);
+            emit(static_cast<uint8_t>(0xB8 + (reg & 7)));
+            emit64(value);
+        }
+    }
+
+    // add/sub/cmp/test等 r/m64, r64 形式：0x01 add、0x29 sub、0x39 cmp、0x85 test
+    void arithmetic(uint8_t opcode, int destination, int source) {
+        rex(true, source, 0, destination);
+        emit(opcode);
+        direct(source, destination);
+    }
+
+    void multiply(int destination, int source) {  // imul destination, source
+        rex(true, destination, 0, source);
+        emit(0x0F);
+        emit(0xAF);
+        direct(destination, source);
+    }
+
+    void unary(int extension, int reg) {  // F7 /extension：3 neg、7 idiv
+        rex(true, 0, 0, reg);
+        emit(0xF7);
+        direct(extension, reg);
+    }
+
+    void signExtend() {  // cqo
+        emit(0x48);
+        emit(0x99);
+    }
+
+    void setCondition(uint8_t condition, int reg) {  // 只用于al、cl
+        emit(0x0F);
+        emit(static_cast<uint8_t>(0x90 + condition));
+        direct(0, reg);
+    }
+
+    void zeroExtend(int reg) {  // movzx reg32, reg8
+        emit(0x0F);
+        emit(0xB6);
+        direct(reg, reg);
+    }
+
+    void byteOperation(uint8_t opcode, int destination, int source) {  // 0x20 and、0x08 or
+        emit(opcode);
+        direct(source, destination);
+    }
+
+    void flipSign(int reg) {  // btc reg, 63
+        rex(true, 0, 0, reg);
+        emit(0x0F);
+        emit(0xBA);
+        direct(7, reg);
+        emit(63);
+    }
+
+    void increment(int reg) {
+        rex(true, 0, 0, reg);
+        emit(0xFF);
+        direct(0, reg);
+    }
+
+    void element(uint8_t opcode, int reg, int base, int index) {  // 0x8B读、0x89写 [base + index*8]
+        rex(true, reg, index, base);
+        emit(opcode);
+        emit(static_cast<uint8_t>(((reg & 7) << 3) | 4));
+        emit(static_cast<uint8_t>(0xC0 | ((index & 7) << 3) | (base & 7)));
+    }
+
+    void compareLength(int index, int array) {  // cmp index, [array-8]
+        rex(true, index, 0, array);
+        emit(0x3B);
+        emit(static_cast<uint8_t>(0x40 | ((index & 7) << 3) | (array & 7)));
+        emit(0xF8);
+    }
+
+    void loadDouble(int xmm, int base, int32_t displacement) {  // movsd xmm, [base+disp]
+        emit(0xF2);
+        rex(false, xmm, 0, base);
+        emit(0x0F);
+        emit(0x10);
+        memory(xmm, base, displacement);
+    }
+
+    void storeDouble(int base, int32_t displacement, int xmm) {
+        emit(0xF2);
+        rex(false, xmm, 0, base);
+        emit(0x0F);
+        emit(0x11);
+        memory(xmm, base, displacement);
+    }
+
+    void doubleFromBits(int xmm, int reg) {  // movq xmm, reg
+        emit(0x66);
+        rex(true, xmm, 0, reg);
+        emit(0x0F);
+        emit(0x6E);
+        direct(xmm, reg);
+    }
+
+    // F2 0F xx：0x58 addsd、0x59 mulsd、0x5C subsd、0x5E divsd
+    void doubleArithmetic(uint8_t opcode, int destination, int source) {
+        emit(0xF2);
+        emit(0x0F);
+        emit(opcode);
+        direct(destination, source);
+    }
+
+    void compareDouble(int left, int right) {  // ucomisd left, right
+        emit(0x66);
+        emit(0x0F);
+        emit(0x2E);
+        direct(left, right);
+    }
+
+    void integerToDouble(int xmm, int reg) {  // cvtsi2sd xmm, reg
+        emit(0xF2);
+        rex(true, xmm, 0, reg);
+        emit(0x0F);
+        emit(0x2A);
+        direct(xmm, reg);
+    }
+
+    void doubleToInteger(int reg, int xmm) {  // cvttsd2si reg, xmm
+        emit(0xF2);
+        rex(true, reg, 0, xmm);
+        emit(0x0F);
+        emit(0x2C);
+        direct(reg, xmm);
+    }
+
+    void push(int reg) {
+        rex(false, 0, 0, reg);
+        emit(static_cast<uint8_t>(0x50 + (reg & 7)));
+    }
+
+    void pop(int reg) {
+        rex(false, 0, 0, reg);
+        emit(static_cast<uint8_t>(0x58 + (reg & 7)));
+    }
+
+    // 条件跳转与无条件跳转，返回待回填的rel32的位置
+    size_t jumpIf(uint8_t condition) {
+        emit(0x0F);
+        emit(static_cast<uint8_t>(0x80 + condition));
+        emit32(0);
+        return size() - 4;
+    }
+
+    size_t jump() {
+        emit(0xE9);
+        emit32(0);
+        return size() - 4;
+    }
+
+    void bind(size_t at, size_t target) {
+        int32_t relative = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(at + 4));
+        std::memcpy(&code[at], &relative, sizeof(relative));
+    }
+};
+
+} // namespace
+
+/**
+ * 一段可执行内存：先以可写方式映射并复制机器码，再改为只读可执行
+ */
+class ExecutableCode {
+private:
+    void* memory = nullptr;
+    size_t length = 0;
+
+public:
+    static std::unique_ptr<ExecutableCode> create(const std::vector<uint8_t>& bytes) {
+#ifdef TRACE_JIT_NATIVE
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t length = (bytes.size() + page - 1) / page * page;
+        void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            return nullptr;
+        }
+        std::memcpy(memory, bytes.data(), bytes.size());
+        if (mprotect(memory, length, PROT_READ | PROT_EXEC) != 0) {
+            munmap(memory, length);
+            return nullptr;
+        }
+        auto code = std::make_unique<ExecutableCode>();
+        code->memory = memory;
+        code->length = length;
+        return code;
+#else
+        (void)bytes;
+        return nullptr;
+#endif
+    }
+
+    ~ExecutableCode() {
+#ifdef TRACE_JIT_NATIVE
+        if (memory) {
+            munmap(memory, length);
+        }
+#endif
+    }
+
+    TraceEntry entry() const {
+        return reinterpret_cast<TraceEntry>(memory);
+    }
+};
+
+namespace {
+
+int32_t slotOffset(int32_t reg) {
+    return reg * static_cast<int32_t>(sizeof(Value));
+}
+
+void loadInteger(Assembler& as, int reg, const TraceOp& op, int slot, int32_t source) {
+    if (op.known[slot]) {
+        as.moveImmediate(reg, op.value[slot].i);
+    } else {
+        as.load(reg, RBX, slotOffset(source));
+    }
+}
+
+void loadDouble(Assembler& as, int xmm, const TraceOp& op, int slot, int32_t source) {
+    if (op.known[slot]) {
+        as.moveImmediate(R11, op.value[slot].i);
+        as.doubleFromBits(xmm, R11);
+    } else {
+        as.loadDouble(xmm, RBX, slotOffset(source));
+    }
+}
+
+/**
+ * 生成轨迹的机器码
+ * 入口保存rbx、r12～r14，r12计数完成的迭代；每个出口一段 mov eax, 出口下标 后跳到公共的返回代码。
+ */
+std::vector<uint8_t> generate(const Trace& trace) {
+    Assembler as;
+    as.push(RBX);
+    as.push(R12);
+    as.push(R13);
+    as.push(R14);
+    as.move(RBX, RDI);
+    as.move(R13, RSI);
+    as.move(R14, RDX);
+    as.moveImmediate(R12, 0);
+
+    std::vector<std::vector<size_t>> exitJumps(trace.exits.size());
+    auto guard = [&](uint8_t failure, int32_t exit) {
+        exitJumps[static_cast<size_t>(exit)].push_back(as.jumpIf(failure));
+    };
+
+    size_t top = as.size();
+    for (const auto& op : trace.ops) {
+        switch (op.op) {
+            case Opcode::LOADI:
+                as.moveImmediate(RAX, op.value[1].i);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::MOVE:
+                loadInteger(as, RAX, op, 1, op.b);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::ADD:
+            case Opcode::SUB:
+            case Opcode::MUL:
+                loadInteger(as, RAX, op, 1, op.b);
+                loadInteger(as, RCX, op, 2, op.c);
+                if (op.op == Opcode::MUL) {
+                    as.multiply(RAX, RCX);
+                } else {
+                    as.arithmetic(op.op == Opcode::ADD ? 0x01 : 0x29, RAX, RCX);
+                }
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::ADDK:
+                loadInteger(as, RAX, op, 1, op.b);
+                as.moveImmediate(RCX, op.c);
+                as.arithmetic(0x01, RAX, RCX);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::DIV:
+            case Opcode::MOD: {
+                loadInteger(as, RCX, op, 2, op.c);
+                if (op.exit >= 0) {
+                    as.arithmetic(0x85, RCX, RCX);
+                    guard(CC_E, op.exit);
+                }
+                loadInteger(as, RAX, op, 1, op.b);
+                // 除数为-1时 INT64_MIN / -1 会触发硬件异常，按解释器的结果单独处理
+                as.moveImmediate(RDX, -1);
+                as.arithmetic(0x39, RCX, RDX);
+                size_t general = as.jumpIf(CC_NE);
+                if (op.op == Opcode::DIV) {
+                    as.unary(3, RAX);
+                } else {
+                    as.moveImmediate(RAX, 0);
+                }
+                size_t done = as.jump();
+                as.bind(general, as.size());
+                as.signExtend();
+                as.unary(7, RCX);
+                if (op.op == Opcode::MOD) {
+                    as.move(RAX, RDX);
+                }
+                as.bind(done, as.size());
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            }
+            case Opcode::NEG:
+                loadInteger(as, RAX, op, 1, op.b);
+                as.unary(3, RAX);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::NOT:
+                loadInteger(as, RAX, op, 1, op.b);
+                as.arithmetic(0x85, RAX, RAX);
+                as.setCondition(CC_E, RAX);
+                as.zeroExtend(RAX);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::FADD:
+            case Opcode::FSUB:
+            case Opcode::FMUL:
+            case Opcode::FDIV: {
+                static const uint8_t opcodes[] = {0x58, 0x5C, 0x59, 0x5E};
+                loadDouble(as, 0, op, 1, op.b);
+                loadDouble(as, 1, op, 2, op.c);
+                as.doubleArithmetic(opcodes[static_cast<int>(op.op) - static_cast<int>(Opcode::FADD)], 0, 1);
+                as.storeDouble(RBX, slotOffset(op.a), 0);
+                break;
+            }
+            case Opcode::FNEG:
+                loadInteger(as, RAX, op, 1, op.b);
+                as.flipSign(RAX);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::I2F:
+                loadInteger(as, RAX, op, 1, op.b);
+                as.integerToDouble(0, RAX);
+                as.storeDouble(RBX, slotOffset(op.a), 0);
+                break;
+            case Opcode::F2I:
+                // 越界与NaN时cvttsd2si得到INT64_MIN，交给解释器按饱和规则转换
+                loadDouble(as, 0, op, 1, op.b);
+                as.doubleToInteger(RAX, 0);
+                as.moveImmediate(RCX, INT64_MIN);
+                as.arithmetic(0x39, RAX, RCX);
+                guard(CC_E, op.exit);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::LT:
+            case Opcode::LE:
+            case Opcode::EQ:
+            case Opcode::NE: {
+                static const uint8_t conditions[] = {CC_L, CC_LE, CC_E, CC_NE};
+                loadInteger(as, RAX, op, 1, op.b);
+                loadInteger(as, RCX, op, 2, op.c);
+                as.arithmetic(0x39, RAX, RCX);
+                as.setCondition(conditions[static_cast<int>(op.op) - static_cast<int>(Opcode::LT)], RAX);
+                as.zeroExtend(RAX);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            }
+            case Opcode::FLT:
+            case Opcode::FLE:
+                // 无序（NaN）时CF=1，a < b 即 b > a 用seta，a <= b 用setae
+                loadDouble(as, 0, op, 1, op.b);
+                loadDouble(as, 1, op, 2, op.c);
+                as.compareDouble(1, 0);
+                as.setCondition(op.op == Opcode::FLT ? CC_A : CC_AE, RAX);
+                as.zeroExtend(RAX);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::FEQ:
+            case Opcode::FNE:
+                loadDouble(as, 0, op, 1, op.b);
+                loadDouble(as, 1, op, 2, op.c);
+                as.compareDouble(0, 1);
+                if (op.op == Opcode::FEQ) {
+                    as.setCondition(CC_E, RAX);
+                    as.setCondition(CC_NP, RCX);
+                    as.byteOperation(0x20, RAX, RCX);
+                } else {
+                    as.setCondition(CC_NE, RAX);
+                    as.setCondition(CC_P, RCX);
+                    as.byteOperation(0x08, RAX, RCX);
+                }
+                as.zeroExtend(RAX);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::JZ:
+            case Opcode::JNZ: {
+                loadInteger(as, RAX, op, 0, op.a);
+                as.arithmetic(0x85, RAX, RAX);
+                bool zero = (op.op == Opcode::JZ) == op.taken;  // 守卫要求的结果
+                guard(zero ? CC_NE : CC_E, op.exit);
+                break;
+            }
+            case Opcode::JLT:
+            case Opcode::JLE:
+            case Opcode::JEQ:
+            case Opcode::JNE: {
+                // 守卫失败的条件：录制时跳转则条件不成立，否则条件成立
+                static const uint8_t holds[] = {CC_L, CC_LE, CC_E, CC_NE};
+                static const uint8_t fails[] = {CC_GE, CC_G, CC_NE, CC_E};
+                int kind = static_cast<int>(op.op) - static_cast<int>(Opcode::JLT);
+                loadInteger(as, RAX, op, 0, op.a);
+                loadInteger(as, RCX, op, 1, op.b);
+                as.arithmetic(0x39, RAX, RCX);
+                guard(op.taken ? fails[kind] : holds[kind], op.exit);
+                break;
+            }
+            case Opcode::LOADELEM:
+            case Opcode::LOADELEM_U:
+                as.load(RCX, RBX, slotOffset(op.b));
+                loadInteger(as, RDX, op, 2, op.c);
+                if (op.exit >= 0) {
+                    as.compareLength(RDX, RCX);
+                    guard(CC_AE, op.exit);
+                }
+                as.element(0x8B, RAX, RCX, RDX);
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::STOREELEM:
+            case Opcode::STOREELEM_U:
+                as.load(RCX, RBX, slotOffset(op.a));
+                loadInteger(as, RDX, op, 1, op.b);
+                if (op.exit >= 0) {
+                    as.compareLength(RDX, RCX);
+                    guard(CC_AE, op.exit);
+                }
+                loadInteger(as, RAX, op, 2, op.c);
+                as.element(0x89, RAX, RCX, RDX);
+                break;
+            case Opcode::GLOAD:
+                as.load(RAX, R13, slotOffset(op.b));
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            case Opcode::GSTORE:
+                loadInteger(as, RAX, op, 1, op.b);
+                as.store(R13, slotOffset(op.a), RAX);
+                break;
+            case Opcode::GARRAY:
+                as.lea(RAX, R13, slotOffset(op.b + 1));
+                as.store(RBX, slotOffset(op.a), RAX);
+                break;
+            default:
+                break;
+        }
+    }
+    as.increment(R12);
+    as.bind(as.jump(), top);
+
+    std::vector<size_t> stubs;
+    for (size_t exit = 0; exit < exitJumps.size(); exit++) {
+        if (exitJumps[exit].empty()) {
+            continue;
+        }
+        for (size_t at : exitJumps[exit]) {
+            as.bind(at, as.size());
+        }
+        as.emit(0xB8);  // mov eax, exit
+        as.emit32(static_cast<int32_t>(exit));
+        stubs.push_back(as.jump());
+    }
+    for (size_t at : stubs) {
+        as.bind(at, as.size());
+    }
+    as.store(R14, 0, R12);
+    as.pop(R14);
+    as.pop(R13);
+    as.pop(R12);
+    as.pop(RBX);
+    as.emit(0xC3);
+    return as.bytes();
+}
+
+bool readsFloat(Opcode op) {
+    switch (op) {
+        case Opcode::FADD: case Opcode::FSUB: case Opcode::FMUL: case Opcode::FDIV: case Opcode::FNEG:
+        case Opcode::F2I: case Opcode::FLT: case Opcode::FLE: case Opcode::FEQ: case Opcode::FNE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void printOp(std::ostream& os, const TraceOp& op) {
+    os << "    " << std::setw(4) << op.pc << "  ";
+    if (op.op == Opcode::LOADI) {
+        os << "CONST r" << op.a << ", " << op.value[1].i << "\n";
+        return;
+    }
+    os << (isConditional(op.op) ? "GUARD " : "") << opcodeName(op.op);
+    const int32_t operands[3] = {op.a, op.b, op.c};
+    int printed = 0;
+    for (int slot = 0; slot < 3; slot++) {
+        OperandKind kind = operandKind(op.op, slot);
+        if (kind == OperandKind::None || kind == OperandKind::Target) {
+            continue;
+        }
+        os << (printed++ == 0 ? " " : ", ");
+        if (op.known[slot] && kind == OperandKind::Register) {
+            if (readsFloat(op.op)) {
+                os << "#" << op.value[slot].f;
+            } else {
+                os << "#" << op.value[slot].i;
+            }
+        } else if (kind == OperandKind::Register) {
+            os << "r" << operands[slot];
+        } else if (kind == OperandKind::Global) {
+            os << "g" << operands[slot];
+        } else {
+            os << operands[slot];
+        }
+    }
+    if (isConditional(op.op)) {
+        os << (op.taken ? "  (taken)" : "  (not taken)");
+    }
+    if (op.exit >= 0) {
+        os << "  -> exit" << op.exit;
+    }
+    os << "\n";
+}
+
+} // namespace
+
+// TraceJit类实现
+TraceJit::TraceJit(const BytecodeModule& module, uint32_t threshold)
+    : threshold(std::max<uint32_t>(threshold, 1)), slots(module.functions.size() * 2) {}
+
+TraceJit::~TraceJit() = default;
+
+bool TraceJit::supported() {
+#ifdef TRACE_JIT_NATIVE
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool TraceJit::record(const BytecodeFunction& body, Value* regs, Value* globals, int32_t& pc, Trace& trace,
+                      uint64_t& instructions, uint64_t& boundsChecks) const {
+    const int32_t head = pc;
+    trace.function = &body;
+    trace.head = head;
+    trace.line = body.lines[head];
+    uint32_t executed = 0;
+    uint32_t checks = 0;
+    auto finish = [&](bool closed) {
+        instructions += executed;
+        boundsChecks += checks;
+        return closed;
+    };
+    // 守卫失败时从target继续；target为可能出错的指令本身时它不计入已执行的指令
+    auto exitTo = [&](int32_t target, bool executedBranch) {
+        trace.exits.push_back({target, executed + (executedBranch ? 1u : 0u), checks, 0});
+        return static_cast<int32_t>(trace.exits.size() - 1);
+    };
+
+    while (trace.ops.size() < MAX_TRACE_LENGTH) {
+        const Instruction& instruction = body.code[pc];
+        TraceOp op;
+        op.op = instruction.op;
+        op.a = instruction.a;
+        op.b = instruction.b;
+        op.c = instruction.c;
+        op.pc = pc;
+        int32_t next = pc + 1;
+        bool keep = true;
+        Value x = operandKind(op.op, 1) == OperandKind::Register ? regs[op.b] : Value();
+        Value y = operandKind(op.op, 2) == OperandKind::Register ? regs[op.c] : Value();
+
+        switch (instruction.op) {
+            case Opcode::NOP:
+                keep = false;
+                break;
+            case Opcode::DIV:
+            case Opcode::MOD:
+                if (y.i == 0) {
+                    return finish(false);  // 由解释器报告除数为0
+                }
+                op.exit = exitTo(pc, false);
+                regs[op.a] = evaluate(op.op, op.b, op.c, x, y);
+                break;
+            case Opcode::F2I:
+                op.exit = exitTo(pc, false);
+                regs[op.a] = evaluate(op.op, op.b, op.c, x, y);
+                break;
+            case Opcode::LOADI:
+                op.known[1] = true;
+                op.value[1].i = op.b;
+                regs[op.a] = evaluate(op.op, op.b, op.c, x, y);
+                break;
+            case Opcode::JMP:
+                keep = false;
+                next = op.a;
+                break;
+            case Opcode::JZ:
+            case Opcode::JNZ:
+            case Opcode::JLT:
+            case Opcode::JLE:
+            case Opcode::JEQ:
+            case Opcode::JNE: {
+                Value left = regs[op.a];
+                Value right = op.op == Opcode::JZ || op.op == Opcode::JNZ ? Value() : regs[op.b];
+                op.taken = condition(op.op, left, right);
+                int32_t target = branchTarget(op);
+                if (target == head && !op.taken) {
+                    // 本轮迭代后循环结束：路径已经完整，守卫仍要求回到循环头
+                    op.taken = true;
+                    op.exit = exitTo(next, true);
+                    trace.ops.push_back(op);
+                    executed++;
+                    pc = next;
+                    trace.instructions = executed;
+                    trace.boundsChecks = checks;
+                    trace.recorded = trace.ops.size();
+                    return finish(true);
+                }
+                if (target <= pc && op.taken && target != head) {
+                    executed++;  // 内层循环的回边
+                    pc = target;
+                    return finish(false);
+                }
+                op.exit = exitTo(op.taken ? next : target, true);
+                next = op.taken ? target : next;
+                break;
+            }
+            case Opcode::LOADELEM:
+            case Opcode::STOREELEM: {
+                const Value* array = op.op == Opcode::LOADELEM ? x.array : regs[op.a].array;
+                int64_t index = op.op == Opcode::LOADELEM ? y.i : x.i;
+                if (static_cast<uint64_t>(index) >= static_cast<uint64_t>(array[-1].i)) {
+                    return finish(false);  // 由解释器报告越界
+                }
+                op.exit = exitTo(pc, false);
+                checks++;
+                if (op.op == Opcode::LOADELEM) {
+                    regs[op.a] = array[index];
+                } else {
+                    regs[op.a].array[index] = y;
+                }
+                break;
+            }
+            case Opcode::LOADELEM_U:
+                regs[op.a] = x.array[y.i];
+                break;
+            case Opcode::STOREELEM_U:
+                regs[op.a].array[x.i] = y;
+                break;
+            case Opcode::GLOAD:
+                regs[op.a] = globals[op.b];
+                break;
+            case Opcode::GSTORE:
+                globals[op.a] = regs[op.b];
+                break;
+            case Opcode::GARRAY:
+                regs[op.a].array = &globals[op.b + 1];
+                op.value[2] = globals[op.b];
+                break;
+            default:
+                if (!isPure(op.op)) {
+                    return finish(false);  // 调用、printf、并行循环、返回与数组分配
+                }
+                regs[op.a] = evaluate(op.op, op.b, op.c, x, y);
+                break;
+        }
+        executed++;
+        if (keep) {
+            trace.ops.push_back(op);
+        }
+        if (next <= pc && next != head) {
+            pc = next;  // 内层循环
+            return finish(false);
+        }
+        pc = next;
+        if (pc == head) {
+            trace.instructions = executed;
+            trace.boundsChecks = checks;
+            trace.recorded = trace.ops.size();
+            return finish(true);
+        }
+    }
+    return finish(false);
+}
+
+void TraceJit::optimize(Trace& trace) const {
+    const BytecodeFunction& body = *trace.function;
+    std::vector<bool> known(body.registerCount, false);
+    std::vector<Value> values(body.registerCount);
+    std::vector<int64_t> lengths(body.registerCount, -1);  // 寄存器中数组的已知长度
+    for (size_t i = 0; i < body.constants.size(); i++) {
+        known[body.firstConstant() + i] = true;
+        values[body.firstConstant() + i] = body.constants[i];
+    }
+
+    // 常量传播：常量寄存器与本轮迭代中由常量算出的值；全部输入已知的运算折叠为常量，
+    // 条件已知的守卫以及下标已知且在已知长度之内的下标检查去掉
+    for (auto& op : trace.ops) {
+        bool allKnown = true;
+        for (int slot = 0; slot < 3; slot++) {
+            if (!reads(op, slot)) {
+                continue;
+            }
+            int32_t reg = slot == 0 ? op.a : slot == 1 ? op.b : op.c;
+            op.known[slot] = known[reg];
+            op.value[slot] = values[reg];
+            allKnown = allKnown && known[reg];
+        }
+        int32_t target = written(op);
+        if (isPure(op.op) && allKnown) {
+            Value result = evaluate(op.op, op.b, op.c, op.value[1], op.value[2]);
+            trace.folded += op.op != Opcode::LOADI ? 1 : 0;
+            trace.guardsRemoved += op.exit >= 0 ? 1 : 0;
+            op.op = Opcode::LOADI;
+            op.known[1] = true;
+            op.value[1] = result;
+            op.known[2] = false;
+            op.exit = -1;
+            known[target] = true;
+            values[target] = result;
+            lengths[target] = -1;
+            continue;
+        }
+        if (isConditional(op.op) && allKnown) {
+            removeGuard(op);
+            trace.guardsRemoved++;
+            continue;
+        }
+        if ((op.op == Opcode::DIV || op.op == Opcode::MOD) && op.known[2] && op.value[2].i != 0) {
+            removeGuard(op);
+            trace.guardsRemoved++;
+        }
+        if (op.op == Opcode::LOADELEM || op.op == Opcode::STOREELEM) {
+            int32_t array = op.op == Opcode::LOADELEM ? op.b : op.a;
+            int slot = op.op == Opcode::LOADELEM ? 2 : 1;
+            if (op.known[slot] && lengths[array] >= 0 && op.value[slot].i >= 0 &&
+                op.value[slot].i < lengths[array]) {
+                removeGuard(op);
+                trace.guardsRemoved++;
+            }
+        }
+        if (target >= 0) {
+            known[target] = false;
+            lengths[target] = op.op == Opcode::GARRAY ? op.value[2].i
+                              : op.op == Opcode::MOVE ? lengths[op.b]
+                                                      : -1;
+        }
+    }
+
+    // 冗余守卫消除：操作数未被改写的情况下，与前面成立过的守卫相同或被其蕴含的守卫去掉
+    std::vector<Fact> facts;
+    for (auto& op : trace.ops) {
+        Fact fact;
+        if (guardFact(op, fact)) {
+            if (std::find(facts.begin(), facts.end(), fact) != facts.end()) {
+                removeGuard(op);
+                trace.guardsRemoved++;
+            } else {
+                facts.push_back(fact);
+                if (fact.kind == FactKind::Less) {
+                    facts.push_back({FactKind::LessEqual, fact.x, fact.y});
+                    facts.push_back({FactKind::NotEqual, std::min(fact.x, fact.y), std::max(fact.x, fact.y)});
+                }
+            }
+        }
+        int32_t target = written(op);
+        if (target >= 0) {
+            facts.erase(std::remove_if(facts.begin(), facts.end(),
+                                       [&](const Fact& f) {
+                                           return f.x == target || (f.kind != FactKind::Zero &&
+                                                                    f.kind != FactKind::NonZero && f.y == target);
+                                       }),
+                        facts.end());
+        }
+    }
+
+    trace.ops.erase(std::remove_if(trace.ops.begin(), trace.ops.end(),
+                                   [](const TraceOp& op) { return op.op == Opcode::NOP; }),
+                    trace.ops.end());
+}
+
+int32_t TraceJit::enterLoop(const BytecodeFunction& function, int version, int32_t head, Value* registers,
+                            Value* globals, uint64_t& instructions, uint64_t& boundsChecks, uint64_t& backEdges) {
+    std::vector<LoopSlot>& functionSlots = slots[version];
+    if (functionSlots.empty()) {
+        functionSlots.resize(function.code.size());
+    }
+    LoopSlot& slot = functionSlots[head];
+    if (slot.trace < 0) {
+        if (slot.attempts >= MAX_RECORD_ATTEMPTS || ++slot.counter < threshold) {
+            return head;
+        }
+        slot.counter = 0;
+        auto trace = std::make_unique<Trace>();
+        int32_t pc = head;
+        if (!record(function, registers, globals, pc, *trace, instructions, boundsChecks)) {
+            slot.attempts++;
+            stats.aborted++;
+            return pc;
+        }
+        backEdges += pc == head;  // 录制的一轮迭代以回到循环头的跳转结束
+        optimize(*trace);
+        std::vector<uint8_t> bytes = generate(*trace);
+        std::unique_ptr<ExecutableCode> native = ExecutableCode::create(bytes);
+        if (!native) {
+            slot.attempts = MAX_RECORD_ATTEMPTS;
+            stats.aborted++;
+            return pc;
+        }
+        trace->codeSize = bytes.size();
+        slot.trace = static_cast<int32_t>(traces.size());
+        traces.push_back(std::move(trace));
+        code.push_back(std::move(native));
+        stats.compiled++;
+        if (pc != head) {
+            return pc;  // 录制的一轮迭代后循环已经结束
+        }
+    }
+
+    Trace& trace = *traces[slot.trace];
+    uint64_t iterations = 0;
+    int32_t exit = code[slot.trace]->entry()(registers, globals, &iterations);
+    TraceExit& out = trace.exits[exit];
+    uint64_t executed = iterations * trace.instructions + out.instructions;
+    instructions += executed;
+    boundsChecks += iterations * trace.boundsChecks + out.boundsChecks;
+    backEdges += iterations;
+    out.taken++;
+    trace.entries++;
+    trace.iterations += iterations;
+    stats.entries++;
+    stats.iterations += iterations;
+    stats.instructions += executed;
+    return out.pc;
+}
+
+const TraceJitStats& TraceJit::getStats() const {
+    return stats;
+}
+
+void TraceJit::dump(std::ostream& os) const {
+    for (size_t i = 0; i < traces.size(); i++) {
+        const Trace& trace = *traces[i];
+        const BytecodeFunction& function = *trace.function;
+        os << "trace " << i << ": " << function.name << " @" << trace.head << " (line " << trace.line << "), "
+           << trace.ops.size() << " op(s) from " << trace.recorded << " recorded, " << trace.folded
+           << " folded, " << trace.guardsRemoved << " guard(s) removed, " << trace.codeSize << " bytes\n";
+        os << "  entries " << trace.entries << ", iterations " << trace.iterations << "\n";
+        for (const auto& op : trace.ops) {
+            printOp(os, op);
+        }
+        for (size_t e = 0; e < trace.exits.size(); e++) {
+            const TraceExit& exit = trace.exits[e];
+            if (exit.taken > 0) {
+                os << "  exit" << e << " -> @" << exit.pc << " (line " << function.lines[exit.pc] << "): "
+                   << exit.taken << " time(s)\n";
+            }
+        }
+    }
+}
@@ -0,0 +1,612 @@
+#include "../include/VirtualMachine.h"
+#include "../include/OutputBuffer.h"
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VM_COMPUTED_GOTO 1
+#endif
+
+namespace {
+
+const int64_t MAX_PARALLEL_CHUNKS = 64;
+const int64_t MIN_CHUNK_TRIPS = 1024;  // 每块至少的迭代次数
+
+// 整数运算按64位补码回绕，避免有符号溢出的未定义行为
+inline int64_t wrapAdd(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+inline int64_t wrapSub(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+inline int64_t wrapMul(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+// 超出范围的浮点数取最近的可表示整数，NaN取0
+inline int64_t toInteger(double value) {
+    if (std::isnan(value)) {
+        return 0;
+    }
+    if (value >= 9.2233720368547758e18) {
+        return INT64_MAX;
+    }
+    if (value <= -9.2233720368547758e18) {
+        return INT64_MIN;
+    }
+    return static_cast<int64_t>(value);
+}
+
+size_t printFormatted(OutputBuffer& output, const FormatString& format, const Value* arguments) {
+    size_t written = 0;
+    char small[128];
+    for (const auto& piece : format.pieces) {
+        output.write(piece.text);
+        written += piece.text.size();
+        if (piece.conversion.empty()) {
+            continue;
+        }
+        const char* spec = piece.conversion.c_str();
+        auto print = [&](char* buffer, size_t size) {
+            if (piece.isFloat) {
+                return std::snprintf(buffer, size, spec, arguments->f);
+            }
+            if (piece.conversion.back() == 'c') {
+                return std::snprintf(buffer, size, spec, static_cast<int>(arguments->i));
+            }
+            return std::snprintf(buffer, size, spec, static_cast<long long>(arguments->i));
+        };
+        int length = print(small, sizeof(small));
+        if (length >= static_cast<int>(sizeof(small))) {
+            std::vector<char> large(static_cast<size_t>(length) + 1);
+            print(large.data(), large.size());
+            output.write(large.data(), static_cast<size_t>(length));
+        } else if (length > 0) {
+            output.write(small, static_cast<size_t>(length));
+        }
+        written += length > 0 ? static_cast<size_t>(length) : 0;
+        arguments++;
+    }
+    return written;
+}
+
+/**
+ * 调用链上的一帧（被调用者返回后恢复）
+ */
+struct CallFrame {
+    const BytecodeFunction* function;
+    int version;  // 代码版本，见TraceJit::enterLoop
+    const Instruction* returnAddress;
+    Value* registers;
+    int32_t result;
+};
+
+} // namespace
+
+// RuntimeError类实现
+RuntimeError::RuntimeError(const std::string& message, int line, const std::string& function)
+    : message(message), line(line), function(function) {}
+
+const char* RuntimeError::what() const noexcept {
+    return message.c_str();
+}
+
+std::string RuntimeError::getFullMessage() const {
+    std::ostringstream oss;
+    oss << "Runtime error at line " << line << " in '" << function << "': " << message;
+    return oss.str();
+}
+
+// VirtualMachine类实现
+VirtualMachine::VirtualMachine(const BytecodeModule& module, const VMOptions& options)
+    : module(module), options(options), stack(options.stackSize) {}
+
+int64_t VirtualMachine::run(std::ostream& out) {
+    stats = VMStats();
+    Value zero;
+    zero.i = 0;
+    globals.assign(module.globalCount, zero);
+    for (const auto& array : module.globalArrays) {
+        globals[array.first].i = array.second;
+    }
+    programOutput = &out;
+    jit.reset();
+    tiers.reset();
+    if (options.tiering) {
+        tiers = std::make_unique<TierManager>(module, options.tierCallThreshold, options.tierBackEdgeThreshold,
+                                              options.tierInBackground);
+    }
+    if (options.jit && TraceJit::supported()) {
+        jit = std::make_unique<TraceJit>(module, options.jitThreshold);
+    }
+    OutputBuffer output(out, options.outputBufferSize);
+    Value* stackEnd = stack.data() + stack.size();
+    try {
+        if (module.globalInitializer >= 0) {
+            execute(module.globalInitializer, stack.data(), stackEnd, output, stats, jit.get(), tiers.get());
+        }
+        int64_t result = execute(module.mainFunction, stack.data(), stackEnd, output, stats, jit.get(), tiers.get());
+        if (tiers) {
+            tiers->wait();
+        }
+        return result;
+    } catch (const RuntimeError&) {
+        if (tiers) {
+            tiers->wait();
+        }
+        throw;
+    }
+}
+
+const VMStats& VirtualMachine::getStats() const {
+    return stats;
+}
+
+const TraceJit* VirtualMachine::getTraceJit() const {
+    return jit.get();
+}
+
+const TierManager* VirtualMachine::getTierManager() const {
+    return tiers.get();
+}
+
+void VirtualMachine::runParallelLoop(const ParallelLoop& loop, Value* registers, int64_t lower, int64_t upper,
+                                     VMStats& counters) {
+    if (!pool) {
+        pool = std::make_unique<ThreadPool>(options.threads);
+    }
+    const BytecodeFunction& body = module.functions[loop.body];
+    uint64_t trips = static_cast<uint64_t>(upper) - static_cast<uint64_t>(lower);
+    uint64_t chunks = std::min<uint64_t>(MAX_PARALLEL_CHUNKS, std::max<uint64_t>(1, trips / MIN_CHUNK_TRIPS));
+    uint64_t base = trips / chunks;
+    uint64_t extra = trips % chunks;
+    size_t reductions = loop.reductions.size();
+
+    // 每块一个帧，之后是部分和数组（长度槽位加各归约变量）
+    std::vector<std::vector<Value>> frames(chunks);
+    std::vector<VMStats> chunkStats(chunks);
+    std::vector<std::unique_ptr<RuntimeError>> errors(chunks);
+    pool->parallelFor(chunks, [&](size_t k) {
+        std::vector<Value>& frame = frames[k];
+        frame.resize(body.frameSize + reductions + 1);
+        Value* partial = frame.data() + body.frameSize + 1;
+        partial[-1].i = static_cast<int64_t>(reductions);
+        for (size_t r = 0; r < reductions; r++) {
+            partial[r].i = 0;
+        }
+        uint64_t first = k * base + std::min<uint64_t>(k, extra);
+        uint64_t count = base + (k < extra ? 1 : 0);
+        frame[0].i = static_cast<int64_t>(static_cast<uint64_t>(lower) + first);
+        frame[1].i = static_cast<int64_t>(static_cast<uint64_t>(lower) + first + count);
+        frame[2].array = partial;
+        for (size_t c = 0; c < loop.captures.size(); c++) {
+            frame[3 + c] = registers[loop.captures[c]];
+        }
+        OutputBuffer output(*programOutput, 0);  // 循环体中没有printf
+        try {
+            execute(loop.body, frame.data(), frame.data() + body.frameSize, output, chunkStats[k], nullptr, nullptr);
+        } catch (const RuntimeError& error) {
+            errors[k] = std::make_unique<RuntimeError>(error);
+        }
+    });
+
+    counters.parallelLoops++;
+    counters.parallelChunks += chunks;
+    for (size_t k = 0; k < chunks; k++) {
+        counters.instructions += chunkStats[k].instructions;
+        counters.boundsChecks += chunkStats[k].boundsChecks;
+    }
+    for (size_t k = 0; k < chunks; k++) {
+        if (errors[k]) {
+            throw *errors[k];
+        }
+    }
+    for (size_t r = 0; r < reductions; r++) {
+        Value& sum = registers[loop.reductions[r]];
+        for (size_t k = 0; k < chunks; k++) {
+            sum.i = wrapAdd(sum.i, frames[k][body.frameSize + 1 + r].i);
+        }
+    }
+}
+
+int64_t VirtualMachine::execute(int entry, Value* frame, Value* frameEnd, OutputBuffer& output,
+                                VMStats& counters, TraceJit* traces, TierManager* tierManager) {
+    std::vector<CallFrame> frames;
+    Value* const stackEnd = frameEnd;
+    const int functionCount = static_cast<int>(module.functions.size());
+    // 进入函数index时选择代码版本：分层执行时可能是优化版本，其编号为index加函数个数
+    auto enter = [&](int index, int& version) {
+        const BytecodeFunction* code = &module.functions[index];
+        if (tierManager) {
+            code = tierManager->enter(index);
+        }
+        version = code == &module.functions[index] ? index : index + functionCount;
+        return code;
+    };
+    int version = entry;
+    const BytecodeFunction* function = enter(entry, version);
+    Value* regs = frame;
+    const Instruction* code = function->code.data();
+    const Instruction* pc = code;
+    uint64_t executed = 0;
+    uint64_t boundsChecks = 0;
+
+    auto raise = [&](const std::string& message) {
+        counters.instructions += executed;
+        counters.boundsChecks += boundsChecks;
+        int line = function->lines[static_cast<size_t>(pc - code)];
+        throw RuntimeError(message, line, function->name);
+    };
+    // 跳到target；向回的跳转交给轨迹JIT，从它返回的位置继续；
+    // 这次跳转与轨迹中完成的迭代一起计入分层执行的计数，使升级与是否启用JIT无关
+    auto branch = [&](int32_t target) {
+        if (target > pc - code) {
+            return code + target;
+        }
+        uint64_t backEdges = 1;
+        int32_t next = traces ? traces->enterLoop(*function, version, target, regs, globals.data(), executed,
+                                                  boundsChecks, backEdges)
+                              : target;
+        if (tierManager) {
+            tierManager->backEdge(version < functionCount ? version : version - functionCount, backEdges);
+        }
+        return code + next;
+    };
+    auto outOfBounds = [&](const Value* array, int64_t index) {
+        raise("index " + std::to_string(index) + " is out of bounds for an array of " +
+              std::to_string(array[-1].i) + " element(s)");
+    };
+
+    if (function->frameSize > static_cast<size_t>(stackEnd - regs)) {
+        raise("stack overflow");
+    }
+    if (!function->constants.empty()) {
+        std::memcpy(regs + function->firstConstant(), function->constants.data(),
+                    function->constants.size() * sizeof(Value));
+    }
+
+#ifdef VM_COMPUTED_GOTO
+#define VM_LABEL_ADDRESS(name, a, b, c) &&op_##name,
+    static const void* const dispatch[] = {BYTECODE_OPCODES(VM_LABEL_ADDRESS)};
+#undef VM_LABEL_ADDRESS
+#define VM_CASE(name) op_##name:
+#define VM_NEXT()                                             \
+    do {                                                      \
+        ++executed;                                           \
+        goto *dispatch[static_cast<size_t>(pc->op)];          \
+    } while (0)
+    VM_NEXT();
+#else
+#define VM_CASE(name) case Opcode::name:
+#define VM_NEXT() continue
+    for (;;) {
+        ++executed;
+        switch (pc->op) {
+#endif
+
+    VM_CASE(NOP) {
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(LOADI) {
+        regs[pc->a].i = pc->b;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(MOVE) {
+        regs[pc->a] = regs[pc->b];
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(ADD) {
+        regs[pc->a].i = wrapAdd(regs[pc->b].i, regs[pc->c].i);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(SUB) {
+        regs[pc->a].i = wrapSub(regs[pc->b].i, regs[pc->c].i);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(MUL) {
+        regs[pc->a].i = wrapMul(regs[pc->b].i, regs[pc->c].i);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(DIV) {
+        int64_t divisor = regs[pc->c].i;
+        if (divisor == 0) {
+            raise("division by zero");
+        }
+        int64_t dividend = regs[pc->b].i;
+        regs[pc->a].i = divisor == -1 ? wrapSub(0, dividend) : dividend / divisor;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(MOD) {
+        int64_t divisor = regs[pc->c].i;
+        if (divisor == 0) {
+            raise("division by zero");
+        }
+        regs[pc->a].i = divisor == -1 ? 0 : regs[pc->b].i % divisor;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(ADDK) {
+        regs[pc->a].i = wrapAdd(regs[pc->b].i, pc->c);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(NEG) {
+        regs[pc->a].i = wrapSub(0, regs[pc->b].i);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(NOT) {
+        regs[pc->a].i = regs[pc->b].i == 0;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(FADD) {
+        regs[pc->a].f = regs[pc->b].f + regs[pc->c].f;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(FSUB) {
+        regs[pc->a].f = regs[pc->b].f - regs[pc->c].f;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(FMUL) {
+        regs[pc->a].f = regs[pc->b].f * regs[pc->c].f;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(FDIV) {
+        regs[pc->a].f = regs[pc->b].f / regs[pc->c].f;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(FNEG) {
+        regs[pc->a].f = -regs[pc->b].f;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(I2F) {
+        regs[pc->a].f = static_cast<double>(regs[pc->b].i);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(F2I) {
+        regs[pc->a].i = toInteger(regs[pc->b].f);
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(LT) {
+        regs[pc->a].i = regs[pc->b].i < regs[pc->c].i;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(LE) {
+        regs[pc->a].i = regs[pc->b].i <= regs[pc->c].i;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(EQ) {
+        regs[pc->a].i = regs[pc->b].i == regs[pc->c].i;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(NE) {
+        regs[pc->a].i = regs[pc->b].i != regs[pc->c].i;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(FLT) {
+        regs[pc->a].i = regs[pc->b].f < regs[pc->c].f;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(FLE) {
+        regs[pc->a].i = regs[pc->b].f <= regs[pc->c].f;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(FEQ) {
+        regs[pc->a].i = regs[pc->b].f == regs[pc->c].f;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(FNE) {
+        regs[pc->a].i = regs[pc->b].f != regs[pc->c].f;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(JMP) {
+        pc = branch(pc->a);
+        VM_NEXT();
+    }
+    VM_CASE(JZ) {
+        pc = regs[pc->a].i == 0 ? branch(pc->b) : pc + 1;
+        VM_NEXT();
+    }
+    VM_CASE(JNZ) {
+        pc = regs[pc->a].i != 0 ? branch(pc->b) : pc + 1;
+        VM_NEXT();
+    }
+    VM_CASE(JLT) {
+        pc = regs[pc->a].i < regs[pc->b].i ? branch(pc->c) : pc + 1;
+        VM_NEXT();
+    }
+    VM_CASE(JLE) {
+        pc = regs[pc->a].i <= regs[pc->b].i ? branch(pc->c) : pc + 1;
+        VM_NEXT();
+    }
+    VM_CASE(JEQ) {
+        pc = regs[pc->a].i == regs[pc->b].i ? branch(pc->c) : pc + 1;
+        VM_NEXT();
+    }
+    VM_CASE(JNE) {
+        pc = regs[pc->a].i != regs[pc->b].i ? branch(pc->c) : pc + 1;
+        VM_NEXT();
+    }
+    VM_CASE(ARRAY) {
+        Value* header = regs + pc->b;
+        header->i = pc->c;
+        std::memset(static_cast<void*>(header + 1), 0, static_cast<size_t>(pc->c) * sizeof(Value));
+        regs[pc->a].array = header + 1;
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(CHECKLEN) {
+        int64_t length = regs[pc->a].array[-1].i;
+        if (length < pc->b) {
+            raise("array argument has " + std::to_string(length) + " element(s), the parameter requires " +
+                  std::to_string(pc->b));
+        }
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(LOADELEM) {
+        const Value* array = regs[pc->b].array;
+        int64_t index = regs[pc->c].i;
+        boundsChecks++;
+        if (static_cast<uint64_t>(index) >= static_cast<uint64_t>(array[-1].i)) {
+            outOfBounds(array, index);
+        }
+        regs[pc->a] = array[index];
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(LOADELEM_U) {
+        regs[pc->a] = regs[pc->b].array[regs[pc->c].i];
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(STOREELEM) {
+        Value* array = regs[pc->a].array;
+        int64_t index = regs[pc->b].i;
+        boundsChecks++;
+        if (static_cast<uint64_t>(index) >= static_cast<uint64_t>(array[-1].i)) {
+            outOfBounds(array, index);
+        }
+        array[index] = regs[pc->c];
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(STOREELEM_U) {
+        regs[pc->a].array[regs[pc->b].i] = regs[pc->c];
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(GLOAD) {
+        regs[pc->a] = globals[pc->b];
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(GSTORE) {
+        globals[pc->a] = regs[pc->b];
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(GARRAY) {
+        regs[pc->a].array = &globals[pc->b + 1];
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(CALL) {
+        int calleeVersion = 0;
+        const BytecodeFunction* callee = enter(pc->b, calleeVersion);
+        Value* calleeRegs = regs + function->frameSize;
+        if (calleeRegs + callee->frameSize > stackEnd || frames.size() >= options.maxCallDepth) {
+            raise("stack overflow in call to '" + callee->name + "'");
+        }
+        std::memcpy(static_cast<void*>(calleeRegs), regs + pc->c, callee->parameterTypes.size() * sizeof(Value));
+        if (!callee->constants.empty()) {
+            std::memcpy(static_cast<void*>(calleeRegs + callee->firstConstant()), callee->constants.data(),
+                        callee->constants.size() * sizeof(Value));
+        }
+        frames.push_back({function, version, pc + 1, regs, pc->a});
+        counters.calls++;
+        counters.maxCallDepth = std::max(counters.maxCallDepth, frames.size());
+        function = callee;
+        version = calleeVersion;
+        regs = calleeRegs;
+        code = callee->code.data();
+        pc = code;
+        VM_NEXT();
+    }
+    VM_CASE(PRINTF) {
+        regs[pc->a].i = static_cast<int64_t>(printFormatted(output, module.formats[pc->b], regs + pc->c));
+        pc++;
+        VM_NEXT();
+    }
+    VM_CASE(PARFOR) {
+        const ParallelLoop& loop = function->parallelLoops[pc->b];
+        int64_t lower = regs[pc->a].i;
+        int64_t upper = regs[loop.upper].i;
+        bool parallel = options.threads != 1 && !(loop.inclusive && upper == INT64_MAX);
+        upper += loop.inclusive && parallel ? 1 : 0;
+        if (!parallel || upper <= lower ||
+            static_cast<uint64_t>(upper) - static_cast<uint64_t>(lower) <
+                static_cast<uint64_t>(std::max<int64_t>(options.minParallelTrips, 1))) {
+            pc++;
+            VM_NEXT();
+        }
+        try {
+            runParallelLoop(loop, regs, lower, upper, counters);
+        } catch (RuntimeError& error) {
+            counters.instructions += executed;
+            counters.boundsChecks += boundsChecks;
+            error.function = function->name;  // 按源码中的函数报告，而不是循环体函数
+            throw;
+        }
+        regs[pc->a].i = upper;
+        pc = code + pc->c;
+        VM_NEXT();
+    }
+    VM_CASE(RET) {
+        Value result = regs[pc->a];
+        if (frames.empty()) {
+            counters.instructions += executed;
+            counters.boundsChecks += boundsChecks;
+            return result.i;
+        }
+        const CallFrame& caller = frames.back();
+        function = caller.function;
+        version = caller.version;
+        regs = caller.registers;
+        code = function->code.data();
+        pc = caller.returnAddress;
+        regs[caller.result] = result;
+        frames.pop_back();
+        VM_NEXT();
+    }
+    VM_CASE(RETV) {
+        if (frames.empty()) {
+            counters.instructions += executed;
+            counters.boundsChecks += boundsChecks;
+            return 0;
+        }
+        const CallFrame& caller = frames.back();
+        function = caller.function;
+        version = caller.version;
+        regs = caller.registers;
+        code = function->code.data();
+        pc = caller.returnAddress;
+        frames.pop_back();
+        VM_NEXT();
+    }
+
+#ifndef VM_COMPUTED_GOTO
+        }
+    }
+#endif
+#undef VM_CASE
+#undef VM_NEXT
+}
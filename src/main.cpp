@@ -3,12 +3,41 @@
 #include "../include/Parser.h"
 #include "../include/ErrorHandler.h"
 #include "../include/CodeFormatter.h"
+#include "../include/IncludeResolver.h"
+#include "../include/MacroExpander.h"
+#include "../include/StringInterner.h"
+#include "../include/Preprocessor.h"
+#include "../include/PrecompiledHeader.h"
+#include "../include/ProjectAnalyzer.h"
+#include "../include/SymbolIndex.h"
+#include "../include/ProjectCache.h"
+#include "../include/ASTQuery.h"
+#include "../include/StructuralRewriter.h"
+#include "../include/SymbolRenamer.h"
+#include "../include/CloneDetector.h"
+#include "../include/TokenDiff.h"
+#include "../include/ASTDiff.h"
+#include "../include/CodeMetrics.h"
+#include "../include/IntervalAnalyzer.h"
+#include "../include/CostEstimator.h"
+#include "../include/DeadCodeDetector.h"
+#include "../include/LintEngine.h"
+#include "../include/CorpusStats.h"
+#include "../include/HtmlExporter.h"
+#include "../include/ASTPrinter.h"
+#include "../include/BytecodeCompiler.h"
+#include "../include/VirtualMachine.h"
+#include "../include/BinaryFormat.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <memory>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <cmath>
 
 /**
  * 代码分析器主类
@@ -17,12 +46,36 @@
 class CodeAnalyzer {
 private:
     std::string sourceCode;
+    std::string filename;
     std::unique_ptr<Lexer> lexer;
     std::unique_ptr<Parser> parser;
     std::unique_ptr<ErrorHandler> errorHandler;
     std::vector<Token> tokens;
+    std::vector<Token> preprocessedTokens;  // 展开 #include 和宏之后供语法分析使用的token流
+    bool usePreprocessedTokens = false;
+    IncludeResolver* includeResolver = nullptr;
+    PrecompiledHeaderCache* pchCache = nullptr;
+    bool expandMacros = true;
+    bool stripDeadCode = false;
+    StringInterner interner;
+    std::unique_ptr<Preprocessor> preprocessor;
     std::unique_ptr<ProgramNode> ast;
     
+    /**
+     * 为来自被包含文件的错误加上文件名
+     */
+    template <typename Error>
+    Error withFileName(const Error& error) const {
+        if (error.fileId == 0 || !includeResolver) {
+            return error;
+        }
+        std::string name = includeResolver->getFileName(error.fileId);
+        if (error.message.compare(0, name.size() + 2, name + ": ") == 0) {
+            return error;  // 已带文件名
+        }
+        return Error(name + ": " + error.message, error.line, error.column, error.fileId);
+    }
+    
 public:
     CodeAnalyzer() {
         errorHandler = std::make_unique<ErrorHandler>();
@@ -42,6 +95,7 @@ public:
         buffer << file.rdbuf();
         sourceCode = buffer.str();
         file.close();
+        this->filename = filename;
         
         errorHandler->setSourceCode(sourceCode);
         
@@ -59,6 +113,34 @@ public:
         errorHandler->setSourceCode(sourceCode);
     }
     
+    /**
+     * 启用 #include 解析（解析器可在多个分析器之间共享）
+     */
+    void setIncludeResolver(IncludeResolver* resolver) {
+        includeResolver = resolver;
+    }
+    
+    /**
+     * 启用预编译头（缓存可在多个分析器之间共享）
+     */
+    void setPrecompiledHeaderCache(PrecompiledHeaderCache* cache) {
+        pchCache = cache;
+    }
+    
+    /**
+     * 启用/关闭宏展开（默认启用）
+     */
+    void setExpandMacros(bool enabled) {
+        expandMacros = enabled;
+    }
+    
+    /**
+     * 启用/关闭语法分析后删除不可达代码与无用写入（默认关闭）
+     */
+    void setStripDeadCode(bool enabled) {
+        stripDeadCode = enabled;
+    }
+    
     /**
      * 执行词法分析
      */
@@ -73,11 +155,41 @@ public:
             errorHandler->addLexicalErrors(lexer->getErrors());
             std::cout << "Lexical analysis completed with errors." << std::endl;
             return false;
-        } else {
-            std::cout << "Lexical analysis completed successfully." << std::endl;
-            std::cout << "Generated " << tokens.size() << " tokens." << std::endl;
-            return true;
         }
+        
+        // 展开 #include 与宏
+        preprocessor = std::make_unique<Preprocessor>(interner);
+        preprocessor->setIncludeResolver(includeResolver);
+        preprocessor->setPrecompiledHeaderCache(pchCache);
+        preprocessor->setExpandMacros(expandMacros);
+        usePreprocessedTokens = preprocessor->run(tokens, filename, preprocessedTokens);
+        if (preprocessor->hasErrors()) {
+            for (const auto& error : preprocessor->getErrors()) {
+                errorHandler->addLexicalError(withFileName(error));
+            }
+            if (preprocessor->hasIncludeErrors()) {
+                std::cout << "Include resolution completed with errors." << std::endl;
+            } else {
+                std::cout << "Macro expansion completed with errors." << std::endl;
+            }
+            return false;
+        }
+        
+        std::cout << "Lexical analysis completed successfully." << std::endl;
+        std::cout << "Generated " << tokens.size() << " tokens." << std::endl;
+        if (includeResolver) {
+            std::cout << "After include expansion: " << preprocessedTokens.size() << " tokens." << std::endl;
+        }
+        const MacroExpander& macroExpander = preprocessor->getMacroExpander();
+        if (macroExpander.getExpansionCount() > 0) {
+            std::cout << "Expanded " << macroExpander.getExpansionCount() << " macro use(s)." << std::endl;
+        }
+        if (auto pch = preprocessor->getPrecompiledHeader()) {
+            std::cout << (preprocessor->loadedPrecompiledHeader() ? "Loaded" : "Saved")
+                      << " precompiled header: " << pch->tokens.size() << " tokens, "
+                      << pch->macros.size() << " macros." << std::endl;
+        }
+        return true;
     }
     
     /**
@@ -91,17 +203,28 @@ public:
         
         std::cout << "\n=== Syntax Analysis ===" << std::endl;
         
-        parser = std::make_unique<Parser>(tokens);
+        parser = std::make_unique<Parser>(getPreprocessedTokens());
         ast = parser->parse();
         
         // 收集语法错误
         if (parser->hasErrors()) {
-            errorHandler->addSyntaxErrors(parser->getErrors());
+            for (const auto& error : parser->getErrors()) {
+                errorHandler->addSyntaxError(withFileName(error));
+            }
             std::cout << "Syntax analysis completed with errors." << std::endl;
             return false;
         } else {
             std::cout << "Syntax analysis completed successfully." << std::endl;
             std::cout << "Abstract Syntax Tree (AST) generated." << std::endl;
+            if (stripDeadCode) {
+                // 格式化使用原始token流；展开过 #include 或宏时语法树下标指向展开后的token流，无法对应回原文
+                size_t stripped = DeadCodeDetector::strip(*ast, usePreprocessedTokens ? preprocessedTokens : tokens);
+                std::cout << "Stripped " << stripped << " dead statement(s) and initializer(s)." << std::endl;
+                if (usePreprocessedTokens && stripped > 0) {
+                    std::cout << "Note: includes or macros were expanded; dead code was removed from the syntax "
+                              << "tree only, formatted output is unchanged." << std::endl;
+                }
+            }
             return true;
         }
     }
@@ -134,11 +257,30 @@ public:
         }
         
         // 使用中文格式打印所有语句
-        for (size_t i = 0; i < ast->statements.size(); ++i) {
-            if (ast->statements[i]) {
-                ast->statements[i]->printChinese(0);
-            }
+        ASTPrinter(ASTDumpFormat::Chinese).print(*ast, std::cout);
+    }
+    
+    /**
+     * 把抽象语法树按指定格式写入文件
+     */
+    bool writeAST(const std::string& path, ASTDumpFormat format) const {
+        if (!ast) {
+            std::cerr << "Error: No AST to write to '" << path << "'" << std::endl;
+            return false;
         }
+        std::ofstream outFile(path, std::ios::binary);
+        if (!outFile.is_open()) {
+            std::cerr << "Error: Cannot create file '" << path << "'" << std::endl;
+            return false;
+        }
+        size_t bytes = ASTPrinter(format).print(*ast, outFile);
+        outFile.close();
+        if (!outFile) {
+            std::cerr << "Error: Failed to write '" << path << "'" << std::endl;
+            return false;
+        }
+        std::cout << "AST written to: " << path << " (" << bytes << " bytes)" << std::endl;
+        return true;
     }
     
     /**
@@ -201,6 +343,22 @@ public:
     const std::vector<Token>& getTokens() const {
         return tokens;
     }
+    
+    /**
+     * 获取预处理（展开 #include 与宏）后的token列表
+     */
+    const std::vector<Token>& getPreprocessedTokens() const {
+        return usePreprocessedTokens ? preprocessedTokens : tokens;
+    }
+    
+    /**
+     * 显示宏表
+     */
+    void showMacroTable() const {
+        if (preprocessor) {
+            preprocessor->getMacroExpander().printMacroTable(std::cout);
+        }
+    }
 };
 
 /**
@@ -216,12 +374,81 @@ void showUsage(const char* programName) {
     std::cout << "  -s, --syntax     Show only syntax analysis" << std::endl;
     std::cout << "  -f, --format     Format and output the code (if syntactically correct)" << std::endl;
     std::cout << "  -o, --output     Output formatted code to 'out' file" << std::endl;
+    std::cout << "  -I <dir>         Add include search path (enables #include resolution)" << std::endl;
+    std::cout << "  --include-graph[=dot]  Print the include graph (text or Graphviz DOT)" << std::endl;
+    std::cout << "  --ast-json <file>  Also write the syntax tree as JSON" << std::endl;
+    std::cout << "  --ast-dot <file>   Also write the syntax tree as a Graphviz DOT graph" << std::endl;
+    std::cout << "  -E, --preprocess Output the code after include and macro expansion" << std::endl;
+    std::cout << "  --macro-table    Print the macro table after analysis" << std::endl;
+    std::cout << "  --no-macros      Do not expand macros" << std::endl;
+    std::cout << "  --pch-dir <dir>  Cache the leading #include block as a precompiled header in <dir>" << std::endl;
+    std::cout << "  --project        Analyze all given files/directories as one project and check linkage" << std::endl;
+    std::cout << "  --project-cache <file>  Reuse results of unchanged units between project runs" << std::endl;
+    std::cout << "  -j <n>           Number of worker threads for project mode (default: all cores)" << std::endl;
+    std::cout << "  --build-index <file>         Build or incrementally update a symbol index of the given files" << std::endl;
+    std::cout << "  --query-index <file> <name>  Show where <name> is defined, declared and referenced" << std::endl;
+    std::cout << "  --query <pattern>            Find AST nodes matching <pattern>, e.g. 'call(name=\"f\", arg0=literal)'" << std::endl;
+    std::cout << "  --index <file>               Use a symbol index to skip files that cannot match a query or rename" << std::endl;
+    std::cout << "  --rewrite <pattern> <replacement>  Rewrite code matching <pattern>; $name is a placeholder" << std::endl;
+    std::cout << "  --rename <old> <new>         Rename a global function or variable across the given files" << std::endl;
+    std::cout << "  --clones                     Report duplicated code across the given files" << std::endl;
+    std::cout << "  --min-tokens <n>             Minimum clone length in tokens (default: 50)" << std::endl;
+    std::cout << "  --diff <old> <new>           Show a token-level diff between two versions of a file" << std::endl;
+    std::cout << "  --ast-diff <old> <new>       Show inserted, deleted, moved and updated syntax tree nodes" << std::endl;
+    std::cout << "  --metrics                    Report per-function complexity, nesting, fan-in/out and Halstead counts" << std::endl;
+    std::cout << "  --metrics-csv <file>         Also write the metrics as CSV" << std::endl;
+    std::cout << "  --metrics-json <file>        Also write the metrics as JSON" << std::endl;
+    std::cout << "  --intervals                  Find divisions by zero, constant conditions and loop bounds by interval analysis" << std::endl;
+    std::cout << "  --cost                       Estimate loop trip counts and per-function cost" << std::endl;
+    std::cout << "  --max-cost <n>               Flag functions whose estimated cost exceeds <n> (default: 10000000)" << std::endl;
+    std::cout << "  --cost-assume <n>            Value assumed for unknown sizes (default: 100); when given, also for" << std::endl;
+    std::cout << "                               recursion and uncounted loops, which are otherwise unbounded" << std::endl;
+    std::cout << "  --dead-code                  Report unreachable code and stores that are never read" << std::endl;
+    std::cout << "  --strip-dead                 Remove dead code from the syntax tree before formatting or output" << std::endl;
+    std::cout << "  --lint                       Check the code against all built-in lint rules in one pass" << std::endl;
+    std::cout << "  --lint-rules <a,b,...>       Check only the given lint rules" << std::endl;
+    std::cout << "  --stats                      Histograms of token kinds, lengths, node kinds, nesting and function sizes" << std::endl;
+    std::cout << "  --html <out.html>            Export one file as syntax-highlighted HTML" << std::endl;
+    std::cout << "  --html-lines                 Prefix each line of the HTML export with a linkable line number" << std::endl;
+    std::cout << "  --run                        Compile one file to bytecode and execute its main function" << std::endl;
+    std::cout << "  --disasm                     Print the compiled bytecode" << std::endl;
+    std::cout << "  --no-bce                     Keep every array bounds check (for comparison)" << std::endl;
+    std::cout << "  --no-parallel                Run every loop serially (for comparison)" << std::endl;
+    std::cout << "  --parallel-min <n>           Minimum trip count for running a loop in parallel (default: 10000)" << std::endl;
+    std::cout << "  --no-loop-opt                Skip loop rotation, strength reduction and unrolling (for comparison)" << std::endl;
+    std::cout << "  --no-jit                     Interpret every loop instead of compiling hot loops to machine code" << std::endl;
+    std::cout << "  --jit-threshold <n>          Loop-head visits before a trace is recorded (default: 100)" << std::endl;
+    std::cout << "  --dump-traces                Print the compiled traces after --run" << std::endl;
+    std::cout << "  --no-tiering                 Apply loop optimizations at compile time instead of to hot functions" << std::endl;
+    std::cout << "  --tier-calls <n>             Calls before a function is recompiled with loop optimizations (default: 50)" << std::endl;
+    std::cout << "  --tier-loops <n>             Back edges (including JIT trace iterations) before a function is recompiled (default: 5000)" << std::endl;
+    std::cout << "  --tier-sync                  Recompile on the interpreter thread (reproducible tier-up points)" << std::endl;
+    std::cout << "  --write                      Write rewritten/renamed files in place (default: dry run)" << std::endl;
     std::cout << "\nExample:" << std::endl;
     std::cout << "  " << programName << " -i                # Interactive mode" << std::endl;
     std::cout << "  " << programName << " test.txt          # Basic analysis" << std::endl;
     std::cout << "  " << programName << " -v test.txt       # Detailed analysis" << std::endl;
     std::cout << "  " << programName << " -f test.txt       # Format code" << std::endl;
     std::cout << "  " << programName << " -o test.txt       # Output to file" << std::endl;
+    std::cout << "  " << programName << " -I inc --include-graph test.txt  # Resolve includes" << std::endl;
+    std::cout << "  " << programName << " -s --ast-dot ast.dot test.txt  # Syntax tree as a graph" << std::endl;
+    std::cout << "  " << programName << " --project src/   # Analyze a whole project" << std::endl;
+    std::cout << "  " << programName << " --project-cache .cache src/  # Incremental project analysis" << std::endl;
+    std::cout << "  " << programName << " --query 'for(init=var(type=\"float\"))' src/  # Search the AST" << std::endl;
+    std::cout << "  " << programName << " --rewrite 'old($a, 0)' 'fresh($a)' src/  # Structural rewrite" << std::endl;
+    std::cout << "  " << programName << " --rename add sum --write src/  # Rename a function everywhere" << std::endl;
+    std::cout << "  " << programName << " --clones --min-tokens 30 src/  # Find duplicated code" << std::endl;
+    std::cout << "  " << programName << " --diff old.cpp new.cpp  # Compare two versions token by token" << std::endl;
+    std::cout << "  " << programName << " --ast-diff old.cpp new.cpp  # Compare two versions by syntax tree" << std::endl;
+    std::cout << "  " << programName << " --metrics --metrics-csv metrics.csv src/  # Export function metrics" << std::endl;
+    std::cout << "  " << programName << " --intervals -j8 src/  # Range analysis of every function" << std::endl;
+    std::cout << "  " << programName << " --cost --max-cost 1000000 gen/  # Reject runaway programs" << std::endl;
+    std::cout << "  " << programName << " --dead-code gen/  # Find unreachable code and dead stores" << std::endl;
+    std::cout << "  " << programName << " -f --strip-dead gen/a.cpp  # Format without dead code" << std::endl;
+    std::cout << "  " << programName << " --lint-rules empty-body,deep-nesting src/  # Run selected lint rules" << std::endl;
+    std::cout << "  " << programName << " --stats -j8 corpus/  # Profile what the input looks like" << std::endl;
+    std::cout << "  " << programName << " --html main.html --html-lines src/main.cpp  # Highlighted source page" << std::endl;
+    std::cout << "  " << programName << " --run --disasm test/array_test.txt  # Execute a program" << std::endl;
 }
 
 /**
@@ -512,6 +739,714 @@ void interactiveMode() {
     }
 }
 
+/**
+ * 各模式共用的前端：按 -I 的路径解析 #include，按 --no-macros 决定是否展开宏
+ */
+struct FrontEnd {
+    IncludeResolver includeResolver;
+    ProjectAnalyzer analyzer;
+
+    FrontEnd(const std::vector<std::string>& includePaths, bool expandMacros, size_t threadCount)
+        : analyzer(threadCount) {
+        for (const auto& path : includePaths) {
+            includeResolver.addSearchPath(path);
+        }
+        analyzer.setIncludeResolver(&includeResolver);
+        analyzer.setExpandMacros(expandMacros);
+    }
+
+    FrontEnd(const FrontEnd&) = delete;
+    FrontEnd& operator=(const FrontEnd&) = delete;
+};
+
+/**
+ * 工程模式：并行分析多个翻译单元并做链接检查
+ */
+int runProject(const std::vector<std::string>& inputs, const std::vector<std::string>& includePaths,
+               const std::string& pchDirectory, const std::string& cachePath, bool expandMacros,
+               size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for project mode." << std::endl;
+        return 1;
+    }
+    
+    // 包含解析与预编译头缓存在所有翻译单元之间共享
+    IncludeResolver includeResolver;
+    for (const auto& path : includePaths) {
+        includeResolver.addSearchPath(path);
+    }
+    std::unique_ptr<PrecompiledHeaderCache> pchCache;
+    if (!pchDirectory.empty()) {
+        pchCache = std::make_unique<PrecompiledHeaderCache>(pchDirectory, &includeResolver);
+    }
+    
+    // 增量缓存：只重新分析自身或被包含文件变化过的单元
+    std::unique_ptr<ProjectCache> projectCache;
+    if (!cachePath.empty()) {
+        projectCache = std::make_unique<ProjectCache>(
+            cachePath, ProjectCache::computeOptions(includePaths, expandMacros));
+        projectCache->load();
+    }
+    
+    ProjectAnalyzer project(threadCount);
+    project.setIncludeResolver(&includeResolver);
+    project.setPrecompiledHeaderCache(pchCache.get());
+    project.setExpandMacros(expandMacros);
+    project.setCache(projectCache.get());
+    project.analyze(files);
+    project.printReport(std::cout);
+    if (projectCache && !projectCache->save(project.getUnits())) {
+        std::cerr << "Warning: Cannot write project cache " << cachePath << std::endl;
+    }
+    return project.hasErrors() ? 1 : 0;
+}
+
+/**
+ * 建立或增量更新符号索引
+ */
+int buildIndex(const std::string& indexPath, const std::vector<std::string>& inputs,
+               const std::vector<std::string>& includePaths, bool expandMacros, size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for the index." << std::endl;
+        return 1;
+    }
+    
+    FrontEnd frontEnd(includePaths, expandMacros, threadCount);
+    
+    std::cout << "\n=== Symbol Index ===" << std::endl;
+    IndexBuildStats stats;
+    if (!SymbolIndex::update(indexPath, files, frontEnd.analyzer, threadCount, stats)) {
+        std::cerr << "Error: Cannot write index '" << indexPath << "'" << std::endl;
+        return 1;
+    }
+    std::cout << "Indexed " << stats.units << " file(s): " << stats.reparsed << " analysed, "
+              << stats.reused << " unchanged." << std::endl;
+    std::cout << "Records: " << stats.records << std::endl;
+    std::cout << "Index written to: " << indexPath << std::endl;
+    return 0;
+}
+
+/**
+ * 在符号索引中查找名字的定义、声明与引用
+ */
+int queryIndex(const std::string& indexPath, const std::string& name) {
+    auto start = std::chrono::steady_clock::now();
+    SymbolIndex index;
+    if (!index.open(indexPath)) {
+        std::cerr << "Error: Cannot open index '" << indexPath << "'" << std::endl;
+        return 1;
+    }
+    std::vector<IndexEntry> entries = index.lookup(name);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    
+    std::cout << "\n=== Symbol Index Query: " << name << " ===" << std::endl;
+    if (entries.empty()) {
+        std::cout << "No occurrences of '" << name << "' in the index." << std::endl;
+    }
+    for (const auto& entry : entries) {
+        std::cout << std::left << std::setw(12) << SymbolCollector::kindName(entry.kind)
+                  << entry.file << ":" << entry.line << ":" << entry.column
+                  << " (offset " << entry.offset << ")" << std::endl;
+    }
+    std::cout << entries.size() << " result(s) from " << index.getRecordCount() << " record(s) in "
+              << elapsed.count() << " us." << std::endl;
+    return entries.empty() ? 1 : 0;
+}
+
+/**
+ * 语法树查询：在给定文件中并行查找匹配模式的节点
+ */
+int runQuery(const std::string& queryText, const std::vector<std::string>& inputs,
+             const std::vector<std::string>& includePaths, const std::string& indexPath,
+             bool expandMacros, size_t threadCount) {
+    ASTQuery query;
+    std::string error;
+    if (!query.compile(queryText, error)) {
+        std::cerr << "Error: Invalid query: " << error << std::endl;
+        return 1;
+    }
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for the query." << std::endl;
+        return 1;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    FrontEnd frontEnd(includePaths, expandMacros, threadCount);
+    
+    SymbolIndex index;
+    if (!indexPath.empty() && !index.open(indexPath)) {
+        std::cerr << "Warning: Cannot open index '" << indexPath << "', scanning all files" << std::endl;
+    }
+    
+    QueryStats stats;
+    std::vector<QueryMatch> matches = query.run(files, frontEnd.analyzer, threadCount, &index, stats);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    
+    std::cout << "\n=== AST Query: " << queryText << " ===" << std::endl;
+    for (const auto& match : matches) {
+        std::cout << match.file << ":" << match.line << ":" << match.column << ": ["
+                  << match.kind << "] " << match.text << std::endl;
+    }
+    std::cout << stats.matches << " match(es) in " << stats.parsed << " file(s)";
+    if (stats.skipped > 0) {
+        std::cout << ", " << stats.skipped << " skipped by index";
+    }
+    std::cout << " (" << elapsed.count() << " ms)" << std::endl;
+    return matches.empty() ? 1 : 0;
+}
+
+/**
+ * 结构化查找替换：把匹配模式的子树改写为替换代码
+ * @param writeFiles 为true时原子地写回文件，否则输出改写后的代码
+ */
+int runRewrite(const std::string& patternText, const std::string& replacementText,
+               const std::vector<std::string>& inputs, bool writeFiles, size_t threadCount) {
+    StructuralRewriter rewriter;
+    std::string error;
+    if (!rewriter.compile(patternText, replacementText, error)) {
+        std::cerr << "Error: Invalid rewrite rule: " << error << std::endl;
+        return 1;
+    }
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for the rewrite." << std::endl;
+        return 1;
+    }
+    
+    std::vector<RewriteResult> results = rewriter.run(files, threadCount);
+    std::cout << "\n=== Structural Rewrite: " << patternText << " -> " << replacementText << " ===" << std::endl;
+    size_t edits = 0;
+    size_t changedFiles = 0;
+    size_t skipped = 0;
+    size_t failed = 0;
+    for (const auto& result : results) {
+        skipped += result.skipped ? 1 : 0;
+        if (!result.diagnostics.empty()) {
+            failed++;
+            std::cout << "  [skipped] " << result.path << " (errors)" << std::endl;
+            for (const auto& diagnostic : result.diagnostics) {
+                std::cout << "      " << diagnostic << std::endl;
+            }
+            continue;
+        }
+        if (result.edits == 0) {
+            continue;
+        }
+        edits += result.edits;
+        changedFiles++;
+        if (writeFiles) {
+            bool written = BinaryWriter::writeFileAtomically(result.path, result.output.data(), result.output.size());
+            std::cout << (written ? "  [written] " : "  [failed]  ") << result.path << " (" << result.edits
+                      << " edit(s))" << std::endl;
+            failed += written ? 0 : 1;
+        } else {
+            std::cout << "\n--- " << result.path << " (" << result.edits << " edit(s)) ---" << std::endl;
+            std::cout << result.output;
+            if (result.output.empty() || result.output.back() != '\n') {
+                std::cout << std::endl;
+            }
+        }
+    }
+    std::cout << "\nRewrite: " << edits << " edit(s) in " << changedFiles << " of " << files.size()
+              << " file(s), " << skipped << " skipped by token pre-filter." << std::endl;
+    return failed > 0 ? 1 : 0;
+}
+
+/**
+ * 按作用域解析的批量改名
+ * @param writeFiles 为true时写回文件，否则只列出将要改动的位置
+ */
+int runRename(const std::string& from, const std::string& to, const std::vector<std::string>& inputs,
+              const std::vector<std::string>& includePaths, const std::string& indexPath,
+              bool expandMacros, bool writeFiles, size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for the rename." << std::endl;
+        return 1;
+    }
+    FrontEnd frontEnd(includePaths, expandMacros, threadCount);
+    
+    SymbolIndex index;
+    if (!indexPath.empty() && !index.open(indexPath)) {
+        std::cerr << "Warning: Cannot open index '" << indexPath << "', analysing all files" << std::endl;
+    }
+    
+    std::cout << "\n=== Rename: " << from << " -> " << to << " ===" << std::endl;
+    SymbolRenamer renamer(frontEnd.analyzer, threadCount);
+    RenameStats stats;
+    bool ok = renamer.plan(from, to, files, &index, stats);
+    for (const auto& warning : renamer.getWarnings()) {
+        std::cout << "warning: " << warning << std::endl;
+    }
+    if (!ok) {
+        for (const auto& conflict : renamer.getConflicts()) {
+            std::cout << "error: " << conflict << std::endl;
+        }
+        std::cout << "Rename aborted; no files were changed." << std::endl;
+        return 1;
+    }
+    
+    for (const auto& file : renamer.getEdits()) {
+        std::cout << "  " << file.first << " (" << file.second.size() << " edit(s))" << std::endl;
+        for (const auto& location : file.second) {
+            std::cout << "      " << location.line << ":" << location.column << std::endl;
+        }
+    }
+    std::cout << renamer.getEditCount() << " edit(s) in " << renamer.getEdits().size() << " file(s); analysed "
+              << stats.analysed << " of " << stats.files << " file(s)";
+    if (stats.skipped > 0) {
+        std::cout << ", " << stats.skipped << " skipped by index";
+    }
+    std::cout << "." << std::endl;
+    
+    if (!writeFiles) {
+        std::cout << "Dry run; use --write to apply the edits." << std::endl;
+        return 0;
+    }
+    std::vector<std::string> failures;
+    if (!renamer.apply(failures)) {
+        for (const auto& failure : failures) {
+            std::cout << "error: cannot update " << failure << std::endl;
+        }
+        return 1;
+    }
+    std::cout << "Renamed in " << renamer.getEdits().size() << " file(s)." << std::endl;
+    return 0;
+}
+
+/**
+ * 重复代码检测
+ */
+int runCloneDetection(const std::vector<std::string>& inputs, size_t minTokens, size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for clone detection." << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    CloneDetector detector(minTokens, threadCount);
+    CloneStats stats;
+    detector.detect(files, stats);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    detector.printReport(std::cout, stats);
+    std::cout << "Detection time: " << elapsed.count() << " ms" << std::endl;
+    return 0;
+}
+
+/**
+ * 比较两个版本的token序列
+ */
+int runTokenDiff(const std::string& oldPath, const std::string& newPath) {
+    auto start = std::chrono::steady_clock::now();
+    TokenDiff diff;
+    TokenDiffStats stats;
+    if (!diff.compare(oldPath, newPath, stats)) {
+        std::cerr << "Error: Cannot open file '" << oldPath << "' or '" << newPath << "'" << std::endl;
+        return 1;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    diff.printReport(std::cout, stats);
+    std::cout << "Diff time: " << elapsed.count() << " ms" << std::endl;
+    return 0;
+}
+
+/**
+ * 函数级代码度量，可导出为CSV或JSON
+ */
+int runMetrics(const std::vector<std::string>& inputs, const std::string& csvPath, const std::string& jsonPath,
+               const std::vector<std::string>& includePaths, bool expandMacros, size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for metrics." << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    FrontEnd frontEnd(includePaths, expandMacros, threadCount);
+    CodeMetrics metrics(threadCount);
+    MetricsStats stats;
+    metrics.analyze(files, frontEnd.analyzer, stats);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    metrics.printReport(std::cout, stats);
+
+    bool ok = true;
+    auto exportTo = [&ok](const std::string& path, const std::string& content) {
+        if (path.empty()) {
+            return;
+        }
+        if (BinaryWriter::writeFileAtomically(path, content.data(), content.size())) {
+            std::cout << "Metrics written to " << path << std::endl;
+        } else {
+            std::cerr << "Error: Cannot write metrics to '" << path << "'" << std::endl;
+            ok = false;
+        }
+    };
+    std::ostringstream csv;
+    if (!csvPath.empty()) {
+        metrics.writeCSV(csv);
+    }
+    exportTo(csvPath, csv.str());
+    std::ostringstream json;
+    if (!jsonPath.empty()) {
+        metrics.writeJSON(json);
+    }
+    exportTo(jsonPath, json.str());
+    std::cout << "Metrics time: " << elapsed.count() << " ms" << std::endl;
+    return ok ? 0 : 1;
+}
+
+/**
+ * 区间分析；有警告或文件无法分析时返回1，便于在持续集成中使用
+ */
+int runIntervalAnalysis(const std::vector<std::string>& inputs, const std::vector<std::string>& includePaths,
+                        bool expandMacros, size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for interval analysis." << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    FrontEnd frontEnd(includePaths, expandMacros, threadCount);
+    IntervalAnalyzer analyzer(threadCount);
+    IntervalStats stats;
+    analyzer.analyze(files, frontEnd.analyzer, stats);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    analyzer.printReport(std::cout, stats);
+    std::cout << "Analysis time: " << elapsed.count() << " ms" << std::endl;
+    bool warnings = std::any_of(analyzer.getFindings().begin(), analyzer.getFindings().end(),
+                                [](const IntervalFinding& finding) {
+                                    return finding.kind != IntervalFindingKind::LoopBound;
+                                });
+    return warnings || stats.failed > 0 ? 1 : 0;
+}
+
+/**
+ * 循环次数与代价估计；有函数超过上限或文件无法分析时返回1，调用者据此拒绝输入
+ * assumeUnbounded为false时递归与无法确定的循环次数视为无界，这些函数一律超过上限
+ */
+int runCostEstimate(const std::vector<std::string>& inputs, double limit, double assumed, bool assumeUnbounded,
+                    const std::vector<std::string>& includePaths, bool expandMacros, size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for cost estimation." << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    FrontEnd frontEnd(includePaths, expandMacros, threadCount);
+    CostEstimator estimator(threadCount, limit, assumed, assumeUnbounded);
+    CostStats stats;
+    estimator.analyze(files, frontEnd.analyzer, stats);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    estimator.printReport(std::cout, stats);
+    std::cout << "Estimate time: " << elapsed.count() << " ms" << std::endl;
+    return stats.overLimit > 0 || stats.failed > 0 ? 1 : 0;
+}
+
+/**
+ * 不可达代码与无用写入检测；有发现或文件无法分析时返回1
+ */
+int runDeadCodeDetection(const std::vector<std::string>& inputs, const std::vector<std::string>& includePaths,
+                         bool expandMacros, size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for dead code detection." << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    FrontEnd frontEnd(includePaths, expandMacros, threadCount);
+    DeadCodeDetector detector(threadCount);
+    DeadCodeStats stats;
+    detector.analyze(files, frontEnd.analyzer, stats);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    detector.printReport(std::cout, stats);
+    std::cout << "Detection time: " << elapsed.count() << " ms" << std::endl;
+    return !detector.getFindings().empty() || stats.failed > 0 ? 1 : 0;
+}
+
+/**
+ * 按规则检查代码；ruleList为逗号分隔的规则名，为空时启用全部内置规则。有发现或文件无法分析时返回1
+ */
+int runLint(const std::vector<std::string>& inputs, const std::string& ruleList,
+            const std::vector<std::string>& includePaths, bool expandMacros, size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for lint." << std::endl;
+        return 1;
+    }
+    std::vector<std::string> selected;
+    std::stringstream names(ruleList);
+    std::string name;
+    while (std::getline(names, name, ',')) {
+        if (!name.empty()) {
+            selected.push_back(name);
+        }
+    }
+    LintEngine engine(threadCount);
+    for (auto& rule : LintEngine::builtinRules()) {
+        auto it = std::find(selected.begin(), selected.end(), rule->name());
+        if (selected.empty() || it != selected.end()) {
+            if (it != selected.end()) {
+                selected.erase(it);
+            }
+            engine.addRule(std::move(rule));
+        }
+    }
+    if (!selected.empty()) {
+        std::cerr << "Error: Unknown lint rule '" << selected.front() << "'. Available rules:" << std::endl;
+        for (const auto& rule : LintEngine::builtinRules()) {
+            std::cerr << "  " << rule->name() << " - " << rule->description() << std::endl;
+        }
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    FrontEnd frontEnd(includePaths, expandMacros, threadCount);
+    LintStats stats;
+    engine.analyze(files, frontEnd.analyzer, stats);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    engine.printReport(std::cout, stats);
+    std::cout << "Lint time: " << elapsed.count() << " ms" << std::endl;
+    return !engine.getFindings().empty() || stats.failed > 0 ? 1 : 0;
+}
+
+/**
+ * 语料统计：token、长度、节点种类、嵌套深度与函数规模的分布
+ */
+int runCorpusStats(const std::vector<std::string>& inputs, const std::vector<std::string>& includePaths,
+                   bool expandMacros, size_t threadCount) {
+    std::vector<std::string> files = ProjectAnalyzer::collectSourceFiles(inputs);
+    if (files.empty()) {
+        std::cerr << "Error: No input files specified for statistics." << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    FrontEnd frontEnd(includePaths, expandMacros, threadCount);
+    CorpusStats corpus(threadCount);
+    corpus.analyze(files, frontEnd.analyzer);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    corpus.printReport(std::cout);
+    std::cout << "Statistics time: " << elapsed.count() << " ms" << std::endl;
+    return 0;
+}
+
+/**
+ * 导出语法高亮的HTML
+ */
+int runHtmlExport(const std::vector<std::string>& inputs, const std::string& outputPath, bool lineAnchors) {
+    if (inputs.size() != 1) {
+        std::cerr << "Error: --html expects exactly one input file." << std::endl;
+        return 1;
+    }
+    std::ifstream file(inputs[0], std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file '" << inputs[0] << "'" << std::endl;
+        return 1;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    std::string source = buffer.str();
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot create file '" << outputPath << "'" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    HtmlExportOptions options;
+    options.lineAnchors = lineAnchors;
+    HtmlExporter exporter(options);
+    HtmlExportStats stats;
+    bool ok = exporter.exportSource(source, inputs[0], out, stats);
+    out.close();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    if (!ok || !out) {
+        std::cerr << "Error: Failed to write '" << outputPath << "'" << std::endl;
+        return 1;
+    }
+
+    double seconds = std::max<double>(elapsed.count(), 1) / 1e6;
+    std::cout << "\n=== HTML Export ===" << std::endl;
+    std::cout << "Input: " << inputs[0] << " (" << stats.inputBytes << " bytes, " << stats.lines << " lines, "
+              << stats.tokens << " tokens)" << std::endl;
+    std::cout << "Output: " << outputPath << " (" << stats.outputBytes << " bytes)" << std::endl;
+    std::cout << "Export time: " << std::fixed << std::setprecision(2) << seconds * 1000 << " ms ("
+              << stats.inputBytes / seconds / (1024 * 1024) << " MB/s)" << std::endl;
+    return 0;
+}
+
+/**
+ * 编译为字节码并执行（或只输出反汇编）
+ */
+int runProgram(const std::vector<std::string>& inputs, bool execute, bool disassemble, bool dumpTraces,
+               const BytecodeCompileOptions& options, const VMOptions& vmOptions,
+               const std::vector<std::string>& includePaths, bool expandMacros) {
+    if (inputs.size() != 1) {
+        std::cerr << "Error: --run and --disasm expect exactly one input file." << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    FrontEnd frontEnd(includePaths, expandMacros, 1);
+    ParsedUnit unit;
+    bool loaded = frontEnd.analyzer.parseUnit(inputs[0], unit);
+    for (const auto& diagnostic : unit.diagnostics) {
+        std::cerr << diagnostic << std::endl;
+    }
+    if (!loaded || !unit.diagnostics.empty() || !unit.program) {
+        return 1;
+    }
+    const ProgramNode* program = unit.program.get();
+    const std::vector<Token>& tokens = unit.tokens;
+    // 分层执行时函数从不做循环变换的基线字节码开始，循环变换留给计数器触发的升级
+    VMOptions runOptions = vmOptions;
+    runOptions.tiering = execute && vmOptions.tiering && options.optimizeLoops;
+    BytecodeCompileOptions compileOptions = options;
+    compileOptions.optimizeLoops = options.optimizeLoops && !runOptions.tiering;
+    BytecodeCompiler compiler(compileOptions);
+    BytecodeModule module;
+    if (!compiler.compile(*program, tokens, module)) {
+        for (const auto& error : compiler.getErrors()) {
+            std::cerr << inputs[0] << ": " << error << std::endl;
+        }
+        return 1;
+    }
+    auto compiled = std::chrono::steady_clock::now();
+    const BytecodeCompileStats& compileStats = compiler.getStats();
+
+    if (disassemble) {
+        std::cout << "\n=== Bytecode ===" << std::endl;
+        module.disassemble(std::cout);
+    }
+    if (!compileStats.loops.empty()) {
+        std::cout << "\n=== Loop Dependences ===" << std::endl;
+        for (const auto& loop : compileStats.loops) {
+            std::cout << loop.function << ":" << loop.line << "  " << (loop.parallel ? "parallel (" : "serial (")
+                      << loop.detail << ")" << std::endl;
+        }
+    }
+    if (!execute) {
+        return 0;
+    }
+
+    std::cout << "\n=== Program Output ===" << std::endl;
+    VirtualMachine vm(module, runOptions);
+    int64_t result = 0;
+    bool ok = true;
+    try {
+        result = vm.run(std::cout);
+    } catch (const RuntimeError& error) {
+        std::cout.flush();
+        std::cerr << inputs[0] << ": " << error.getFullMessage() << std::endl;
+        ok = false;
+    }
+    auto finished = std::chrono::steady_clock::now();
+    const VMStats& stats = vm.getStats();
+
+    auto milliseconds = [](std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000.0;
+    };
+    std::cout << "\n=== Execution ===" << std::endl;
+    if (ok) {
+        std::cout << "Return value: " << result << std::endl;
+    }
+    std::cout << "Functions: " << compileStats.functions << " (" << compileStats.instructions << " instructions)"
+              << std::endl;
+    std::cout << "Array accesses: " << compileStats.elidedAccesses << " without bounds check, "
+              << compileStats.checkedAccesses << " checked" << std::endl;
+    std::cout << "Instructions executed: " << stats.instructions << std::endl;
+    std::cout << "Bounds checks executed: " << stats.boundsChecks << std::endl;
+    std::cout << "Calls: " << stats.calls << " (max depth " << stats.maxCallDepth << ")" << std::endl;
+    std::cout << "Parallel loops: " << compileStats.parallelLoops << " of " << compileStats.loops.size()
+              << " for loops, " << stats.parallelLoops << " run(s) in " << stats.parallelChunks << " chunk(s)"
+              << std::endl;
+    if (const TierManager* tiers = vm.getTierManager()) {
+        TierStats tierStats = tiers->getStats();
+        std::cout << "Loop optimizations: " << tierStats.loops.rotated << " rotated, " << tierStats.loops.unrolled
+                  << " unrolled, " << tierStats.loops.reduced << " multiplies reduced (in tier-ups)" << std::endl;
+        std::cout << "Tiering: " << tierStats.tierUps << " tier-up(s) (" << tierStats.byCalls << " by calls, "
+                  << tierStats.byBackEdges << " by back edges), " << tierStats.optimized << " optimized, "
+                  << tierStats.unchanged << " unchanged, " << tierStats.switched << " switched at entry, "
+                  << tierStats.optimizedCalls << " optimized call(s), " << std::fixed << std::setprecision(2)
+                  << tierStats.compileMs << " ms compiling" << std::endl;
+    } else {
+        std::cout << "Loop optimizations: " << compileStats.loopsRotated << " rotated, " << compileStats.loopsUnrolled
+                  << " unrolled, " << compileStats.multipliesReduced << " multiplies reduced" << std::endl;
+    }
+    if (const TraceJit* jit = vm.getTraceJit()) {
+        const TraceJitStats& traceStats = jit->getStats();
+        std::cout << "Traces: " << traceStats.compiled << " compiled, " << traceStats.aborted << " aborted, "
+                  << traceStats.entries << " entries, " << traceStats.iterations << " iterations ("
+                  << traceStats.instructions << " instructions in native code)" << std::endl;
+    }
+    std::cout << std::fixed << std::setprecision(2) << "Compile time: " << milliseconds(compiled - start)
+              << " ms, run time: " << milliseconds(finished - compiled) << " ms" << std::endl;
+    if (const TierManager* tiers = vm.getTierManager()) {
+        std::vector<TierUp> events = tiers->getTierUps();
+        if (!events.empty()) {
+            std::cout << "\n=== Tier-ups ===" << std::endl;
+        }
+        for (const auto& event : events) {
+            std::cout << module.functions[event.function].name << ": " << (event.byCalls ? "calls " : "back edges ")
+                      << (event.byCalls ? event.calls : event.backEdges) << " -> ";
+            if (!event.changed) {
+                std::cout << "unchanged" << std::endl;
+                continue;
+            }
+            std::cout << "tier 1 (" << event.loops.rotated << " rotated, " << event.loops.unrolled << " unrolled, "
+                      << event.loops.reduced << " reduced), ";
+            if (event.switchedAtCall > 0) {
+                std::cout << "switched at call " << event.switchedAtCall << ", " << event.optimizedCalls
+                          << " optimized call(s)" << std::endl;
+            } else {
+                std::cout << "not re-entered (no on-stack replacement: the running call stays on baseline code)"
+                          << std::endl;
+            }
+        }
+    }
+    if (dumpTraces && vm.getTraceJit()) {
+        std::cout << "\n=== Traces ===" << std::endl;
+        vm.getTraceJit()->dump(std::cout);
+    }
+    return ok ? 0 : 1;
+}
+
+/**
+ * 按语法树比较两个版本
+ */
+int runASTDiff(const std::string& oldPath, const std::string& newPath) {
+    auto start = std::chrono::steady_clock::now();
+    ASTDiff diff;
+    ASTDiffStats stats;
+    if (!diff.compare(oldPath, newPath, stats)) {
+        for (const auto& diagnostic : diff.getDiagnostics()) {
+            std::cerr << "Error: " << diagnostic << std::endl;
+        }
+        return 1;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    diff.printReport(std::cout, stats);
+    std::cout << "Diff time: " << elapsed.count() << " ms" << std::endl;
+    return 0;
+}
+
+/**
+ * 解析数值选项的值：整个参数须是非负的十进制数且不超出T的范围，否则输出错误并返回false
+ */
+template <typename T>
+bool parseOptionValue(const std::string& option, const std::string& text, T& value) {
+    T parsed{};
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, parsed);
+    if (text.empty() || result.ec != std::errc() || result.ptr != end || !(parsed >= 0) ||
+        !std::isfinite(static_cast<double>(parsed))) {
+        std::cerr << "Error: invalid value for " << option << ": '" << text << "'" << std::endl;
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
 /**
  * 主函数
  */
@@ -532,6 +1467,56 @@ int main(int argc, char* argv[]) {
     bool formatOnly = false;
     bool outputOnly = false;
     bool interactiveFlag = false;
+    bool resolveIncludes = false;
+    bool preprocessOnly = false;
+    bool showMacroTable = false;
+    bool expandMacros = true;
+    std::string includeGraphFormat;  // 为空表示不输出包含关系图
+    std::string astJSONPath;         // --ast-json / --ast-dot：导出语法树的文件
+    std::string astDotPath;
+    std::string pchDirectory;        // 为空表示不使用预编译头
+    bool projectMode = false;
+    std::string projectCachePath;    // 为空表示不使用工程增量缓存
+    size_t threadCount = 0;          // 0表示使用硬件并发数
+    std::vector<std::string> inputFiles;
+    std::string buildIndexPath;      // --build-index 的索引文件
+    std::string queryIndexPath;      // --query-index 的索引文件
+    std::string queryName;
+    std::string astQuery;            // --query 的查询文本
+    std::string indexPath;           // --index：查询时用于跳过文件的索引
+    std::string rewritePattern;      // --rewrite 的模式与替换
+    std::string rewriteReplacement;
+    bool rewriteMode = false;
+    bool writeFiles = false;         // --write：把改写结果写回文件
+    std::string renameFrom;          // --rename 的旧名与新名
+    std::string renameTo;
+    bool detectClones = false;
+    size_t minCloneTokens = 50;      // --min-tokens：最短克隆长度
+    std::string diffOld;             // --diff 的旧版本与新版本
+    std::string diffNew;
+    bool structuralDiff = false;     // --ast-diff：按语法树比较
+    bool computeMetrics = false;
+    std::string metricsCSVPath;      // --metrics-csv / --metrics-json：导出度量的文件
+    std::string metricsJSONPath;
+    bool intervalAnalysis = false;   // --intervals：区间分析
+    bool estimateCost = false;
+    double maxCost = 1e7;            // --max-cost：代价上限
+    double costAssumed = 100;        // --cost-assume：未知规模与循环次数的假定值
+    bool costAssumeGiven = false;    // 给出--cost-assume时递归与无法确定的循环次数也取该值，否则视为无界
+    bool detectDeadCode = false;
+    bool stripDeadCode = false;      // --strip-dead：格式化与输出前删除死代码
+    bool lint = false;
+    std::string lintRules;           // --lint-rules：逗号分隔的规则名，为空表示全部
+    bool corpusStats = false;        // --stats：语料统计
+    std::string htmlPath;            // --html：导出的HTML文件
+    bool htmlLineAnchors = false;
+    bool runMode = false;            // --run：编译为字节码并执行
+    bool disassemble = false;        // --disasm：输出字节码
+    bool dumpTraces = false;         // --dump-traces：执行后输出编译的轨迹
+    BytecodeCompileOptions compileOptions;
+    VMOptions vmOptions;
+    vmOptions.tiering = true;        // 默认只对变热的函数做循环变换；--no-tiering改为编译时对所有函数做
+    std::vector<std::string> includePaths;
     std::string filename;
     
     // 解析命令行参数
@@ -553,8 +1538,150 @@ int main(int argc, char* argv[]) {
             formatOnly = true;
         } else if (arg == "-o" || arg == "--output") {
             outputOnly = true;
+        } else if (arg == "-I" && i + 1 < argc) {
+            includePaths.push_back(argv[++i]);
+            resolveIncludes = true;
+        } else if (arg.size() > 2 && arg.compare(0, 2, "-I") == 0) {
+            includePaths.push_back(arg.substr(2));
+            resolveIncludes = true;
+        } else if (arg == "--include-graph" || arg == "--include-graph=text") {
+            includeGraphFormat = "text";
+            resolveIncludes = true;
+        } else if (arg == "--include-graph=dot") {
+            includeGraphFormat = "dot";
+            resolveIncludes = true;
+        } else if (arg == "--ast-json" && i + 1 < argc) {
+            astJSONPath = argv[++i];
+        } else if (arg == "--ast-dot" && i + 1 < argc) {
+            astDotPath = argv[++i];
+        } else if (arg == "-E" || arg == "--preprocess") {
+            preprocessOnly = true;
+        } else if (arg == "--macro-table") {
+            showMacroTable = true;
+        } else if (arg == "--no-macros") {
+            expandMacros = false;
+        } else if (arg == "--pch-dir" && i + 1 < argc) {
+            pchDirectory = argv[++i];
+            resolveIncludes = true;
+        } else if (arg == "--project") {
+            projectMode = true;
+        } else if (arg == "--project-cache" && i + 1 < argc) {
+            projectCachePath = argv[++i];
+            projectMode = true;
+        } else if (arg == "--build-index" && i + 1 < argc) {
+            buildIndexPath = argv[++i];
+        } else if (arg == "--query-index" && i + 2 < argc) {
+            queryIndexPath = argv[++i];
+            queryName = argv[++i];
+        } else if (arg == "--query" && i + 1 < argc) {
+            astQuery = argv[++i];
+        } else if (arg == "--rewrite" && i + 2 < argc) {
+            rewritePattern = argv[++i];
+            rewriteReplacement = argv[++i];
+            rewriteMode = true;
+        } else if (arg == "--rename" && i + 2 < argc) {
+            renameFrom = argv[++i];
+            renameTo = argv[++i];
+        } else if (arg == "--clones") {
+            detectClones = true;
+        } else if (arg == "--min-tokens" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], minCloneTokens)) {
+                return 1;
+            }
+        } else if (arg == "--diff" && i + 2 < argc) {
+            diffOld = argv[++i];
+            diffNew = argv[++i];
+        } else if (arg == "--ast-diff" && i + 2 < argc) {
+            diffOld = argv[++i];
+            diffNew = argv[++i];
+            structuralDiff = true;
+        } else if (arg == "--metrics") {
+            computeMetrics = true;
+        } else if (arg == "--metrics-csv" && i + 1 < argc) {
+            metricsCSVPath = argv[++i];
+            computeMetrics = true;
+        } else if (arg == "--metrics-json" && i + 1 < argc) {
+            metricsJSONPath = argv[++i];
+            computeMetrics = true;
+        } else if (arg == "--intervals") {
+            intervalAnalysis = true;
+        } else if (arg == "--cost") {
+            estimateCost = true;
+        } else if (arg == "--max-cost" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], maxCost)) {
+                return 1;
+            }
+            estimateCost = true;
+        } else if (arg == "--cost-assume" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], costAssumed)) {
+                return 1;
+            }
+            costAssumeGiven = true;
+            estimateCost = true;
+        } else if (arg == "--dead-code") {
+            detectDeadCode = true;
+        } else if (arg == "--strip-dead") {
+            stripDeadCode = true;
+        } else if (arg == "--lint") {
+            lint = true;
+        } else if (arg == "--lint-rules" && i + 1 < argc) {
+            lintRules = argv[++i];
+            lint = true;
+        } else if (arg == "--stats") {
+            corpusStats = true;
+        } else if (arg == "--html" && i + 1 < argc) {
+            htmlPath = argv[++i];
+        } else if (arg == "--html-lines") {
+            htmlLineAnchors = true;
+        } else if (arg == "--run") {
+            runMode = true;
+        } else if (arg == "--disasm") {
+            disassemble = true;
+        } else if (arg == "--no-bce") {
+            compileOptions.eliminateBoundsChecks = false;
+        } else if (arg == "--no-parallel") {
+            compileOptions.parallelizeLoops = false;
+        } else if (arg == "--no-loop-opt") {
+            compileOptions.optimizeLoops = false;
+        } else if (arg == "--no-jit") {
+            vmOptions.jit = false;
+        } else if (arg == "--jit-threshold" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], vmOptions.jitThreshold)) {
+                return 1;
+            }
+        } else if (arg == "--dump-traces") {
+            dumpTraces = true;
+        } else if (arg == "--no-tiering") {
+            vmOptions.tiering = false;
+        } else if (arg == "--tier-calls" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], vmOptions.tierCallThreshold)) {
+                return 1;
+            }
+        } else if (arg == "--tier-loops" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], vmOptions.tierBackEdgeThreshold)) {
+                return 1;
+            }
+        } else if (arg == "--tier-sync") {
+            vmOptions.tierInBackground = false;
+        } else if (arg == "--parallel-min" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], vmOptions.minParallelTrips)) {
+                return 1;
+            }
+        } else if (arg == "--write") {
+            writeFiles = true;
+        } else if (arg == "--index" && i + 1 < argc) {
+            indexPath = argv[++i];
+        } else if (arg == "-j" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], threadCount)) {
+                return 1;
+            }
+        } else if (arg.size() > 2 && arg.compare(0, 2, "-j") == 0) {
+            if (!parseOptionValue("-j", arg.substr(2), threadCount)) {
+                return 1;
+            }
         } else if (arg[0] != '-') {
             filename = arg;
+            inputFiles.push_back(arg);
         } else {
             std::cerr << "Unknown option: " << arg << std::endl;
             showUsage(argv[0]);
@@ -569,6 +1696,73 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
+    if (!queryIndexPath.empty()) {
+        return queryIndex(queryIndexPath, queryName);
+    }
+    
+    if (!diffOld.empty()) {
+        return structuralDiff ? runASTDiff(diffOld, diffNew) : runTokenDiff(diffOld, diffNew);
+    }
+    
+    if (computeMetrics) {
+        return runMetrics(inputFiles, metricsCSVPath, metricsJSONPath, includePaths, expandMacros, threadCount);
+    }
+    
+    if (intervalAnalysis) {
+        return runIntervalAnalysis(inputFiles, includePaths, expandMacros, threadCount);
+    }
+    
+    if (estimateCost) {
+        return runCostEstimate(inputFiles, maxCost, costAssumed, costAssumeGiven, includePaths, expandMacros, threadCount);
+    }
+    
+    if (detectDeadCode) {
+        return runDeadCodeDetection(inputFiles, includePaths, expandMacros, threadCount);
+    }
+    
+    if (lint) {
+        return runLint(inputFiles, lintRules, includePaths, expandMacros, threadCount);
+    }
+    
+    if (corpusStats) {
+        return runCorpusStats(inputFiles, includePaths, expandMacros, threadCount);
+    }
+    
+    if (!htmlPath.empty()) {
+        return runHtmlExport(inputFiles, htmlPath, htmlLineAnchors);
+    }
+    
+    if (runMode || disassemble) {
+        vmOptions.threads = threadCount;
+        return runProgram(inputFiles, runMode, disassemble, dumpTraces, compileOptions, vmOptions, includePaths,
+                          expandMacros);
+    }
+    
+    if (detectClones) {
+        return runCloneDetection(inputFiles, minCloneTokens, threadCount);
+    }
+    
+    if (!renameFrom.empty()) {
+        return runRename(renameFrom, renameTo, inputFiles, includePaths, indexPath, expandMacros, writeFiles,
+                         threadCount);
+    }
+    
+    if (rewriteMode) {
+        return runRewrite(rewritePattern, rewriteReplacement, inputFiles, writeFiles, threadCount);
+    }
+    
+    if (!astQuery.empty()) {
+        return runQuery(astQuery, inputFiles, includePaths, indexPath, expandMacros, threadCount);
+    }
+    
+    if (!buildIndexPath.empty()) {
+        return buildIndex(buildIndexPath, inputFiles, includePaths, expandMacros, threadCount);
+    }
+    
+    if (projectMode) {
+        return runProject(inputFiles, includePaths, pchDirectory, projectCachePath, expandMacros, threadCount);
+    }
+    
     if (filename.empty()) {
         std::cerr << "Error: No input file specified." << std::endl;
         std::cout << "\n💡 提示: 使用 " << argv[0] << " -i 启动交互式界面" << std::endl;
@@ -578,6 +1772,20 @@ int main(int argc, char* argv[]) {
     
     // 创建代码分析器
     CodeAnalyzer analyzer;
+    IncludeResolver includeResolver;
+    if (resolveIncludes) {
+        for (const auto& path : includePaths) {
+            includeResolver.addSearchPath(path);
+        }
+        analyzer.setIncludeResolver(&includeResolver);
+    }
+    std::unique_ptr<PrecompiledHeaderCache> pchCache;
+    if (!pchDirectory.empty()) {
+        pchCache = std::make_unique<PrecompiledHeaderCache>(pchDirectory, &includeResolver);
+        analyzer.setPrecompiledHeaderCache(pchCache.get());
+    }
+    analyzer.setExpandMacros(expandMacros);
+    analyzer.setStripDeadCode(stripDeadCode);
     
     // 加载源代码文件
     if (!analyzer.loadFromFile(filename)) {
@@ -585,7 +1793,15 @@ int main(int argc, char* argv[]) {
     }
     
     try {
-        if (tokensOnly) {
+        if (preprocessOnly) {
+            // 只执行预处理，输出展开后的代码
+            if (!analyzer.performLexicalAnalysis()) {
+                analyzer.showErrorReport();
+                return 1;
+            }
+            std::cout << "\n=== Preprocessed Code ===" << std::endl;
+            Preprocessor::print(analyzer.getPreprocessedTokens(), std::cout);
+        } else if (tokensOnly) {
             // 只执行词法分析
             std::cout << "\n🔤 执行词法分析..." << std::endl;
             analyzer.performLexicalAnalysis();
@@ -654,8 +1870,28 @@ int main(int argc, char* argv[]) {
             analyzer.analyze(showDetails);
         }
         
+        if (showMacroTable) {
+            analyzer.showMacroTable();
+        }
+        
+        // 输出包含关系图
+        if (includeGraphFormat == "text") {
+            includeResolver.printIncludeGraph(std::cout);
+        } else if (includeGraphFormat == "dot") {
+            includeResolver.printIncludeGraphDot(std::cout);
+        }
+        
+        // 导出语法树
+        bool astWritten = true;
+        if (!astJSONPath.empty()) {
+            astWritten = analyzer.writeAST(astJSONPath, ASTDumpFormat::JSON) && astWritten;
+        }
+        if (!astDotPath.empty()) {
+            astWritten = analyzer.writeAST(astDotPath, ASTDumpFormat::Dot) && astWritten;
+        }
+        
         // 返回适当的退出代码
-        return analyzer.hasErrors() ? 1 : 0;
+        return analyzer.hasErrors() || !astWritten ? 1 : 0;
         
     } catch (const std::exception& e) {
         std::cerr << "Error during analysis: " << e.what() << std::endl;
@@ -0,0 +1,9 @@
+#ifndef LIMITS_H
+#define LIMITS_H
+
+#define MAX_ITEMS 64
+#define SCALE(x) ((x) * MAX_ITEMS)
+
+int clamp(int value, int limit);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef UTIL_H
+#define UTIL_H
+#include "config.h"
+
+int add(int a, int b);
+int global_count = 0;
+
+#endif